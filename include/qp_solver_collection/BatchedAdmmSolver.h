@@ -0,0 +1,201 @@
+/* Author: Masaki Murooka */
+
+#pragma once
+
+#include <qp_solver_collection/QpSolverCollection.h>
+
+namespace QpSolverCollection
+{
+/** \brief ADMM solver of many QPs with the same dimensions.
+
+    Solve a batch of QPs of @ref QpSolver#solve "QpSolver::solve" that share the dimensions but differ in the
+   coefficients. The iterations are the same as those of OSQP (without scaling), and the KKT matrix of each QP is
+   factorized by dense Cholesky decomposition. The KKT matrices are refactorized only when the penalty parameter of any
+   QP is adapted.
+
+    The coefficients and iterates are stored in structure-of-arrays layout: each element (e.g., an element of the
+   objective matrix) is a contiguous row over the QPs. All the operations, including the Cholesky decomposition and
+   triangular solves, are written as Eigen expressions on such rows, so that the QPs are processed in the SIMD lanes
+   (the width depends on the instruction set enabled at compile time, e.g., with -march=native).
+
+    The batch is divided into blocks of block_size QPs, each of which is iterated independently until all its QPs
+   converge, so that the working set of a block fits in the cache. Convergence is checked for each QP every
+   check_interval_ iterations, and the iterates of the converged QPs are frozen by masks, so the solution of each QP
+   does not depend on the other QPs in the batch.
+ */
+class BatchedAdmmSolver
+{
+public:
+  /** \brief Type of array in structure-of-arrays layout (rows are elements and columns are QPs). */
+  using BatchArray = Eigen::Array<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>;
+
+  /** \brief Type of array with an element for each QP. */
+  using LaneArray = Eigen::Array<double, 1, Eigen::Dynamic>;
+
+public:
+  /** \brief Allocate the batch.
+      \param batch_size number of QPs
+      \param dim_var dimension of decision variable
+      \param dim_eq dimension of equality constraint
+      \param dim_ineq dimension of inequality constraint
+      \param block_size number of QPs iterated together (a multiple of the SIMD width is efficient)
+
+      The coefficients are initialized to those of QpCoeff::setup.
+   */
+  void setup(int batch_size, int dim_var, int dim_eq, int dim_ineq, int block_size = 32);
+
+  /** \brief Set QP coefficient of a QP in the batch.
+      \param idx index of QP in the batch
+      \param qp_coeff QP coefficient whose dimensions are the same as those given to setup
+   */
+  void setQpCoeff(int idx, const QpCoeff & qp_coeff);
+
+  /** \brief Solve all the QPs in the batch (the iterates start from zero). */
+  void solve();
+
+  /** \brief Get solution of a QP in the batch (Lagrange multipliers follow the sign convention of SolveResult). */
+  SolveResult result(int idx) const;
+
+  /** \brief Get number of QPs in the batch. */
+  inline int batchSize() const
+  {
+    return batch_size_;
+  }
+
+  /** \brief Get number of iterations of a QP in the batch in the last solve. */
+  inline int iterNum(int idx) const
+  {
+    return iter_num_[idx];
+  }
+
+  /** \brief Get status of a QP in the batch in the last solve. */
+  inline QpSolveStatus status(int idx) const
+  {
+    return status_[idx];
+  }
+
+  /** \brief Get number of QPs that are solved in the last solve. */
+  int solvedNum() const;
+
+public:
+  //! Initial ADMM penalty parameter of inequality constraints and bounds (multiplied by 1e3 for equality constraints)
+  double rho_ = 0.1;
+
+  //! Whether to adapt the ADMM penalty parameter of each QP to balance the primal and dual residuals
+  bool adaptive_rho_ = true;
+
+  //! Regularization of the decision variable
+  double sigma_ = 1e-6;
+
+  //! Relaxation parameter
+  double alpha_ = 1.6;
+
+  //! Absolute tolerance of primal and dual residuals
+  double eps_abs_ = 1e-5;
+
+  //! Relative tolerance of primal and dual residuals
+  double eps_rel_ = 1e-5;
+
+  //! Maximum number of iterations
+  int max_iter_ = 4000;
+
+  //! Interval of iterations to check convergence
+  int check_interval_ = 10;
+
+protected:
+  /** \brief Coefficients, iterates, and workspace of a block of QPs (rows are elements and columns are QPs). */
+  struct LaneBlock
+  {
+    //! Index of the first QP of the block in the batch
+    int offset = 0;
+
+    //! Coefficients (objective matrix, equality and inequality constraint matrices are stored in row-major order)
+    BatchArray obj_mat;
+    BatchArray obj_vec;
+    BatchArray cstr_mat;
+    BatchArray cstr_min;
+    BatchArray cstr_max;
+    BatchArray x_min;
+    BatchArray x_max;
+
+    //! Lower triangular Cholesky factor of KKT matrices (stored in row-major order)
+    BatchArray kkt_factor;
+
+    //! Reciprocals of diagonal elements of the Cholesky factor
+    BatchArray kkt_diag_inv;
+
+    //! ADMM penalty parameters of constraints and bounds
+    BatchArray cstr_rho;
+    LaneArray bound_rho;
+
+    //! Primal iterate, and auxiliary and dual variables of constraints and bounds
+    BatchArray x;
+    BatchArray cstr_z;
+    BatchArray cstr_y;
+    BatchArray bound_z;
+    BatchArray bound_y;
+
+    //! Workspace
+    BatchArray x_tilde;
+    BatchArray cstr_z_tilde;
+    BatchArray cstr_tmp;
+    BatchArray var_tmp;
+
+    //! Mask of QPs that are not converged yet (1 for active and 0 for frozen)
+    LaneArray active_mask;
+  };
+
+protected:
+  /** \brief Iterate a block until all its QPs converge. */
+  void solveBlock(LaneBlock & block);
+
+  /** \brief Factorize KKT matrices of all the QPs in a block.
+      \returns mask of QPs whose KKT matrix is positive definite
+   */
+  Eigen::Array<bool, 1, Eigen::Dynamic> factorize(LaneBlock & block) const;
+
+  /** \brief Solve linear equations with the factorized KKT matrices in place. */
+  void solveKkt(const LaneBlock & block, BatchArray & vec) const;
+
+  /** \brief Check convergence of the active QPs, freeze the converged ones, and adapt the penalty parameters.
+      \param block block of QPs
+      \param iter_num number of iterations so far
+      \returns whether the penalty parameter of any QP is updated (i.e., refactorization is required)
+   */
+  bool checkConvergence(LaneBlock & block, int iter_num);
+
+  /** \brief Update the penalty parameters of constraints from those of bounds. */
+  void updateCstrRho(LaneBlock & block) const;
+
+  /** \brief Compute mat * vec for each QP (mat has dim_row * dim_col rows in row-major order). */
+  void multiply(const BatchArray & mat, int dim_row, int dim_col, const BatchArray & vec, BatchArray & out) const;
+
+  /** \brief Compute mat^T * vec for each QP (mat has dim_row * dim_col rows in row-major order). */
+  void multiplyTranspose(const BatchArray & mat,
+                         int dim_row,
+                         int dim_col,
+                         const BatchArray & vec,
+                         BatchArray & out) const;
+
+protected:
+  //! Number of QPs
+  int batch_size_ = 0;
+
+  //! Number of QPs in each block
+  int block_size_ = 0;
+
+  //! Dimensions
+  int dim_var_ = 0;
+  int dim_eq_ = 0;
+  int dim_ineq_ = 0;
+
+  //! Blocks of QPs
+  std::vector<LaneBlock> block_list_;
+
+  //! Number of iterations of each QP
+  std::vector<int> iter_num_;
+
+  //! Status of each QP
+  std::vector<QpSolveStatus> status_;
+};
+} // namespace QpSolverCollection
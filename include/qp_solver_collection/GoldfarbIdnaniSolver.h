@@ -0,0 +1,619 @@
+/* Author: Masaki Murooka */
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+#include <Eigen/Cholesky>
+#include <Eigen/Core>
+
+namespace QpSolverCollection
+{
+/** \brief Dense dual active-set QP solver of Goldfarb and Idnani.
+
+    This is a header-only implementation depending only on Eigen, which is used by QpSolverBuiltin. The QP is
+   formulated in the same way as @ref QpSolver#solve "QpSolver::solve".
+
+    The algorithm follows D. Goldfarb and A. Idnani, "A numerically stable dual method for solving strictly convex
+   quadratic programs," Mathematical Programming, 1983. The active set is represented by the QR decomposition of
+   \f$\boldsymbol{L}^{-1} \boldsymbol{N}\f$ (\f$\boldsymbol{L}\f$ is the Cholesky factor of the objective matrix and
+   \f$\boldsymbol{N}\f$ is the matrix of active constraint normals), which is updated by Givens rotations when a
+   constraint is added or deleted.
+
+    The implementation is tuned for small dense QPs:
+    - All the workspace is allocated in resize, so solves with the same dimensions do not allocate memory.
+    - Matrices are column-major and the rotations are applied to contiguous columns of \f$\boldsymbol{J}\f$ by Eigen
+   expressions, which are vectorized with SIMD instructions.
+    - Bounds are handled as constraints whose normals are unit vectors, so their products with \f$\boldsymbol{J}\f$ are
+   row extractions instead of matrix-vector products.
+    - The Cholesky factorization of the objective matrix can be reused in the next solve, which removes the cubic cost
+   when only the vectors change.
+ */
+class GoldfarbIdnaniSolver
+{
+public:
+  /** \brief Result of solve. */
+  enum class Status
+  {
+    //! Solved
+    Solved = 0,
+    //! Constraints are inconsistent
+    Infeasible,
+    //! Objective matrix is not positive definite
+    NotPositiveDefinite,
+    //! Maximum number of iterations is reached
+    MaxIterReached
+  };
+
+public:
+  /** \brief Allocate the workspace for the given dimensions (called automatically by solve if necessary). */
+  inline void resize(int dim_var, int dim_eq, int dim_ineq)
+  {
+    // The factorization of the objective matrix is kept if only the dimensions of constraints change
+    if(dim_var != dim_var_)
+    {
+      llt_ = Eigen::LLT<Eigen::MatrixXd>(dim_var);
+      J_init_.resize(dim_var, dim_var);
+      factorized_ = false;
+    }
+    dim_var_ = dim_var;
+    dim_eq_ = dim_eq;
+    dim_ineq_ = dim_ineq;
+    int ineq_num = dim_ineq + 2 * dim_var;
+    J_.resize(dim_var, dim_var);
+    R_.resize(dim_var, dim_var);
+    x_.resize(dim_var);
+    x_old_.resize(dim_var);
+    z_.resize(dim_var);
+    d_.resize(dim_var);
+    r_.resize(dim_var);
+    col_.resize(dim_var);
+    u_.resize(dim_var + 1);
+    u_old_.resize(dim_var + 1);
+    active_list_.resize(dim_var + 1);
+    active_list_old_.resize(dim_var + 1);
+    slack_.resize(ineq_num);
+    inactive_list_.resize(ineq_num);
+    addable_list_.resize(ineq_num);
+    dual_eq_.resize(dim_eq);
+    dual_ineq_.resize(dim_ineq);
+    dual_bound_.resize(dim_var);
+  }
+
+  /** \brief Solve QP.
+      \param Q objective matrix (must be positive definite)
+      \param c objective vector
+      \param A equality constraint matrix
+      \param b equality constraint vector
+      \param C inequality constraint matrix
+      \param d inequality constraint vector
+      \param x_min lower bound (infinite elements are ignored)
+      \param x_max upper bound (infinite elements are ignored)
+      \param max_iter maximum number of iterations (i.e., additions and deletions of active constraints)
+      \param reuse_factor whether to reuse the factorization of the objective matrix in the previous solve (Q must be
+     the same as that of the previous solve)
+   */
+  inline Status solve(const Eigen::Ref<const Eigen::MatrixXd> & Q,
+                      const Eigen::Ref<const Eigen::VectorXd> & c,
+                      const Eigen::Ref<const Eigen::MatrixXd> & A,
+                      const Eigen::Ref<const Eigen::VectorXd> & b,
+                      const Eigen::Ref<const Eigen::MatrixXd> & C,
+                      const Eigen::Ref<const Eigen::VectorXd> & d,
+                      const Eigen::Ref<const Eigen::VectorXd> & x_min,
+                      const Eigen::Ref<const Eigen::VectorXd> & x_max,
+                      int max_iter,
+                      bool reuse_factor = false)
+  {
+    int n = static_cast<int>(Q.rows());
+    int p = static_cast<int>(A.rows());
+    int m = static_cast<int>(C.rows());
+    if(n != dim_var_ || p != dim_eq_ || m != dim_ineq_)
+    {
+      resize(n, p, m);
+    }
+    int ineq_num = m + 2 * n;
+    constexpr double eps = std::numeric_limits<double>::epsilon();
+    constexpr double inf = std::numeric_limits<double>::infinity();
+    iter_num_ = 0;
+    dual_eq_.setZero();
+    dual_ineq_.setZero();
+    dual_bound_.setZero();
+
+    // Inequality constraint k is expressed as n_k^T x + b_k >= 0: -C x + d >= 0, x_max - x >= 0, and x - x_min >= 0
+    auto ineqValue = [&](int k) {
+      if(k < m)
+      {
+        return d[k] - C.row(k).dot(x_);
+      }
+      else if(k < m + n)
+      {
+        return std::isfinite(x_max[k - m]) ? x_max[k - m] - x_[k - m] : inf;
+      }
+      else
+      {
+        return std::isfinite(x_min[k - m - n]) ? x_[k - m - n] - x_min[k - m - n] : inf;
+      }
+    };
+    auto ineqNormalDot = [&](int k, const Eigen::VectorXd & v) {
+      if(k < m)
+      {
+        return -C.row(k).dot(v);
+      }
+      else if(k < m + n)
+      {
+        return -v[k - m];
+      }
+      else
+      {
+        return v[k - m - n];
+      }
+    };
+    // d = J^T n_k
+    auto computeIneqD = [&](int k) {
+      if(k < m)
+      {
+        d_.noalias() = -J_.transpose() * C.row(k).transpose();
+      }
+      else if(k < m + n)
+      {
+        d_ = -J_.row(k - m).transpose();
+      }
+      else
+      {
+        d_ = J_.row(k - m - n).transpose();
+      }
+    };
+    // z = J_2 d_2 and r = R^{-1} d_1 where the subscripts 1 and 2 denote the active and inactive parts
+    auto computeStep = [&](int iq) {
+      z_.noalias() = J_.rightCols(n - iq) * d_.tail(n - iq);
+      r_.head(iq) = R_.topLeftCorner(iq, iq).triangularView<Eigen::Upper>().solve(d_.head(iq));
+    };
+
+    // Unconstrained minimum and J = L^{-T}
+    if(!(reuse_factor && factorized_))
+    {
+      llt_.compute(Q);
+      factorized_ = (llt_.info() == Eigen::Success);
+      if(!factorized_)
+      {
+        return Status::NotPositiveDefinite;
+      }
+      J_init_.setIdentity();
+      llt_.matrixU().solveInPlace(J_init_);
+    }
+    J_ = J_init_;
+    double c1 = Q.trace();
+    double c2 = J_.trace();
+    x_ = -llt_.solve(c);
+    obj_ = 0.5 * c.dot(x_);
+    R_.setZero();
+    double R_norm = 1.0;
+    int iq = 0;
+
+    // Add equality constraints, whose normals are the rows of A
+    for(int i = 0; i < p; i++)
+    {
+      d_.noalias() = J_.transpose() * A.row(i).transpose();
+      if(iq >= n || d_.tail(n - iq).norm() <= std::sqrt(eps) * std::max(R_norm, d_.norm()))
+      {
+        // The constraint is linearly dependent on the active equality constraints, so it is skipped if redundant
+        if(std::abs(b[i] - A.row(i).dot(x_)) <= std::sqrt(eps) * (1.0 + std::abs(b[i])))
+        {
+          continue;
+        }
+        return Status::Infeasible;
+      }
+      computeStep(iq);
+      double t2 = 0;
+      double z_n = A.row(i).dot(z_);
+      if(std::abs(z_.dot(z_)) > eps)
+      {
+        t2 = (b[i] - A.row(i).dot(x_)) / z_n;
+      }
+      x_ += t2 * z_;
+      u_[iq] = t2;
+      u_.head(iq) -= t2 * r_.head(iq);
+      obj_ += 0.5 * t2 * t2 * z_n;
+      active_list_[iq] = -i - 1;
+      if(!addConstraint(iq, R_norm))
+      {
+        return Status::Infeasible;
+      }
+    }
+
+    for(int k = 0; k < ineq_num; k++)
+    {
+      inactive_list_[k] = k;
+    }
+
+    while(true)
+    {
+      // Step 1: choose a violated constraint
+      for(int i = p; i < iq; i++)
+      {
+        inactive_list_[active_list_[i]] = -1;
+      }
+      double psi = 0;
+      for(int k = 0; k < ineq_num; k++)
+      {
+        addable_list_[k] = 1;
+        slack_[k] = ineqValue(k);
+        psi += std::min(0.0, slack_[k]);
+      }
+      if(std::abs(psi) <= ineq_num * eps * c1 * c2 * 100.0)
+      {
+        setDual(iq, m, n);
+        return Status::Solved;
+      }
+      u_old_.head(iq) = u_.head(iq);
+      std::copy(active_list_.begin(), active_list_.begin() + iq, active_list_old_.begin());
+      x_old_ = x_;
+
+      bool restart = false;
+      while(!restart)
+      {
+        int ip = -1;
+        double ss = 0;
+        for(int k = 0; k < ineq_num; k++)
+        {
+          if(slack_[k] < ss && inactive_list_[k] != -1 && addable_list_[k])
+          {
+            ss = slack_[k];
+            ip = k;
+          }
+        }
+        if(ip == -1)
+        {
+          setDual(iq, m, n);
+          return Status::Solved;
+        }
+        u_[iq] = 0;
+        active_list_[iq] = ip;
+
+        // Step 2: check for feasibility and determine a new S-pair
+        while(true)
+        {
+          if(++iter_num_ > max_iter)
+          {
+            setDual(iq, m, n);
+            return Status::MaxIterReached;
+          }
+
+          computeIneqD(ip);
+          computeStep(iq);
+
+          // Partial step length t1 (maximum step in dual space)
+          int l = -1;
+          double t1 = inf;
+          for(int k = p; k < iq; k++)
+          {
+            if(r_[k] > 0 && u_[k] / r_[k] < t1)
+            {
+              t1 = u_[k] / r_[k];
+              l = active_list_[k];
+            }
+          }
+          // Full step length t2 (minimum step in primal space)
+          double t2 = inf;
+          double z_n = ineqNormalDot(ip, z_);
+          if(std::abs(z_.dot(z_)) > eps)
+          {
+            t2 = -slack_[ip] / z_n;
+          }
+          double t = std::min(t1, t2);
+
+          if(t >= inf)
+          {
+            return Status::Infeasible;
+          }
+
+          if(t2 >= inf)
+          {
+            // Step in dual space only
+            u_.head(iq) -= t * r_.head(iq);
+            u_[iq] += t;
+            inactive_list_[l] = l;
+            deleteConstraint(iq, p, l);
+            continue;
+          }
+
+          // Step in primal and dual space
+          x_ += t * z_;
+          obj_ += t * z_n * (0.5 * t + u_[iq]);
+          u_.head(iq) -= t * r_.head(iq);
+          u_[iq] += t;
+
+          if(t == t2)
+          {
+            // Full step: add the constraint to the active set
+            if(!addConstraint(iq, R_norm))
+            {
+              // The constraint is linearly dependent on the active set, so it is excluded and the iterate is restored
+              addable_list_[ip] = 0;
+              for(int k = 0; k < ineq_num; k++)
+              {
+                inactive_list_[k] = k;
+              }
+              for(int i = p; i < iq; i++)
+              {
+                active_list_[i] = active_list_old_[i];
+                u_[i] = u_old_[i];
+                inactive_list_[active_list_[i]] = -1;
+              }
+              x_ = x_old_;
+              break;
+            }
+            inactive_list_[ip] = -1;
+            restart = true;
+            break;
+          }
+
+          // Partial step: drop the blocking constraint
+          inactive_list_[l] = l;
+          deleteConstraint(iq, p, l);
+          slack_[ip] = ineqValue(ip);
+        }
+      }
+    }
+  }
+
+  /** \brief Get solution. */
+  inline const Eigen::VectorXd & x() const
+  {
+    return x_;
+  }
+
+  /** \brief Get objective value. */
+  inline double obj() const
+  {
+    return obj_;
+  }
+
+  /** \brief Get Lagrange multipliers of equality constraints (see SolveResult for the sign convention). */
+  inline const Eigen::VectorXd & dualEq() const
+  {
+    return dual_eq_;
+  }
+
+  /** \brief Get Lagrange multipliers of inequality constraints (see SolveResult for the sign convention). */
+  inline const Eigen::VectorXd & dualIneq() const
+  {
+    return dual_ineq_;
+  }
+
+  /** \brief Get Lagrange multipliers of bounds (see SolveResult for the sign convention). */
+  inline const Eigen::VectorXd & dualBound() const
+  {
+    return dual_bound_;
+  }
+
+  /** \brief Get number of iterations. */
+  inline int iterNum() const
+  {
+    return iter_num_;
+  }
+
+  /** \brief Get heap memory usage of the workspace in bytes. */
+  inline size_t memoryUsage() const
+  {
+    size_t double_num = llt_.matrixLLT().size() + J_init_.size() + J_.size() + R_.size() + x_.size() + x_old_.size()
+                        + z_.size() + d_.size() + r_.size() + col_.size() + u_.size() + u_old_.size() + slack_.size()
+                        + dual_eq_.size() + dual_ineq_.size() + dual_bound_.size();
+    size_t int_num =
+        active_list_.size() + active_list_old_.size() + inactive_list_.size() + addable_list_.size();
+    return sizeof(double) * double_num + sizeof(int) * int_num;
+  }
+
+protected:
+  /** \brief Add constraint whose d = J^T n is computed to the active set.
+      \returns false if the constraint is linearly dependent on the active set, in which case iq and R are unchanged
+   */
+  inline bool addConstraint(int & iq, double & R_norm)
+  {
+    int n = dim_var_;
+    if(iq >= n)
+    {
+      return false;
+    }
+    // Rotate the inactive columns of J so that d has zeros below iq
+    for(int j = n - 1; j >= iq + 1; j--)
+    {
+      double cc = d_[j - 1];
+      double ss = d_[j];
+      double h = std::hypot(cc, ss);
+      if(h == 0.0)
+      {
+        continue;
+      }
+      d_[j] = 0.0;
+      ss /= h;
+      cc /= h;
+      if(cc < 0.0)
+      {
+        cc = -cc;
+        ss = -ss;
+        d_[j - 1] = -h;
+      }
+      else
+      {
+        d_[j - 1] = h;
+      }
+      double xny = ss / (1.0 + cc);
+      rotateColumns(J_.col(j - 1), J_.col(j), cc, ss, xny);
+    }
+    if(std::abs(d_[iq]) <= std::numeric_limits<double>::epsilon() * R_norm)
+    {
+      return false;
+    }
+    iq++;
+    R_.col(iq - 1).head(iq) = d_.head(iq);
+    R_norm = std::max(R_norm, std::abs(d_[iq - 1]));
+    return true;
+  }
+
+  /** \brief Delete constraint l from the active set and restore the triangular structure of R. */
+  inline void deleteConstraint(int & iq, int p, int l)
+  {
+    int qq = -1;
+    for(int i = p; i < iq; i++)
+    {
+      if(active_list_[i] == l)
+      {
+        qq = i;
+        break;
+      }
+    }
+    for(int i = qq; i < iq - 1; i++)
+    {
+      active_list_[i] = active_list_[i + 1];
+      u_[i] = u_[i + 1];
+      R_.col(i) = R_.col(i + 1);
+    }
+    active_list_[iq - 1] = active_list_[iq];
+    u_[iq - 1] = u_[iq];
+    active_list_[iq] = 0;
+    u_[iq] = 0.0;
+    R_.col(iq - 1).head(iq).setZero();
+    iq--;
+    if(iq == 0)
+    {
+      return;
+    }
+
+    for(int j = qq; j < iq; j++)
+    {
+      double cc = R_(j, j);
+      double ss = R_(j + 1, j);
+      double h = std::hypot(cc, ss);
+      if(h == 0.0)
+      {
+        continue;
+      }
+      cc /= h;
+      ss /= h;
+      R_(j + 1, j) = 0.0;
+      if(cc < 0.0)
+      {
+        R_(j, j) = -h;
+        cc = -cc;
+        ss = -ss;
+      }
+      else
+      {
+        R_(j, j) = h;
+      }
+      double xny = ss / (1.0 + cc);
+      for(int k = j + 1; k < iq; k++)
+      {
+        double t1 = R_(j, k);
+        double t2 = R_(j + 1, k);
+        R_(j, k) = t1 * cc + t2 * ss;
+        R_(j + 1, k) = xny * (t1 + R_(j, k)) - t2;
+      }
+      rotateColumns(J_.col(j), J_.col(j + 1), cc, ss, xny);
+    }
+  }
+
+  /** \brief Apply Givens rotation to two contiguous columns (vectorized by Eigen). */
+  template<class ColType>
+  inline void rotateColumns(ColType col1, ColType col2, double cc, double ss, double xny)
+  {
+    col_ = col1;
+    col1 = cc * col_ + ss * col2;
+    col2 = xny * (col_ + col1) - col2;
+  }
+
+  /** \brief Set Lagrange multipliers from the active set. */
+  inline void setDual(int iq, int m, int n)
+  {
+    for(int i = 0; i < iq; i++)
+    {
+      int k = active_list_[i];
+      if(k < 0)
+      {
+        dual_eq_[-k - 1] = -u_[i];
+      }
+      else if(k < m)
+      {
+        dual_ineq_[k] = u_[i];
+      }
+      else if(k < m + n)
+      {
+        dual_bound_[k - m] += u_[i];
+      }
+      else
+      {
+        dual_bound_[k - m - n] -= u_[i];
+      }
+    }
+  }
+
+protected:
+  //! Dimensions of the allocated workspace
+  int dim_var_ = -1;
+  int dim_eq_ = -1;
+  int dim_ineq_ = -1;
+
+  //! Cholesky decomposition of objective matrix
+  Eigen::LLT<Eigen::MatrixXd> llt_;
+
+  //! Matrix L^{-T} (i.e., J for the empty active set)
+  Eigen::MatrixXd J_init_;
+
+  //! Whether llt_ and J_init_ hold the factorization of a positive definite objective matrix
+  bool factorized_ = false;
+
+  //! Matrix J = L^{-T} Q_N where Q_N is the orthogonal factor of the QR decomposition of L^{-1} N
+  Eigen::MatrixXd J_;
+
+  //! Triangular factor of the QR decomposition of L^{-1} N
+  Eigen::MatrixXd R_;
+
+  //! Primal iterate and its backup
+  Eigen::VectorXd x_;
+  Eigen::VectorXd x_old_;
+
+  //! Step direction in primal space
+  Eigen::VectorXd z_;
+
+  //! Product of J^T and the normal of the added constraint
+  Eigen::VectorXd d_;
+
+  //! Step direction in dual space
+  Eigen::VectorXd r_;
+
+  //! Temporary column for rotations
+  Eigen::VectorXd col_;
+
+  //! Lagrange multipliers of active constraints and their backup
+  Eigen::VectorXd u_;
+  Eigen::VectorXd u_old_;
+
+  //! Active constraints (negative for equality constraints) and their backup
+  std::vector<int> active_list_;
+  std::vector<int> active_list_old_;
+
+  //! Values of inequality constraints (n_k^T x + b_k)
+  Eigen::VectorXd slack_;
+
+  //! Index of each inequality constraint if inactive, -1 if active
+  std::vector<int> inactive_list_;
+
+  //! Whether each inequality constraint can be added (0 if linearly dependent on the active set)
+  std::vector<int> addable_list_;
+
+  //! Lagrange multipliers
+  Eigen::VectorXd dual_eq_;
+  Eigen::VectorXd dual_ineq_;
+  Eigen::VectorXd dual_bound_;
+
+  //! Objective value
+  double obj_ = 0;
+
+  //! Number of iterations
+  int iter_num_ = 0;
+};
+} // namespace QpSolverCollection
@@ -0,0 +1,253 @@
+/* Author: Masaki Murooka */
+
+#pragma once
+
+#include <atomic>
+#include <deque>
+#include <functional>
+#include <mutex>
+
+#include <qp_solver_collection/QpSolverCollection.h>
+
+namespace QpSolverCollection
+{
+/** \brief Node selection strategy of MiqpSolver. */
+enum class MiqpSearchStrategy
+{
+  //! Node with the lowest bound first (fewer nodes to prove optimality)
+  BestBound = 0,
+  //! Deepest node first (finds integer solutions early and reuses the QP solver state of the parent)
+  DepthFirst
+};
+
+/** \brief Mixed-integer QP solver with branch and bound.
+
+    Solve the QP of @ref QpSolver#solve "QpSolver::solve" with the additional constraint that the specified elements of
+   the decision variable are integers. Binary variables are represented by integer variables with bounds [0, 1].
+
+    Each node solves the QP relaxation with bounds tightened from the parent node, and branches on the most fractional
+   integer variable. Since the nodes differ only in the bounds, the dimensions and sparsity of the QPs are identical,
+   and the QP solvers that keep their workspace between solves (e.g., OSQP, qpOASES, HPIPM, and ProxQP) reuse it. In
+   addition, each relaxation is warm-started from the solution and Lagrange multipliers of the parent relaxation (see
+   WarmStart), which remains valid when the node is stolen by another worker.
+
+    The tree is explored by a pool of worker threads, each of which has its own QP solver instance and node queue. A
+   worker takes the nodes from its own queue, so the children are usually solved by the instance that solved the parent,
+   and steals nodes from the other workers when its queue is empty. Since each worker selects the best node in its own
+   queue, MiqpSearchStrategy::BestBound is best-bound only locally when multiple threads are used.
+
+    Nodes for which the QP solver fails are pruned as infeasible.
+ */
+class MiqpSolver
+{
+public:
+  /** \brief Type of function to allocate QP solver instance for each worker. */
+  using QpSolverFactory = std::function<std::shared_ptr<QpSolver>()>;
+
+public:
+  /** \brief Constructor.
+      \param qp_solver_type QP solver type for node relaxations
+   */
+  MiqpSolver(const QpSolverType & qp_solver_type);
+
+  /** \brief Constructor.
+      \param qp_solver_factory function to allocate QP solver instance for each worker
+   */
+  MiqpSolver(const QpSolverFactory & qp_solver_factory);
+
+  /** \brief Solve mixed-integer QP.
+      \param qp_coeff QP coefficient (not modified)
+      \param integer_idx_list indices of integer elements of the decision variable
+      \returns solution (zero if no integer solution is found)
+   */
+  Eigen::VectorXd solve(const QpCoeff & qp_coeff, const std::vector<int> & integer_idx_list);
+
+  /** \brief Set QP solver settings of node relaxations. */
+  inline void setQpSolverSettings(const QpSolverSettings & settings)
+  {
+    qp_settings_ = settings;
+  }
+
+  /** \brief Get whether it failed to find an integer solution. */
+  inline bool solveFailed() const
+  {
+    return solve_failed_;
+  }
+
+  /** \brief Get status of solve.
+
+      QpSolveStatus::MaxIterReached is returned if the number of nodes reaches the limit, and
+     QpSolveStatus::PrimalInfeasible is returned if the whole tree is explored without an integer solution.
+   */
+  inline QpSolveStatus status() const
+  {
+    return status_;
+  }
+
+  /** \brief Get objective value of the solution (infinity if no integer solution is found). */
+  inline double objValue() const
+  {
+    return obj_value_;
+  }
+
+  /** \brief Get lower bound of the optimal objective value. */
+  inline double lowerBound() const
+  {
+    return lower_bound_;
+  }
+
+  /** \brief Get number of nodes whose relaxation is solved. */
+  inline int nodeNum() const
+  {
+    return node_num_;
+  }
+
+public:
+  //! Node selection strategy
+  MiqpSearchStrategy strategy_ = MiqpSearchStrategy::BestBound;
+
+  //! Number of worker threads (hardware concurrency if not positive)
+  int thread_num_ = 1;
+
+  //! Maximum number of nodes
+  int max_node_num_ = 100000;
+
+  //! Tolerance to regard the value as integer
+  double int_tol_ = 1e-6;
+
+  //! Absolute tolerance of the gap between objective value and lower bound
+  double abs_gap_tol_ = 1e-6;
+
+  //! Relative tolerance of the gap between objective value and lower bound
+  double rel_gap_tol_ = 1e-6;
+
+protected:
+  /** \brief Node of branch-and-bound tree. */
+  struct Node
+  {
+    //! Lower bound of decision variable
+    Eigen::VectorXd x_min;
+
+    //! Upper bound of decision variable
+    Eigen::VectorXd x_max;
+
+    //! Lower bound of objective value (objective value of the parent relaxation)
+    double bound = -std::numeric_limits<double>::infinity();
+
+    //! Depth in the tree
+    int depth = 0;
+
+    //! Solution of the parent relaxation shared by the siblings (null for the root node)
+    std::shared_ptr<const WarmStart> warm_start;
+  };
+
+  /** \brief Worker of the pool. */
+  struct Worker
+  {
+    //! QP solver instance
+    std::shared_ptr<QpSolver> qp_solver;
+
+    //! Objective matrix passed to the QP solver (copied for each node since some QP solvers overwrite it)
+    Eigen::MatrixXd obj_mat;
+
+    //! Node queue (heap for MiqpSearchStrategy::BestBound)
+    std::deque<Node> node_queue;
+
+    //! Mutex of node queue
+    std::mutex mtx;
+  };
+
+  /** \brief Loop of worker thread. */
+  void workerLoop(int worker_idx);
+
+  /** \brief Solve relaxation of the node and push the children. */
+  void processNode(int worker_idx, Node & node);
+
+  /** \brief Push node to the queue of the worker. */
+  void pushNode(int worker_idx, Node && node);
+
+  /** \brief Pop node from the queue of the worker.
+      \param worker_idx index of the worker whose queue is accessed
+      \param steal whether another worker takes the node
+      \param[out] node popped node
+      \returns whether a node is popped
+   */
+  bool popNode(int worker_idx, bool steal, Node & node);
+
+  /** \brief Get threshold of the bound above which nodes are pruned. */
+  double pruneThreshold() const;
+
+  /** \brief Compute objective value. */
+  double computeObj(const Eigen::VectorXd & x) const;
+
+protected:
+  //! Function to allocate QP solver instance for each worker
+  QpSolverFactory qp_solver_factory_;
+
+  //! QP solver settings of node relaxations
+  QpSolverSettings qp_settings_;
+
+  //! Workers (kept between solves to reuse QP solver instances)
+  std::vector<std::unique_ptr<Worker>> worker_list_;
+
+  //! Number of workers used in the current solve
+  int worker_num_ = 0;
+
+  //! QP coefficient being solved
+  const QpCoeff * qp_coeff_ = nullptr;
+
+  //! Indices of integer elements of the decision variable
+  std::vector<int> integer_idx_list_;
+
+  //! Number of nodes pushed and not processed yet
+  std::atomic<int> pending_num_{0};
+
+  //! Number of nodes whose processing is started
+  std::atomic<int> node_count_{0};
+
+  //! Whether the number of nodes reaches the limit
+  std::atomic<bool> node_limit_reached_{false};
+
+  //! Objective value of the incumbent (read without lock for pruning)
+  std::atomic<double> incumbent_obj_{std::numeric_limits<double>::infinity()};
+
+  //! Incumbent solution
+  Eigen::VectorXd incumbent_x_;
+
+  //! Mutex of incumbent
+  std::mutex incumbent_mtx_;
+
+  //! Whether it failed to find an integer solution
+  bool solve_failed_ = false;
+
+  //! Status of solve
+  QpSolveStatus status_ = QpSolveStatus::Unsolved;
+
+  //! Objective value of the solution
+  double obj_value_ = std::numeric_limits<double>::infinity();
+
+  //! Lower bound of the optimal objective value
+  double lower_bound_ = -std::numeric_limits<double>::infinity();
+
+  //! Number of nodes whose relaxation is solved
+  int node_num_ = 0;
+};
+} // namespace QpSolverCollection
+
+namespace std
+{
+inline string to_string(QpSolverCollection::MiqpSearchStrategy strategy)
+{
+  switch(strategy)
+  {
+    case QpSolverCollection::MiqpSearchStrategy::BestBound:
+      return "BestBound";
+    case QpSolverCollection::MiqpSearchStrategy::DepthFirst:
+      return "DepthFirst";
+    default:
+      QSC_ERROR_STREAM("[MiqpSearchStrategy] Unsupported value: " << std::to_string(static_cast<int>(strategy)));
+  }
+
+  return "";
+}
+} // namespace std
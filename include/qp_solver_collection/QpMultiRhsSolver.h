@@ -0,0 +1,118 @@
+/* Author: Masaki Murooka */
+
+#pragma once
+
+#include <vector>
+
+#include <qp_solver_collection/QpSolverCollection.h>
+
+namespace QpSolverCollection
+{
+/** \brief Solver of many QPs that share the matrices and differ only in the vectors.
+
+    Solve the QPs of @ref QpSolver#solve "QpSolver::solve" whose objective matrix, constraint matrices, and bounds are
+   common, and whose objective vector, equality constraint vector, and inequality constraint vector differ. The
+   objective matrix is factorized once by Cholesky decomposition for all the QPs.
+
+    The QPs are grouped by the active set of the solution. A representative QP is solved by the backend QP solver, and
+   the equality-constrained QP with its active set is solved for all the remaining QPs at once by the Schur complement
+   method, where the right-hand sides are stacked as columns so that the solves are matrix-matrix products. The
+   solutions that satisfy the primal and dual feasibility are accepted (i.e., the QP has the same active set as the
+   representative). The other QPs form the next group, and they are solved by the backend one by one after
+   max_group_num_ groups.
+
+    If the objective matrix is not positive definite, all the QPs are solved by the backend one by one.
+ */
+class QpMultiRhsSolver
+{
+public:
+  /** \brief Constructor.
+      \param qp_solver_type QP solver type of backend
+   */
+  QpMultiRhsSolver(const QpSolverType & qp_solver_type);
+
+  /** \brief Constructor.
+      \param qp_solver backend QP solver instance
+   */
+  QpMultiRhsSolver(const std::shared_ptr<QpSolver> & qp_solver);
+
+  /** \brief Solve QPs that share the matrices and bounds.
+      \param Q objective matrix
+      \param A equality constraint matrix
+      \param C inequality constraint matrix
+      \param c_mat objective vectors (each column corresponds to a QP)
+      \param b_mat equality constraint vectors (each column corresponds to a QP)
+      \param d_mat inequality constraint vectors (each column corresponds to a QP)
+      \param x_min lower bound
+      \param x_max upper bound
+      \returns solution of each QP (Lagrange multipliers of the QPs solved by the backend are empty if not provided by
+     the backend)
+   */
+  std::vector<SolveResult> solveMultiRhs(Eigen::Ref<Eigen::MatrixXd> Q,
+                                         const Eigen::Ref<const Eigen::MatrixXd> & A,
+                                         const Eigen::Ref<const Eigen::MatrixXd> & C,
+                                         const Eigen::Ref<const Eigen::MatrixXd> & c_mat,
+                                         const Eigen::Ref<const Eigen::MatrixXd> & b_mat,
+                                         const Eigen::Ref<const Eigen::MatrixXd> & d_mat,
+                                         const Eigen::Ref<const Eigen::VectorXd> & x_min,
+                                         const Eigen::Ref<const Eigen::VectorXd> & x_max);
+
+  /** \brief Get backend QP solver. */
+  inline QpSolver & backend()
+  {
+    return *backend_;
+  }
+
+  /** \brief Get number of groups of QPs solved with a factorized active set in the last solve. */
+  inline int groupNum() const
+  {
+    return group_num_;
+  }
+
+  /** \brief Get number of QPs solved by the backend in the last solve (including the representatives). */
+  inline int backendSolveNum() const
+  {
+    return backend_solve_num_;
+  }
+
+public:
+  //! Tolerance of primal and dual feasibility to accept the solution with the active set of the representative
+  double feasibility_tol_ = 1e-8;
+
+  //! Tolerance to determine the active set from the solution of the representative
+  double active_tol_ = 1e-6;
+
+  //! Maximum number of groups (the remaining QPs are solved by the backend one by one)
+  int max_group_num_ = 8;
+
+protected:
+  /** \brief Solve a QP with the backend.
+      \param Q objective matrix
+      \param A equality constraint matrix
+      \param C inequality constraint matrix
+      \param c objective vector
+      \param b equality constraint vector
+      \param d inequality constraint vector
+      \param x_min lower bound
+      \param x_max upper bound
+   */
+  SolveResult solveByBackend(Eigen::Ref<Eigen::MatrixXd> Q,
+                             const Eigen::Ref<const Eigen::MatrixXd> & A,
+                             const Eigen::Ref<const Eigen::MatrixXd> & C,
+                             const Eigen::Ref<const Eigen::VectorXd> & c,
+                             const Eigen::Ref<const Eigen::VectorXd> & b,
+                             const Eigen::Ref<const Eigen::VectorXd> & d,
+                             const Eigen::Ref<const Eigen::VectorXd> & x_min,
+                             const Eigen::Ref<const Eigen::VectorXd> & x_max);
+
+protected:
+  //! Backend QP solver
+  std::shared_ptr<QpSolver> backend_;
+
+  //! Number of groups in the last solve
+  int group_num_ = 0;
+
+  //! Number of QPs solved by the backend in the last solve
+  int backend_solve_num_ = 0;
+};
+} // namespace QpSolverCollection
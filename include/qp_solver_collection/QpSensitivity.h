@@ -0,0 +1,108 @@
+/* Author: Masaki Murooka */
+
+#pragma once
+
+#include <vector>
+
+#include <Eigen/LU>
+
+#include <qp_solver_collection/QpSolverCollection.h>
+
+namespace QpSolverCollection
+{
+/** \brief Sensitivity of QP solution with respect to QP coefficient.
+
+    The QP is locally equivalent to the equality-constrained QP with the active set of the solution:
+    \f{align*}{
+    \begin{bmatrix} \boldsymbol{Q} & \boldsymbol{G}^T \\ \boldsymbol{G} & \boldsymbol{O} \end{bmatrix}
+    \begin{bmatrix} \boldsymbol{x} \\ \boldsymbol{\nu} \end{bmatrix} =
+    \begin{bmatrix} -\boldsymbol{c} \\ \boldsymbol{h} \end{bmatrix}
+    \f}
+    where \f$\boldsymbol{G}\f$ and \f$\boldsymbol{h}\f$ stack the equality constraints and the active inequality
+   constraints and bounds. The reduced KKT matrix is factorized once in factorize(), and each call of backward() costs
+   a single solve with the factorization.
+
+    The gradients are those of the locally smooth solution map; they are not defined where the active set changes (i.e.,
+   at weakly active constraints).
+ */
+class QpSensitivity
+{
+public:
+  /** \brief Constructor. */
+  QpSensitivity() {}
+
+  /** \brief Factorize the reduced KKT matrix.
+      \param qp_coeff QP coefficient
+      \param result QP solution (the active set is determined from Lagrange multipliers if available, otherwise from
+     the constraint slacks)
+      \returns whether the reduced KKT matrix is nonsingular
+   */
+  bool factorize(const QpCoeff & qp_coeff, const SolveResult & result);
+
+  /** \brief Compute the vector-Jacobian product of QP solution.
+      \param grad_x gradient of a scalar loss with respect to the QP solution
+      \param grad gradient of the loss with respect to each QP coefficient (dimensions are set by this method)
+
+      The gradient of the objective matrix is symmetrized. The gradients of the rows of inactive inequality constraints
+   and of inactive bounds are zero.
+   */
+  void backward(const Eigen::Ref<const Eigen::VectorXd> & grad_x, QpCoeff & grad) const;
+
+  /** \brief Compute the vector-Jacobian product of QP solution.
+      \param grad_x gradient of a scalar loss with respect to the QP solution
+      \returns gradient of the loss with respect to each QP coefficient
+   */
+  QpCoeff backward(const Eigen::Ref<const Eigen::VectorXd> & grad_x) const;
+
+  /** \brief Get whether the reduced KKT matrix has been factorized successfully. */
+  inline bool factorized() const
+  {
+    return factorized_;
+  }
+
+  /** \brief Get indices of active inequality constraints. */
+  inline const std::vector<int> & activeIneqList() const
+  {
+    return active_ineq_list_;
+  }
+
+  /** \brief Get indices of variables whose lower bounds are active. */
+  inline const std::vector<int> & activeLowerList() const
+  {
+    return active_lower_list_;
+  }
+
+  /** \brief Get indices of variables whose upper bounds are active. */
+  inline const std::vector<int> & activeUpperList() const
+  {
+    return active_upper_list_;
+  }
+
+public:
+  //! Tolerance to determine the active set from the QP solution
+  double active_tol_ = 1e-6;
+
+protected:
+  //! Dimensions of the factorized QP
+  int dim_var_ = 0;
+  int dim_eq_ = 0;
+  int dim_ineq_ = 0;
+
+  //! Indices of active inequality constraints
+  std::vector<int> active_ineq_list_;
+
+  //! Indices of variables whose lower bounds are active
+  std::vector<int> active_lower_list_;
+
+  //! Indices of variables whose upper bounds are active
+  std::vector<int> active_upper_list_;
+
+  //! Primal solution and Lagrange multipliers of the reduced KKT system
+  Eigen::VectorXd sol_;
+
+  //! Factorization of the reduced KKT matrix
+  Eigen::FullPivLU<Eigen::MatrixXd> kkt_lu_;
+
+  bool factorized_ = false;
+};
+} // namespace QpSolverCollection
@@ -0,0 +1,160 @@
+/* Author: Masaki Murooka */
+
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <thread>
+
+#include <qp_solver_collection/QpSolverCollection.h>
+
+namespace QpSolverCollection
+{
+/** \brief Result of asynchronous QP solve. */
+class QpAsyncResult
+{
+public:
+  //! Solution with Lagrange multipliers
+  SolveResult result_;
+
+  //! Whether it failed to solve the QP
+  bool solve_failed_ = false;
+
+  //! QP coefficient moved back to the caller for reuse of its buffers (empty for QpSolverAsync::swapBuffers)
+  QpCoeff qp_coeff_;
+};
+
+/** \brief QP solver running on a dedicated thread.
+
+    QP coefficients are moved to the solver thread instead of being copied, so that the caller can assemble the next QP
+   while the current one is being solved.
+
+    For periodic control loops, the double buffer avoids allocation in every tick:
+    \code
+    QpSolverAsync qp_solver(QpSolverType::Any);
+    std::future<QpAsyncResult> future;
+    while(true)
+    {
+      QpCoeff & qp_coeff = qp_solver.backBuffer();
+      // Assemble QP of tick k+1 in qp_coeff while QP of tick k is being solved
+      if(future.valid())
+      {
+        QpAsyncResult result = future.get();
+      }
+      future = qp_solver.swapBuffers();
+    }
+    \endcode
+ */
+class QpSolverAsync
+{
+public:
+  /** \brief Type of callback function called on the solver thread. */
+  using Callback = std::function<void(QpAsyncResult &&)>;
+
+public:
+  /** \brief Constructor.
+      \param qp_solver_type QP solver type
+   */
+  QpSolverAsync(const QpSolverType & qp_solver_type);
+
+  /** \brief Constructor.
+      \param qp_solver QP solver instance used on the solver thread
+   */
+  QpSolverAsync(const std::shared_ptr<QpSolver> & qp_solver);
+
+  /** \brief Destructor.
+
+      The pending requests are solved before the solver thread stops.
+   */
+  ~QpSolverAsync();
+
+  /** \brief Solve QP asynchronously.
+      \param qp_coeff QP coefficient (moved to the solver thread and moved back in QpAsyncResult::qp_coeff_)
+   */
+  std::future<QpAsyncResult> solveAsync(QpCoeff && qp_coeff);
+
+  /** \brief Solve QP asynchronously and call the callback function on the solver thread.
+      \param qp_coeff QP coefficient (moved to the solver thread and moved back in QpAsyncResult::qp_coeff_)
+      \param callback callback function
+   */
+  void solveAsync(QpCoeff && qp_coeff, Callback callback);
+
+  /** \brief Get the back buffer of QP coefficient to be assembled.
+
+      The back buffer is the one that was solved two calls of swapBuffers ago (or empty at first), so call
+     QpCoeff::setup if its dimensions are different.
+   */
+  inline QpCoeff & backBuffer()
+  {
+    return back_buffer_;
+  }
+
+  /** \brief Solve the back buffer asynchronously and swap the buffers.
+
+      This waits only if the previous solve of the double buffer is not finished.
+   */
+  std::future<QpAsyncResult> swapBuffers();
+
+  /** \brief Wait until all the pending requests are solved. */
+  void waitIdle();
+
+  /** \brief Get QP solver instance.
+
+      The instance must not be accessed while requests are pending (e.g., call waitIdle before setting settings).
+   */
+  inline const std::shared_ptr<QpSolver> & qpSolver() const
+  {
+    return qp_solver_;
+  }
+
+protected:
+  /** \brief Request of QP solve. */
+  struct Request
+  {
+    QpCoeff qp_coeff;
+    std::promise<QpAsyncResult> promise;
+    Callback callback;
+    bool from_double_buffer = false;
+  };
+
+  /** \brief Push the request to the queue. */
+  void push(Request && request);
+
+  /** \brief Loop of solver thread. */
+  void solverLoop();
+
+protected:
+  //! QP solver instance
+  std::shared_ptr<QpSolver> qp_solver_;
+
+  //! Solver thread
+  std::thread thread_;
+
+  //! Mutex of the following variables
+  std::mutex mutex_;
+
+  //! Condition variable notified when the queue or buffers are updated
+  std::condition_variable cond_;
+
+  //! Queue of pending requests
+  std::deque<Request> request_queue_;
+
+  //! Whether a request is being solved
+  bool busy_ = false;
+
+  //! Whether to stop the solver thread
+  bool stop_ = false;
+
+  //! Back buffer of QP coefficient
+  QpCoeff back_buffer_;
+
+  //! Buffer of QP coefficient returned from the solver thread
+  QpCoeff returned_buffer_;
+
+  //! Whether a buffer of the double buffer is being solved
+  bool buffer_in_flight_ = false;
+};
+} // namespace QpSolverCollection
@@ -2,9 +2,15 @@
 
 #pragma once
 
+#include <array>
 #include <chrono>
+#include <cstdint>
+#include <cstring>
 #include <fstream>
+#include <limits>
+#include <map>
 #include <memory>
+#include <vector>
 
 #include <Eigen/SparseCore>
 
@@ -88,11 +94,47 @@ enum class QpSolverType
   NASOQ,
   HPIPM,
   PROXQP,
-  QPMAD
+  QPMAD,
+  Builtin
 };
 
 /*! \brief Convert std::string to QpSolverType. */
 QpSolverType strToQpSolverType(const std::string & qp_solver_type);
+
+/** \brief Accuracy profile of QP solver. */
+enum class QpAccuracyProfile
+{
+  //! Prioritize speed over accuracy
+  Fast = 0,
+  //! Default options of each QP solver
+  Balanced,
+  //! Prioritize accuracy and robustness over speed
+  Robust
+};
+
+/*! \brief Convert std::string to QpAccuracyProfile. */
+QpAccuracyProfile strToQpAccuracyProfile(const std::string & profile);
+
+/** \brief Status of QP solve normalized over QP solvers. */
+enum class QpSolveStatus
+{
+  //! Not solved yet
+  Unsolved = -1,
+  //! Solved
+  Solved = 0,
+  //! Maximum number of iterations is reached (the returned solution may be inaccurate)
+  MaxIterReached,
+  //! Constraints are inconsistent
+  PrimalInfeasible,
+  //! Objective is unbounded below (e.g., objective matrix is not positive definite)
+  DualInfeasible,
+  //! Numerical difficulty (e.g., too small step or NaN in iterates)
+  NumericalError,
+  //! Invalid input (e.g., NaN in coefficients)
+  InvalidInput,
+  //! Other failures
+  Unknown
+};
 } // namespace QpSolverCollection
 
 namespace std
@@ -123,19 +165,161 @@ inline string to_string(QpSolverType qp_solver_type)
       return "QpSolverType::PROXQP";
     case QpSolverType::QPMAD:
       return "QpSolverType::QPMAD";
+    case QpSolverType::Builtin:
+      return "QpSolverType::Builtin";
     default:
       QSC_ERROR_STREAM("[QpSolverType] Unsupported value: " << std::to_string(static_cast<int>(qp_solver_type)));
   }
 
   return "";
 }
+
+inline string to_string(QpSolverCollection::QpAccuracyProfile profile)
+{
+  switch(profile)
+  {
+    case QpSolverCollection::QpAccuracyProfile::Fast:
+      return "Fast";
+    case QpSolverCollection::QpAccuracyProfile::Balanced:
+      return "Balanced";
+    case QpSolverCollection::QpAccuracyProfile::Robust:
+      return "Robust";
+    default:
+      QSC_ERROR_STREAM("[QpAccuracyProfile] Unsupported value: " << std::to_string(static_cast<int>(profile)));
+  }
+
+  return "";
+}
+
+inline string to_string(QpSolverCollection::QpSolveStatus status)
+{
+  switch(status)
+  {
+    case QpSolverCollection::QpSolveStatus::Unsolved:
+      return "Unsolved";
+    case QpSolverCollection::QpSolveStatus::Solved:
+      return "Solved";
+    case QpSolverCollection::QpSolveStatus::MaxIterReached:
+      return "MaxIterReached";
+    case QpSolverCollection::QpSolveStatus::PrimalInfeasible:
+      return "PrimalInfeasible";
+    case QpSolverCollection::QpSolveStatus::DualInfeasible:
+      return "DualInfeasible";
+    case QpSolverCollection::QpSolveStatus::NumericalError:
+      return "NumericalError";
+    case QpSolverCollection::QpSolveStatus::InvalidInput:
+      return "InvalidInput";
+    case QpSolverCollection::QpSolveStatus::Unknown:
+      return "Unknown";
+    default:
+      QSC_ERROR_STREAM("[QpSolveStatus] Unsupported value: " << std::to_string(static_cast<int>(status)));
+  }
+
+  return "";
+}
 } // namespace std
 
 namespace QpSolverCollection
 {
-/** \brief Class of QP coefficient. */
+/** \brief Identifier unique to each instance, which is newly assigned when the owner is copied. */
+class QpInstanceId
+{
+public:
+  /** \brief Constructor. */
+  QpInstanceId() : value_(next()) {}
+
+  /** \brief Copy constructor (a new identifier is assigned). */
+  QpInstanceId(const QpInstanceId &) : value_(next()) {}
+
+  /** \brief Copy assignment (a new identifier is assigned). */
+  QpInstanceId & operator=(const QpInstanceId &)
+  {
+    value_ = next();
+    return *this;
+  }
+
+  /** \brief Get identifier (never 0). */
+  inline uint64_t value() const
+  {
+    return value_;
+  }
+
+protected:
+  /** \brief Issue a new identifier (thread-safe). */
+  static uint64_t next();
+
+protected:
+  //! Identifier
+  uint64_t value_;
+};
+
+/** \brief Class of identifiers of the variables and constraints of QP.
+
+    The identifiers are given by the user so that the elements of the QPs with different structures (e.g., when the
+   variables and constraints of contacts are added or removed) are associated with each other. Each identifier must be
+   unique among the variables, the equality constraints, and the inequality constraints, respectively.
+ */
+class QpElementIds
+{
+public:
+  /** \brief Whether the identifiers are not given. */
+  inline bool empty() const
+  {
+    return var_id_list_.empty();
+  }
+
+  /** \brief Check whether the numbers of identifiers are consistent with the QP (the identifiers of constraints may be
+     empty). */
+  bool isValid(int dim_var, int dim_eq, int dim_ineq) const;
+
+public:
+  //! Identifiers of the elements of decision variable
+  std::vector<int64_t> var_id_list_;
+
+  //! Identifiers of the rows of equality constraint (empty if not identified)
+  std::vector<int64_t> eq_id_list_;
+
+  //! Identifiers of the rows of inequality constraint (empty if not identified)
+  std::vector<int64_t> ineq_id_list_;
+};
+
+/** \brief Class of QP coefficient.
+
+    Modifications of the coefficients can be tracked for each block so that the QP solvers update only the modified
+   blocks in the next solve (e.g., OSQP, qpOASES, and PROXQP skip updating the matrices when only the vectors are
+   modified). Since the members are public and their direct modifications cannot be detected, the tracking is enabled
+   only if track_modification_ is true; then the modifications must be made by the setters or notified by
+   setModified. The modifications are tracked against the previous solve of the same instance by the same QP solver
+   instance, and copies of QpCoeff are regarded as different instances.
+ */
 class QpCoeff
 {
+public:
+  /** \brief Block of coefficients whose modifications are tracked. */
+  enum class Block
+  {
+    //! Objective matrix
+    ObjMat = 0,
+    //! Objective vector
+    ObjVec,
+    //! Equality constraint matrix
+    EqMat,
+    //! Equality constraint vector
+    EqVec,
+    //! Inequality constraint matrix
+    IneqMat,
+    //! Inequality constraint vector
+    IneqVec,
+    //! Lower and upper bounds
+    Bound
+  };
+
+  //! Number of blocks
+  static constexpr int block_num = 7;
+
+  /** \brief Type of modification counters of the blocks. */
+  using GenerationList = std::array<uint64_t, block_num>;
+
 public:
   /** \brief Constructor. */
   QpCoeff() {}
@@ -153,7 +337,94 @@ public:
   /** \brief Dump coefficients. */
   void dump(std::ofstream & ofs) const;
 
+  /** \brief Load coefficients dumped by dump.
+      \returns whether the coefficients are loaded successfully
+
+      Multiple coefficients dumped in the same stream can be loaded by calling this method repeatedly.
+   */
+  bool load(std::istream & is);
+
+  /** \brief Notify that a block is modified. */
+  inline void setModified(Block block)
+  {
+    generation_list_[static_cast<int>(block)]++;
+  }
+
+  /** \brief Notify that all the blocks are modified. */
+  inline void setModified()
+  {
+    for(auto & generation : generation_list_)
+    {
+      generation++;
+    }
+  }
+
+  /** \brief Set objective matrix and notify the modification. */
+  inline void setObjMat(const Eigen::Ref<const Eigen::MatrixXd> & obj_mat)
+  {
+    obj_mat_ = obj_mat;
+    setModified(Block::ObjMat);
+  }
+
+  /** \brief Set objective vector and notify the modification. */
+  inline void setObjVec(const Eigen::Ref<const Eigen::VectorXd> & obj_vec)
+  {
+    obj_vec_ = obj_vec;
+    setModified(Block::ObjVec);
+  }
+
+  /** \brief Set equality constraint matrix and notify the modification. */
+  inline void setEqMat(const Eigen::Ref<const Eigen::MatrixXd> & eq_mat)
+  {
+    eq_mat_ = eq_mat;
+    setModified(Block::EqMat);
+  }
+
+  /** \brief Set equality constraint vector and notify the modification. */
+  inline void setEqVec(const Eigen::Ref<const Eigen::VectorXd> & eq_vec)
+  {
+    eq_vec_ = eq_vec;
+    setModified(Block::EqVec);
+  }
+
+  /** \brief Set inequality constraint matrix and notify the modification. */
+  inline void setIneqMat(const Eigen::Ref<const Eigen::MatrixXd> & ineq_mat)
+  {
+    ineq_mat_ = ineq_mat;
+    setModified(Block::IneqMat);
+  }
+
+  /** \brief Set inequality constraint vector and notify the modification. */
+  inline void setIneqVec(const Eigen::Ref<const Eigen::VectorXd> & ineq_vec)
+  {
+    ineq_vec_ = ineq_vec;
+    setModified(Block::IneqVec);
+  }
+
+  /** \brief Set lower and upper bounds and notify the modification. */
+  inline void setBound(const Eigen::Ref<const Eigen::VectorXd> & x_min, const Eigen::Ref<const Eigen::VectorXd> & x_max)
+  {
+    x_min_ = x_min;
+    x_max_ = x_max;
+    setModified(Block::Bound);
+  }
+
+  /** \brief Get identifier of this instance. */
+  inline uint64_t id() const
+  {
+    return id_.value();
+  }
+
+  /** \brief Get modification counters of the blocks. */
+  inline const GenerationList & generationList() const
+  {
+    return generation_list_;
+  }
+
 public:
+  //! Whether to track modifications of the blocks (all the blocks are regarded as modified in every solve if false)
+  bool track_modification_ = false;
+
   //! Dimension of decision variable
   int dim_var_ = 0;
 
@@ -186,8 +457,364 @@ public:
 
   //! Upper bound (corresponding to \f$\boldsymbol{x}_{max}\f$ in @ref QpSolver#solve "QpSolver::solve".)
   Eigen::VectorXd x_max_;
+
+  /** \brief Identifiers of the variables and constraints (empty if not given).
+
+      If given, the solution of the previous QP is remapped onto this QP by the identifiers to warm-start the QP solver
+     (see QpSolverSettings::warm_start_by_id_). They are cleared by setup.
+   */
+  QpElementIds element_ids_;
+
+protected:
+  //! Identifier of this instance
+  QpInstanceId id_;
+
+  //! Modification counters of the blocks
+  GenerationList generation_list_ = {};
+};
+
+/** \brief Combine the value into the hash. */
+inline void hashCombine(size_t & hash, size_t value)
+{
+  hash ^= value + static_cast<size_t>(0x9e3779b97f4a7c15ull) + (hash << 12) + (hash >> 4);
+}
+
+/** \brief Combine the bits of the floating-point value into the hash (values differing in any digit are
+   distinguished). */
+inline void hashCombineDouble(size_t & hash, double value)
+{
+  uint64_t bits;
+  std::memcpy(&bits, &value, sizeof(bits));
+  hashCombine(hash, static_cast<size_t>(bits ^ (bits >> 32)));
+}
+
+/** \brief Class of QP solver settings.
+
+    Each QP solver translates the settings into its native options. Tolerances and maximum number of iterations that
+   are not positive are determined by the accuracy profile.
+
+    \note QuadProg and LSSOL have no corresponding options and ignore the settings. JRLQP uses only the maximum number
+   of iterations.
+ */
+class QpSolverSettings
+{
+public:
+  /** \brief Select a value according to the accuracy profile. */
+  template<class T>
+  inline T byProfile(T fast, T balanced, T robust) const
+  {
+    switch(profile_)
+    {
+      case QpAccuracyProfile::Fast:
+        return fast;
+      case QpAccuracyProfile::Robust:
+        return robust;
+      default:
+        return balanced;
+    }
+  }
+
+  /** \brief Get absolute tolerance, falling back to the value according to the accuracy profile. */
+  inline double absTol(double fast, double balanced, double robust) const
+  {
+    return abs_tol_ > 0 ? abs_tol_ : byProfile(fast, balanced, robust);
+  }
+
+  /** \brief Get relative tolerance, falling back to the value according to the accuracy profile. */
+  inline double relTol(double fast, double balanced, double robust) const
+  {
+    return rel_tol_ > 0 ? rel_tol_ : byProfile(fast, balanced, robust);
+  }
+
+  /** \brief Get maximum number of iterations, falling back to the value according to the accuracy profile. */
+  inline int maxIter(int fast, int balanced, int robust) const
+  {
+    return max_iter_ > 0 ? max_iter_ : byProfile(fast, balanced, robust);
+  }
+
+  /** \brief Get solver-specific parameter.
+      \param key parameter name
+      \param[out] value parameter value (unchanged if not found)
+      \returns whether the parameter is found
+   */
+  inline bool param(const std::string & key, double & value) const
+  {
+    auto it = params_.find(key);
+    if(it == params_.end())
+    {
+      return false;
+    }
+    value = it->second;
+    return true;
+  }
+
+  /** \brief Dump settings. */
+  void dump(std::ostream & os) const;
+
+  /** \brief Compute hash of all the settings including the bits of floating-point values. */
+  size_t hash() const;
+
+  /** \brief Load settings dumped by dump.
+      \returns whether the settings are loaded successfully
+   */
+  bool load(std::istream & is);
+
+public:
+  //! Accuracy profile
+  QpAccuracyProfile profile_ = QpAccuracyProfile::Balanced;
+
+  //! Absolute tolerance (the profile value is used if not positive)
+  double abs_tol_ = 0;
+
+  //! Relative tolerance (the profile value is used if not positive)
+  double rel_tol_ = 0;
+
+  //! Maximum number of iterations (the profile value is used if not positive)
+  int max_iter_ = 0;
+
+  //! Whether to print messages of QP solver
+  bool verbose_ = false;
+
+  /** \brief Whether to screen the QP for infeasibility before calling the QP solver.
+
+      See presolveQp for the checks. Infeasible QPs are rejected without calling the QP solver.
+   */
+  bool presolve_ = false;
+
+  /** \brief Whether to reuse the factorization of the objective matrix while it is unchanged.
+
+      Supported by QLD, QuadProg, JRLQP, QPMAD, and the built-in QP solver, which accept a factorized objective matrix.
+     The objective matrix is compared with that of the previous solve unless obj_mat_fixed_ is true.
+   */
+  bool reuse_obj_mat_factor_ = true;
+
+  /** \brief Whether to assume that the objective matrix is the same as that of the previous solve.
+
+      The comparison of the objective matrix is skipped, and it is refactorized only if the dimension changes. The
+     result is wrong if the objective matrix is changed while this is true.
+   */
+  bool obj_mat_fixed_ = false;
+
+  /** \brief Whether to warm-start from the solution of the previous QP remapped by the identifiers of the variables and
+     constraints.
+
+      Applied to the solve of QpCoeff with QpCoeff::element_ids_ unless the initial guess is given explicitly. The
+     solution of the last successful solve with the identifiers is remapped by remapWarmStart.
+   */
+  bool warm_start_by_id_ = true;
+
+  /** \brief Solver-specific parameters.
+
+      The following parameters are supported (others are ignored):
+      - OSQP: rho, sigma, alpha
+      - HPIPM: mode (0: SPEED_ABS, 1: SPEED, 2: BALANCE, 3: ROBUST, overriding the profile), mu0
+      - PROXQP: rho, mu_eq, mu_in
+      - qpOASES: enable_regularisation, enable_ramping, enable_far_bounds, enable_flipping_bounds (0 or 1)
+   */
+  std::map<std::string, double> params_;
 };
 
+/** \brief Save settings profile (i.e., QP solver settings for each QP solver type) to a file.
+    \param path file path
+    \param settings_profile QP solver settings for each QP solver type
+ */
+void saveSettingsProfile(const std::string & path, const std::map<QpSolverType, QpSolverSettings> & settings_profile);
+
+/** \brief Load settings profile saved by saveSettingsProfile.
+    \param path file path
+
+    Throws std::runtime_error if the file cannot be parsed.
+ */
+std::map<QpSolverType, QpSolverSettings> loadSettingsProfile(const std::string & path);
+
+/** \brief Class of QP solution.
+
+    Lagrange multipliers are defined so that the stationarity condition of @ref QpSolver#solve "QpSolver::solve" is
+    \f{align*}{
+    \boldsymbol{Q} \boldsymbol{x} + \boldsymbol{c} + \boldsymbol{A}^T \boldsymbol{\lambda}_{eq} + \boldsymbol{C}^T
+   \boldsymbol{\lambda}_{ineq} + \boldsymbol{\lambda}_{bound} = \boldsymbol{0}
+    \f}
+    where \f$\boldsymbol{\lambda}_{ineq} \geq \boldsymbol{0}\f$, and each element of \f$\boldsymbol{\lambda}_{bound}\f$
+   is positive when the upper bound is active and negative when the lower bound is active.
+ */
+class SolveResult
+{
+public:
+  /** \brief Whether Lagrange multipliers are set. */
+  inline bool hasDual() const
+  {
+    return dual_bound_.size() > 0 && dual_bound_.size() == x_.size();
+  }
+
+public:
+  //! Primal solution
+  Eigen::VectorXd x_;
+
+  //! Lagrange multipliers of equality constraints (empty if not provided by the solver)
+  Eigen::VectorXd dual_eq_;
+
+  //! Lagrange multipliers of inequality constraints (empty if not provided by the solver)
+  Eigen::VectorXd dual_ineq_;
+
+  //! Lagrange multipliers of bounds (empty if not provided by the solver)
+  Eigen::VectorXd dual_bound_;
+
+  //! Status of solve
+  QpSolveStatus status_ = QpSolveStatus::Unsolved;
+};
+
+/** \brief Class of initial guess of primal and dual variables of QP.
+
+    Lagrange multipliers follow the order and sign convention of SolveResult, so that the solution of the previous QP
+   can be passed as it is. Empty Lagrange multipliers are regarded as zero.
+ */
+class WarmStart
+{
+public:
+  /** \brief Constructor. */
+  WarmStart() {}
+
+  /** \brief Constructor.
+      \param x primal variable
+      \param dual_eq Lagrange multipliers of equality constraints
+      \param dual_ineq Lagrange multipliers of inequality constraints
+      \param dual_bound Lagrange multipliers of bounds
+   */
+  WarmStart(const Eigen::VectorXd & x,
+            const Eigen::VectorXd & dual_eq = Eigen::VectorXd(),
+            const Eigen::VectorXd & dual_ineq = Eigen::VectorXd(),
+            const Eigen::VectorXd & dual_bound = Eigen::VectorXd())
+  : x_(x), dual_eq_(dual_eq), dual_ineq_(dual_ineq), dual_bound_(dual_bound)
+  {
+  }
+
+  /** \brief Constructor from QP solution. */
+  WarmStart(const SolveResult & result)
+  : WarmStart(result.x_, result.dual_eq_, result.dual_ineq_, result.dual_bound_)
+  {
+  }
+
+  /** \brief Whether any Lagrange multipliers are set. */
+  inline bool hasDual() const
+  {
+    return dual_eq_.size() > 0 || dual_ineq_.size() > 0 || dual_bound_.size() > 0;
+  }
+
+  /** \brief Check whether the dimensions are consistent with the QP (Lagrange multipliers may be empty). */
+  bool isValid(int dim_var, int dim_eq, int dim_ineq) const;
+
+  /** \brief Get Lagrange multipliers stacked in the order of equality constraints, inequality constraints, and bounds
+     (empty ones are filled with zero). */
+  Eigen::VectorXd stackedDual(int dim_var, int dim_eq, int dim_ineq) const;
+
+public:
+  //! Primal variable
+  Eigen::VectorXd x_;
+
+  //! Lagrange multipliers of equality constraints (empty if unknown)
+  Eigen::VectorXd dual_eq_;
+
+  //! Lagrange multipliers of inequality constraints (empty if unknown)
+  Eigen::VectorXd dual_ineq_;
+
+  //! Lagrange multipliers of bounds (empty if unknown)
+  Eigen::VectorXd dual_bound_;
+};
+
+/** \brief Remap the solution of the previous QP onto the QP by the identifiers of the variables and constraints.
+    \param result solution of the previous QP
+    \param element_ids identifiers of the variables and constraints of the previous QP
+    \param qp_coeff QP coefficient with the identifiers (see QpCoeff::element_ids_)
+    \returns initial guess of the QP
+
+    The elements whose identifiers are not found in the previous QP are filled with neutral values: the primal
+   variable is zero projected onto the bounds, and the Lagrange multipliers are zero (i.e., inactive). The Lagrange
+   multipliers of constraints without identifiers are left empty.
+ */
+WarmStart remapWarmStart(const SolveResult & result, const QpElementIds & element_ids, const QpCoeff & qp_coeff);
+
+/** \brief Class of KKT residual of QP solution. */
+class KktResidual
+{
+public:
+  /** \brief Whether all the residuals are smaller than the tolerance.
+      \param tol tolerance
+      \param check_dual whether to check the residuals related to Lagrange multipliers (skipped if not available)
+   */
+  bool satisfied(double tol, bool check_dual = true) const;
+
+  /** \brief Print information. */
+  void printInfo(bool verbose = false, const std::string & header = "") const;
+
+public:
+  //! Maximum violation of equality constraints, inequality constraints, and bounds
+  double primal_feas_ = 0;
+
+  //! Maximum absolute value of the stationarity residual and sign violation of Lagrange multipliers (NaN if not
+  //! available)
+  double dual_feas_ = std::numeric_limits<double>::quiet_NaN();
+
+  //! Maximum absolute value of the product of Lagrange multiplier and constraint slack (NaN if not available)
+  double complementarity_ = std::numeric_limits<double>::quiet_NaN();
+
+  //! Absolute difference between primal and dual objectives (NaN if not available)
+  double duality_gap_ = std::numeric_limits<double>::quiet_NaN();
+
+  //! Primal objective value
+  double obj_ = 0;
+};
+
+/** \brief Compute KKT residual of QP solution.
+    \param qp_coeff QP coefficient
+    \param result QP solution (Lagrange multipliers are optional)
+
+    Objective and constraint matrices are traversed only once column by column, so the computational cost is comparable
+   to a single matrix-vector product with each of them.
+ */
+KktResidual computeKkt(const QpCoeff & qp_coeff, const SolveResult & result);
+
+/** \brief Screen QP for infeasibility with cheap checks.
+    \param A equality constraint matrix
+    \param b equality constraint vector
+    \param C inequality constraint matrix
+    \param d inequality constraint vector
+    \param x_min lower bound
+    \param x_max upper bound
+    \param tol tolerance of constraint violation
+    \returns QpSolveStatus::PrimalInfeasible or QpSolveStatus::InvalidInput if detected, QpSolveStatus::Unsolved
+   otherwise
+
+    The following are checked:
+    - NaN in constraints and crossed bounds (i.e., \f$x_{min,i} > x_{max,i}\f$)
+    - Zero rows of constraint matrices whose constraint vector is violated
+    - Inconsistent equality constraints (i.e., \f$\boldsymbol{b}\f$ is not in the range of \f$\boldsymbol{A}\f$)
+
+    The rank check of equality constraints costs a QR decomposition of \f$\boldsymbol{A}\f$, and the others are
+   linear in the number of elements.
+ */
+QpSolveStatus presolveQp(const Eigen::Ref<const Eigen::MatrixXd> & A,
+                         const Eigen::Ref<const Eigen::VectorXd> & b,
+                         const Eigen::Ref<const Eigen::MatrixXd> & C,
+                         const Eigen::Ref<const Eigen::VectorXd> & d,
+                         const Eigen::Ref<const Eigen::VectorXd> & x_min,
+                         const Eigen::Ref<const Eigen::VectorXd> & x_max,
+                         double tol = 1e-9);
+
+/** \brief Get heap memory usage of dense matrix in bytes. */
+template<class Derived>
+inline size_t matrixMemoryUsage(const Eigen::PlainObjectBase<Derived> & mat)
+{
+  return sizeof(typename Derived::Scalar) * static_cast<size_t>(mat.size());
+}
+
+/** \brief Get heap memory usage of sparse matrix in bytes. */
+template<class Scalar, int Options, class StorageIndex>
+inline size_t matrixMemoryUsage(const Eigen::SparseMatrix<Scalar, Options, StorageIndex> & mat)
+{
+  return (sizeof(Scalar) + sizeof(StorageIndex)) * static_cast<size_t>(mat.data().allocatedSize())
+         + sizeof(StorageIndex) * static_cast<size_t>(mat.outerSize() + 1);
+}
+
 /** \brief Virtual class of QP solver. */
 class QpSolver
 {
@@ -246,6 +873,63 @@ public:
   */
   virtual Eigen::VectorXd solve(QpCoeff & qp_coeff);
 
+  /** \brief Solve QP starting from the initial guess.
+      \param warm_start initial guess of primal and dual variables
+
+      The initial guess is used by HPIPM (only the primal variable), OSQP, PROXQP, and qpOASES (only when the solver is
+     initialized, where the working set is guessed from the Lagrange multipliers), and ignored by the other QP
+     solvers. The wrappers of QP solvers (e.g., QpSolverMemoize) pass it to the backend. Throws std::invalid_argument
+     if the dimensions of the initial guess are inconsistent with the QP.
+   */
+  Eigen::VectorXd solve(int dim_var,
+                        int dim_eq,
+                        int dim_ineq,
+                        Eigen::Ref<Eigen::MatrixXd> Q,
+                        const Eigen::Ref<const Eigen::VectorXd> & c,
+                        const Eigen::Ref<const Eigen::MatrixXd> & A,
+                        const Eigen::Ref<const Eigen::VectorXd> & b,
+                        const Eigen::Ref<const Eigen::MatrixXd> & C,
+                        const Eigen::Ref<const Eigen::VectorXd> & d,
+                        const Eigen::Ref<const Eigen::VectorXd> & x_min,
+                        const Eigen::Ref<const Eigen::VectorXd> & x_max,
+                        const WarmStart & warm_start);
+
+  /** \brief Solve QP starting from the initial guess.
+      \param qp_coeff QP coefficient
+      \param warm_start initial guess of primal and dual variables
+  */
+  Eigen::VectorXd solve(QpCoeff & qp_coeff, const WarmStart & warm_start);
+
+  /** \brief Solve QP and get the solution with Lagrange multipliers.
+      \param qp_coeff QP coefficient
+  */
+  SolveResult solveWithResult(QpCoeff & qp_coeff);
+
+  /** \brief Solve QP starting from the initial guess and get the solution with Lagrange multipliers.
+      \param qp_coeff QP coefficient
+      \param warm_start initial guess of primal and dual variables (e.g., the solution of the previous QP)
+  */
+  SolveResult solveWithResult(QpCoeff & qp_coeff, const WarmStart & warm_start);
+
+  /** \brief Set QP solver settings.
+      \param settings QP solver settings
+
+      The settings are translated into native options of each QP solver in the next solve.
+   */
+  virtual void setSettings(const QpSolverSettings & settings);
+
+  /** \brief Get QP solver settings. */
+  inline const QpSolverSettings & settings() const
+  {
+    return settings_;
+  }
+
+  /** \brief Set QP solver settings for this QP solver type from settings profile file.
+      \param path file path of settings profile (see loadSettingsProfile)
+      \returns whether the settings for this QP solver type are found
+   */
+  bool loadSettings(const std::string & path);
+
   /** \brief Get QP solver type. */
   inline QpSolverType type() const
   {
@@ -258,12 +942,173 @@ public:
     return solve_failed_;
   }
 
+  /** \brief Get status of the last solve. */
+  inline QpSolveStatus status() const
+  {
+    return status_;
+  }
+
+  /** \brief Get number of iterations of the last solve (negative if not provided by the solver). */
+  inline int iterNum() const
+  {
+    return iter_num_;
+  }
+
+  /** \brief Get Lagrange multipliers of equality constraints of the last solve (empty if not provided by the solver).
+
+      See SolveResult for the sign convention.
+   */
+  inline const Eigen::VectorXd & dualEq() const
+  {
+    return dual_eq_;
+  }
+
+  /** \brief Get Lagrange multipliers of inequality constraints of the last solve (empty if not provided by the
+     solver). */
+  inline const Eigen::VectorXd & dualIneq() const
+  {
+    return dual_ineq_;
+  }
+
+  /** \brief Get Lagrange multipliers of bounds of the last solve (empty if not provided by the solver). */
+  inline const Eigen::VectorXd & dualBound() const
+  {
+    return dual_bound_;
+  }
+
+  /** \brief Get memory usage in bytes.
+
+      This is the sum of the memory owned by this instance (e.g., stacked constraints and sparse copies of matrices)
+     and the workspace of the QP solver for the dimensions of the last solve. The workspace is exact for HPIPM and
+     estimated from the dimensions and the number of nonzeros for the other QP solvers.
+   */
+  virtual size_t memoryUsage() const;
+
+  /** \brief Get hash of the configuration that affects the solution.
+
+      This includes the QP solver type, the settings, and the public parameters of each QP solver (e.g.,
+     force_initialize_). Decorators include the configuration of their backend.
+   */
+  virtual size_t configHash() const;
+
+protected:
+  /** \brief Screen the QP for infeasibility if enabled in the settings.
+      \returns whether the QP is rejected (the status is set and the QP solver should not be called)
+   */
+  bool presolveFailed(const Eigen::Ref<const Eigen::MatrixXd> & A,
+                      const Eigen::Ref<const Eigen::VectorXd> & b,
+                      const Eigen::Ref<const Eigen::MatrixXd> & C,
+                      const Eigen::Ref<const Eigen::VectorXd> & d,
+                      const Eigen::Ref<const Eigen::VectorXd> & x_min,
+                      const Eigen::Ref<const Eigen::VectorXd> & x_max);
+
+  /** \brief Get whether a block of the QP coefficient is unchanged since the previous solve.
+
+      This is true only while solving QpCoeff whose modifications are tracked (see QpCoeff) and the previous solve by
+     this instance was for the same QpCoeff instance. The QP solvers can skip updating such blocks.
+   */
+  inline bool coeffUnchanged(QpCoeff::Block block) const
+  {
+    return (unchanged_block_mask_ >> static_cast<int>(block)) & 1u;
+  }
+
+  /** \brief Check whether the objective matrix is unchanged since the previous call (see
+     QpSolverSettings::reuse_obj_mat_factor_).
+      \returns whether the factorization of the objective matrix in the previous solve can be reused
+   */
+  bool objMatUnchanged(const Eigen::Ref<const Eigen::MatrixXd> & Q);
+
+  /** \brief Get Cholesky factor of the objective matrix, which is recomputed only if the objective matrix is changed
+     (see objMatUnchanged).
+      \param Q objective matrix
+      \param upper whether to get the upper triangular factor R (Q = R^T R) instead of the lower triangular factor L
+     (Q = L L^T)
+      \param inverse whether to get the inverse of the factor
+      \returns pointer to the factor owned by this instance (nullptr if the reuse is disabled or the objective matrix is
+     not positive definite)
+   */
+  Eigen::MatrixXd * objMatFactor(const Eigen::Ref<const Eigen::MatrixXd> & Q, bool upper, bool inverse);
+
+  /** \brief Store the dimensions of the QP to estimate the workspace in memoryUsage.
+
+      This is called at the beginning of every solve of the QP solvers, and also counts the solves.
+   */
+  inline void setLastDimension(int dim_var, int dim_eq, int dim_ineq)
+  {
+    solve_count_++;
+    last_dim_var_ = static_cast<size_t>(dim_var);
+    last_dim_eq_ = static_cast<size_t>(dim_eq);
+    last_dim_ineq_ = static_cast<size_t>(dim_ineq);
+  }
+
 protected:
   /** \brief QP solver type. */
   QpSolverType type_ = QpSolverType::Uninitialized;
 
   /** \brief Whether it failed to solve the QP. */
   bool solve_failed_ = false;
+
+  /** \brief Status of the last solve. */
+  QpSolveStatus status_ = QpSolveStatus::Unsolved;
+
+  /** \brief Number of iterations of the last solve. */
+  int iter_num_ = -1;
+
+  /** \brief QP solver settings. */
+  QpSolverSettings settings_;
+
+  /** \brief Whether settings have been updated since they were last translated into native options. */
+  bool settings_updated_ = true;
+
+  /** \brief Lagrange multipliers of equality constraints. */
+  Eigen::VectorXd dual_eq_;
+
+  /** \brief Lagrange multipliers of inequality constraints. */
+  Eigen::VectorXd dual_ineq_;
+
+  /** \brief Lagrange multipliers of bounds. */
+  Eigen::VectorXd dual_bound_;
+
+  /** \brief Bit mask of the blocks of the QP coefficient unchanged since the previous solve (see coeffUnchanged). */
+  unsigned int unchanged_block_mask_ = 0;
+
+  /** \brief Identifier of the QP coefficient solved successfully in the previous solve (0 if not solved with QpCoeff).
+   */
+  uint64_t last_coeff_id_ = 0;
+
+  /** \brief Number of solves (see setLastDimension) when the previous QP coefficient was solved. */
+  uint64_t last_coeff_solve_count_ = 0;
+
+  /** \brief Number of solves. */
+  uint64_t solve_count_ = 0;
+
+  /** \brief Modification counters of the QP coefficient solved in the previous solve. */
+  QpCoeff::GenerationList last_coeff_generation_list_ = {};
+
+  /** \brief Objective matrix of the previous call of objMatUnchanged. */
+  Eigen::MatrixXd last_obj_mat_;
+
+  /** \brief Cholesky factor of the objective matrix computed by objMatFactor. */
+  Eigen::MatrixXd obj_mat_factor_;
+
+  /** \brief Whether obj_mat_factor_ is the factor of last_obj_mat_. */
+  bool obj_mat_factor_valid_ = false;
+
+  /** \brief Dimensions of the last solved QP. */
+  size_t last_dim_var_ = 0;
+  size_t last_dim_eq_ = 0;
+  size_t last_dim_ineq_ = 0;
+
+  /** \brief Initial guess given to the current solve (nullptr if not given). Its dimensions are checked before the
+     solve. */
+  const WarmStart * warm_start_ = nullptr;
+
+  /** \brief Solution of the last successful solve of QpCoeff with the identifiers (see
+     QpSolverSettings::warm_start_by_id_). */
+  SolveResult last_id_result_;
+
+  /** \brief Identifiers of the variables and constraints of last_id_result_. */
+  QpElementIds last_element_ids_;
 };
 
 #if ENABLE_QLD
@@ -287,6 +1132,9 @@ public:
                                 const Eigen::Ref<const Eigen::VectorXd> & x_min,
                                 const Eigen::Ref<const Eigen::VectorXd> & x_max) override;
 
+  /** \brief Get memory usage in bytes. */
+  virtual size_t memoryUsage() const override;
+
 protected:
   std::unique_ptr<Eigen::QLDDirect> qld_;
 };
@@ -313,6 +1161,9 @@ public:
                                 const Eigen::Ref<const Eigen::VectorXd> & x_min,
                                 const Eigen::Ref<const Eigen::VectorXd> & x_max) override;
 
+  /** \brief Get memory usage in bytes. */
+  virtual size_t memoryUsage() const override;
+
 protected:
   std::unique_ptr<Eigen::QuadProgDense> quadprog_;
 };
@@ -339,6 +1190,9 @@ public:
                                 const Eigen::Ref<const Eigen::VectorXd> & x_min,
                                 const Eigen::Ref<const Eigen::VectorXd> & x_max) override;
 
+  /** \brief Get memory usage in bytes. */
+  virtual size_t memoryUsage() const override;
+
 protected:
   std::unique_ptr<Eigen::LSSOL_QP> lssol_;
 };
@@ -365,6 +1219,9 @@ public:
                                 const Eigen::Ref<const Eigen::VectorXd> & x_min,
                                 const Eigen::Ref<const Eigen::VectorXd> & x_max) override;
 
+  /** \brief Get memory usage in bytes. */
+  virtual size_t memoryUsage() const override;
+
 protected:
   std::unique_ptr<jrl::qp::GoldfarbIdnaniSolver> jrlqp_;
 };
@@ -393,6 +1250,12 @@ public:
                                 const Eigen::Ref<const Eigen::VectorXd> & x_min,
                                 const Eigen::Ref<const Eigen::VectorXd> & x_max) override;
 
+  /** \brief Get memory usage in bytes. */
+  virtual size_t memoryUsage() const override;
+
+  /** \brief Get hash of the configuration including the public parameters. */
+  virtual size_t configHash() const override;
+
 public:
   int n_wsr_ = 10000;
 
@@ -404,6 +1267,10 @@ public:
 
 protected:
   std::unique_ptr<qpOASES::SQProblem> qpoases_;
+
+  //! Objective matrix and stacked constraint matrix, which must be held since qpOASES refers to them without copying
+  Eigen::MatrixXd Q_;
+  Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor> AC_row_major_;
 };
 #endif
 
@@ -430,6 +1297,31 @@ public:
                                 const Eigen::Ref<const Eigen::VectorXd> & x_min,
                                 const Eigen::Ref<const Eigen::VectorXd> & x_max) override;
 
+  /** \brief Get memory usage in bytes. */
+  virtual size_t memoryUsage() const override;
+
+  /** \brief Get hash of the configuration including the public parameters. */
+  virtual size_t configHash() const override;
+
+  /** \brief Declare the sparsity pattern of the matrices.
+      \param Q_pattern objective matrix whose nonzero elements may be nonzero
+      \param A_pattern equality constraint matrix whose nonzero elements may be nonzero
+      \param C_pattern inequality constraint matrix whose nonzero elements may be nonzero
+
+      The declared sparsity pattern replaces the one fixed in the previous solves, and the solver is initialized fully
+     in the next solve. See fix_sparsity_pattern_.
+   */
+  void setSparsityPattern(const Eigen::Ref<const Eigen::MatrixXd> & Q_pattern,
+                          const Eigen::Ref<const Eigen::MatrixXd> & A_pattern,
+                          const Eigen::Ref<const Eigen::MatrixXd> & C_pattern);
+
+  /** \brief Get number of full initializations of OSQP by this wrapper (the initializations by OSQP itself for the
+     updates changing the sparsity pattern are not counted). */
+  inline int initNum() const
+  {
+    return init_num_;
+  }
+
 public:
   /** \brief Whether to initialize each time instead of doing a warm start.
 
@@ -437,6 +1329,23 @@ public:
   */
   bool force_initialize_ = true;
 
+  /** \brief Whether to fix the sparsity pattern of the matrices passed to OSQP.
+
+      If true, the sparsity pattern is fixed in the first solve (or declared by setSparsityPattern) and the values are
+     written into it in the following solves, so that the elements that become zero remain in the pattern and OSQP
+     updates only the values of the KKT matrix without symbolic factorization (when force_initialize_ is false). The
+     pattern is extended (and the solver is initialized fully) only when a nonzero element appears out of the pattern,
+     and is cleared when the dimensions change. If false, zero elements are removed from the matrices in each solve,
+     and OSQP initializes the solver fully whenever the sparsity pattern changes.
+  */
+  bool fix_sparsity_pattern_ = true;
+
+  /** \brief Tolerance of residuals to accept the solution when the maximum number of iterations is reached.
+
+      If either of the primal and dual residuals exceeds this, the solve is regarded as failed.
+  */
+  double max_iter_accept_tol_ = 1e-4;
+
 protected:
   std::unique_ptr<OsqpEigen::Solver> osqp_;
 
@@ -446,6 +1355,12 @@ protected:
   Eigen::VectorXd bd_with_bound_min_;
   Eigen::VectorXd bd_with_bound_max_;
 
+  //! Whether the sparsity pattern is declared by setSparsityPattern after the last solve
+  bool sparsity_pattern_declared_ = false;
+
+  //! Number of full initializations
+  int init_num_ = 0;
+
   double sparse_duration_ = 0; // [ms]
 };
 #endif
@@ -473,6 +1388,9 @@ public:
                                 const Eigen::Ref<const Eigen::VectorXd> & x_min,
                                 const Eigen::Ref<const Eigen::VectorXd> & x_max) override;
 
+  /** \brief Get memory usage in bytes. */
+  virtual size_t memoryUsage() const override;
+
 protected:
   Eigen::SparseMatrix<double, Eigen::ColMajor, int> Q_sparse_;
   Eigen::SparseMatrix<double, Eigen::ColMajor, int> A_sparse_;
@@ -503,6 +1421,12 @@ public:
                                 const Eigen::Ref<const Eigen::VectorXd> & x_min,
                                 const Eigen::Ref<const Eigen::VectorXd> & x_max) override;
 
+  /** \brief Get memory usage in bytes. */
+  virtual size_t memoryUsage() const override;
+
+  /** \brief Get hash of the configuration including the public parameters. */
+  virtual size_t configHash() const override;
+
 public:
   /** \brief Maximum limits of inequality bounds.
 
@@ -511,6 +1435,13 @@ public:
   */
   double bound_limit_ = 1e10;
 
+  /** \brief Tolerance of residuals to accept the solution when the maximum number of iterations is reached.
+
+      If any of the stationarity, equality, inequality, and complementarity residuals exceeds this, the solve is
+     regarded as failed.
+  */
+  double max_iter_accept_tol_ = 1e-4;
+
 protected:
   std::unique_ptr<struct d_dense_qp_dim> qp_dim_;
   std::unique_ptr<struct d_dense_qp> qp_;
@@ -525,6 +1456,9 @@ protected:
   std::unique_ptr<uint8_t[]> ipm_ws_mem_ = nullptr;
 
   std::unique_ptr<double[]> opt_x_mem_ = nullptr;
+
+  //! Total size of the memory allocated for HPIPM
+  size_t hpipm_mem_size_ = 0;
 };
 #endif
 
@@ -549,6 +1483,9 @@ public:
                                 const Eigen::Ref<const Eigen::VectorXd> & x_min,
                                 const Eigen::Ref<const Eigen::VectorXd> & x_max) override;
 
+  /** \brief Get memory usage in bytes. */
+  virtual size_t memoryUsage() const override;
+
 protected:
   std::unique_ptr<proxsuite::proxqp::dense::QP<double>> proxqp_;
 };
@@ -575,15 +1512,52 @@ public:
                                 const Eigen::Ref<const Eigen::VectorXd> & x_min,
                                 const Eigen::Ref<const Eigen::VectorXd> & x_max) override;
 
+  /** \brief Get memory usage in bytes. */
+  virtual size_t memoryUsage() const override;
+
 protected:
   std::unique_ptr<qpmad::Solver> qpmad_;
 };
 #endif
 
+class GoldfarbIdnaniSolver;
+
+/** \brief Built-in QP solver, which is always enabled.
+
+    This solves QPs by GoldfarbIdnaniSolver, a dense dual active-set method implemented in this package without
+   external dependencies. It is intended for small dense QPs (e.g., less than 100 variables) and requires the objective
+   matrix to be positive definite.
+ */
+class QpSolverBuiltin : public QpSolver
+{
+public:
+  /** \brief Constructor. */
+  QpSolverBuiltin();
+
+  /** \brief Solve QP. */
+  virtual Eigen::VectorXd solve(int dim_var,
+                                int dim_eq,
+                                int dim_ineq,
+                                Eigen::Ref<Eigen::MatrixXd> Q,
+                                const Eigen::Ref<const Eigen::VectorXd> & c,
+                                const Eigen::Ref<const Eigen::MatrixXd> & A,
+                                const Eigen::Ref<const Eigen::VectorXd> & b,
+                                const Eigen::Ref<const Eigen::MatrixXd> & C,
+                                const Eigen::Ref<const Eigen::VectorXd> & d,
+                                const Eigen::Ref<const Eigen::VectorXd> & x_min,
+                                const Eigen::Ref<const Eigen::VectorXd> & x_max) override;
+
+  /** \brief Get memory usage in bytes. */
+  virtual size_t memoryUsage() const override;
+
+protected:
+  std::unique_ptr<GoldfarbIdnaniSolver> gi_;
+};
+
 /** \brief Get one QP solver type that is enabled.
 
     Checks whether each QP solver is enabled in the order of definition in QpSolverType and returns the first one that
-   is enabled.
+   is enabled. QpSolverType::Builtin is returned if no external QP solver is enabled.
  */
 QpSolverType getAnyQpSolverType();
 
@@ -0,0 +1,195 @@
+/* Author: Masaki Murooka */
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+#include <qp_solver_collection/QpSolverCollection.h>
+
+namespace QpSolverCollection
+{
+/** \brief QP captured by QpSolverFlightRecorder with the information to reproduce the solve. */
+class QpFlightRecord
+{
+public:
+  /** \brief Dump record.
+
+      The format consists of the header, the settings dumped by QpSolverSettings::dump, and the coefficients dumped by
+     QpCoeff::dump, separated by empty lines.
+   */
+  void dump(std::ofstream & ofs) const;
+
+  /** \brief Load record dumped by dump.
+      \returns whether the record is loaded successfully
+   */
+  bool load(std::istream & is);
+
+public:
+  //! QP solver type
+  QpSolverType qp_solver_type_ = QpSolverType::Uninitialized;
+
+  //! Sequence number of solve in the recorder
+  uint64_t seq_ = 0;
+
+  //! Status of solve
+  QpSolveStatus status_ = QpSolveStatus::Unsolved;
+
+  //! Whether it failed to solve the QP
+  bool solve_failed_ = false;
+
+  //! Latency of solve [ms]
+  double duration_ = 0;
+
+  //! QP solver settings
+  QpSolverSettings settings_;
+
+  //! QP coefficient (copied before solving since some QP solvers overwrite the objective matrix)
+  QpCoeff qp_coeff_;
+};
+
+/** \brief QP solver that keeps the last QPs in a ring buffer and persists failing and slow ones.
+
+    Each solve copies the QP into a slot of the ring buffer, whose memory is reused as long as the dimensions do not
+   change, so the overhead is a copy of the coefficients. When the backend fails to solve the QP or the latency exceeds
+   the threshold, the record is handed to a background thread, which writes it to
+   "<output_dir>/qp_<solver>_<recorder id>_<seq>.txt". The file can be loaded by QpFlightRecord::load to reproduce the
+   solve.
+ */
+class QpSolverFlightRecorder : public QpSolver
+{
+public:
+  /** \brief Constructor.
+      \param qp_solver_type backend QP solver type
+      \param output_dir existing directory to which records are written
+      \param history_size number of QPs kept in the ring buffer
+   */
+  QpSolverFlightRecorder(const QpSolverType & qp_solver_type,
+                         const std::string & output_dir,
+                         size_t history_size = 16);
+
+  /** \brief Constructor.
+      \param qp_solver backend QP solver instance
+      \param output_dir existing directory to which records are written
+      \param history_size number of QPs kept in the ring buffer
+   */
+  QpSolverFlightRecorder(const std::shared_ptr<QpSolver> & qp_solver,
+                         const std::string & output_dir,
+                         size_t history_size = 16);
+
+  /** \brief Destructor, which waits until the pending records are written. */
+  ~QpSolverFlightRecorder();
+
+  using QpSolver::solve;
+
+  /** \brief Solve QP. */
+  virtual Eigen::VectorXd solve(int dim_var,
+                                int dim_eq,
+                                int dim_ineq,
+                                Eigen::Ref<Eigen::MatrixXd> Q,
+                                const Eigen::Ref<const Eigen::VectorXd> & c,
+                                const Eigen::Ref<const Eigen::MatrixXd> & A,
+                                const Eigen::Ref<const Eigen::VectorXd> & b,
+                                const Eigen::Ref<const Eigen::MatrixXd> & C,
+                                const Eigen::Ref<const Eigen::VectorXd> & d,
+                                const Eigen::Ref<const Eigen::VectorXd> & x_min,
+                                const Eigen::Ref<const Eigen::VectorXd> & x_max) override;
+
+  /** \brief Set QP solver settings of the backend. */
+  virtual void setSettings(const QpSolverSettings & settings) override;
+
+  /** \brief Get memory usage in bytes including the backend and the ring buffer. */
+  virtual size_t memoryUsage() const override;
+
+  /** \brief Get hash of the configuration of the backend. */
+  virtual size_t configHash() const override;
+
+  /** \brief Allocate the ring buffer for the given dimensions in advance so that solves do not allocate memory. */
+  void preallocate(int dim_var, int dim_eq, int dim_ineq);
+
+  /** \brief Persist all the QPs in the ring buffer (e.g., when the application detects an anomaly).
+      \returns number of records handed to the background thread
+   */
+  size_t persistHistory();
+
+  /** \brief Wait until the pending records are written. */
+  void flush();
+
+  /** \brief Get the QPs in the ring buffer from the oldest one. */
+  std::vector<QpFlightRecord> history() const;
+
+  /** \brief Get the number of records written. */
+  inline size_t persistedCount() const
+  {
+    return persisted_count_;
+  }
+
+  /** \brief Get the backend QP solver instance. */
+  inline const std::shared_ptr<QpSolver> & backend() const
+  {
+    return backend_;
+  }
+
+public:
+  //! Latency threshold [ms] above which the QP is persisted (not persisted by latency if not positive)
+  double latency_threshold_ = 0;
+
+  //! Whether to persist the QPs that the backend failed to solve
+  bool persist_failure_ = true;
+
+  //! Maximum number of records persisted in the lifetime of the recorder (to avoid filling up the disk)
+  size_t max_persist_num_ = 100;
+
+protected:
+  /** \brief Hand the record to the background thread.
+      \returns whether the record is accepted
+   */
+  bool persist(const QpFlightRecord & record);
+
+  /** \brief Loop of the background thread. */
+  void writerLoop();
+
+protected:
+  //! Backend QP solver instance
+  std::shared_ptr<QpSolver> backend_;
+
+  //! Directory to which records are written
+  std::string output_dir_;
+
+  //! ID of the recorder to distinguish the files of multiple recorders
+  int recorder_id_;
+
+  //! Ring buffer of QPs
+  std::vector<QpFlightRecord> history_list_;
+
+  //! Number of records (the slot of the next solve is this modulo the size of ring buffer)
+  uint64_t record_count_ = 0;
+
+  //! Number of records handed to the background thread
+  size_t persist_request_count_ = 0;
+
+  //! Number of records written by the background thread
+  std::atomic<size_t> persisted_count_{0};
+
+  //! Records waiting to be written
+  std::deque<QpFlightRecord> pending_list_;
+
+  //! Whether the background thread is writing a record
+  bool writing_ = false;
+
+  //! Whether to stop the background thread
+  bool stop_ = false;
+
+  //! Mutex for the pending records and the flags of the background thread
+  mutable std::mutex mtx_;
+
+  //! Condition variable to notify the pending records and the completion of writing
+  std::condition_variable cv_;
+
+  //! Background thread to write records
+  std::thread thread_;
+};
+} // namespace QpSolverCollection
@@ -0,0 +1,237 @@
+/* Author: Masaki Murooka */
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+
+#include <qp_solver_collection/QpSolverCollection.h>
+
+namespace QpSolverCollection
+{
+/** \brief Compute hash of QP.
+
+    The data of all the matrices and vectors are hashed bitwise in four independent 64-bit lanes, which compilers
+   vectorize with SIMD instructions.
+ */
+size_t computeQpHash(int dim_var,
+                     int dim_eq,
+                     int dim_ineq,
+                     const Eigen::Ref<const Eigen::MatrixXd> & Q,
+                     const Eigen::Ref<const Eigen::VectorXd> & c,
+                     const Eigen::Ref<const Eigen::MatrixXd> & A,
+                     const Eigen::Ref<const Eigen::VectorXd> & b,
+                     const Eigen::Ref<const Eigen::MatrixXd> & C,
+                     const Eigen::Ref<const Eigen::VectorXd> & d,
+                     const Eigen::Ref<const Eigen::VectorXd> & x_min,
+                     const Eigen::Ref<const Eigen::VectorXd> & x_max);
+
+/** \brief Thread-safe bounded cache of QP solutions keyed by the exact QP and the QP solver that solved it.
+
+    The cache is divided into shards, each of which is protected by its own mutex and evicts the least recently used
+   entry. It can be shared by QpSolverMemoize instances of multiple threads, and the instances with different backends
+   or settings do not return each other's solutions.
+ */
+class QpSolveMemoCache
+{
+public:
+  /** \brief Entry of cache. */
+  struct Entry
+  {
+    //! Key of the backend class and configuration used to solve the QP (see QpSolverMemoize::solverKey)
+    size_t solver_key = 0;
+
+    //! QP coefficient used to check the exact match
+    QpCoeff qp_coeff;
+
+    //! Solution with Lagrange multipliers
+    SolveResult result;
+
+    //! Whether it failed to solve the QP
+    bool solve_failed = false;
+  };
+
+public:
+  /** \brief Constructor.
+      \param capacity maximum number of entries
+   */
+  QpSolveMemoCache(size_t capacity = 64);
+
+  /** \brief Find the entry that exactly matches the QP.
+      \param hash hash computed by computeQpHash and combined with the solver key
+      \param solver_key key of the backend class and configuration
+      \param match function to check whether the QP coefficient of the entry exactly matches the QP
+      \param result solution of the found entry
+      \param solve_failed whether it failed to solve the QP of the found entry
+      \returns whether the entry is found
+
+      The predicate is a template parameter so that it is called without type erasure (and heap allocation).
+   */
+  template<class MatchFunc>
+  bool find(size_t hash, size_t solver_key, const MatchFunc & match, SolveResult & result, bool & solve_failed)
+  {
+    Shard & shard = shard_list_[hash % shard_num_];
+    {
+      std::lock_guard<std::mutex> lock(shard.mutex);
+      auto range = shard.lru_map.equal_range(hash);
+      for(auto it = range.first; it != range.second; it++)
+      {
+        const Entry & entry = it->second->second;
+        if(entry.solver_key == solver_key && match(entry.qp_coeff))
+        {
+          result = entry.result;
+          solve_failed = entry.solve_failed;
+          shard.lru_list.splice(shard.lru_list.begin(), shard.lru_list, it->second);
+          hit_count_++;
+          return true;
+        }
+      }
+    }
+    miss_count_++;
+    return false;
+  }
+
+  /** \brief Insert the entry. */
+  void insert(size_t hash, Entry && entry);
+
+  /** \brief Clear entries and counters. */
+  void clear();
+
+  /** \brief Get the number of entries. */
+  size_t size() const;
+
+  /** \brief Get the number of found entries. */
+  inline size_t hitCount() const
+  {
+    return hit_count_;
+  }
+
+  /** \brief Get the number of entries not found. */
+  inline size_t missCount() const
+  {
+    return miss_count_;
+  }
+
+protected:
+  /** \brief Shard of cache. */
+  struct Shard
+  {
+    //! Mutex of shard
+    mutable std::mutex mutex;
+
+    //! Hash and entry ordered from the most recently used one
+    std::list<std::pair<size_t, Entry>> lru_list;
+
+    //! Map from hash to the position in lru_list (multiple entries may have the same hash)
+    std::unordered_multimap<size_t, std::list<std::pair<size_t, Entry>>::iterator> lru_map;
+  };
+
+  //! Number of shards
+  static constexpr size_t shard_num_ = 16;
+
+  //! Shards
+  std::array<Shard, shard_num_> shard_list_;
+
+  //! Maximum number of entries in each shard
+  size_t shard_capacity_;
+
+  std::atomic<size_t> hit_count_{0};
+  std::atomic<size_t> miss_count_{0};
+};
+
+/** \brief QP solver that returns the cached solution for the QP bit-identical to a previously solved one.
+
+    A duplicate solve costs a hash and a comparison of the QP coefficient, each of which reads the coefficient once.
+   The solutions are looked up only among those solved with the same backend class and configuration (see
+   QpSolver::configHash), which is checked in each solve so that the settings and parameters changed directly on the
+   backend are also taken into account.
+
+    \note Since the backend is not called for duplicate solves, its warm-start state is not updated by them.
+ */
+class QpSolverMemoize : public QpSolver
+{
+public:
+  /** \brief Constructor.
+      \param qp_solver_type backend QP solver type
+      \param cache cache shared with other instances (a new cache is created if null)
+   */
+  QpSolverMemoize(const QpSolverType & qp_solver_type, const std::shared_ptr<QpSolveMemoCache> & cache = nullptr);
+
+  /** \brief Constructor.
+      \param qp_solver backend QP solver instance
+      \param cache cache shared with other instances (a new cache is created if null)
+   */
+  QpSolverMemoize(const std::shared_ptr<QpSolver> & qp_solver,
+                  const std::shared_ptr<QpSolveMemoCache> & cache = nullptr);
+
+  using QpSolver::solve;
+
+  /** \brief Solve QP. */
+  virtual Eigen::VectorXd solve(int dim_var,
+                                int dim_eq,
+                                int dim_ineq,
+                                Eigen::Ref<Eigen::MatrixXd> Q,
+                                const Eigen::Ref<const Eigen::VectorXd> & c,
+                                const Eigen::Ref<const Eigen::MatrixXd> & A,
+                                const Eigen::Ref<const Eigen::VectorXd> & b,
+                                const Eigen::Ref<const Eigen::MatrixXd> & C,
+                                const Eigen::Ref<const Eigen::VectorXd> & d,
+                                const Eigen::Ref<const Eigen::VectorXd> & x_min,
+                                const Eigen::Ref<const Eigen::VectorXd> & x_max) override;
+
+  /** \brief Set QP solver settings of the backend.
+
+      The solutions cached with the previous settings are not returned anymore, while those of other instances sharing
+     the cache are kept.
+   */
+  virtual void setSettings(const QpSolverSettings & settings) override;
+
+  /** \brief Get memory usage in bytes including the backend.
+
+      The cache is not included since it may be shared with other instances.
+   */
+  virtual size_t memoryUsage() const override;
+
+  /** \brief Get hash of the configuration of the backend. */
+  virtual size_t configHash() const override;
+
+  /** \brief Get the backend QP solver instance. */
+  inline const std::shared_ptr<QpSolver> & backend() const
+  {
+    return backend_;
+  }
+
+  /** \brief Get the cache. */
+  inline const std::shared_ptr<QpSolveMemoCache> & cache() const
+  {
+    return cache_;
+  }
+
+  /** \brief Get whether the last solve was answered from the cache. */
+  inline bool lastHit() const
+  {
+    return last_hit_;
+  }
+
+  /** \brief Get the key of the backend class and its current configuration. */
+  size_t solverKey() const;
+
+protected:
+  //! Backend QP solver instance
+  std::shared_ptr<QpSolver> backend_;
+
+  //! Cache of solutions
+  std::shared_ptr<QpSolveMemoCache> cache_;
+
+  //! Buffer of the solution found in the cache
+  SolveResult result_;
+
+  //! Hash of the backend class
+  size_t backend_class_hash_ = 0;
+
+  bool last_hit_ = false;
+};
+} // namespace QpSolverCollection
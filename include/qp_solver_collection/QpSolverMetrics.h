@@ -0,0 +1,286 @@
+/* Author: Masaki Murooka */
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <qp_solver_collection/QpSolverCollection.h>
+
+namespace QpSolverCollection
+{
+/** \brief Snapshot of histogram. */
+struct QpMetricsHistogramSnapshot
+{
+  //! Upper bounds of buckets (the last bucket without upper bound is not included)
+  std::vector<double> upper_bound_list;
+
+  //! Number of observations in each bucket (not cumulative, the last element corresponds to the bucket without upper
+  //! bound)
+  std::vector<uint64_t> bucket_count_list;
+
+  //! Number of observations
+  uint64_t count = 0;
+
+  //! Sum of observations
+  double sum = 0;
+};
+
+/** \brief Histogram with buckets of powers of two.
+
+    The upper bound of the i-th bucket is \f$2^{min\_exp + i}\f$. Observation assumes a single writer and consists of
+   relaxed atomic loads and stores without read-modify-write instructions, while snapshot can be taken from any thread.
+ */
+class QpMetricsHistogram
+{
+public:
+  /** \brief Constructor.
+      \param min_exp exponent of the upper bound of the first bucket
+      \param bucket_num number of buckets with upper bound
+   */
+  QpMetricsHistogram(int min_exp, int bucket_num);
+
+  /** \brief Add observation. */
+  void observe(uint64_t value);
+
+  /** \brief Get snapshot.
+      \param scale scale multiplied to upper bounds and sum (e.g., 1e-9 to convert nanoseconds to seconds)
+   */
+  QpMetricsHistogramSnapshot snapshot(double scale = 1.0) const;
+
+  /** \brief Reset observations. */
+  void reset();
+
+protected:
+  int min_exp_;
+  int bucket_num_;
+  std::unique_ptr<std::atomic<uint64_t>[]> bucket_count_list_;
+  std::atomic<uint64_t> sum_{0};
+};
+
+/** \brief Number of values of QpSolveStatus. */
+constexpr int qp_solve_status_num = static_cast<int>(QpSolveStatus::Unknown) - static_cast<int>(QpSolveStatus::Unsolved)
+                                    + 1;
+
+/** \brief Snapshot of metrics of one QP solver type. */
+struct QpSolverMetricsSnapshot
+{
+  //! QP solver type
+  QpSolverType qp_solver_type = QpSolverType::Uninitialized;
+
+  //! Latency [s]
+  QpMetricsHistogramSnapshot latency;
+
+  //! Number of iterations (only for QP solvers that report it)
+  QpMetricsHistogramSnapshot iter;
+
+  //! Dimension of decision variable
+  QpMetricsHistogramSnapshot dim_var;
+
+  //! Number of solves
+  uint64_t solve_count = 0;
+
+  //! Number of failed solves
+  uint64_t failure_count = 0;
+
+  //! Number of solves for each status (indexed by the status minus QpSolveStatus::Unsolved)
+  std::array<uint64_t, qp_solve_status_num> status_count_list = {};
+};
+
+/** \brief Metrics of one QP solver type recorded by a single thread. */
+class QpSolverMetrics
+{
+public:
+  /** \brief Constructor. */
+  QpSolverMetrics();
+
+  /** \brief Record solve.
+      \param duration latency [ns]
+      \param iter number of iterations (negative if not available)
+      \param dim_var dimension of decision variable
+      \param status status of solve
+      \param solve_failed whether it failed to solve
+   */
+  void record(uint64_t duration, int iter, int dim_var, QpSolveStatus status, bool solve_failed);
+
+  /** \brief Add snapshot to the given one. */
+  void accumulateSnapshot(QpSolverMetricsSnapshot & metrics) const;
+
+  /** \brief Reset metrics. */
+  void reset();
+
+protected:
+  QpMetricsHistogram latency_;
+  QpMetricsHistogram iter_;
+  QpMetricsHistogram dim_var_;
+  std::atomic<uint64_t> solve_count_{0};
+  std::atomic<uint64_t> failure_count_{0};
+  std::array<std::atomic<uint64_t>, qp_solve_status_num> status_count_list_;
+};
+
+/** \brief Process-wide registry of metrics of QP solvers.
+
+    Each QP solver reports the latency, number of iterations, dimension, and status after each solve if the registry is
+   enabled. Each thread records into its own shard of metrics, which is merged when a snapshot is taken. Recording is
+   therefore lock-free without contended cache lines and costs a few tens of nanoseconds, so it can stay enabled in
+   production. The shard of an exited thread is reused by a new thread so that the metrics are never lost.
+
+    The metrics can be exported in the Prometheus text format to a stream, to a file (e.g., for the textfile collector
+   of node exporter), or to an HTTP endpoint with QpMetricsHttpExporter.
+ */
+class QpMetricsRegistry
+{
+public:
+  /** \brief Get the instance. */
+  static QpMetricsRegistry & instance();
+
+  /** \brief Set whether to record metrics (disabled by default). */
+  inline void setEnabled(bool enabled)
+  {
+    enabled_.store(enabled, std::memory_order_relaxed);
+  }
+
+  /** \brief Get whether to record metrics. */
+  inline bool enabled() const
+  {
+    return enabled_.load(std::memory_order_relaxed);
+  }
+
+  /** \brief Record solve (ignored if the QP solver type is not a concrete one).
+      \param qp_solver_type QP solver type
+      \param duration latency [ns]
+      \param iter number of iterations (negative if not available)
+      \param dim_var dimension of decision variable
+      \param status status of solve
+      \param solve_failed whether it failed to solve
+   */
+  void record(QpSolverType qp_solver_type,
+              uint64_t duration,
+              int iter,
+              int dim_var,
+              QpSolveStatus status,
+              bool solve_failed);
+
+  /** \brief Get snapshot of the QP solver types that have been used. */
+  std::vector<QpSolverMetricsSnapshot> snapshot() const;
+
+  /** \brief Reset metrics.
+
+      Solves recorded concurrently with reset may be partially kept.
+   */
+  void reset();
+
+  /** \brief Write metrics in the Prometheus text format. */
+  void writePrometheus(std::ostream & os) const;
+
+  /** \brief Write metrics in the Prometheus text format to a file.
+      \returns whether the file is written successfully
+
+      The file is replaced atomically by writing to a temporary file and renaming it.
+   */
+  bool writePrometheus(const std::string & path) const;
+
+protected:
+  //! Number of concrete QP solver types
+  static constexpr int qp_solver_type_num_ = static_cast<int>(QpSolverType::Builtin) + 1;
+
+  /** \brief Metrics of all QP solver types recorded by a single thread. */
+  struct Shard
+  {
+    std::array<QpSolverMetrics, qp_solver_type_num_> metrics_list;
+  };
+
+  /** \brief Owner of the shard of a thread, which returns the shard to the registry when the thread exits. */
+  struct ShardHolder
+  {
+    ~ShardHolder();
+
+    Shard * shard = nullptr;
+  };
+
+protected:
+  /** \brief Constructor. */
+  QpMetricsRegistry() {}
+
+  /** \brief Get the shard of the calling thread. */
+  Shard & localShard();
+
+protected:
+  std::atomic<bool> enabled_{false};
+
+  //! All shards ever allocated (shards are never deallocated to keep the metrics)
+  std::vector<std::unique_ptr<Shard>> shard_list_;
+
+  //! Shards released by exited threads
+  std::vector<Shard *> free_shard_list_;
+
+  //! Mutex for the shard lists, locked only when a thread records for the first time or exits
+  mutable std::mutex shard_mtx_;
+};
+
+/** \brief Scoped recorder of a solve, placed at the beginning of QpSolver::solve.
+
+    The metrics are recorded from the state of the QP solver when it goes out of scope. The clock is not read if the
+   registry is disabled.
+ */
+class QpMetricsGuard
+{
+public:
+  /** \brief Constructor.
+      \param qp_solver QP solver
+      \param dim_var dimension of decision variable
+   */
+  QpMetricsGuard(const QpSolver & qp_solver, int dim_var);
+
+  /** \brief Destructor. */
+  ~QpMetricsGuard();
+
+protected:
+  const QpSolver & qp_solver_;
+  int dim_var_;
+  bool enabled_;
+  QpSolver::clock::time_point start_time_;
+};
+
+/** \brief HTTP endpoint that serves metrics in the Prometheus text format.
+
+    A background thread accepts connections and responds to any request with the metrics of QpMetricsRegistry. It is
+   available only on POSIX systems.
+ */
+class QpMetricsHttpExporter
+{
+public:
+  /** \brief Constructor.
+      \param port TCP port (0 to choose a free port)
+      \param address IPv4 address to bind (local only by default)
+
+      Throws std::runtime_error if the socket cannot be opened.
+   */
+  QpMetricsHttpExporter(int port, const std::string & address = "127.0.0.1");
+
+  /** \brief Destructor. */
+  ~QpMetricsHttpExporter();
+
+  /** \brief Get the bound port. */
+  inline int port() const
+  {
+    return port_;
+  }
+
+protected:
+  /** \brief Loop of the background thread. */
+  void serverLoop();
+
+protected:
+  int socket_fd_ = -1;
+  int port_ = 0;
+  std::atomic<bool> stop_{false};
+  std::thread thread_;
+};
+} // namespace QpSolverCollection
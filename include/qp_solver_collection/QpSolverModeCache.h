@@ -0,0 +1,208 @@
+/* Author: Masaki Murooka */
+
+#pragma once
+
+#include <functional>
+#include <list>
+#include <unordered_map>
+
+#include <qp_solver_collection/QpSolverCollection.h>
+
+namespace QpSolverCollection
+{
+/** \brief Structural signature of QP.
+
+    Two QPs with the same signature are expected to have similar active sets, so that the warm-start state of one can
+   be reused for the other.
+ */
+struct QpSignature
+{
+  //! Dimension of decision variable
+  int dim_var = 0;
+
+  //! Dimension of equality constraint
+  int dim_eq = 0;
+
+  //! Dimension of inequality constraint
+  int dim_ineq = 0;
+
+  //! Hash of the sparsity pattern of objective and constraint matrices
+  size_t sparsity_hash = 0;
+
+  //! User-supplied mode tag (e.g., index of contact configuration)
+  size_t mode_tag = 0;
+
+  /** \brief Equality operator. */
+  inline bool operator==(const QpSignature & other) const
+  {
+    return dim_var == other.dim_var && dim_eq == other.dim_eq && dim_ineq == other.dim_ineq
+           && sparsity_hash == other.sparsity_hash && mode_tag == other.mode_tag;
+  }
+};
+
+/** \brief Hash function of QpSignature. */
+struct QpSignatureHash
+{
+  /** \brief Compute hash. */
+  size_t operator()(const QpSignature & signature) const;
+};
+
+/** \brief Compute structural signature of QP.
+    \param Q objective matrix
+    \param A equality constraint matrix
+    \param C inequality constraint matrix
+    \param mode_tag user-supplied mode tag
+    \param use_sparsity_hash whether to hash the sparsity pattern of matrices (if false, only dimensions and mode tag
+   are used)
+ */
+QpSignature computeQpSignature(const Eigen::Ref<const Eigen::MatrixXd> & Q,
+                               const Eigen::Ref<const Eigen::MatrixXd> & A,
+                               const Eigen::Ref<const Eigen::MatrixXd> & C,
+                               size_t mode_tag = 0,
+                               bool use_sparsity_hash = true);
+
+/** \brief QP solver that holds warm-start states for each structural signature of QP.
+
+    A backend QP solver instance and the primal-dual solution of its last successful solve are kept for each signature
+   in a bounded LRU cache. When the signature reappears (e.g., when a locomotion controller switches back to a previous
+   contact configuration), the stored solution is passed to the backend as WarmStart unless the warm start is given to
+   this solver explicitly. In addition, the internal state of the backend instance (e.g., the workspace of qpOASES and
+   OSQP with force_initialize_ false) is kept per signature.
+ */
+class QpSolverModeCache : public QpSolver
+{
+public:
+  /** \brief Type of function to allocate backend QP solver instance. */
+  using QpSolverFactory = std::function<std::shared_ptr<QpSolver>()>;
+
+public:
+  /** \brief Constructor.
+      \param qp_solver_type backend QP solver type
+      \param capacity maximum number of cached backend instances
+   */
+  QpSolverModeCache(const QpSolverType & qp_solver_type, size_t capacity = 8);
+
+  /** \brief Constructor.
+      \param qp_solver_factory function to allocate backend QP solver instance (the QP solver type is taken from the
+     first allocated instance)
+      \param capacity maximum number of cached backend instances
+   */
+  QpSolverModeCache(const QpSolverFactory & qp_solver_factory, size_t capacity = 8);
+
+  using QpSolver::solve;
+
+  /** \brief Solve QP. */
+  virtual Eigen::VectorXd solve(int dim_var,
+                                int dim_eq,
+                                int dim_ineq,
+                                Eigen::Ref<Eigen::MatrixXd> Q,
+                                const Eigen::Ref<const Eigen::VectorXd> & c,
+                                const Eigen::Ref<const Eigen::MatrixXd> & A,
+                                const Eigen::Ref<const Eigen::VectorXd> & b,
+                                const Eigen::Ref<const Eigen::MatrixXd> & C,
+                                const Eigen::Ref<const Eigen::VectorXd> & d,
+                                const Eigen::Ref<const Eigen::VectorXd> & x_min,
+                                const Eigen::Ref<const Eigen::VectorXd> & x_max) override;
+
+  /** \brief Set QP solver settings of all the backend instances. */
+  virtual void setSettings(const QpSolverSettings & settings) override;
+
+  /** \brief Get memory usage in bytes including all the cached backend instances. */
+  virtual size_t memoryUsage() const override;
+
+  /** \brief Get the signature of the last solved QP. */
+  inline const QpSignature & lastSignature() const
+  {
+    return last_signature_;
+  }
+
+  /** \brief Get the backend instance used for the last solve. */
+  inline const std::shared_ptr<QpSolver> & lastSolver() const
+  {
+    return last_solver_;
+  }
+
+  /** \brief Get the number of cached backend instances. */
+  inline size_t size() const
+  {
+    return lru_list_.size();
+  }
+
+  /** \brief Get the number of solves whose signature was found in the cache. */
+  inline size_t hitCount() const
+  {
+    return hit_count_;
+  }
+
+  /** \brief Get the number of solves whose signature was not found in the cache. */
+  inline size_t missCount() const
+  {
+    return miss_count_;
+  }
+
+  /** \brief Set the maximum number of cached backend instances. */
+  void setCapacity(size_t capacity);
+
+  /** \brief Apply the function to each cached backend instance. */
+  template<class FuncType>
+  void forEachSolver(FuncType func)
+  {
+    for(auto & entry : lru_list_)
+    {
+      func(*entry.qp_solver);
+    }
+  }
+
+  /** \brief Clear cache. */
+  void clear();
+
+public:
+  //! User-supplied mode tag included in the signature
+  size_t mode_tag_ = 0;
+
+  //! Whether to include the sparsity pattern of matrices in the signature
+  bool use_sparsity_hash_ = true;
+
+  //! Whether to warm-start the backend from the last solution of the same signature
+  bool restore_solution_ = true;
+
+protected:
+  /** \brief Entry of cache. */
+  struct CacheEntry
+  {
+    //! Signature of QP
+    QpSignature signature;
+
+    //! Backend instance
+    std::shared_ptr<QpSolver> qp_solver;
+
+    //! Solution of the last successful solve (x_ is empty if not solved yet)
+    SolveResult last_result;
+  };
+
+protected:
+  /** \brief Find the cache entry for the signature, allocating the backend instance if not found.
+      \returns cache entry (null if the backend instance cannot be allocated)
+   */
+  CacheEntry * findOrAllocate(const QpSignature & signature);
+
+protected:
+  //! Function to allocate backend QP solver instance
+  QpSolverFactory qp_solver_factory_;
+
+  //! Maximum number of cached backend instances
+  size_t capacity_ = 8;
+
+  //! Backend instances ordered from the most recently used one
+  std::list<CacheEntry> lru_list_;
+
+  //! Map from signature to the position in lru_list_
+  std::unordered_map<QpSignature, std::list<CacheEntry>::iterator, QpSignatureHash> lru_map_;
+
+  QpSignature last_signature_;
+  std::shared_ptr<QpSolver> last_solver_;
+
+  size_t hit_count_ = 0;
+  size_t miss_count_ = 0;
+};
+} // namespace QpSolverCollection
@@ -0,0 +1,187 @@
+/* Author: Masaki Murooka */
+
+#pragma once
+
+#include <list>
+#include <vector>
+
+#include <qp_solver_collection/QpSolverCollection.h>
+
+namespace QpSolverCollection
+{
+/** \brief Critical region of parametric QP.
+
+    For a fixed active set, the primal and dual solutions are affine in the vectors of QP (i.e., \f$\boldsymbol{c},
+   \boldsymbol{b}, \boldsymbol{d}, \boldsymbol{x}_{min}, \boldsymbol{x}_{max}\f$):
+    \f{align*}{
+    \begin{bmatrix} \boldsymbol{x} \\ \boldsymbol{\nu} \end{bmatrix} =
+    \begin{bmatrix} \boldsymbol{Q} & \boldsymbol{G}^T \\ \boldsymbol{G} & \boldsymbol{O} \end{bmatrix}^{-1}
+    \begin{bmatrix} -\boldsymbol{c} \\ \boldsymbol{h} \end{bmatrix}
+    \f}
+    where \f$\boldsymbol{G}\f$ and \f$\boldsymbol{h}\f$ stack the equality constraints and the active inequality
+   constraints and bounds. The region is the set of vectors where this solution is primal and dual feasible.
+ */
+struct QpCriticalRegion
+{
+  //! Indices of active inequality constraints
+  std::vector<int> active_ineq_list;
+
+  //! Indices of variables whose lower bounds are active
+  std::vector<int> active_lower_list;
+
+  //! Indices of variables whose upper bounds are active
+  std::vector<int> active_upper_list;
+
+  //! Inverse of KKT matrix
+  Eigen::MatrixXd kkt_inv;
+
+  /** \brief Get the memory usage in bytes. */
+  size_t memoryUsage() const;
+};
+
+/** \brief QP solver that caches the critical regions of parametric QP.
+
+    This is intended for small QPs whose matrices (i.e., \f$\boldsymbol{Q}, \boldsymbol{A}, \boldsymbol{C}\f$) are
+   fixed and only the vectors vary, as in explicit MPC. The active set of each solution of the backend QP solver is
+   stored with the affine solution law. When the vectors of the next QP fall in a stored region, the solution is
+   obtained by a single matrix-vector product without calling the backend.
+
+    Regions are searched from the most recently used one, so the lookup cost grows with the number of regions; bound it
+   with memory_limit_. The cache is cleared whenever the matrices change.
+ */
+class QpSolverRegionCache : public QpSolver
+{
+public:
+  /** \brief Constructor.
+      \param qp_solver_type backend QP solver type
+   */
+  QpSolverRegionCache(const QpSolverType & qp_solver_type);
+
+  /** \brief Constructor.
+      \param qp_solver backend QP solver instance
+   */
+  QpSolverRegionCache(const std::shared_ptr<QpSolver> & qp_solver);
+
+  using QpSolver::solve;
+
+  /** \brief Solve QP. */
+  virtual Eigen::VectorXd solve(int dim_var,
+                                int dim_eq,
+                                int dim_ineq,
+                                Eigen::Ref<Eigen::MatrixXd> Q,
+                                const Eigen::Ref<const Eigen::VectorXd> & c,
+                                const Eigen::Ref<const Eigen::MatrixXd> & A,
+                                const Eigen::Ref<const Eigen::VectorXd> & b,
+                                const Eigen::Ref<const Eigen::MatrixXd> & C,
+                                const Eigen::Ref<const Eigen::VectorXd> & d,
+                                const Eigen::Ref<const Eigen::VectorXd> & x_min,
+                                const Eigen::Ref<const Eigen::VectorXd> & x_max) override;
+
+  /** \brief Set QP solver settings of the backend. */
+  virtual void setSettings(const QpSolverSettings & settings) override;
+
+  /** \brief Get the backend QP solver instance. */
+  inline const std::shared_ptr<QpSolver> & backend() const
+  {
+    return backend_;
+  }
+
+  /** \brief Get the number of cached regions. */
+  inline size_t regionNum() const
+  {
+    return region_list_.size();
+  }
+
+  /** \brief Get the memory usage of cached regions in bytes. */
+  inline size_t cacheMemoryUsage() const
+  {
+    return memory_usage_;
+  }
+
+  /** \brief Get memory usage in bytes including the cached regions and the backend. */
+  virtual size_t memoryUsage() const override;
+
+  /** \brief Get hash of the configuration including the tolerances and the backend. */
+  virtual size_t configHash() const override;
+
+  /** \brief Get the number of solves answered from the cache. */
+  inline size_t hitCount() const
+  {
+    return hit_count_;
+  }
+
+  /** \brief Get the number of solves passed to the backend. */
+  inline size_t missCount() const
+  {
+    return miss_count_;
+  }
+
+  /** \brief Get the ratio of solves answered from the cache. */
+  inline double hitRate() const
+  {
+    size_t total_count = hit_count_ + miss_count_;
+    return total_count == 0 ? 0.0 : static_cast<double>(hit_count_) / static_cast<double>(total_count);
+  }
+
+  /** \brief Clear cached regions and statistics. */
+  void clear();
+
+public:
+  //! Maximum memory usage of cached regions in bytes (least recently used regions are evicted)
+  size_t memory_limit_ = 4 * 1024 * 1024;
+
+  //! Tolerance of primal and dual feasibility to check whether the vectors fall in a region
+  double feasibility_tol_ = 1e-8;
+
+  //! Tolerance to determine the active set from the solution of the backend
+  double active_tol_ = 1e-6;
+
+protected:
+  /** \brief Clear the cache if the matrices are different from the stored ones. */
+  void updateMatrices(const Eigen::Ref<const Eigen::MatrixXd> & Q,
+                      const Eigen::Ref<const Eigen::MatrixXd> & A,
+                      const Eigen::Ref<const Eigen::MatrixXd> & C);
+
+  /** \brief Evaluate the solution law of the region.
+      \returns whether the vectors fall in the region
+   */
+  bool evaluateRegion(const QpCriticalRegion & region,
+                      const Eigen::Ref<const Eigen::VectorXd> & c,
+                      const Eigen::Ref<const Eigen::VectorXd> & b,
+                      const Eigen::Ref<const Eigen::VectorXd> & d,
+                      const Eigen::Ref<const Eigen::VectorXd> & x_min,
+                      const Eigen::Ref<const Eigen::VectorXd> & x_max,
+                      Eigen::VectorXd & sol);
+
+  /** \brief Make the region from the solution of the backend and add it to the cache. */
+  void addRegion(const Eigen::VectorXd & x,
+                 const Eigen::Ref<const Eigen::VectorXd> & c,
+                 const Eigen::Ref<const Eigen::VectorXd> & b,
+                 const Eigen::Ref<const Eigen::VectorXd> & d,
+                 const Eigen::Ref<const Eigen::VectorXd> & x_min,
+                 const Eigen::Ref<const Eigen::VectorXd> & x_max);
+
+  /** \brief Set Lagrange multipliers from the solution of the region. */
+  void setDual(const QpCriticalRegion & region, const Eigen::VectorXd & sol);
+
+protected:
+  //! Backend QP solver instance
+  std::shared_ptr<QpSolver> backend_;
+
+  //! Cached regions ordered from the most recently used one
+  std::list<QpCriticalRegion> region_list_;
+
+  //! Matrices of the cached regions
+  Eigen::MatrixXd Q_;
+  Eigen::MatrixXd A_;
+  Eigen::MatrixXd C_;
+
+  //! Buffers for the evaluation of regions
+  Eigen::VectorXd rhs_;
+  Eigen::VectorXd sol_;
+
+  size_t memory_usage_ = 0;
+  size_t hit_count_ = 0;
+  size_t miss_count_ = 0;
+};
+} // namespace QpSolverCollection
@@ -0,0 +1,270 @@
+/* Author: Masaki Murooka */
+
+#pragma once
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include <qp_solver_collection/QpSolverCollection.h>
+
+namespace QpSolverCollection
+{
+namespace detail
+{
+class QpShmRegion;
+} // namespace detail
+
+/** \brief Configuration of shared memory of QP solve server. */
+struct QpShmConfig
+{
+  //! Maximum dimension of decision variable
+  int max_dim_var = 0;
+
+  //! Maximum dimension of equality constraint
+  int max_dim_eq = 0;
+
+  //! Maximum dimension of inequality constraint
+  int max_dim_ineq = 0;
+
+  //! Number of slots (i.e., maximum number of requests in flight)
+  int slot_num = 8;
+
+  //! Whether to remove the existing shared memory of the same name (e.g., the stale one left by a crashed server)
+  bool remove_existing = false;
+};
+
+/** \brief Request of QP solve placed in a shared-memory slot.
+
+    The coefficients are mapped directly onto the shared memory, so that they can be written in place without an
+   intermediate QpCoeff.
+ */
+class QpShmRequest
+{
+public:
+  /** \brief Constructor.
+      \param slot_idx index of slot
+      \param dim_var dimension of decision variable
+      \param dim_eq dimension of equality constraint
+      \param dim_ineq dimension of inequality constraint
+      \param data start of the coefficient data in the slot
+   */
+  QpShmRequest(int slot_idx, int dim_var, int dim_eq, int dim_ineq, double * data);
+
+  /** \brief Get the index of slot. */
+  inline int slotIdx() const
+  {
+    return slot_idx_;
+  }
+
+protected:
+  //! Index of slot
+  int slot_idx_;
+
+public:
+  //! Objective matrix
+  Eigen::Map<Eigen::MatrixXd> obj_mat_;
+
+  //! Objective vector
+  Eigen::Map<Eigen::VectorXd> obj_vec_;
+
+  //! Equality constraint matrix
+  Eigen::Map<Eigen::MatrixXd> eq_mat_;
+
+  //! Equality constraint vector
+  Eigen::Map<Eigen::VectorXd> eq_vec_;
+
+  //! Inequality constraint matrix
+  Eigen::Map<Eigen::MatrixXd> ineq_mat_;
+
+  //! Inequality constraint vector
+  Eigen::Map<Eigen::VectorXd> ineq_vec_;
+
+  //! Lower bound
+  Eigen::Map<Eigen::VectorXd> x_min_;
+
+  //! Upper bound
+  Eigen::Map<Eigen::VectorXd> x_max_;
+
+  //! Solution written by the server
+  Eigen::Map<Eigen::VectorXd> x_;
+
+  //! Lagrange multipliers of equality constraints written by the server (see QpSolverClient::requestHasDual)
+  Eigen::Map<Eigen::VectorXd> dual_eq_;
+
+  //! Lagrange multipliers of inequality constraints written by the server
+  Eigen::Map<Eigen::VectorXd> dual_ineq_;
+
+  //! Lagrange multipliers of bounds written by the server
+  Eigen::Map<Eigen::VectorXd> dual_bound_;
+};
+
+/** \brief Server that solves QPs placed in POSIX shared memory by other processes.
+
+    The shared memory consists of fixed-size slots and a lock-free ring of slot indices. A client writes the
+   coefficients into a free slot and pushes its index to the ring. A worker thread of the server pops the index, solves
+   the QP with its preallocated QpSolver instance, and writes the solution back into the same slot. The slot index and
+   the dimensions read from the shared memory are checked against the layout before the slot is accessed, and the
+   slots abandoned by the clients after timeout are reclaimed.
+
+    \note Worker threads busy-wait (with yield) for requests to keep the handoff latency on the order of microseconds.
+ */
+class QpSolverServer
+{
+public:
+  /** \brief Constructor.
+      \param name name of shared memory (e.g., "/qp_solver_server")
+      \param qp_solver_type QP solver type
+      \param config configuration of shared memory
+      \param thread_num number of worker threads (i.e., number of preallocated QpSolver instances)
+
+      Throws std::runtime_error if the shared memory cannot be created, including the case where the shared memory of
+     the same name exists and QpShmConfig::remove_existing is false.
+   */
+  QpSolverServer(const std::string & name,
+                 const QpSolverType & qp_solver_type,
+                 const QpShmConfig & config,
+                 int thread_num = 1);
+
+  /** \brief Destructor.
+
+      Worker threads are stopped and the shared memory is removed.
+   */
+  ~QpSolverServer();
+
+  /** \brief Start worker threads. */
+  void start();
+
+  /** \brief Stop worker threads. */
+  void stop();
+
+  /** \brief Set QP solver settings of all the preallocated instances.
+
+      This must be called while worker threads are stopped.
+   */
+  void setSettings(const QpSolverSettings & settings);
+
+  /** \brief Get whether worker threads are running. */
+  inline bool running() const
+  {
+    return running_;
+  }
+
+  /** \brief Get the number of solved requests. */
+  inline size_t solvedCount() const
+  {
+    return solved_count_;
+  }
+
+protected:
+  /** \brief Loop of worker thread. */
+  void workerLoop(int thread_idx);
+
+protected:
+  //! Shared memory
+  std::unique_ptr<detail::QpShmRegion> region_;
+
+  //! Preallocated QP solver instance of each worker thread
+  std::vector<std::shared_ptr<QpSolver>> qp_solver_list_;
+
+  //! Worker threads
+  std::vector<std::thread> thread_list_;
+
+  //! Whether worker threads are running
+  std::atomic<bool> running_{false};
+
+  //! Number of solved requests
+  std::atomic<size_t> solved_count_{0};
+};
+
+/** \brief Client of QpSolverServer.
+
+    Since this class is a QpSolver, it can be used in place of a local QP solver. To avoid copying the coefficients,
+   use acquire(), submit(), wait(), and release() directly.
+
+    Lagrange multipliers are transferred from the server if the QP solver of the server provides them.
+ */
+class QpSolverClient : public QpSolver
+{
+public:
+  /** \brief Constructor.
+      \param name name of shared memory created by QpSolverServer
+
+      Throws std::runtime_error if the shared memory cannot be opened.
+   */
+  QpSolverClient(const std::string & name);
+
+  /** \brief Destructor. */
+  ~QpSolverClient();
+
+  using QpSolver::solve;
+
+  /** \brief Solve QP on the server.
+
+      Throws std::runtime_error if no slot becomes free within timeout_ (see acquire).
+   */
+  virtual Eigen::VectorXd solve(int dim_var,
+                                int dim_eq,
+                                int dim_ineq,
+                                Eigen::Ref<Eigen::MatrixXd> Q,
+                                const Eigen::Ref<const Eigen::VectorXd> & c,
+                                const Eigen::Ref<const Eigen::MatrixXd> & A,
+                                const Eigen::Ref<const Eigen::VectorXd> & b,
+                                const Eigen::Ref<const Eigen::MatrixXd> & C,
+                                const Eigen::Ref<const Eigen::VectorXd> & d,
+                                const Eigen::Ref<const Eigen::VectorXd> & x_min,
+                                const Eigen::Ref<const Eigen::VectorXd> & x_max) override;
+
+  /** \brief Acquire a free slot, waiting until one becomes free.
+      \param dim_var dimension of decision variable
+      \param dim_eq dimension of equality constraint
+      \param dim_ineq dimension of inequality constraint
+
+      Throws std::runtime_error if the dimensions exceed the maximum dimensions of the shared memory or no slot becomes
+     free within timeout_.
+   */
+  QpShmRequest acquire(int dim_var, int dim_eq, int dim_ineq);
+
+  /** \brief Submit the request to the server. */
+  void submit(const QpShmRequest & request);
+
+  /** \brief Check whether the request has been solved. */
+  bool poll(const QpShmRequest & request) const;
+
+  /** \brief Wait until the request is solved.
+      \returns whether the request is solved within timeout_ (the solution is stored in QpShmRequest::x_)
+
+      If false is returned, the request must be given up by abandon instead of release.
+   */
+  bool wait(const QpShmRequest & request);
+
+  /** \brief Get whether the server failed to solve the request. */
+  bool requestFailed(const QpShmRequest & request) const;
+
+  /** \brief Get the status of solve of the request. */
+  QpSolveStatus requestStatus(const QpShmRequest & request) const;
+
+  /** \brief Get whether the server wrote the Lagrange multipliers of the request (QpShmRequest::dual_eq_ etc.). */
+  bool requestHasDual(const QpShmRequest & request) const;
+
+  /** \brief Release the slot of the request. */
+  void release(const QpShmRequest & request);
+
+  /** \brief Give up the request whose solution is not waited for anymore.
+
+      The slot is reclaimed by the server when it finishes or skips the request, so that it can be acquired again.
+   */
+  void abandon(const QpShmRequest & request);
+
+public:
+  //! Timeout of waiting for the server to solve the request or to free a slot [sec]
+  double timeout_ = 1.0;
+
+protected:
+  //! Shared memory
+  std::unique_ptr<detail::QpShmRegion> region_;
+
+  //! Index of slot from which to search for a free one
+  int slot_hint_ = 0;
+};
+} // namespace QpSolverCollection
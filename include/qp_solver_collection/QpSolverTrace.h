@@ -0,0 +1,189 @@
+/* Author: Masaki Murooka */
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include <qp_solver_collection/QpSolverCollection.h>
+
+namespace QpSolverCollection
+{
+/** \brief Trace event of a scope, corresponding to the complete event ("ph": "X") of the Chrome trace format. */
+struct QpTraceEvent
+{
+  //! Event name (string literal)
+  const char * name = nullptr;
+
+  //! Thread ID assigned by QpTracer
+  int tid = 0;
+
+  //! Begin time [ns] from the start of QpTracer
+  uint64_t begin = 0;
+
+  //! Duration [ns]
+  uint64_t duration = 0;
+};
+
+/** \brief Process-wide collector of trace events of solve phases.
+
+    Each thread writes events into its own ring buffer with relaxed atomic stores, so that tracing does not block or
+   contend with other threads. When the buffer is full, the oldest events are overwritten (and the oldest remaining
+   event is not flushed because it cannot be distinguished from the one being overwritten). The buffers are flushed to
+   the Chrome trace JSON, which can be viewed in Perfetto (https://ui.perfetto.dev) or chrome://tracing.
+
+    Events are emitted by QSC_TRACE_SCOPE and QSC_TRACE_PHASE, which expand to nothing unless the library is built with
+   ENABLE_TRACING:
+    \code
+    QSC_TRACE_SCOPE("QpSolverOsqp::solve");
+    QSC_TRACE_PHASE("stack"); // Stack constraint matrices
+    ...
+    QSC_TRACE_PHASE("iterate"); // Ends the previous phase
+    ...
+    \endcode
+ */
+class QpTracer
+{
+public:
+  /** \brief Get the instance. */
+  static QpTracer & instance();
+
+  /** \brief Set whether to record events (enabled by default; effective only if built with ENABLE_TRACING). */
+  inline void setEnabled(bool enabled)
+  {
+    enabled_.store(enabled, std::memory_order_relaxed);
+  }
+
+  /** \brief Get whether to record events. */
+  inline bool enabled() const
+  {
+    return enabled_.load(std::memory_order_relaxed);
+  }
+
+  /** \brief Set the number of events held by the buffer of each thread (applied to buffers allocated afterwards). */
+  void setBufferCapacity(size_t capacity);
+
+  /** \brief Record event.
+      \param name event name (must be a string literal or outlive the tracer)
+      \param begin_time begin time
+      \param end_time end time
+   */
+  void record(const char * name, QpSolver::clock::time_point begin_time, QpSolver::clock::time_point end_time);
+
+  /** \brief Get events held by the buffers in the order of threads and begin times. */
+  std::vector<QpTraceEvent> events() const;
+
+  /** \brief Clear events.
+
+      Events recorded concurrently with clear may be partially kept.
+   */
+  void clear();
+
+  /** \brief Write events in the Chrome trace JSON. */
+  void writeChromeTrace(std::ostream & os) const;
+
+  /** \brief Write events in the Chrome trace JSON to a file.
+      \returns whether the file is written successfully
+   */
+  bool writeChromeTrace(const std::string & path) const;
+
+protected:
+  /** \brief Ring buffer of events written by a single thread. */
+  struct Buffer
+  {
+    /** \brief Slot of event, whose members are atomic so that the buffer can be read while being written. */
+    struct Slot
+    {
+      std::atomic<const char *> name{nullptr};
+      std::atomic<uint64_t> begin{0};
+      std::atomic<uint64_t> duration{0};
+    };
+
+    Buffer(int _tid, size_t _capacity) : tid(_tid), slot_list(new Slot[_capacity]), capacity(_capacity) {}
+
+    int tid;
+    std::unique_ptr<Slot[]> slot_list;
+    size_t capacity;
+
+    //! Total number of events written (the slot index is this modulo capacity)
+    std::atomic<uint64_t> write_count{0};
+
+    //! Events written before this count are regarded as cleared
+    std::atomic<uint64_t> clear_count{0};
+  };
+
+  /** \brief Owner of the buffer of a thread, which returns the buffer to the tracer when the thread exits. */
+  struct BufferHolder
+  {
+    ~BufferHolder();
+
+    Buffer * buffer = nullptr;
+  };
+
+protected:
+  /** \brief Constructor. */
+  QpTracer();
+
+  /** \brief Get the buffer of the calling thread. */
+  Buffer & localBuffer();
+
+protected:
+  std::atomic<bool> enabled_{true};
+
+  size_t buffer_capacity_ = 8192;
+
+  //! Start time, from which timestamps are measured
+  QpSolver::clock::time_point start_time_;
+
+  //! All buffers ever allocated (buffers are never deallocated to keep the events)
+  std::vector<std::unique_ptr<Buffer>> buffer_list_;
+
+  //! Buffers released by exited threads
+  std::vector<Buffer *> free_buffer_list_;
+
+  //! Mutex for the buffer lists, locked only when a thread records for the first time or exits
+  mutable std::mutex buffer_mtx_;
+};
+
+/** \brief Scoped trace event, optionally divided into consecutive phases.
+
+    Use QSC_TRACE_SCOPE and QSC_TRACE_PHASE instead of using this class directly.
+ */
+class QpTraceScope
+{
+public:
+  /** \brief Constructor.
+      \param name event name of the whole scope (string literal)
+   */
+  explicit QpTraceScope(const char * name);
+
+  /** \brief Destructor, which records the current phase and the whole scope. */
+  ~QpTraceScope();
+
+  /** \brief End the current phase (if any) and begin the next phase.
+      \param name event name of the phase (string literal)
+   */
+  void phase(const char * name);
+
+protected:
+  const char * name_;
+  const char * phase_name_ = nullptr;
+  bool enabled_;
+  QpSolver::clock::time_point begin_time_;
+  QpSolver::clock::time_point phase_begin_time_;
+};
+} // namespace QpSolverCollection
+
+#if ENABLE_TRACING
+/** \brief Record the enclosing scope as a trace event (at most one per scope). */
+#  define QSC_TRACE_SCOPE(name) QpSolverCollection::QpTraceScope qsc_trace_scope_(name)
+/** \brief End the current phase and begin the next phase of the scope declared by QSC_TRACE_SCOPE. */
+#  define QSC_TRACE_PHASE(name) qsc_trace_scope_.phase(name)
+#else
+#  define QSC_TRACE_SCOPE(name) ((void)0)
+#  define QSC_TRACE_PHASE(name) ((void)0)
+#endif
@@ -0,0 +1,258 @@
+/* Author: Masaki Murooka */
+
+#pragma once
+
+#include <functional>
+
+#include <qp_solver_collection/QpSolverCollection.h>
+
+namespace QpSolverCollection
+{
+/** \brief Nonlinear program solved by SqpSolver.
+
+    The problem is formulated as follows:
+    \f{align*}{
+    & min_{\boldsymbol{x}} \ f(\boldsymbol{x}) \\
+    & s.t. \ \ \boldsymbol{g}(\boldsymbol{x}) = \boldsymbol{0} \nonumber \\
+    & \phantom{s.t.} \ \ \boldsymbol{h}(\boldsymbol{x}) \leq \boldsymbol{0} \nonumber \\
+    & \phantom{s.t.} \ \ \boldsymbol{x}_{min} \leq \boldsymbol{x} \leq \boldsymbol{x}_{max} \nonumber
+    \f}
+
+    Derivatives are written into the given matrices and vectors, which are the buffers of the QP subproblem, so that no
+   memory is allocated in each iteration.
+ */
+class SqpProblem
+{
+public:
+  /** \brief Type of function to compute value. */
+  using ValueFunc = std::function<double(const Eigen::VectorXd & x)>;
+
+  /** \brief Type of function to compute vector (e.g., gradient and constraint values). */
+  using VectorFunc = std::function<void(const Eigen::VectorXd & x, Eigen::Ref<Eigen::VectorXd> vec)>;
+
+  /** \brief Type of function to compute matrix (e.g., Jacobian). */
+  using MatrixFunc = std::function<void(const Eigen::VectorXd & x, Eigen::Ref<Eigen::MatrixXd> mat)>;
+
+  /** \brief Type of function to compute Hessian of Lagrangian.
+
+      The Lagrangian is \f$f(\boldsymbol{x}) + \boldsymbol{\lambda}_{eq}^T \boldsymbol{g}(\boldsymbol{x}) +
+     \boldsymbol{\lambda}_{ineq}^T \boldsymbol{h}(\boldsymbol{x})\f$. The Hessian must be positive definite.
+   */
+  using HessianFunc = std::function<void(const Eigen::VectorXd & x,
+                                         const Eigen::VectorXd & dual_eq,
+                                         const Eigen::VectorXd & dual_ineq,
+                                         Eigen::Ref<Eigen::MatrixXd> hess)>;
+
+public:
+  //! Dimension of decision variable
+  int dim_var_ = 0;
+
+  //! Dimension of equality constraint
+  int dim_eq_ = 0;
+
+  //! Dimension of inequality constraint
+  int dim_ineq_ = 0;
+
+  //! Cost function \f$f\f$
+  ValueFunc cost_func_;
+
+  //! Gradient of cost function
+  VectorFunc cost_grad_func_;
+
+  //! Equality constraint function \f$\boldsymbol{g}\f$ (not required if dim_eq_ is zero)
+  VectorFunc eq_func_;
+
+  //! Jacobian of equality constraint function (not required if dim_eq_ is zero)
+  MatrixFunc eq_jac_func_;
+
+  //! Inequality constraint function \f$\boldsymbol{h}\f$ (not required if dim_ineq_ is zero)
+  VectorFunc ineq_func_;
+
+  //! Jacobian of inequality constraint function (not required if dim_ineq_ is zero)
+  MatrixFunc ineq_jac_func_;
+
+  //! Hessian of Lagrangian (approximated by damped BFGS if empty)
+  HessianFunc hess_func_;
+
+  //! Lower bound (unbounded if empty)
+  Eigen::VectorXd x_min_;
+
+  //! Upper bound (unbounded if empty)
+  Eigen::VectorXd x_max_;
+
+  //! Whether the constraints are linear (the Jacobians are computed only once)
+  bool linear_constraint_ = false;
+};
+
+/** \brief Sequential quadratic programming solver for nonlinear programs.
+
+    In each iteration, the QP subproblem of the step \f$\boldsymbol{d}\f$
+    \f{align*}{
+    & min_{\boldsymbol{d}} \ \frac{1}{2}{\boldsymbol{d}^T \boldsymbol{B} \boldsymbol{d}} + {\nabla f^T \boldsymbol{d}}
+   \\
+    & s.t. \ \ \nabla \boldsymbol{g} \boldsymbol{d} = - \boldsymbol{g} \nonumber \\
+    & \phantom{s.t.} \ \ \nabla \boldsymbol{h} \boldsymbol{d} \leq - \boldsymbol{h} \nonumber \\
+    & \phantom{s.t.} \ \ \boldsymbol{x}_{min} - \boldsymbol{x} \leq \boldsymbol{d} \leq \boldsymbol{x}_{max} -
+   \boldsymbol{x} \nonumber
+    \f}
+    is solved by the backend QP solver, and the step size is determined by backtracking line search on the l1 merit
+   function \f$f + \mu (\|\boldsymbol{g}\|_1 + \|\max(\boldsymbol{h}, \boldsymbol{0})\|_1)\f$.
+
+    The QP coefficient is allocated once and its blocks are overwritten in place by the callbacks of SqpProblem. Since
+   the dimensions and sparsity of the QP subproblem do not change between iterations, the backend is kept warm: the
+   modified blocks are notified to the QP solver (the Jacobians are marked as modified only when re-evaluated), and
+   each QP subproblem is warm-started from the step and Lagrange multipliers of the previous iteration. The forced
+   initialization of OSQP and qpOASES is disabled only if the QP solver instance is allocated by the constructor with
+   the QP solver type.
+ */
+class SqpSolver
+{
+public:
+  /** \brief Constructor.
+      \param qp_solver_type QP solver type of QP subproblems
+   */
+  SqpSolver(const QpSolverType & qp_solver_type);
+
+  /** \brief Constructor.
+      \param qp_solver QP solver instance of QP subproblems (its settings are not changed)
+   */
+  SqpSolver(const std::shared_ptr<QpSolver> & qp_solver);
+
+  /** \brief Solve nonlinear program.
+      \param problem nonlinear program
+      \param x_init initial guess (projected to the bounds)
+      \returns solution
+   */
+  Eigen::VectorXd solve(const SqpProblem & problem, const Eigen::VectorXd & x_init);
+
+  /** \brief Get whether it failed to solve the problem. */
+  inline bool solveFailed() const
+  {
+    return solve_failed_;
+  }
+
+  /** \brief Get status of solve.
+
+      QpSolveStatus::MaxIterReached is returned if it does not converge, QpSolveStatus::NumericalError is returned if
+     the line search fails, and the status of the QP solver is returned if the QP subproblem fails.
+   */
+  inline QpSolveStatus status() const
+  {
+    return status_;
+  }
+
+  /** \brief Get number of SQP iterations of the last solve. */
+  inline int iterNum() const
+  {
+    return iter_num_;
+  }
+
+  /** \brief Get cost of the solution. */
+  inline double cost() const
+  {
+    return cost_;
+  }
+
+  /** \brief Get maximum constraint violation of the solution. */
+  inline double constraintViolation() const
+  {
+    return constraint_violation_;
+  }
+
+  /** \brief Get Lagrange multipliers of equality constraints (zero if not provided by the QP solver). */
+  inline const Eigen::VectorXd & dualEq() const
+  {
+    return dual_eq_;
+  }
+
+  /** \brief Get Lagrange multipliers of inequality constraints (zero if not provided by the QP solver). */
+  inline const Eigen::VectorXd & dualIneq() const
+  {
+    return dual_ineq_;
+  }
+
+  /** \brief Get QP solver instance of QP subproblems. */
+  inline const std::shared_ptr<QpSolver> & qpSolver() const
+  {
+    return qp_solver_;
+  }
+
+public:
+  //! Maximum number of SQP iterations
+  int max_iter_ = 100;
+
+  //! Tolerance of step and constraint violation for convergence
+  double tol_ = 1e-6;
+
+  //! Sufficient decrease coefficient of the merit function in line search
+  double armijo_coeff_ = 1e-4;
+
+  //! Scale of step size in each backtracking of line search
+  double backtrack_scale_ = 0.5;
+
+  //! Minimum step size of line search
+  double min_step_size_ = 1e-8;
+
+  //! Value regarded as infinity for empty bounds
+  double bound_inf_ = 1e10;
+
+  //! Whether to print the progress of each iteration
+  bool verbose_ = false;
+
+protected:
+  /** \brief Evaluate cost and constraints at x. */
+  void evalValue(const SqpProblem & problem, const Eigen::VectorXd & x);
+
+  /** \brief Evaluate gradient of cost and Jacobians of constraints at x into the QP coefficient. */
+  void evalDerivative(const SqpProblem & problem, const Eigen::VectorXd & x, bool first);
+
+  /** \brief Compute l1 norm of constraint violation with the evaluated values. */
+  double computeViolation() const;
+
+  /** \brief Compute gradient of Lagrangian into lagrangian_grad with the evaluated derivatives. */
+  void computeLagrangianGrad(Eigen::VectorXd & lagrangian_grad) const;
+
+protected:
+  //! QP solver instance of QP subproblems
+  std::shared_ptr<QpSolver> qp_solver_;
+
+  //! QP coefficient of QP subproblem (reused between iterations)
+  QpCoeff qp_coeff_;
+
+  //! Hessian of Lagrangian or its approximation
+  Eigen::MatrixXd hess_;
+
+  //! Gradient of cost
+  Eigen::VectorXd cost_grad_;
+
+  //! Values of equality constraints
+  Eigen::VectorXd eq_val_;
+
+  //! Values of inequality constraints
+  Eigen::VectorXd ineq_val_;
+
+  //! Whether it failed to solve the problem
+  bool solve_failed_ = false;
+
+  //! Status of solve
+  QpSolveStatus status_ = QpSolveStatus::Unsolved;
+
+  //! Number of SQP iterations
+  int iter_num_ = 0;
+
+  //! Cost
+  double cost_ = 0;
+
+  //! Maximum constraint violation
+  double constraint_violation_ = 0;
+
+  //! Lagrange multipliers of equality constraints
+  Eigen::VectorXd dual_eq_;
+
+  //! Lagrange multipliers of inequality constraints
+  Eigen::VectorXd dual_ineq_;
+
+  //! Warm start of QP subproblem (step and Lagrange multipliers of the previous iteration)
+  WarmStart qp_warm_start_;
+};
+} // namespace QpSolverCollection
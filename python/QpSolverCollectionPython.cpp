@@ -0,0 +1,328 @@
+/* Author: Masaki Murooka */
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+#include <pybind11/eigen.h>
+#include <pybind11/pybind11.h>
+#include <pybind11/stl.h>
+
+#include <qp_solver_collection/QpSolverCollection.h>
+#include <qp_solver_collection/QpSolverMetrics.h>
+#include <qp_solver_collection/QpSolverTrace.h>
+
+namespace py = pybind11;
+using namespace QpSolverCollection;
+
+namespace
+{
+/** \brief Define property of the matrix or vector member of QpCoeff.
+
+    The getter returns a NumPy view of the member without copying, so that the coefficients can be filled in place
+   from Python (e.g., qp_coeff.obj_mat[:] = Q). The setter notifies the modification of the block, while the
+   modifications in place must be notified by set_modified.
+ */
+template<class MatrixType>
+void defMatrixProperty(py::class_<QpCoeff> & cls,
+                       const char * name,
+                       MatrixType QpCoeff::*member,
+                       QpCoeff::Block block)
+{
+  cls.def_property(
+      name, [member](QpCoeff & self) -> MatrixType & { return self.*member; },
+      [member, block](QpCoeff & self, const MatrixType & value) {
+        self.*member = value;
+        self.setModified(block);
+      });
+}
+
+/** \brief Solve QPs in parallel.
+    \param qp_solver_type QP solver type
+    \param qp_coeff_list list of QP coefficients
+    \param settings QP solver settings
+    \param thread_num number of threads (hardware concurrency if non-positive)
+    \returns tuple of the list of solutions and the list of failure flags
+
+    A QP solver instance is allocated for each thread since QP solver instances are not thread-safe. The GIL is
+   released while solving, so that Python threads can run concurrently.
+ */
+py::tuple solveBatch(const QpSolverType & qp_solver_type,
+                     const std::vector<QpCoeff *> & qp_coeff_list,
+                     const QpSolverSettings & settings,
+                     int thread_num)
+{
+  for(const auto & qp_coeff : qp_coeff_list)
+  {
+    if(qp_coeff == nullptr)
+    {
+      throw std::invalid_argument("[solveBatch] QpCoeff must not be None.");
+    }
+  }
+
+  std::vector<Eigen::VectorXd> x_list(qp_coeff_list.size());
+  std::vector<bool> failed_list(qp_coeff_list.size(), true);
+
+  {
+    py::gil_scoped_release release;
+
+    if(thread_num <= 0)
+    {
+      thread_num = std::max(static_cast<int>(std::thread::hardware_concurrency()), 1);
+    }
+    thread_num = std::min(thread_num, std::max(static_cast<int>(qp_coeff_list.size()), 1));
+
+    std::atomic<size_t> next_idx(0);
+    std::vector<std::exception_ptr> exception_list(thread_num);
+    // std::vector<bool> is not safe for concurrent writes of different elements
+    std::vector<char> failed_flag_list(qp_coeff_list.size(), 1);
+    auto worker = [&](int thread_idx) {
+      try
+      {
+        auto qp_solver = allocateQpSolver(qp_solver_type);
+        if(!qp_solver)
+        {
+          return;
+        }
+        qp_solver->setSettings(settings);
+        for(size_t i = next_idx++; i < qp_coeff_list.size(); i = next_idx++)
+        {
+          x_list[i] = qp_solver->solve(*qp_coeff_list[i]);
+          failed_flag_list[i] = qp_solver->solveFailed();
+        }
+      }
+      catch(...)
+      {
+        exception_list[thread_idx] = std::current_exception();
+      }
+    };
+
+    std::vector<std::thread> thread_list;
+    for(int thread_idx = 1; thread_idx < thread_num; thread_idx++)
+    {
+      thread_list.emplace_back(worker, thread_idx);
+    }
+    worker(0);
+    for(auto & thread : thread_list)
+    {
+      thread.join();
+    }
+
+    for(const auto & exception : exception_list)
+    {
+      if(exception)
+      {
+        std::rethrow_exception(exception);
+      }
+    }
+    std::copy(failed_flag_list.begin(), failed_flag_list.end(), failed_list.begin());
+  }
+
+  return py::make_tuple(x_list, failed_list);
+}
+} // namespace
+
+PYBIND11_MODULE(qp_solver_collection, m)
+{
+  m.doc() = "Python bindings of QpSolverCollection";
+
+  py::enum_<QpSolverType>(m, "QpSolverType")
+      .value("Any", QpSolverType::Any)
+      .value("Uninitialized", QpSolverType::Uninitialized)
+      .value("QLD", QpSolverType::QLD)
+      .value("QuadProg", QpSolverType::QuadProg)
+      .value("LSSOL", QpSolverType::LSSOL)
+      .value("JRLQP", QpSolverType::JRLQP)
+      .value("qpOASES", QpSolverType::qpOASES)
+      .value("OSQP", QpSolverType::OSQP)
+      .value("NASOQ", QpSolverType::NASOQ)
+      .value("HPIPM", QpSolverType::HPIPM)
+      .value("PROXQP", QpSolverType::PROXQP)
+      .value("QPMAD", QpSolverType::QPMAD)
+      .value("Builtin", QpSolverType::Builtin);
+
+  py::enum_<QpAccuracyProfile>(m, "QpAccuracyProfile")
+      .value("Fast", QpAccuracyProfile::Fast)
+      .value("Balanced", QpAccuracyProfile::Balanced)
+      .value("Robust", QpAccuracyProfile::Robust);
+
+  py::enum_<QpSolveStatus>(m, "QpSolveStatus")
+      .value("Unsolved", QpSolveStatus::Unsolved)
+      .value("Solved", QpSolveStatus::Solved)
+      .value("MaxIterReached", QpSolveStatus::MaxIterReached)
+      .value("PrimalInfeasible", QpSolveStatus::PrimalInfeasible)
+      .value("DualInfeasible", QpSolveStatus::DualInfeasible)
+      .value("NumericalError", QpSolveStatus::NumericalError)
+      .value("InvalidInput", QpSolveStatus::InvalidInput)
+      .value("Unknown", QpSolveStatus::Unknown);
+
+  m.def("strToQpSolverType", &strToQpSolverType, py::arg("qp_solver_type"));
+  m.def("isQpSolverEnabled", &isQpSolverEnabled, py::arg("qp_solver_type"));
+  m.def("getAnyQpSolverType", &getAnyQpSolverType);
+  m.def("allocateQpSolver", &allocateQpSolver, py::arg("qp_solver_type"));
+
+  py::class_<QpElementIds>(m, "QpElementIds")
+      .def(py::init<>())
+      .def("empty", &QpElementIds::empty)
+      .def("isValid", &QpElementIds::isValid, py::arg("dim_var"), py::arg("dim_eq"), py::arg("dim_ineq"))
+      .def_readwrite("var_id_list", &QpElementIds::var_id_list_)
+      .def_readwrite("eq_id_list", &QpElementIds::eq_id_list_)
+      .def_readwrite("ineq_id_list", &QpElementIds::ineq_id_list_);
+
+  py::class_<QpCoeff> qp_coeff_cls(m, "QpCoeff");
+  qp_coeff_cls.def(py::init<>())
+      .def("setup", &QpCoeff::setup, py::arg("dim_var"), py::arg("dim_eq"), py::arg("dim_ineq"))
+      .def_readwrite("dim_var", &QpCoeff::dim_var_)
+      .def_readwrite("dim_eq", &QpCoeff::dim_eq_)
+      .def_readwrite("dim_ineq", &QpCoeff::dim_ineq_)
+      .def_readwrite("track_modification", &QpCoeff::track_modification_)
+      .def_readwrite("element_ids", &QpCoeff::element_ids_)
+      .def("set_modified", py::overload_cast<QpCoeff::Block>(&QpCoeff::setModified), py::arg("block"))
+      .def("set_modified", py::overload_cast<>(&QpCoeff::setModified));
+  py::enum_<QpCoeff::Block>(qp_coeff_cls, "Block")
+      .value("ObjMat", QpCoeff::Block::ObjMat)
+      .value("ObjVec", QpCoeff::Block::ObjVec)
+      .value("EqMat", QpCoeff::Block::EqMat)
+      .value("EqVec", QpCoeff::Block::EqVec)
+      .value("IneqMat", QpCoeff::Block::IneqMat)
+      .value("IneqVec", QpCoeff::Block::IneqVec)
+      .value("Bound", QpCoeff::Block::Bound);
+  defMatrixProperty(qp_coeff_cls, "obj_mat", &QpCoeff::obj_mat_, QpCoeff::Block::ObjMat);
+  defMatrixProperty(qp_coeff_cls, "obj_vec", &QpCoeff::obj_vec_, QpCoeff::Block::ObjVec);
+  defMatrixProperty(qp_coeff_cls, "eq_mat", &QpCoeff::eq_mat_, QpCoeff::Block::EqMat);
+  defMatrixProperty(qp_coeff_cls, "eq_vec", &QpCoeff::eq_vec_, QpCoeff::Block::EqVec);
+  defMatrixProperty(qp_coeff_cls, "ineq_mat", &QpCoeff::ineq_mat_, QpCoeff::Block::IneqMat);
+  defMatrixProperty(qp_coeff_cls, "ineq_vec", &QpCoeff::ineq_vec_, QpCoeff::Block::IneqVec);
+  defMatrixProperty(qp_coeff_cls, "x_min", &QpCoeff::x_min_, QpCoeff::Block::Bound);
+  defMatrixProperty(qp_coeff_cls, "x_max", &QpCoeff::x_max_, QpCoeff::Block::Bound);
+
+  py::class_<QpSolverSettings>(m, "QpSolverSettings")
+      .def(py::init<>())
+      .def_readwrite("profile", &QpSolverSettings::profile_)
+      .def_readwrite("abs_tol", &QpSolverSettings::abs_tol_)
+      .def_readwrite("rel_tol", &QpSolverSettings::rel_tol_)
+      .def_readwrite("max_iter", &QpSolverSettings::max_iter_)
+      .def_readwrite("verbose", &QpSolverSettings::verbose_)
+      .def_readwrite("presolve", &QpSolverSettings::presolve_)
+      .def_readwrite("reuse_obj_mat_factor", &QpSolverSettings::reuse_obj_mat_factor_)
+      .def_readwrite("obj_mat_fixed", &QpSolverSettings::obj_mat_fixed_)
+      .def_readwrite("warm_start_by_id", &QpSolverSettings::warm_start_by_id_)
+      .def_readwrite("params", &QpSolverSettings::params_);
+
+  py::class_<WarmStart>(m, "WarmStart")
+      .def(py::init<>())
+      .def(py::init<const Eigen::VectorXd &, const Eigen::VectorXd &, const Eigen::VectorXd &,
+                    const Eigen::VectorXd &>(),
+           py::arg("x"), py::arg("dual_eq") = Eigen::VectorXd(), py::arg("dual_ineq") = Eigen::VectorXd(),
+           py::arg("dual_bound") = Eigen::VectorXd())
+      .def_readwrite("x", &WarmStart::x_)
+      .def_readwrite("dual_eq", &WarmStart::dual_eq_)
+      .def_readwrite("dual_ineq", &WarmStart::dual_ineq_)
+      .def_readwrite("dual_bound", &WarmStart::dual_bound_);
+
+  py::class_<KktResidual>(m, "KktResidual")
+      .def("satisfied", &KktResidual::satisfied, py::arg("tol"), py::arg("check_dual") = true)
+      .def_readonly("primal_feas", &KktResidual::primal_feas_)
+      .def_readonly("dual_feas", &KktResidual::dual_feas_)
+      .def_readonly("complementarity", &KktResidual::complementarity_)
+      .def_readonly("duality_gap", &KktResidual::duality_gap_)
+      .def_readonly("obj", &KktResidual::obj_);
+
+  m.def(
+      "computeKkt",
+      [](const QpCoeff & qp_coeff, const QpSolver & qp_solver, const Eigen::VectorXd & x) {
+        SolveResult result;
+        result.x_ = x;
+        result.dual_eq_ = qp_solver.dualEq();
+        result.dual_ineq_ = qp_solver.dualIneq();
+        result.dual_bound_ = qp_solver.dualBound();
+        return computeKkt(qp_coeff, result);
+      },
+      py::arg("qp_coeff"), py::arg("qp_solver"), py::arg("x"),
+      "Compute KKT residual of the solution with the Lagrange multipliers of the last solve of qp_solver.");
+
+  // Matrices are passed to the QP solver without copying if they are Fortran-contiguous float64 arrays (e.g.,
+  // np.asfortranarray(Q)), and vectors if they are contiguous float64 arrays. Otherwise, they are copied once.
+  py::class_<QpSolver, std::shared_ptr<QpSolver>>(m, "QpSolver")
+      .def(
+          "solve",
+          [](QpSolver & self, int dim_var, int dim_eq, int dim_ineq, Eigen::Ref<Eigen::MatrixXd> Q,
+             const Eigen::Ref<const Eigen::VectorXd> & c, const Eigen::Ref<const Eigen::MatrixXd> & A,
+             const Eigen::Ref<const Eigen::VectorXd> & b, const Eigen::Ref<const Eigen::MatrixXd> & C,
+             const Eigen::Ref<const Eigen::VectorXd> & d, const Eigen::Ref<const Eigen::VectorXd> & x_min,
+             const Eigen::Ref<const Eigen::VectorXd> & x_max) {
+            py::gil_scoped_release release;
+            return self.solve(dim_var, dim_eq, dim_ineq, Q, c, A, b, C, d, x_min, x_max);
+          },
+          py::arg("dim_var"), py::arg("dim_eq"), py::arg("dim_ineq"), py::arg("Q"), py::arg("c"), py::arg("A"),
+          py::arg("b"), py::arg("C"), py::arg("d"), py::arg("x_min"), py::arg("x_max"),
+          "Solve QP. Q may be overwritten by some QP solvers (e.g., QPMAD).")
+      .def(
+          "solve",
+          // Fallback for Q that cannot be referenced as a writable Fortran-contiguous float64 array
+          [](QpSolver & self, int dim_var, int dim_eq, int dim_ineq, Eigen::MatrixXd Q,
+             const Eigen::Ref<const Eigen::VectorXd> & c, const Eigen::Ref<const Eigen::MatrixXd> & A,
+             const Eigen::Ref<const Eigen::VectorXd> & b, const Eigen::Ref<const Eigen::MatrixXd> & C,
+             const Eigen::Ref<const Eigen::VectorXd> & d, const Eigen::Ref<const Eigen::VectorXd> & x_min,
+             const Eigen::Ref<const Eigen::VectorXd> & x_max) {
+            py::gil_scoped_release release;
+            return self.solve(dim_var, dim_eq, dim_ineq, Q, c, A, b, C, d, x_min, x_max);
+          },
+          py::arg("dim_var"), py::arg("dim_eq"), py::arg("dim_ineq"), py::arg("Q"), py::arg("c"), py::arg("A"),
+          py::arg("b"), py::arg("C"), py::arg("d"), py::arg("x_min"), py::arg("x_max"))
+      .def(
+          "solve",
+          [](QpSolver & self, QpCoeff & qp_coeff) {
+            py::gil_scoped_release release;
+            return self.solve(qp_coeff);
+          },
+          py::arg("qp_coeff"))
+      .def(
+          "solve",
+          [](QpSolver & self, QpCoeff & qp_coeff, const WarmStart & warm_start) {
+            py::gil_scoped_release release;
+            return self.solve(qp_coeff, warm_start);
+          },
+          py::arg("qp_coeff"), py::arg("warm_start"),
+          "Solve QP starting from the initial guess (used by HPIPM, OSQP, and PROXQP).")
+      .def("setSettings", &QpSolver::setSettings, py::arg("settings"))
+      .def("settings", &QpSolver::settings, py::return_value_policy::copy)
+      .def("loadSettings", &QpSolver::loadSettings, py::arg("path"))
+      .def("type", &QpSolver::type)
+      .def("solveFailed", &QpSolver::solveFailed)
+      .def("status", &QpSolver::status)
+      .def("iterNum", &QpSolver::iterNum)
+      .def("dualEq", &QpSolver::dualEq, py::return_value_policy::copy)
+      .def("dualIneq", &QpSolver::dualIneq, py::return_value_policy::copy)
+      .def("dualBound", &QpSolver::dualBound, py::return_value_policy::copy);
+
+  m.def("solveBatch", &solveBatch, py::arg("qp_solver_type"), py::arg("qp_coeff_list"),
+        py::arg("settings") = QpSolverSettings(), py::arg("thread_num") = 0,
+        "Solve QPs in parallel with the GIL released. Returns the tuple of the list of solutions and the list of "
+        "failure flags. Each QpCoeff must not appear more than once in the list.");
+
+  m.def(
+      "setMetricsEnabled", [](bool enabled) { QpMetricsRegistry::instance().setEnabled(enabled); },
+      py::arg("enabled"), "Set whether QP solvers record metrics to the process-wide registry.");
+  m.def("resetMetrics", []() { QpMetricsRegistry::instance().reset(); });
+  m.def(
+      "metricsPrometheus",
+      []() {
+        std::ostringstream oss;
+        QpMetricsRegistry::instance().writePrometheus(oss);
+        return oss.str();
+      },
+      "Get metrics in the Prometheus text format.");
+  m.def(
+      "writeMetricsPrometheus",
+      [](const std::string & path) { return QpMetricsRegistry::instance().writePrometheus(path); }, py::arg("path"),
+      "Write metrics in the Prometheus text format to the file.");
+
+  m.def("clearTrace", []() { QpTracer::instance().clear(); });
+  m.def(
+      "writeChromeTrace", [](const std::string & path) { return QpTracer::instance().writeChromeTrace(path); },
+      py::arg("path"), "Write trace events of solve phases in the Chrome trace JSON (requires ENABLE_TRACING).");
+}
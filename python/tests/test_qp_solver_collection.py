@@ -0,0 +1,84 @@
+# Author: Masaki Murooka
+
+import unittest
+
+import numpy as np
+
+import qp_solver_collection as qsc
+
+QP_SOLVER_TYPE_LIST = [
+    qsc.QpSolverType.QLD,
+    qsc.QpSolverType.QuadProg,
+    qsc.QpSolverType.LSSOL,
+    qsc.QpSolverType.JRLQP,
+    qsc.QpSolverType.qpOASES,
+    qsc.QpSolverType.OSQP,
+    qsc.QpSolverType.NASOQ,
+    qsc.QpSolverType.HPIPM,
+    qsc.QpSolverType.PROXQP,
+    qsc.QpSolverType.QPMAD,
+    qsc.QpSolverType.Builtin,
+]
+
+
+def make_qp_coeff(offset=0.0):
+    # Same as TestSampleQP.TestSampleQP1 except for the offset of the objective vector
+    qp_coeff = qsc.QpCoeff()
+    qp_coeff.setup(2, 1, 0)
+    qp_coeff.obj_mat[:] = [[2.0, 0.5], [0.5, 1.0]]
+    qp_coeff.obj_vec[:] = [1.0 + offset, 1.0]
+    qp_coeff.eq_mat[:] = [[1.0, 1.0]]
+    qp_coeff.eq_vec[:] = [1.0]
+    qp_coeff.x_min[:] = 0.0
+    qp_coeff.x_max[:] = 1000.0
+    return qp_coeff
+
+
+class TestQpSolverCollection(unittest.TestCase):
+    def enabled_qp_solver_types(self):
+        return [t for t in QP_SOLVER_TYPE_LIST if qsc.isQpSolverEnabled(t)]
+
+    def test_qp_coeff_view(self):
+        qp_coeff = make_qp_coeff()
+        obj_mat = qp_coeff.obj_mat
+        obj_mat[0, 0] = 3.0
+        # The property is a view of the C++ member
+        self.assertEqual(qp_coeff.obj_mat[0, 0], 3.0)
+
+    def test_solve(self):
+        x_gt = np.array([0.0, 1.0])
+        for qp_solver_type in self.enabled_qp_solver_types():
+            qp_solver = qsc.allocateQpSolver(qp_solver_type)
+
+            x = qp_solver.solve(make_qp_coeff())
+            self.assertFalse(qp_solver.solveFailed())
+            np.testing.assert_allclose(x, x_gt, atol=1e-3)
+
+            # Fortran-contiguous arrays are passed without copying
+            Q = np.asfortranarray([[2.0, 0.5], [0.5, 1.0]])
+            A = np.asfortranarray([[1.0, 1.0]])
+            C = np.zeros((0, 2), order="F")
+            x = qp_solver.solve(2, 1, 0, Q, np.ones(2), A, np.ones(1), C, np.zeros(0), np.zeros(2),
+                                np.full(2, 1000.0))
+            self.assertFalse(qp_solver.solveFailed())
+            np.testing.assert_allclose(x, x_gt, atol=1e-3)
+
+            # C-contiguous arrays are copied
+            x = qp_solver.solve(2, 1, 0, np.array([[2.0, 0.5], [0.5, 1.0]]), np.ones(2), np.array([[1.0, 1.0]]),
+                                np.ones(1), np.zeros((0, 2)), np.zeros(0), np.zeros(2), np.full(2, 1000.0))
+            self.assertFalse(qp_solver.solveFailed())
+            np.testing.assert_allclose(x, x_gt, atol=1e-3)
+
+    def test_solve_batch(self):
+        qp_coeff_list = [make_qp_coeff(0.1 * i) for i in range(20)]
+        for qp_solver_type in self.enabled_qp_solver_types():
+            x_list, failed_list = qsc.solveBatch(qp_solver_type, qp_coeff_list, thread_num=4)
+            self.assertEqual(len(x_list), len(qp_coeff_list))
+            self.assertFalse(any(failed_list))
+            for qp_coeff, x in zip(qp_coeff_list, x_list):
+                x_single = qsc.allocateQpSolver(qp_solver_type).solve(make_qp_coeff(qp_coeff.obj_vec[0] - 1.0))
+                np.testing.assert_allclose(x, x_single, atol=1e-6)
+
+
+if __name__ == "__main__":
+    unittest.main()
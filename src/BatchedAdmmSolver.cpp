@@ -0,0 +1,383 @@
+/* Author: Masaki Murooka */
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+#include <qp_solver_collection/BatchedAdmmSolver.h>
+
+using namespace QpSolverCollection;
+
+void BatchedAdmmSolver::setup(int batch_size, int dim_var, int dim_eq, int dim_ineq, int block_size)
+{
+  if(block_size <= 0)
+  {
+    throw std::invalid_argument("[BatchedAdmmSolver::setup] Block size must be positive: "
+                                + std::to_string(block_size));
+  }
+
+  batch_size_ = batch_size;
+  block_size_ = block_size;
+  dim_var_ = dim_var;
+  dim_eq_ = dim_eq;
+  dim_ineq_ = dim_ineq;
+  int dim_cstr = dim_eq + dim_ineq;
+
+  block_list_.resize((batch_size + block_size - 1) / block_size);
+  for(size_t block_idx = 0; block_idx < block_list_.size(); block_idx++)
+  {
+    LaneBlock & block = block_list_[block_idx];
+    block.offset = static_cast<int>(block_idx) * block_size;
+    int lane_num = std::min(block_size, batch_size - block.offset);
+
+    block.obj_mat.setZero(dim_var * dim_var, lane_num);
+    block.obj_vec.setZero(dim_var, lane_num);
+    block.cstr_mat.setZero(dim_cstr * dim_var, lane_num);
+    block.cstr_min.setZero(dim_cstr, lane_num);
+    block.cstr_min.bottomRows(dim_ineq).setConstant(std::numeric_limits<double>::lowest());
+    block.cstr_max.setZero(dim_cstr, lane_num);
+    block.x_min.setConstant(dim_var, lane_num, std::numeric_limits<double>::lowest());
+    block.x_max.setConstant(dim_var, lane_num, std::numeric_limits<double>::max());
+
+    block.kkt_factor.resize(dim_var * dim_var, lane_num);
+    block.kkt_diag_inv.resize(dim_var, lane_num);
+    block.cstr_rho.resize(dim_cstr, lane_num);
+    block.bound_rho.resize(lane_num);
+    block.x.resize(dim_var, lane_num);
+    block.cstr_z.resize(dim_cstr, lane_num);
+    block.cstr_y.resize(dim_cstr, lane_num);
+    block.bound_z.resize(dim_var, lane_num);
+    block.bound_y.resize(dim_var, lane_num);
+    block.x_tilde.resize(dim_var, lane_num);
+    block.cstr_z_tilde.resize(dim_cstr, lane_num);
+    block.cstr_tmp.resize(dim_cstr, lane_num);
+    block.var_tmp.resize(dim_var, lane_num);
+    block.active_mask.resize(lane_num);
+  }
+
+  iter_num_.assign(batch_size, 0);
+  status_.assign(batch_size, QpSolveStatus::Unsolved);
+}
+
+void BatchedAdmmSolver::setQpCoeff(int idx, const QpCoeff & qp_coeff)
+{
+  if(idx < 0 || idx >= batch_size_)
+  {
+    throw std::out_of_range("[BatchedAdmmSolver::setQpCoeff] Index " + std::to_string(idx) + " is out of the batch of "
+                            + std::to_string(batch_size_) + ".");
+  }
+  if(qp_coeff.dim_var_ != dim_var_ || qp_coeff.dim_eq_ != dim_eq_ || qp_coeff.dim_ineq_ != dim_ineq_)
+  {
+    throw std::invalid_argument("[BatchedAdmmSolver::setQpCoeff] Dimensions of QP coefficient are inconsistent.");
+  }
+
+  LaneBlock & block = block_list_[idx / block_size_];
+  int lane = idx % block_size_;
+  for(int i = 0; i < dim_var_; i++)
+  {
+    for(int j = 0; j < dim_var_; j++)
+    {
+      block.obj_mat(i * dim_var_ + j, lane) = qp_coeff.obj_mat_(i, j);
+    }
+    for(int k = 0; k < dim_eq_; k++)
+    {
+      block.cstr_mat(k * dim_var_ + i, lane) = qp_coeff.eq_mat_(k, i);
+    }
+    for(int k = 0; k < dim_ineq_; k++)
+    {
+      block.cstr_mat((dim_eq_ + k) * dim_var_ + i, lane) = qp_coeff.ineq_mat_(k, i);
+    }
+  }
+  block.obj_vec.col(lane) = qp_coeff.obj_vec_;
+  block.cstr_min.col(lane).head(dim_eq_) = qp_coeff.eq_vec_;
+  block.cstr_max.col(lane).head(dim_eq_) = qp_coeff.eq_vec_;
+  block.cstr_max.col(lane).tail(dim_ineq_) = qp_coeff.ineq_vec_;
+  block.x_min.col(lane) = qp_coeff.x_min_;
+  block.x_max.col(lane) = qp_coeff.x_max_;
+}
+
+void BatchedAdmmSolver::solve()
+{
+  std::fill(iter_num_.begin(), iter_num_.end(), max_iter_);
+  std::fill(status_.begin(), status_.end(), QpSolveStatus::MaxIterReached);
+  for(auto & block : block_list_)
+  {
+    solveBlock(block);
+  }
+}
+
+SolveResult BatchedAdmmSolver::result(int idx) const
+{
+  SolveResult result;
+  result.status_ = status_[idx];
+  if(status_[idx] != QpSolveStatus::Solved && status_[idx] != QpSolveStatus::MaxIterReached)
+  {
+    result.x_.setZero(dim_var_);
+    return result;
+  }
+  const LaneBlock & block = block_list_[idx / block_size_];
+  int lane = idx % block_size_;
+  result.x_ = block.x.col(lane);
+  result.dual_eq_ = block.cstr_y.col(lane).head(dim_eq_);
+  result.dual_ineq_ = block.cstr_y.col(lane).tail(dim_ineq_);
+  result.dual_bound_ = block.bound_y.col(lane);
+  return result;
+}
+
+int BatchedAdmmSolver::solvedNum() const
+{
+  return static_cast<int>(std::count(status_.begin(), status_.end(), QpSolveStatus::Solved));
+}
+
+void BatchedAdmmSolver::solveBlock(LaneBlock & block)
+{
+  int dim_cstr = dim_eq_ + dim_ineq_;
+  block.bound_rho.setConstant(rho_);
+  updateCstrRho(block);
+  block.x.setZero();
+  block.cstr_z.setZero();
+  block.cstr_y.setZero();
+  block.bound_z.setZero();
+  block.bound_y.setZero();
+
+  // Lanes whose mask is zero are frozen
+  Eigen::Array<bool, 1, Eigen::Dynamic> pd_mask = factorize(block);
+  for(int lane = 0; lane < pd_mask.size(); lane++)
+  {
+    block.active_mask[lane] = (pd_mask[lane] ? 1.0 : 0.0);
+    if(!pd_mask[lane])
+    {
+      iter_num_[block.offset + lane] = 0;
+      status_[block.offset + lane] = QpSolveStatus::DualInfeasible;
+    }
+  }
+
+  for(int iter = 0; iter < max_iter_ && (block.active_mask > 0.0).any(); iter++)
+  {
+    // Solve KKT system: (P + sigma I + G^T R G + rho I) x~ = sigma x - q + G^T (R z - y) + rho z_b - y_b
+    block.cstr_tmp = block.cstr_rho * block.cstr_z - block.cstr_y;
+    multiplyTranspose(block.cstr_mat, dim_cstr, dim_var_, block.cstr_tmp, block.x_tilde);
+    block.var_tmp = block.bound_z;
+    block.var_tmp.rowwise() *= block.bound_rho;
+    block.x_tilde += sigma_ * block.x - block.obj_vec + block.var_tmp - block.bound_y;
+    solveKkt(block, block.x_tilde);
+    multiply(block.cstr_mat, dim_cstr, dim_var_, block.x_tilde, block.cstr_z_tilde);
+
+    // Update decision variable with relaxation
+    block.var_tmp = alpha_ * (block.x_tilde - block.x);
+    block.var_tmp.rowwise() *= block.active_mask;
+    block.x += block.var_tmp;
+
+    // Update auxiliary and dual variables of constraints
+    block.cstr_z_tilde = alpha_ * block.cstr_z_tilde + (1.0 - alpha_) * block.cstr_z;
+    block.cstr_tmp = (block.cstr_z_tilde + block.cstr_y / block.cstr_rho).max(block.cstr_min).min(block.cstr_max);
+    block.cstr_z_tilde = block.cstr_rho * (block.cstr_z_tilde - block.cstr_tmp);
+    block.cstr_z_tilde.rowwise() *= block.active_mask;
+    block.cstr_y += block.cstr_z_tilde;
+    block.cstr_tmp -= block.cstr_z;
+    block.cstr_tmp.rowwise() *= block.active_mask;
+    block.cstr_z += block.cstr_tmp;
+
+    // Update auxiliary and dual variables of bounds
+    block.x_tilde = alpha_ * block.x_tilde + (1.0 - alpha_) * block.bound_z;
+    block.var_tmp = block.bound_y;
+    block.var_tmp.rowwise() /= block.bound_rho;
+    block.var_tmp = (block.x_tilde + block.var_tmp).max(block.x_min).min(block.x_max);
+    block.x_tilde -= block.var_tmp;
+    block.x_tilde.rowwise() *= block.bound_rho * block.active_mask;
+    block.bound_y += block.x_tilde;
+    block.var_tmp -= block.bound_z;
+    block.var_tmp.rowwise() *= block.active_mask;
+    block.bound_z += block.var_tmp;
+
+    if((iter + 1) % check_interval_ == 0 || iter + 1 == max_iter_)
+    {
+      if(checkConvergence(block, iter + 1))
+      {
+        updateCstrRho(block);
+        factorize(block);
+      }
+    }
+  }
+}
+
+Eigen::Array<bool, 1, Eigen::Dynamic> BatchedAdmmSolver::factorize(LaneBlock & block) const
+{
+  int dim_cstr = dim_eq_ + dim_ineq_;
+  BatchArray & factor = block.kkt_factor;
+  Eigen::Array<bool, 1, Eigen::Dynamic> pd_mask =
+      Eigen::Array<bool, 1, Eigen::Dynamic>::Constant(block.active_mask.size(), true);
+
+  // Lower triangle of KKT matrix
+  for(int i = 0; i < dim_var_; i++)
+  {
+    for(int j = 0; j <= i; j++)
+    {
+      auto kkt_ij = factor.row(i * dim_var_ + j);
+      kkt_ij = block.obj_mat.row(i * dim_var_ + j);
+      if(i == j)
+      {
+        kkt_ij += sigma_ + block.bound_rho;
+      }
+      for(int k = 0; k < dim_cstr; k++)
+      {
+        kkt_ij += block.cstr_rho.row(k) * block.cstr_mat.row(k * dim_var_ + i) * block.cstr_mat.row(k * dim_var_ + j);
+      }
+    }
+  }
+
+  // Cholesky decomposition (each row operation processes all the QPs)
+  for(int j = 0; j < dim_var_; j++)
+  {
+    auto diag = factor.row(j * dim_var_ + j);
+    for(int k = 0; k < j; k++)
+    {
+      diag -= factor.row(j * dim_var_ + k).square();
+    }
+    pd_mask = pd_mask && (diag > 0.0);
+    // Lanes that are not positive definite are replaced by identity so that the iterates remain finite
+    diag = (diag > 0.0).select(diag.sqrt(), 1.0);
+    block.kkt_diag_inv.row(j) = diag.inverse();
+    for(int i = j + 1; i < dim_var_; i++)
+    {
+      auto factor_ij = factor.row(i * dim_var_ + j);
+      for(int k = 0; k < j; k++)
+      {
+        factor_ij -= factor.row(i * dim_var_ + k) * factor.row(j * dim_var_ + k);
+      }
+      factor_ij *= block.kkt_diag_inv.row(j);
+    }
+  }
+
+  return pd_mask;
+}
+
+void BatchedAdmmSolver::solveKkt(const LaneBlock & block, BatchArray & vec) const
+{
+  const BatchArray & factor = block.kkt_factor;
+  // Forward substitution with L
+  for(int i = 0; i < dim_var_; i++)
+  {
+    for(int k = 0; k < i; k++)
+    {
+      vec.row(i) -= factor.row(i * dim_var_ + k) * vec.row(k);
+    }
+    vec.row(i) *= block.kkt_diag_inv.row(i);
+  }
+  // Backward substitution with L^T
+  for(int i = dim_var_ - 1; i >= 0; i--)
+  {
+    for(int k = i + 1; k < dim_var_; k++)
+    {
+      vec.row(i) -= factor.row(k * dim_var_ + i) * vec.row(k);
+    }
+    vec.row(i) *= block.kkt_diag_inv.row(i);
+  }
+}
+
+bool BatchedAdmmSolver::checkConvergence(LaneBlock & block, int iter_num)
+{
+  int dim_cstr = dim_eq_ + dim_ineq_;
+  int lane_num = static_cast<int>(block.active_mask.size());
+  auto colwiseMaxAbs = [lane_num](const BatchArray & arr) -> LaneArray {
+    if(arr.rows() == 0)
+    {
+      return LaneArray::Zero(lane_num);
+    }
+    return arr.abs().colwise().maxCoeff();
+  };
+
+  // Primal residual: G x - z and x - z_b
+  multiply(block.cstr_mat, dim_cstr, dim_var_, block.x, block.cstr_tmp);
+  LaneArray prim_res = colwiseMaxAbs(block.cstr_tmp - block.cstr_z).max(colwiseMaxAbs(block.x - block.bound_z));
+  LaneArray prim_scale = colwiseMaxAbs(block.cstr_tmp)
+                             .max(colwiseMaxAbs(block.cstr_z))
+                             .max(colwiseMaxAbs(block.x))
+                             .max(colwiseMaxAbs(block.bound_z));
+
+  // Dual residual: P x + q + G^T y + y_b
+  multiply(block.obj_mat, dim_var_, dim_var_, block.x, block.var_tmp);
+  multiplyTranspose(block.cstr_mat, dim_cstr, dim_var_, block.cstr_y, block.x_tilde);
+  LaneArray dual_res = colwiseMaxAbs(block.var_tmp + block.obj_vec + block.x_tilde + block.bound_y);
+  LaneArray dual_scale = colwiseMaxAbs(block.var_tmp)
+                             .max(colwiseMaxAbs(block.obj_vec))
+                             .max(colwiseMaxAbs(block.x_tilde))
+                             .max(colwiseMaxAbs(block.bound_y));
+
+  bool rho_updated = false;
+  for(int lane = 0; lane < lane_num; lane++)
+  {
+    if(block.active_mask[lane] == 0.0)
+    {
+      continue;
+    }
+    int idx = block.offset + lane;
+    if(!std::isfinite(prim_res[lane]) || !std::isfinite(dual_res[lane]))
+    {
+      block.active_mask[lane] = 0.0;
+      iter_num_[idx] = iter_num;
+      status_[idx] = QpSolveStatus::NumericalError;
+    }
+    else if(prim_res[lane] <= eps_abs_ + eps_rel_ * prim_scale[lane]
+            && dual_res[lane] <= eps_abs_ + eps_rel_ * dual_scale[lane])
+    {
+      block.active_mask[lane] = 0.0;
+      iter_num_[idx] = iter_num;
+      status_[idx] = QpSolveStatus::Solved;
+    }
+    else if(adaptive_rho_)
+    {
+      // Balance the normalized primal and dual residuals in the same way as OSQP
+      double rho_ratio = std::sqrt((prim_res[lane] / (prim_scale[lane] + 1e-10))
+                                   / (dual_res[lane] / (dual_scale[lane] + 1e-10) + 1e-10));
+      double rho_new = std::clamp(block.bound_rho[lane] * rho_ratio, 1e-6, 1e6);
+      if(rho_new > 5.0 * block.bound_rho[lane] || rho_new < 0.2 * block.bound_rho[lane])
+      {
+        block.bound_rho[lane] = rho_new;
+        rho_updated = true;
+      }
+    }
+  }
+
+  return rho_updated;
+}
+
+void BatchedAdmmSolver::updateCstrRho(LaneBlock & block) const
+{
+  // Equality constraints are made stiffer in the same way as OSQP
+  block.cstr_rho.topRows(dim_eq_).rowwise() = 1e3 * block.bound_rho;
+  block.cstr_rho.bottomRows(dim_ineq_).rowwise() = block.bound_rho;
+}
+
+void BatchedAdmmSolver::multiply(const BatchArray & mat,
+                                 int dim_row,
+                                 int dim_col,
+                                 const BatchArray & vec,
+                                 BatchArray & out) const
+{
+  out.setZero();
+  for(int i = 0; i < dim_row; i++)
+  {
+    for(int j = 0; j < dim_col; j++)
+    {
+      out.row(i) += mat.row(i * dim_col + j) * vec.row(j);
+    }
+  }
+}
+
+void BatchedAdmmSolver::multiplyTranspose(const BatchArray & mat,
+                                          int dim_row,
+                                          int dim_col,
+                                          const BatchArray & vec,
+                                          BatchArray & out) const
+{
+  out.setZero();
+  for(int i = 0; i < dim_row; i++)
+  {
+    for(int j = 0; j < dim_col; j++)
+    {
+      out.row(j) += mat.row(i * dim_col + j) * vec.row(i);
+    }
+  }
+}
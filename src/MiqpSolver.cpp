@@ -0,0 +1,315 @@
+/* Author: Masaki Murooka */
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <thread>
+
+#include <qp_solver_collection/MiqpSolver.h>
+
+using namespace QpSolverCollection;
+
+namespace
+{
+/** \brief Comparison of heap so that the node with the lowest bound (and the deepest one for ties) is on top. */
+template<class NodeType>
+bool worseNode(const NodeType & node1, const NodeType & node2)
+{
+  return node1.bound != node2.bound ? node1.bound > node2.bound : node1.depth < node2.depth;
+}
+} // namespace
+
+MiqpSolver::MiqpSolver(const QpSolverType & qp_solver_type)
+: MiqpSolver([qp_solver_type]() { return allocateQpSolver(qp_solver_type); })
+{
+}
+
+MiqpSolver::MiqpSolver(const QpSolverFactory & qp_solver_factory) : qp_solver_factory_(qp_solver_factory)
+{
+  if(!qp_solver_factory_)
+  {
+    throw std::runtime_error("[MiqpSolver] QP solver factory is empty.");
+  }
+}
+
+Eigen::VectorXd MiqpSolver::solve(const QpCoeff & qp_coeff, const std::vector<int> & integer_idx_list)
+{
+  int dim_var = qp_coeff.dim_var_;
+  for(int idx : integer_idx_list)
+  {
+    if(idx < 0 || idx >= dim_var)
+    {
+      throw std::invalid_argument("[MiqpSolver] Integer index is out of range: " + std::to_string(idx));
+    }
+  }
+
+  // Setup workers
+  worker_num_ = thread_num_ > 0 ? thread_num_ : std::max(static_cast<int>(std::thread::hardware_concurrency()), 1);
+  while(static_cast<int>(worker_list_.size()) < worker_num_)
+  {
+    worker_list_.push_back(std::make_unique<Worker>());
+    worker_list_.back()->qp_solver = qp_solver_factory_();
+    if(!worker_list_.back()->qp_solver)
+    {
+      worker_list_.pop_back();
+      throw std::runtime_error("[MiqpSolver] QP solver factory returned null.");
+    }
+  }
+  for(int i = 0; i < worker_num_; i++)
+  {
+    worker_list_[i]->qp_solver->setSettings(qp_settings_);
+  }
+
+  qp_coeff_ = &qp_coeff;
+  integer_idx_list_ = integer_idx_list;
+  pending_num_ = 0;
+  node_count_ = 0;
+  node_limit_reached_ = false;
+  incumbent_obj_ = std::numeric_limits<double>::infinity();
+  incumbent_x_.resize(0);
+
+  // Root node with the bounds of integer variables rounded inward
+  Node root_node;
+  root_node.x_min = qp_coeff.x_min_;
+  root_node.x_max = qp_coeff.x_max_;
+  bool root_infeasible = false;
+  for(int idx : integer_idx_list_)
+  {
+    root_node.x_min[idx] = std::ceil(root_node.x_min[idx] - int_tol_);
+    root_node.x_max[idx] = std::floor(root_node.x_max[idx] + int_tol_);
+    root_infeasible = root_infeasible || (root_node.x_min[idx] > root_node.x_max[idx]);
+  }
+
+  if(!root_infeasible)
+  {
+    pushNode(0, std::move(root_node));
+    std::vector<std::thread> thread_list;
+    for(int i = 1; i < worker_num_; i++)
+    {
+      thread_list.emplace_back(&MiqpSolver::workerLoop, this, i);
+    }
+    workerLoop(0);
+    for(auto & thread : thread_list)
+    {
+      thread.join();
+    }
+  }
+
+  // Nodes remaining due to the node limit bound the optimal objective value
+  obj_value_ = incumbent_obj_;
+  lower_bound_ = obj_value_;
+  for(int i = 0; i < worker_num_; i++)
+  {
+    for(const auto & node : worker_list_[i]->node_queue)
+    {
+      lower_bound_ = std::min(lower_bound_, node.bound);
+    }
+    worker_list_[i]->node_queue.clear();
+  }
+  node_num_ = std::min(static_cast<int>(node_count_), max_node_num_);
+  qp_coeff_ = nullptr;
+
+  solve_failed_ = (incumbent_x_.size() == 0);
+  if(node_limit_reached_)
+  {
+    status_ = QpSolveStatus::MaxIterReached;
+  }
+  else
+  {
+    status_ = solve_failed_ ? QpSolveStatus::PrimalInfeasible : QpSolveStatus::Solved;
+  }
+  if(solve_failed_)
+  {
+    QSC_WARN_STREAM("[MiqpSolver] No integer solution is found. status: " << std::to_string(status_)
+                                                                           << ", node num: " << node_num_);
+    return Eigen::VectorXd::Zero(dim_var);
+  }
+  return incumbent_x_;
+}
+
+void MiqpSolver::workerLoop(int worker_idx)
+{
+  Node node;
+  while(!node_limit_reached_)
+  {
+    // Take the node from the own queue, or steal from the other workers
+    bool popped = popNode(worker_idx, false, node);
+    for(int i = 1; !popped && i < worker_num_; i++)
+    {
+      popped = popNode((worker_idx + i) % worker_num_, true, node);
+    }
+    if(!popped)
+    {
+      if(pending_num_ == 0)
+      {
+        break;
+      }
+      std::this_thread::yield();
+      continue;
+    }
+
+    processNode(worker_idx, node);
+    // Decremented after pushing the children so that the other workers do not stop while the children are created
+    pending_num_--;
+  }
+}
+
+void MiqpSolver::processNode(int worker_idx, Node & node)
+{
+  if(node.bound >= pruneThreshold())
+  {
+    return;
+  }
+  if(node_count_++ >= max_node_num_)
+  {
+    node_limit_reached_ = true;
+    pushNode(worker_idx, std::move(node));
+    return;
+  }
+
+  // Solve relaxation
+  const QpCoeff & qp_coeff = *qp_coeff_;
+  Worker & worker = *worker_list_[worker_idx];
+  worker.obj_mat = qp_coeff.obj_mat_;
+  Eigen::VectorXd x;
+  if(node.warm_start)
+  {
+    x = worker.qp_solver->solve(qp_coeff.dim_var_, qp_coeff.dim_eq_, qp_coeff.dim_ineq_, worker.obj_mat,
+                                qp_coeff.obj_vec_, qp_coeff.eq_mat_, qp_coeff.eq_vec_, qp_coeff.ineq_mat_,
+                                qp_coeff.ineq_vec_, node.x_min, node.x_max, *node.warm_start);
+  }
+  else
+  {
+    x = worker.qp_solver->solve(qp_coeff.dim_var_, qp_coeff.dim_eq_, qp_coeff.dim_ineq_, worker.obj_mat,
+                                qp_coeff.obj_vec_, qp_coeff.eq_mat_, qp_coeff.eq_vec_, qp_coeff.ineq_mat_,
+                                qp_coeff.ineq_vec_, node.x_min, node.x_max);
+  }
+  if(worker.qp_solver->solveFailed())
+  {
+    return;
+  }
+  double obj = computeObj(x);
+  if(obj >= pruneThreshold())
+  {
+    return;
+  }
+
+  // Select the most fractional integer variable
+  int branch_idx = -1;
+  double max_frac = int_tol_;
+  for(int idx : integer_idx_list_)
+  {
+    double frac = std::abs(x[idx] - std::round(x[idx]));
+    if(frac > max_frac)
+    {
+      branch_idx = idx;
+      max_frac = frac;
+    }
+  }
+
+  if(branch_idx == -1)
+  {
+    for(int idx : integer_idx_list_)
+    {
+      x[idx] = std::round(x[idx]);
+    }
+    obj = computeObj(x);
+    std::lock_guard<std::mutex> lock(incumbent_mtx_);
+    if(obj < incumbent_obj_)
+    {
+      incumbent_obj_ = obj;
+      incumbent_x_ = x;
+    }
+    return;
+  }
+
+  // The children share the solution of this relaxation as their warm start
+  const QpSolver & qp_solver = *worker.qp_solver;
+  auto warm_start = std::make_shared<const WarmStart>(
+      x, qp_solver.dualEq().size() == qp_coeff.dim_eq_ ? qp_solver.dualEq() : Eigen::VectorXd(),
+      qp_solver.dualIneq().size() == qp_coeff.dim_ineq_ ? qp_solver.dualIneq() : Eigen::VectorXd(),
+      qp_solver.dualBound().size() == qp_coeff.dim_var_ ? qp_solver.dualBound() : Eigen::VectorXd());
+
+  Node down_node;
+  down_node.x_min = node.x_min;
+  down_node.x_max = node.x_max;
+  down_node.x_max[branch_idx] = std::floor(x[branch_idx]);
+  down_node.bound = obj;
+  down_node.depth = node.depth + 1;
+  down_node.warm_start = warm_start;
+  Node up_node;
+  up_node.x_min = std::move(node.x_min);
+  up_node.x_max = std::move(node.x_max);
+  up_node.x_min[branch_idx] = std::ceil(x[branch_idx]);
+  up_node.bound = obj;
+  up_node.depth = node.depth + 1;
+  up_node.warm_start = std::move(warm_start);
+
+  // The child closer to the relaxed solution is pushed last so that it is taken first in depth-first search
+  if(x[branch_idx] - std::floor(x[branch_idx]) < 0.5)
+  {
+    pushNode(worker_idx, std::move(up_node));
+    pushNode(worker_idx, std::move(down_node));
+  }
+  else
+  {
+    pushNode(worker_idx, std::move(down_node));
+    pushNode(worker_idx, std::move(up_node));
+  }
+}
+
+void MiqpSolver::pushNode(int worker_idx, Node && node)
+{
+  Worker & worker = *worker_list_[worker_idx];
+  pending_num_++;
+  std::lock_guard<std::mutex> lock(worker.mtx);
+  worker.node_queue.push_back(std::move(node));
+  if(strategy_ == MiqpSearchStrategy::BestBound)
+  {
+    std::push_heap(worker.node_queue.begin(), worker.node_queue.end(), worseNode<Node>);
+  }
+}
+
+bool MiqpSolver::popNode(int worker_idx, bool steal, Node & node)
+{
+  Worker & worker = *worker_list_[worker_idx];
+  std::lock_guard<std::mutex> lock(worker.mtx);
+  if(worker.node_queue.empty())
+  {
+    return false;
+  }
+
+  if(strategy_ == MiqpSearchStrategy::BestBound)
+  {
+    std::pop_heap(worker.node_queue.begin(), worker.node_queue.end(), worseNode<Node>);
+    node = std::move(worker.node_queue.back());
+    worker.node_queue.pop_back();
+  }
+  else if(steal)
+  {
+    // The shallowest node is stolen since its subtree is expected to be the largest
+    node = std::move(worker.node_queue.front());
+    worker.node_queue.pop_front();
+  }
+  else
+  {
+    node = std::move(worker.node_queue.back());
+    worker.node_queue.pop_back();
+  }
+  return true;
+}
+
+double MiqpSolver::pruneThreshold() const
+{
+  double incumbent_obj = incumbent_obj_;
+  if(std::isinf(incumbent_obj))
+  {
+    return incumbent_obj;
+  }
+  return incumbent_obj - std::max(abs_gap_tol_, rel_gap_tol_ * std::abs(incumbent_obj));
+}
+
+double MiqpSolver::computeObj(const Eigen::VectorXd & x) const
+{
+  return 0.5 * x.dot(qp_coeff_->obj_mat_ * x) + qp_coeff_->obj_vec_.dot(x);
+}
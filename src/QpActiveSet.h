@@ -0,0 +1,189 @@
+/* Author: Masaki Murooka */
+
+#pragma once
+
+#include <cmath>
+#include <limits>
+#include <vector>
+
+#include <Eigen/Core>
+
+namespace QpSolverCollection
+{
+namespace detail
+{
+/** \brief Whether the bound is finite (bounds with the largest magnitude are regarded as absent). */
+inline bool isFiniteBound(double bound)
+{
+  return std::abs(bound) < std::numeric_limits<double>::max();
+}
+
+/** \brief Determine the active set from Lagrange multipliers if available, otherwise from the constraint slacks.
+    \param x solution
+    \param C inequality constraint matrix
+    \param d inequality constraint vector
+    \param x_min lower bound
+    \param x_max upper bound
+    \param dual_ineq Lagrange multipliers of inequality constraints (not used if the dimension is inconsistent)
+    \param dual_bound Lagrange multipliers of bounds (not used if the dimension is inconsistent)
+    \param active_tol tolerance of Lagrange multipliers or constraint slacks to regard the constraint as active
+    \param active_ineq_list indices of active inequality constraints
+    \param active_lower_list indices of active lower bounds
+    \param active_upper_list indices of active upper bounds
+ */
+inline void detectActiveSet(const Eigen::Ref<const Eigen::VectorXd> & x,
+                            const Eigen::Ref<const Eigen::MatrixXd> & C,
+                            const Eigen::Ref<const Eigen::VectorXd> & d,
+                            const Eigen::Ref<const Eigen::VectorXd> & x_min,
+                            const Eigen::Ref<const Eigen::VectorXd> & x_max,
+                            const Eigen::Ref<const Eigen::VectorXd> & dual_ineq,
+                            const Eigen::Ref<const Eigen::VectorXd> & dual_bound,
+                            double active_tol,
+                            std::vector<int> & active_ineq_list,
+                            std::vector<int> & active_lower_list,
+                            std::vector<int> & active_upper_list)
+{
+  Eigen::Index dim_var = x.size();
+  Eigen::Index dim_ineq = C.rows();
+  bool has_dual_ineq = (dual_ineq.size() == dim_ineq);
+  bool has_dual_bound = (dual_bound.size() == dim_var);
+  active_ineq_list.clear();
+  active_lower_list.clear();
+  active_upper_list.clear();
+  for(Eigen::Index i = 0; i < dim_ineq; i++)
+  {
+    if(has_dual_ineq ? dual_ineq[i] > active_tol : d[i] - C.row(i).dot(x) < active_tol)
+    {
+      active_ineq_list.push_back(static_cast<int>(i));
+    }
+  }
+  for(Eigen::Index i = 0; i < dim_var; i++)
+  {
+    if(isFiniteBound(x_min[i]) && (has_dual_bound ? dual_bound[i] < -active_tol : x[i] - x_min[i] < active_tol))
+    {
+      active_lower_list.push_back(static_cast<int>(i));
+    }
+    else if(isFiniteBound(x_max[i]) && (has_dual_bound ? dual_bound[i] > active_tol : x_max[i] - x[i] < active_tol))
+    {
+      active_upper_list.push_back(static_cast<int>(i));
+    }
+  }
+}
+
+/** \brief Get the number of active constraints including equality constraints. */
+inline Eigen::Index activeDim(Eigen::Index dim_eq,
+                              const std::vector<int> & active_ineq_list,
+                              const std::vector<int> & active_lower_list,
+                              const std::vector<int> & active_upper_list)
+{
+  return dim_eq
+         + static_cast<Eigen::Index>(active_ineq_list.size() + active_lower_list.size() + active_upper_list.size());
+}
+
+/** \brief Assemble the matrix of active constraints.
+
+    The rows are ordered as equality constraints, active inequality constraints, active lower bounds, and active upper
+   bounds, which is the order of the Lagrange multipliers in the reduced KKT system.
+ */
+inline void assembleActiveMat(const Eigen::Ref<const Eigen::MatrixXd> & A,
+                              const Eigen::Ref<const Eigen::MatrixXd> & C,
+                              const std::vector<int> & active_ineq_list,
+                              const std::vector<int> & active_lower_list,
+                              const std::vector<int> & active_upper_list,
+                              Eigen::Ref<Eigen::MatrixXd> active_mat)
+{
+  Eigen::Index dim_eq = A.rows();
+  active_mat.setZero();
+  active_mat.topRows(dim_eq) = A;
+  Eigen::Index row_idx = dim_eq;
+  for(int i : active_ineq_list)
+  {
+    active_mat.row(row_idx++) = C.row(i);
+  }
+  for(int i : active_lower_list)
+  {
+    active_mat(row_idx++, i) = 1.0;
+  }
+  for(int i : active_upper_list)
+  {
+    active_mat(row_idx++, i) = 1.0;
+  }
+}
+
+/** \brief Assemble the vector of active constraints in the same order as assembleActiveMat. */
+inline void assembleActiveVec(const Eigen::Ref<const Eigen::VectorXd> & b,
+                              const Eigen::Ref<const Eigen::VectorXd> & d,
+                              const Eigen::Ref<const Eigen::VectorXd> & x_min,
+                              const Eigen::Ref<const Eigen::VectorXd> & x_max,
+                              const std::vector<int> & active_ineq_list,
+                              const std::vector<int> & active_lower_list,
+                              const std::vector<int> & active_upper_list,
+                              Eigen::Ref<Eigen::VectorXd> active_vec)
+{
+  Eigen::Index dim_eq = b.size();
+  active_vec.head(dim_eq) = b;
+  Eigen::Index row_idx = dim_eq;
+  for(int i : active_ineq_list)
+  {
+    active_vec[row_idx++] = d[i];
+  }
+  for(int i : active_lower_list)
+  {
+    active_vec[row_idx++] = x_min[i];
+  }
+  for(int i : active_upper_list)
+  {
+    active_vec[row_idx++] = x_max[i];
+  }
+}
+
+/** \brief Assemble the reduced KKT matrix [Q G^T; G 0] where G is the matrix of active constraints. */
+inline Eigen::MatrixXd assembleKktMat(const Eigen::Ref<const Eigen::MatrixXd> & Q,
+                                      const Eigen::Ref<const Eigen::MatrixXd> & A,
+                                      const Eigen::Ref<const Eigen::MatrixXd> & C,
+                                      const std::vector<int> & active_ineq_list,
+                                      const std::vector<int> & active_lower_list,
+                                      const std::vector<int> & active_upper_list)
+{
+  Eigen::Index dim_var = Q.rows();
+  Eigen::Index dim_active = activeDim(A.rows(), active_ineq_list, active_lower_list, active_upper_list);
+  Eigen::MatrixXd kkt_mat = Eigen::MatrixXd::Zero(dim_var + dim_active, dim_var + dim_active);
+  kkt_mat.topLeftCorner(dim_var, dim_var) = Q;
+  assembleActiveMat(A, C, active_ineq_list, active_lower_list, active_upper_list,
+                    kkt_mat.bottomLeftCorner(dim_active, dim_var));
+  kkt_mat.topRightCorner(dim_var, dim_active) = kkt_mat.bottomLeftCorner(dim_active, dim_var).transpose();
+  return kkt_mat;
+}
+
+/** \brief Scatter the Lagrange multipliers of active constraints (ordered as in assembleActiveMat) to those of all the
+   constraints. */
+inline void scatterDual(const Eigen::Ref<const Eigen::VectorXd> & dual_active,
+                        Eigen::Index dim_var,
+                        Eigen::Index dim_eq,
+                        Eigen::Index dim_ineq,
+                        const std::vector<int> & active_ineq_list,
+                        const std::vector<int> & active_lower_list,
+                        const std::vector<int> & active_upper_list,
+                        Eigen::VectorXd & dual_eq,
+                        Eigen::VectorXd & dual_ineq,
+                        Eigen::VectorXd & dual_bound)
+{
+  dual_eq = dual_active.head(dim_eq);
+  dual_ineq.setZero(dim_ineq);
+  dual_bound.setZero(dim_var);
+  Eigen::Index row_idx = dim_eq;
+  for(int i : active_ineq_list)
+  {
+    dual_ineq[i] = dual_active[row_idx++];
+  }
+  for(int i : active_lower_list)
+  {
+    dual_bound[i] = dual_active[row_idx++];
+  }
+  for(int i : active_upper_list)
+  {
+    dual_bound[i] = dual_active[row_idx++];
+  }
+}
+} // namespace detail
+} // namespace QpSolverCollection
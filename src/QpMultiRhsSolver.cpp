@@ -0,0 +1,182 @@
+/* Author: Masaki Murooka */
+
+#include <limits>
+#include <numeric>
+#include <stdexcept>
+
+#include <Eigen/Cholesky>
+#include <Eigen/LU>
+
+#include <qp_solver_collection/QpMultiRhsSolver.h>
+
+#include "QpActiveSet.h"
+
+using namespace QpSolverCollection;
+
+namespace
+{
+/** \brief Minimum coefficient of the vector (infinity if empty). */
+template<class VectorType>
+inline double minCoeffOrInf(const VectorType & vec)
+{
+  return vec.size() > 0 ? vec.minCoeff() : std::numeric_limits<double>::infinity();
+}
+} // namespace
+
+QpMultiRhsSolver::QpMultiRhsSolver(const QpSolverType & qp_solver_type)
+: QpMultiRhsSolver(allocateQpSolver(qp_solver_type))
+{
+}
+
+QpMultiRhsSolver::QpMultiRhsSolver(const std::shared_ptr<QpSolver> & qp_solver) : backend_(qp_solver)
+{
+  if(!backend_)
+  {
+    throw std::runtime_error("[QpMultiRhsSolver] Backend QP solver instance is null.");
+  }
+}
+
+std::vector<SolveResult> QpMultiRhsSolver::solveMultiRhs(Eigen::Ref<Eigen::MatrixXd> Q,
+                                                         const Eigen::Ref<const Eigen::MatrixXd> & A,
+                                                         const Eigen::Ref<const Eigen::MatrixXd> & C,
+                                                         const Eigen::Ref<const Eigen::MatrixXd> & c_mat,
+                                                         const Eigen::Ref<const Eigen::MatrixXd> & b_mat,
+                                                         const Eigen::Ref<const Eigen::MatrixXd> & d_mat,
+                                                         const Eigen::Ref<const Eigen::VectorXd> & x_min,
+                                                         const Eigen::Ref<const Eigen::VectorXd> & x_max)
+{
+  Eigen::Index dim_var = Q.rows();
+  Eigen::Index dim_eq = A.rows();
+  Eigen::Index dim_ineq = C.rows();
+  Eigen::Index rhs_num = c_mat.cols();
+  if(Q.cols() != dim_var || A.cols() != dim_var || C.cols() != dim_var || c_mat.rows() != dim_var
+     || b_mat.rows() != dim_eq || b_mat.cols() != rhs_num || d_mat.rows() != dim_ineq || d_mat.cols() != rhs_num
+     || x_min.size() != dim_var || x_max.size() != dim_var)
+  {
+    throw std::invalid_argument("[QpMultiRhsSolver::solveMultiRhs] Dimensions of matrices are inconsistent.");
+  }
+
+  group_num_ = 0;
+  backend_solve_num_ = 0;
+  std::vector<SolveResult> result_list(rhs_num);
+  std::vector<Eigen::Index> pending_list(rhs_num);
+  std::iota(pending_list.begin(), pending_list.end(), 0);
+
+  // Factorize the objective matrix and compute the unconstrained solutions of all the QPs at once
+  Eigen::LLT<Eigen::MatrixXd> llt(Q);
+  bool factorized = (llt.info() == Eigen::Success);
+  Eigen::MatrixXd x_unconstr_mat;
+  if(factorized)
+  {
+    x_unconstr_mat = llt.solve(-c_mat);
+  }
+
+  while(!pending_list.empty())
+  {
+    // Solve the representative with the backend
+    Eigen::Index rep_idx = pending_list.front();
+    pending_list.erase(pending_list.begin());
+    const SolveResult & rep_result = result_list[rep_idx] = solveByBackend(
+        Q, A, C, c_mat.col(rep_idx), b_mat.col(rep_idx), d_mat.col(rep_idx), x_min, x_max);
+    if(!factorized || group_num_ >= max_group_num_ || pending_list.empty() || backend_->solveFailed())
+    {
+      continue;
+    }
+
+    // Determine the active set from Lagrange multipliers if available, otherwise from the constraint slacks
+    std::vector<int> active_ineq_list;
+    std::vector<int> active_lower_list;
+    std::vector<int> active_upper_list;
+    detail::detectActiveSet(rep_result.x_, C, d_mat.col(rep_idx), x_min, x_max, rep_result.dual_ineq_,
+                            rep_result.dual_bound_, active_tol_, active_ineq_list, active_lower_list,
+                            active_upper_list);
+    Eigen::Index active_ineq_num = static_cast<Eigen::Index>(active_ineq_list.size());
+    Eigen::Index active_lower_num = static_cast<Eigen::Index>(active_lower_list.size());
+    Eigen::Index active_upper_num = static_cast<Eigen::Index>(active_upper_list.size());
+    Eigen::Index dim_active = detail::activeDim(dim_eq, active_ineq_list, active_lower_list, active_upper_list);
+
+    // Assemble the active constraint matrix and factorize the Schur complement G Q^-1 G^T
+    Eigen::MatrixXd active_mat(dim_active, dim_var);
+    detail::assembleActiveMat(A, C, active_ineq_list, active_lower_list, active_upper_list, active_mat);
+    Eigen::MatrixXd q_inv_active_mat_t = llt.solve(active_mat.transpose());
+    Eigen::FullPivLU<Eigen::MatrixXd> schur_lu(active_mat * q_inv_active_mat_t);
+    // Degenerate active sets (e.g., linearly dependent active constraints) are not used
+    if(dim_active > 0 && !schur_lu.isInvertible())
+    {
+      continue;
+    }
+    group_num_++;
+
+    // Stack the right-hand sides of the remaining QPs as columns
+    Eigen::Index pending_num = static_cast<Eigen::Index>(pending_list.size());
+    Eigen::MatrixXd x_mat(dim_var, pending_num);
+    Eigen::MatrixXd active_vec_mat(dim_active, pending_num);
+    Eigen::MatrixXd ineq_slack_mat(dim_ineq, pending_num);
+    for(Eigen::Index j = 0; j < pending_num; j++)
+    {
+      Eigen::Index idx = pending_list[j];
+      x_mat.col(j) = x_unconstr_mat.col(idx);
+      detail::assembleActiveVec(b_mat.col(idx), d_mat.col(idx), x_min, x_max, active_ineq_list, active_lower_list,
+                                active_upper_list, active_vec_mat.col(j));
+      ineq_slack_mat.col(j) = d_mat.col(idx);
+    }
+
+    // Solve the equality-constrained QPs with the active set
+    Eigen::MatrixXd dual_mat(dim_active, pending_num);
+    if(dim_active > 0)
+    {
+      active_vec_mat = active_mat * x_mat - active_vec_mat;
+      dual_mat = schur_lu.solve(active_vec_mat);
+      x_mat.noalias() -= q_inv_active_mat_t * dual_mat;
+    }
+    ineq_slack_mat.noalias() -= C * x_mat;
+
+    // Accept the solutions that satisfy the primal and dual feasibility
+    std::vector<Eigen::Index> rejected_list;
+    for(Eigen::Index j = 0; j < pending_num; j++)
+    {
+      const auto & dual = dual_mat.col(j);
+      const auto & x_j = x_mat.col(j);
+      bool feasible = minCoeffOrInf(dual.segment(dim_eq, active_ineq_num)) >= -feasibility_tol_
+                      && minCoeffOrInf(-dual.segment(dim_eq + active_ineq_num, active_lower_num)) >= -feasibility_tol_
+                      && minCoeffOrInf(dual.tail(active_upper_num)) >= -feasibility_tol_
+                      && minCoeffOrInf(x_j - x_min) >= -feasibility_tol_
+                      && minCoeffOrInf(x_max - x_j) >= -feasibility_tol_
+                      && minCoeffOrInf(ineq_slack_mat.col(j)) >= -feasibility_tol_;
+      if(!feasible)
+      {
+        rejected_list.push_back(pending_list[j]);
+        continue;
+      }
+
+      SolveResult & result = result_list[pending_list[j]];
+      result.x_ = x_j;
+      detail::scatterDual(dual, dim_var, dim_eq, dim_ineq, active_ineq_list, active_lower_list, active_upper_list,
+                          result.dual_eq_, result.dual_ineq_, result.dual_bound_);
+      result.status_ = QpSolveStatus::Solved;
+    }
+    pending_list = std::move(rejected_list);
+  }
+
+  return result_list;
+}
+
+SolveResult QpMultiRhsSolver::solveByBackend(Eigen::Ref<Eigen::MatrixXd> Q,
+                                             const Eigen::Ref<const Eigen::MatrixXd> & A,
+                                             const Eigen::Ref<const Eigen::MatrixXd> & C,
+                                             const Eigen::Ref<const Eigen::VectorXd> & c,
+                                             const Eigen::Ref<const Eigen::VectorXd> & b,
+                                             const Eigen::Ref<const Eigen::VectorXd> & d,
+                                             const Eigen::Ref<const Eigen::VectorXd> & x_min,
+                                             const Eigen::Ref<const Eigen::VectorXd> & x_max)
+{
+  backend_solve_num_++;
+  SolveResult result;
+  result.x_ = backend_->solve(static_cast<int>(Q.rows()), static_cast<int>(A.rows()), static_cast<int>(C.rows()), Q,
+                              c, A, b, C, d, x_min, x_max);
+  result.dual_eq_ = backend_->dualEq();
+  result.dual_ineq_ = backend_->dualIneq();
+  result.dual_bound_ = backend_->dualBound();
+  result.status_ = backend_->status();
+  return result;
+}
@@ -0,0 +1,95 @@
+/* Author: Masaki Murooka */
+
+#include <stdexcept>
+
+#include <qp_solver_collection/QpSensitivity.h>
+
+#include "QpActiveSet.h"
+
+using namespace QpSolverCollection;
+
+bool QpSensitivity::factorize(const QpCoeff & qp_coeff, const SolveResult & result)
+{
+  dim_var_ = qp_coeff.dim_var_;
+  dim_eq_ = qp_coeff.dim_eq_;
+  dim_ineq_ = qp_coeff.dim_ineq_;
+  const Eigen::VectorXd & x = result.x_;
+
+  // Determine the active set from Lagrange multipliers if available, otherwise from the constraint slacks
+  detail::detectActiveSet(x, qp_coeff.ineq_mat_, qp_coeff.ineq_vec_, qp_coeff.x_min_, qp_coeff.x_max_,
+                          result.dual_ineq_, result.dual_bound_, active_tol_, active_ineq_list_, active_lower_list_,
+                          active_upper_list_);
+
+  // Assemble the reduced KKT matrix and its right-hand side
+  Eigen::Index dim_active = detail::activeDim(dim_eq_, active_ineq_list_, active_lower_list_, active_upper_list_);
+  Eigen::VectorXd kkt_vec(dim_var_ + dim_active);
+  kkt_vec.head(dim_var_) = -qp_coeff.obj_vec_;
+  detail::assembleActiveVec(qp_coeff.eq_vec_, qp_coeff.ineq_vec_, qp_coeff.x_min_, qp_coeff.x_max_,
+                            active_ineq_list_, active_lower_list_, active_upper_list_, kkt_vec.tail(dim_active));
+
+  // Degenerate active sets (e.g., linearly dependent active constraints) make the matrix singular
+  kkt_lu_.compute(detail::assembleKktMat(qp_coeff.obj_mat_, qp_coeff.eq_mat_, qp_coeff.ineq_mat_, active_ineq_list_,
+                                         active_lower_list_, active_upper_list_));
+  factorized_ = kkt_lu_.isInvertible();
+  if(!factorized_)
+  {
+    QSC_WARN_STREAM("[QpSensitivity] Reduced KKT matrix is singular. Active set may be degenerate.");
+    return false;
+  }
+
+  // Primal solution and Lagrange multipliers consistent with the active set
+  sol_ = kkt_lu_.solve(kkt_vec);
+
+  return true;
+}
+
+void QpSensitivity::backward(const Eigen::Ref<const Eigen::VectorXd> & grad_x, QpCoeff & grad) const
+{
+  if(!factorized_)
+  {
+    throw std::runtime_error("[QpSensitivity] backward is called before the reduced KKT matrix is factorized.");
+  }
+  if(grad_x.size() != dim_var_)
+  {
+    throw std::runtime_error("[QpSensitivity] Dimension of grad_x is inconsistent: " + std::to_string(grad_x.size())
+                             + " != " + std::to_string(dim_var_));
+  }
+
+  // Since the KKT matrix is symmetric, the adjoint system is solved with the same factorization
+  Eigen::VectorXd adj_vec = Eigen::VectorXd::Zero(sol_.size());
+  adj_vec.head(dim_var_) = grad_x;
+  Eigen::VectorXd adj = kkt_lu_.solve(adj_vec);
+
+  // The solution z of K z = r satisfies dL/dr = w and dL/dK = -w z^T where w = K^{-1} dL/dz
+  const auto & x = sol_.head(dim_var_);
+  const auto & adj_x = adj.head(dim_var_);
+  grad.setup(dim_var_, dim_eq_, dim_ineq_);
+  grad.x_min_.setZero();
+  grad.x_max_.setZero();
+  grad.obj_mat_.noalias() = -0.5 * (adj_x * x.transpose() + x * adj_x.transpose());
+  grad.obj_vec_ = -adj_x;
+  grad.eq_mat_.noalias() = -(adj.segment(dim_var_, dim_eq_) * x.transpose()
+                             + sol_.segment(dim_var_, dim_eq_) * adj_x.transpose());
+  grad.eq_vec_ = adj.segment(dim_var_, dim_eq_);
+  int row_idx = dim_var_ + dim_eq_;
+  for(int i : active_ineq_list_)
+  {
+    grad.ineq_mat_.row(i) = -(adj[row_idx] * x + sol_[row_idx] * adj_x).transpose();
+    grad.ineq_vec_[i] = adj[row_idx++];
+  }
+  for(int i : active_lower_list_)
+  {
+    grad.x_min_[i] = adj[row_idx++];
+  }
+  for(int i : active_upper_list_)
+  {
+    grad.x_max_[i] = adj[row_idx++];
+  }
+}
+
+QpCoeff QpSensitivity::backward(const Eigen::Ref<const Eigen::VectorXd> & grad_x) const
+{
+  QpCoeff grad;
+  backward(grad_x, grad);
+  return grad;
+}
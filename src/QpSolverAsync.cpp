@@ -0,0 +1,165 @@
+/* Author: Masaki Murooka */
+
+#include <stdexcept>
+
+#include <qp_solver_collection/QpSolverAsync.h>
+
+using namespace QpSolverCollection;
+
+QpSolverAsync::QpSolverAsync(const QpSolverType & qp_solver_type)
+: QpSolverAsync(allocateQpSolver(qp_solver_type))
+{
+}
+
+QpSolverAsync::QpSolverAsync(const std::shared_ptr<QpSolver> & qp_solver) : qp_solver_(qp_solver)
+{
+  if(!qp_solver_)
+  {
+    throw std::runtime_error("[QpSolverAsync] QP solver instance is null.");
+  }
+  thread_ = std::thread(&QpSolverAsync::solverLoop, this);
+}
+
+QpSolverAsync::~QpSolverAsync()
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = true;
+  }
+  cond_.notify_all();
+  thread_.join();
+}
+
+std::future<QpAsyncResult> QpSolverAsync::solveAsync(QpCoeff && qp_coeff)
+{
+  Request request;
+  request.qp_coeff = std::move(qp_coeff);
+  std::future<QpAsyncResult> future = request.promise.get_future();
+  push(std::move(request));
+  return future;
+}
+
+void QpSolverAsync::solveAsync(QpCoeff && qp_coeff, Callback callback)
+{
+  Request request;
+  request.qp_coeff = std::move(qp_coeff);
+  request.callback = std::move(callback);
+  push(std::move(request));
+}
+
+std::future<QpAsyncResult> QpSolverAsync::swapBuffers()
+{
+  Request request;
+  request.qp_coeff = std::move(back_buffer_);
+  request.from_double_buffer = true;
+  std::future<QpAsyncResult> future = request.promise.get_future();
+
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    // Wait for the other buffer to be returned from the solver thread
+    cond_.wait(lock, [this]() { return !buffer_in_flight_; });
+    back_buffer_ = std::move(returned_buffer_);
+    buffer_in_flight_ = true;
+    request_queue_.push_back(std::move(request));
+  }
+  cond_.notify_all();
+
+  return future;
+}
+
+void QpSolverAsync::waitIdle()
+{
+  std::unique_lock<std::mutex> lock(mutex_);
+  cond_.wait(lock, [this]() { return request_queue_.empty() && !busy_; });
+}
+
+void QpSolverAsync::push(Request && request)
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    request_queue_.push_back(std::move(request));
+  }
+  cond_.notify_all();
+}
+
+void QpSolverAsync::solverLoop()
+{
+  while(true)
+  {
+    Request request;
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      cond_.wait(lock, [this]() { return stop_ || !request_queue_.empty(); });
+      if(request_queue_.empty())
+      {
+        // Stop only after all the pending requests are solved
+        return;
+      }
+      request = std::move(request_queue_.front());
+      request_queue_.pop_front();
+      busy_ = true;
+    }
+
+    QpAsyncResult result;
+    std::exception_ptr exception;
+    try
+    {
+      result.result_ = qp_solver_->solveWithResult(request.qp_coeff);
+      result.solve_failed_ = qp_solver_->solveFailed();
+    }
+    catch(...)
+    {
+      exception = std::current_exception();
+    }
+
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if(request.from_double_buffer)
+      {
+        returned_buffer_ = std::move(request.qp_coeff);
+        buffer_in_flight_ = false;
+      }
+      else
+      {
+        result.qp_coeff_ = std::move(request.qp_coeff);
+      }
+    }
+
+    if(request.callback)
+    {
+      if(exception)
+      {
+        try
+        {
+          std::rethrow_exception(exception);
+        }
+        catch(const std::exception & e)
+        {
+          QSC_ERROR_STREAM("[QpSolverAsync] Exception while solving: " << e.what());
+        }
+        catch(...)
+        {
+          QSC_ERROR_STREAM("[QpSolverAsync] Unknown exception while solving.");
+        }
+      }
+      else
+      {
+        request.callback(std::move(result));
+      }
+    }
+    else if(exception)
+    {
+      request.promise.set_exception(exception);
+    }
+    else
+    {
+      request.promise.set_value(std::move(result));
+    }
+
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      busy_ = false;
+    }
+    cond_.notify_all();
+  }
+}
@@ -0,0 +1,91 @@
+/* Author: Masaki Murooka */
+
+#include <qp_solver_collection/GoldfarbIdnaniSolver.h>
+#include <qp_solver_collection/QpSolverCollection.h>
+#include <qp_solver_collection/QpSolverMetrics.h>
+#include <qp_solver_collection/QpSolverTrace.h>
+
+using namespace QpSolverCollection;
+
+QpSolverBuiltin::QpSolverBuiltin()
+{
+  type_ = QpSolverType::Builtin;
+  gi_ = std::make_unique<GoldfarbIdnaniSolver>();
+}
+
+Eigen::VectorXd QpSolverBuiltin::solve(int dim_var,
+                                       int dim_eq,
+                                       int dim_ineq,
+                                       Eigen::Ref<Eigen::MatrixXd> Q,
+                                       const Eigen::Ref<const Eigen::VectorXd> & c,
+                                       const Eigen::Ref<const Eigen::MatrixXd> & A,
+                                       const Eigen::Ref<const Eigen::VectorXd> & b,
+                                       const Eigen::Ref<const Eigen::MatrixXd> & C,
+                                       const Eigen::Ref<const Eigen::VectorXd> & d,
+                                       const Eigen::Ref<const Eigen::VectorXd> & x_min,
+                                       const Eigen::Ref<const Eigen::VectorXd> & x_max)
+{
+  QSC_TRACE_SCOPE("QpSolverBuiltin::solve");
+  QpMetricsGuard metrics_guard(*this, dim_var);
+  setLastDimension(dim_var, dim_eq, dim_ineq);
+
+  if(presolveFailed(A, b, C, d, x_min, x_max))
+  {
+    return Eigen::VectorXd::Zero(dim_var);
+  }
+
+  QSC_TRACE_PHASE("iterate");
+  // The active-set iterations terminate finitely, so the limit only guards against cycling due to rounding errors
+  int dim_all = dim_var + dim_eq + dim_ineq;
+  int max_iter = settings_.maxIter(10 * dim_all + 100, 100 * dim_all + 1000, 1000 * dim_all + 10000);
+  settings_updated_ = false;
+  GoldfarbIdnaniSolver::Status status = gi_->solve(Q, c, A, b, C, d, x_min, x_max, max_iter, objMatUnchanged(Q));
+  iter_num_ = gi_->iterNum();
+
+  QSC_TRACE_PHASE("postprocess");
+  switch(status)
+  {
+    case GoldfarbIdnaniSolver::Status::Solved:
+      status_ = QpSolveStatus::Solved;
+      break;
+    case GoldfarbIdnaniSolver::Status::Infeasible:
+      status_ = QpSolveStatus::PrimalInfeasible;
+      break;
+    case GoldfarbIdnaniSolver::Status::NotPositiveDefinite:
+      status_ = QpSolveStatus::DualInfeasible;
+      break;
+    case GoldfarbIdnaniSolver::Status::MaxIterReached:
+      status_ = QpSolveStatus::MaxIterReached;
+      break;
+    default:
+      status_ = QpSolveStatus::Unknown;
+  }
+  solve_failed_ = (status_ != QpSolveStatus::Solved);
+  if(solve_failed_)
+  {
+    QSC_WARN_STREAM("[QpSolverBuiltin::solve] Failed to solve: " << std::to_string(status_));
+    dual_eq_.resize(0);
+    dual_ineq_.resize(0);
+    dual_bound_.resize(0);
+    return Eigen::VectorXd::Zero(dim_var);
+  }
+
+  dual_eq_ = gi_->dualEq();
+  dual_ineq_ = gi_->dualIneq();
+  dual_bound_ = gi_->dualBound();
+  return gi_->x();
+}
+
+size_t QpSolverBuiltin::memoryUsage() const
+{
+  return QpSolver::memoryUsage() + sizeof(*this) - sizeof(QpSolver) + sizeof(GoldfarbIdnaniSolver)
+         + gi_->memoryUsage();
+}
+
+namespace QpSolverCollection
+{
+std::shared_ptr<QpSolver> allocateQpSolverBuiltin()
+{
+  return std::make_shared<QpSolverBuiltin>();
+}
+} // namespace QpSolverCollection
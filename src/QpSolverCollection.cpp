@@ -1,6 +1,17 @@
 /* Author: Masaki Murooka */
 
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdlib>
 #include <fstream>
+#include <functional>
+#include <sstream>
+#include <stdexcept>
+#include <unordered_map>
+
+#include <Eigen/Cholesky>
+#include <Eigen/QR>
 
 #include <qp_solver_collection/QpSolverCollection.h>
 
@@ -52,14 +63,119 @@ QpSolverType QpSolverCollection::strToQpSolverType(const std::string & qp_solver
   {
     return QpSolverType::QPMAD;
   }
+  else if(qp_solver_type == "Builtin")
+  {
+    return QpSolverType::Builtin;
+  }
   else
   {
     throw std::runtime_error("[strToQpSolverType] Unsupported QpSolverType name: " + qp_solver_type);
   }
 }
 
+QpAccuracyProfile QpSolverCollection::strToQpAccuracyProfile(const std::string & profile)
+{
+  if(profile == "Fast")
+  {
+    return QpAccuracyProfile::Fast;
+  }
+  else if(profile == "Balanced")
+  {
+    return QpAccuracyProfile::Balanced;
+  }
+  else if(profile == "Robust")
+  {
+    return QpAccuracyProfile::Robust;
+  }
+  else
+  {
+    throw std::runtime_error("[strToQpAccuracyProfile] Unsupported QpAccuracyProfile name: " + profile);
+  }
+}
+
+namespace
+{
+/** \brief Get QP solver name without the prefix of "QpSolverType::" (i.e., the name accepted by strToQpSolverType). */
+std::string qpSolverName(QpSolverType qp_solver_type)
+{
+  const std::string prefix = "QpSolverType::";
+  std::string name = std::to_string(qp_solver_type);
+  if(name.compare(0, prefix.size(), prefix) == 0)
+  {
+    name.erase(0, prefix.size());
+  }
+  return name;
+}
+
+/** \brief Read a token and convert it to double (inf and nan are also accepted). */
+bool readDouble(std::istream & is, double & value)
+{
+  std::string token;
+  if(!(is >> token))
+  {
+    return false;
+  }
+  char * end = nullptr;
+  value = std::strtod(token.c_str(), &end);
+  return end != token.c_str() && *end == '\0';
+}
+
+/** \brief Read a label followed by a matrix in row-major order. */
+template<class MatrixType>
+bool readMatrix(std::istream & is, const std::string & label, MatrixType & mat)
+{
+  std::string token;
+  if(!(is >> token) || token != label)
+  {
+    return false;
+  }
+  for(Eigen::Index i = 0; i < mat.rows(); i++)
+  {
+    for(Eigen::Index j = 0; j < mat.cols(); j++)
+    {
+      if(!readDouble(is, mat(i, j)))
+      {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+/** \brief Assign a value to a variable and restore the previous value on scope exit even if an exception is thrown. */
+template<class T>
+class ScopedValue
+{
+public:
+  ScopedValue(T & var, T value) : var_(var), prev_value_(var)
+  {
+    var_ = value;
+  }
+
+  ~ScopedValue()
+  {
+    var_ = prev_value_;
+  }
+
+  ScopedValue(const ScopedValue &) = delete;
+  ScopedValue & operator=(const ScopedValue &) = delete;
+
+protected:
+  T & var_;
+  T prev_value_;
+};
+} // namespace
+
+uint64_t QpInstanceId::next()
+{
+  static std::atomic<uint64_t> counter(0);
+  return ++counter;
+}
+
 void QpCoeff::setup(int dim_var, int dim_eq, int dim_ineq)
 {
+  setModified();
+
   dim_var_ = dim_var;
   dim_eq_ = dim_eq;
   dim_ineq_ = dim_ineq;
@@ -72,6 +188,8 @@ void QpCoeff::setup(int dim_var, int dim_eq, int dim_ineq)
   ineq_vec_.setZero(dim_ineq);
   x_min_.setConstant(dim_var, std::numeric_limits<double>::lowest());
   x_max_.setConstant(dim_var, std::numeric_limits<double>::max());
+
+  element_ids_ = QpElementIds();
 }
 
 void QpCoeff::printInfo(bool, const std::string & header) const
@@ -81,17 +199,472 @@ void QpCoeff::printInfo(bool, const std::string & header) const
 
 void QpCoeff::dump(std::ofstream & ofs) const
 {
+  // Dump with the precision of round trip so that the loaded coefficients reproduce the same solution
+  const Eigen::IOFormat fmt(Eigen::StreamPrecision);
+  std::streamsize prev_precision = ofs.precision(std::numeric_limits<double>::max_digits10);
   ofs << "dim_var: " << dim_var_ << std::endl;
   ofs << "dim_eq: " << dim_eq_ << std::endl;
   ofs << "dim_ineq: " << dim_ineq_ << std::endl;
-  ofs << "obj_mat:\n" << obj_mat_ << std::endl;
-  ofs << "obj_vec:\n" << obj_vec_.transpose() << std::endl;
-  ofs << "eq_mat:\n" << eq_mat_ << std::endl;
-  ofs << "eq_vec:\n" << eq_vec_.transpose() << std::endl;
-  ofs << "ineq_mat:\n" << ineq_mat_ << std::endl;
-  ofs << "ineq_vec:\n" << ineq_vec_.transpose() << std::endl;
-  ofs << "x_min:\n" << x_min_.transpose() << std::endl;
-  ofs << "x_max:\n" << x_max_.transpose() << std::endl;
+  ofs << "obj_mat:\n" << obj_mat_.format(fmt) << std::endl;
+  ofs << "obj_vec:\n" << obj_vec_.transpose().format(fmt) << std::endl;
+  ofs << "eq_mat:\n" << eq_mat_.format(fmt) << std::endl;
+  ofs << "eq_vec:\n" << eq_vec_.transpose().format(fmt) << std::endl;
+  ofs << "ineq_mat:\n" << ineq_mat_.format(fmt) << std::endl;
+  ofs << "ineq_vec:\n" << ineq_vec_.transpose().format(fmt) << std::endl;
+  ofs << "x_min:\n" << x_min_.transpose().format(fmt) << std::endl;
+  ofs << "x_max:\n" << x_max_.transpose().format(fmt) << std::endl;
+  ofs.precision(prev_precision);
+}
+
+bool QpCoeff::load(std::istream & is)
+{
+  std::string token;
+  int dim_var, dim_eq, dim_ineq;
+  if(!(is >> token >> dim_var) || token != "dim_var:" || !(is >> token >> dim_eq) || token != "dim_eq:"
+     || !(is >> token >> dim_ineq) || token != "dim_ineq:")
+  {
+    return false;
+  }
+
+  setup(dim_var, dim_eq, dim_ineq);
+  Eigen::Map<Eigen::RowVectorXd> obj_vec(obj_vec_.data(), dim_var);
+  Eigen::Map<Eigen::RowVectorXd> eq_vec(eq_vec_.data(), dim_eq);
+  Eigen::Map<Eigen::RowVectorXd> ineq_vec(ineq_vec_.data(), dim_ineq);
+  Eigen::Map<Eigen::RowVectorXd> x_min(x_min_.data(), dim_var);
+  Eigen::Map<Eigen::RowVectorXd> x_max(x_max_.data(), dim_var);
+  if(!(readMatrix(is, "obj_mat:", obj_mat_) && readMatrix(is, "obj_vec:", obj_vec)
+       && readMatrix(is, "eq_mat:", eq_mat_) && readMatrix(is, "eq_vec:", eq_vec)
+       && readMatrix(is, "ineq_mat:", ineq_mat_) && readMatrix(is, "ineq_vec:", ineq_vec)
+       && readMatrix(is, "x_min:", x_min) && readMatrix(is, "x_max:", x_max)))
+  {
+    QSC_WARN_STREAM("[QpCoeff::load] Failed to load coefficients.");
+    return false;
+  }
+
+  return true;
+}
+
+bool WarmStart::isValid(int dim_var, int dim_eq, int dim_ineq) const
+{
+  return x_.size() == dim_var && (dual_eq_.size() == 0 || dual_eq_.size() == dim_eq)
+         && (dual_ineq_.size() == 0 || dual_ineq_.size() == dim_ineq)
+         && (dual_bound_.size() == 0 || dual_bound_.size() == dim_var);
+}
+
+Eigen::VectorXd WarmStart::stackedDual(int dim_var, int dim_eq, int dim_ineq) const
+{
+  Eigen::VectorXd dual = Eigen::VectorXd::Zero(dim_eq + dim_ineq + dim_var);
+  if(dual_eq_.size() == dim_eq)
+  {
+    dual.head(dim_eq) = dual_eq_;
+  }
+  if(dual_ineq_.size() == dim_ineq)
+  {
+    dual.segment(dim_eq, dim_ineq) = dual_ineq_;
+  }
+  if(dual_bound_.size() == dim_var)
+  {
+    dual.tail(dim_var) = dual_bound_;
+  }
+  return dual;
+}
+
+bool QpElementIds::isValid(int dim_var, int dim_eq, int dim_ineq) const
+{
+  return static_cast<int>(var_id_list_.size()) == dim_var
+         && (eq_id_list_.empty() || static_cast<int>(eq_id_list_.size()) == dim_eq)
+         && (ineq_id_list_.empty() || static_cast<int>(ineq_id_list_.size()) == dim_ineq);
+}
+
+namespace
+{
+/** \brief Remap the vector by the identifiers of its elements, filling the elements of new identifiers with the
+   default vector. The default vector is returned if the vector or the previous identifiers are not available. */
+Eigen::VectorXd remapById(const Eigen::VectorXd & vec,
+                          const std::vector<int64_t> & prev_id_list,
+                          const std::vector<int64_t> & id_list,
+                          const Eigen::VectorXd & default_vec)
+{
+  if(prev_id_list.empty() || vec.size() != static_cast<Eigen::Index>(prev_id_list.size()))
+  {
+    return default_vec;
+  }
+
+  std::unordered_map<int64_t, Eigen::Index> prev_idx_map;
+  prev_idx_map.reserve(prev_id_list.size());
+  for(size_t i = 0; i < prev_id_list.size(); i++)
+  {
+    prev_idx_map.emplace(prev_id_list[i], static_cast<Eigen::Index>(i));
+  }
+
+  Eigen::VectorXd vec_remapped = default_vec;
+  for(size_t i = 0; i < id_list.size(); i++)
+  {
+    auto it = prev_idx_map.find(id_list[i]);
+    if(it != prev_idx_map.end())
+    {
+      vec_remapped[i] = vec[it->second];
+    }
+  }
+  return vec_remapped;
+}
+} // namespace
+
+WarmStart QpSolverCollection::remapWarmStart(const SolveResult & result,
+                                             const QpElementIds & element_ids,
+                                             const QpCoeff & qp_coeff)
+{
+  const QpElementIds & new_element_ids = qp_coeff.element_ids_;
+  if(!new_element_ids.isValid(qp_coeff.dim_var_, qp_coeff.dim_eq_, qp_coeff.dim_ineq_))
+  {
+    throw std::invalid_argument("[remapWarmStart] Numbers of identifiers are inconsistent with QP.");
+  }
+
+  WarmStart warm_start;
+  Eigen::VectorXd x_default =
+      Eigen::VectorXd::Zero(qp_coeff.dim_var_).cwiseMax(qp_coeff.x_min_).cwiseMin(qp_coeff.x_max_);
+  warm_start.x_ = remapById(result.x_, element_ids.var_id_list_, new_element_ids.var_id_list_, x_default);
+  if(result.hasDual())
+  {
+    warm_start.dual_bound_ = remapById(result.dual_bound_, element_ids.var_id_list_, new_element_ids.var_id_list_,
+                                       Eigen::VectorXd::Zero(qp_coeff.dim_var_));
+  }
+  if(!new_element_ids.eq_id_list_.empty())
+  {
+    warm_start.dual_eq_ = remapById(result.dual_eq_, element_ids.eq_id_list_, new_element_ids.eq_id_list_,
+                                    Eigen::VectorXd::Zero(qp_coeff.dim_eq_));
+  }
+  if(!new_element_ids.ineq_id_list_.empty())
+  {
+    warm_start.dual_ineq_ = remapById(result.dual_ineq_, element_ids.ineq_id_list_, new_element_ids.ineq_id_list_,
+                                      Eigen::VectorXd::Zero(qp_coeff.dim_ineq_));
+  }
+  return warm_start;
+}
+
+bool KktResidual::satisfied(double tol, bool check_dual) const
+{
+  if(!(primal_feas_ <= tol))
+  {
+    return false;
+  }
+  if(check_dual && !std::isnan(dual_feas_))
+  {
+    return dual_feas_ <= tol && complementarity_ <= tol && duality_gap_ <= tol;
+  }
+  return true;
+}
+
+void QpSolverSettings::dump(std::ostream & os) const
+{
+  os << "profile: " << std::to_string(profile_) << std::endl;
+  os << "abs_tol: " << abs_tol_ << std::endl;
+  os << "rel_tol: " << rel_tol_ << std::endl;
+  os << "max_iter: " << max_iter_ << std::endl;
+  os << "verbose: " << verbose_ << std::endl;
+  os << "presolve: " << presolve_ << std::endl;
+  os << "reuse_obj_mat_factor: " << reuse_obj_mat_factor_ << std::endl;
+  os << "obj_mat_fixed: " << obj_mat_fixed_ << std::endl;
+  os << "warm_start_by_id: " << warm_start_by_id_ << std::endl;
+  for(const auto & param : params_)
+  {
+    os << "param." << param.first << ": " << param.second << std::endl;
+  }
+}
+
+size_t QpSolverSettings::hash() const
+{
+  size_t hash = static_cast<size_t>(profile_);
+  hashCombineDouble(hash, abs_tol_);
+  hashCombineDouble(hash, rel_tol_);
+  hashCombine(hash, static_cast<size_t>(max_iter_));
+  hashCombine(hash, (static_cast<size_t>(verbose_) << 0) | (static_cast<size_t>(presolve_) << 1)
+                        | (static_cast<size_t>(reuse_obj_mat_factor_) << 2) | (static_cast<size_t>(obj_mat_fixed_) << 3)
+                        | (static_cast<size_t>(warm_start_by_id_) << 4));
+  for(const auto & param : params_)
+  {
+    hashCombine(hash, std::hash<std::string>{}(param.first));
+    hashCombineDouble(hash, param.second);
+  }
+  return hash;
+}
+
+bool QpSolverSettings::load(std::istream & is)
+{
+  // Read "key: value" lines until an empty line or the end of stream
+  std::string line;
+  while(std::getline(is, line) && !line.empty())
+  {
+    std::istringstream line_ss(line);
+    std::string key, value_str;
+    if(!(line_ss >> key >> value_str) || key.back() != ':')
+    {
+      QSC_WARN_STREAM("[QpSolverSettings::load] Invalid line: " << line);
+      return false;
+    }
+    key.pop_back();
+
+    if(key == "profile")
+    {
+      profile_ = strToQpAccuracyProfile(value_str);
+      continue;
+    }
+
+    char * end = nullptr;
+    double value = std::strtod(value_str.c_str(), &end);
+    if(end == value_str.c_str() || *end != '\0')
+    {
+      QSC_WARN_STREAM("[QpSolverSettings::load] Invalid value: " << line);
+      return false;
+    }
+    if(key == "abs_tol")
+    {
+      abs_tol_ = value;
+    }
+    else if(key == "rel_tol")
+    {
+      rel_tol_ = value;
+    }
+    else if(key == "max_iter")
+    {
+      max_iter_ = static_cast<int>(value);
+    }
+    else if(key == "verbose")
+    {
+      verbose_ = (value != 0);
+    }
+    else if(key == "presolve")
+    {
+      presolve_ = (value != 0);
+    }
+    else if(key == "reuse_obj_mat_factor")
+    {
+      reuse_obj_mat_factor_ = (value != 0);
+    }
+    else if(key == "obj_mat_fixed")
+    {
+      obj_mat_fixed_ = (value != 0);
+    }
+    else if(key == "warm_start_by_id")
+    {
+      warm_start_by_id_ = (value != 0);
+    }
+    else if(key.compare(0, 6, "param.") == 0)
+    {
+      params_[key.substr(6)] = value;
+    }
+    else
+    {
+      QSC_WARN_STREAM("[QpSolverSettings::load] Unknown key: " << key);
+    }
+  }
+
+  return true;
+}
+
+void QpSolverCollection::saveSettingsProfile(const std::string & path,
+                                             const std::map<QpSolverType, QpSolverSettings> & settings_profile)
+{
+  std::ofstream ofs(path);
+  ofs.precision(std::numeric_limits<double>::max_digits10);
+  for(const auto & settings_kv : settings_profile)
+  {
+    ofs << "solver: " << qpSolverName(settings_kv.first) << std::endl;
+    settings_kv.second.dump(ofs);
+    ofs << std::endl;
+  }
+}
+
+std::map<QpSolverType, QpSolverSettings> QpSolverCollection::loadSettingsProfile(const std::string & path)
+{
+  std::ifstream ifs(path);
+  if(!ifs)
+  {
+    throw std::runtime_error("[loadSettingsProfile] Failed to open file: " + path);
+  }
+
+  std::map<QpSolverType, QpSolverSettings> settings_profile;
+  std::string line;
+  while(std::getline(ifs, line))
+  {
+    if(line.empty())
+    {
+      continue;
+    }
+    std::istringstream line_ss(line);
+    std::string key, name;
+    if(!(line_ss >> key >> name) || key != "solver:")
+    {
+      throw std::runtime_error("[loadSettingsProfile] Invalid line: " + line);
+    }
+    QpSolverSettings settings;
+    if(!settings.load(ifs))
+    {
+      throw std::runtime_error("[loadSettingsProfile] Failed to load settings of " + name);
+    }
+    settings_profile[strToQpSolverType(name)] = settings;
+  }
+
+  return settings_profile;
+}
+
+void KktResidual::printInfo(bool, const std::string & header) const
+{
+  QSC_INFO_STREAM(header << "primal_feas: " << primal_feas_ << ", dual_feas: " << dual_feas_
+                         << ", complementarity: " << complementarity_ << ", duality_gap: " << duality_gap_);
+}
+
+QpSolveStatus QpSolverCollection::presolveQp(const Eigen::Ref<const Eigen::MatrixXd> & A,
+                                             const Eigen::Ref<const Eigen::VectorXd> & b,
+                                             const Eigen::Ref<const Eigen::MatrixXd> & C,
+                                             const Eigen::Ref<const Eigen::VectorXd> & d,
+                                             const Eigen::Ref<const Eigen::VectorXd> & x_min,
+                                             const Eigen::Ref<const Eigen::VectorXd> & x_max,
+                                             double tol)
+{
+  // NaN in constraints (infinite values are allowed for absent bounds)
+  if(A.hasNaN() || b.hasNaN() || C.hasNaN() || d.hasNaN() || x_min.hasNaN() || x_max.hasNaN())
+  {
+    return QpSolveStatus::InvalidInput;
+  }
+
+  // Crossed bounds
+  if((x_min.array() > x_max.array() + tol).any())
+  {
+    return QpSolveStatus::PrimalInfeasible;
+  }
+
+  // Zero rows of constraint matrices
+  for(Eigen::Index i = 0; i < A.rows(); i++)
+  {
+    if(A.row(i).isZero(0) && std::abs(b[i]) > tol)
+    {
+      return QpSolveStatus::PrimalInfeasible;
+    }
+  }
+  for(Eigen::Index i = 0; i < C.rows(); i++)
+  {
+    if(C.row(i).isZero(0) && d[i] < -tol)
+    {
+      return QpSolveStatus::PrimalInfeasible;
+    }
+  }
+
+  // Equality constraints are consistent if and only if the least-squares residual is zero
+  if(A.rows() > 0)
+  {
+    Eigen::ColPivHouseholderQR<Eigen::MatrixXd> qr(A);
+    if((A * qr.solve(b) - b).norm() > tol * (1.0 + b.norm()))
+    {
+      return QpSolveStatus::PrimalInfeasible;
+    }
+  }
+
+  return QpSolveStatus::Unsolved;
+}
+
+KktResidual QpSolverCollection::computeKkt(const QpCoeff & qp_coeff, const SolveResult & result)
+{
+  const int dim_var = qp_coeff.dim_var_;
+  const int dim_eq = qp_coeff.dim_eq_;
+  const int dim_ineq = qp_coeff.dim_ineq_;
+  const Eigen::VectorXd & x = result.x_;
+
+  KktResidual kkt;
+  if(x.size() != dim_var)
+  {
+    QSC_WARN_STREAM("[computeKkt] Dimension of solution is inconsistent: " << x.size() << " != " << dim_var);
+    kkt.primal_feas_ = std::numeric_limits<double>::infinity();
+    return kkt;
+  }
+
+  bool has_dual = result.hasDual();
+  if(has_dual && !(result.dual_eq_.size() == dim_eq && result.dual_ineq_.size() == dim_ineq))
+  {
+    QSC_WARN_STREAM("[computeKkt] Dimension of Lagrange multipliers is inconsistent. Ignore Lagrange multipliers.");
+    has_dual = false;
+  }
+
+  // Traverse Q, A, and C only once in column-major order
+  Eigen::VectorXd Ax = Eigen::VectorXd::Zero(dim_eq);
+  Eigen::VectorXd Cx = Eigen::VectorXd::Zero(dim_ineq);
+  double xQx = 0.0;
+  double stationarity = 0.0;
+  for(int j = 0; j < dim_var; j++)
+  {
+    double x_j = x[j];
+    double Qx_j = qp_coeff.obj_mat_.col(j).dot(x);
+    xQx += x_j * Qx_j;
+    Ax.noalias() += x_j * qp_coeff.eq_mat_.col(j);
+    Cx.noalias() += x_j * qp_coeff.ineq_mat_.col(j);
+    if(has_dual)
+    {
+      double grad_j = Qx_j + qp_coeff.obj_vec_[j] + qp_coeff.eq_mat_.col(j).dot(result.dual_eq_)
+                      + qp_coeff.ineq_mat_.col(j).dot(result.dual_ineq_) + result.dual_bound_[j];
+      stationarity = std::max(stationarity, std::abs(grad_j));
+    }
+  }
+  kkt.obj_ = 0.5 * xQx + qp_coeff.obj_vec_.dot(x);
+
+  // Primal feasibility
+  Eigen::VectorXd ineq_slack = qp_coeff.ineq_vec_ - Cx;
+  kkt.primal_feas_ = 0.0;
+  if(dim_eq > 0)
+  {
+    kkt.primal_feas_ = std::max(kkt.primal_feas_, (Ax - qp_coeff.eq_vec_).cwiseAbs().maxCoeff());
+  }
+  if(dim_ineq > 0)
+  {
+    kkt.primal_feas_ = std::max(kkt.primal_feas_, -1 * ineq_slack.minCoeff());
+  }
+  if(dim_var > 0)
+  {
+    kkt.primal_feas_ = std::max(kkt.primal_feas_, (qp_coeff.x_min_ - x).maxCoeff());
+    kkt.primal_feas_ = std::max(kkt.primal_feas_, (x - qp_coeff.x_max_).maxCoeff());
+  }
+
+  if(!has_dual)
+  {
+    return kkt;
+  }
+
+  // Dual feasibility, complementarity, and duality gap
+  double sign_violation = 0.0;
+  double complementarity = 0.0;
+  double dual_obj_const = qp_coeff.eq_vec_.dot(result.dual_eq_);
+  for(int i = 0; i < dim_ineq; i++)
+  {
+    double dual_i = result.dual_ineq_[i];
+    if(dual_i == 0.0)
+    {
+      continue;
+    }
+    sign_violation = std::max(sign_violation, -1 * dual_i);
+    complementarity = std::max(complementarity, std::abs(dual_i * ineq_slack[i]));
+    dual_obj_const += dual_i * qp_coeff.ineq_vec_[i];
+  }
+  for(int i = 0; i < dim_var; i++)
+  {
+    double dual_i = result.dual_bound_[i];
+    if(dual_i == 0.0)
+    {
+      continue;
+    }
+    double bound_i = (dual_i > 0 ? qp_coeff.x_max_[i] : qp_coeff.x_min_[i]);
+    if(std::abs(bound_i) >= std::numeric_limits<double>::max())
+    {
+      // Infinite bounds (including the default of QpCoeff::setup) are regarded as absent
+      continue;
+    }
+    complementarity = std::max(complementarity, std::abs(dual_i * (bound_i - x[i])));
+    dual_obj_const += dual_i * bound_i;
+  }
+  kkt.dual_feas_ = std::max(stationarity, sign_violation);
+  kkt.complementarity_ = complementarity;
+  // Dual objective is -0.5 x^T Q x - b^T lambda_eq - d^T lambda_ineq - (active bounds)^T lambda_bound
+  kkt.duality_gap_ = std::abs(kkt.obj_ + 0.5 * xQx + dual_obj_const);
+
+  return kkt;
 }
 
 void QpSolver::printInfo(bool, const std::string & header) const
@@ -101,9 +674,241 @@ void QpSolver::printInfo(bool, const std::string & header) const
 
 Eigen::VectorXd QpSolver::solve(QpCoeff & qp_coeff)
 {
-  return solve(qp_coeff.dim_var_, qp_coeff.dim_eq_, qp_coeff.dim_ineq_, qp_coeff.obj_mat_, qp_coeff.obj_vec_,
-               qp_coeff.eq_mat_, qp_coeff.eq_vec_, qp_coeff.ineq_mat_, qp_coeff.ineq_vec_, qp_coeff.x_min_,
-               qp_coeff.x_max_);
+  bool use_element_ids = settings_.warm_start_by_id_ && !qp_coeff.element_ids_.empty();
+  if(use_element_ids && !qp_coeff.element_ids_.isValid(qp_coeff.dim_var_, qp_coeff.dim_eq_, qp_coeff.dim_ineq_))
+  {
+    throw std::invalid_argument("[QpSolver::solve] Numbers of identifiers are inconsistent with QP.");
+  }
+
+  // The blocks are compared only if no other QP has been solved since the previous solve of the same instance
+  unsigned int unchanged_block_mask = 0;
+  if(qp_coeff.track_modification_ && qp_coeff.id() == last_coeff_id_ && solve_count_ == last_coeff_solve_count_)
+  {
+    for(int i = 0; i < QpCoeff::block_num; i++)
+    {
+      if(qp_coeff.generationList()[i] == last_coeff_generation_list_[i])
+      {
+        unchanged_block_mask |= (1u << i);
+      }
+    }
+  }
+  // The mask is cleared even if the QP solver throws so that it does not affect the solves of raw matrices
+  ScopedValue<unsigned int> unchanged_block_mask_scope(unchanged_block_mask_, unchanged_block_mask);
+
+  // The solution of the previous QP is remapped only if the initial guess is not given explicitly. The pointer to the
+  // local variable is reset even if the QP solver throws.
+  WarmStart remapped_warm_start;
+  ScopedValue<const WarmStart *> warm_start_scope(warm_start_, warm_start_);
+  if(use_element_ids && !warm_start_ && !last_element_ids_.empty())
+  {
+    remapped_warm_start = remapWarmStart(last_id_result_, last_element_ids_, qp_coeff);
+    warm_start_ = &remapped_warm_start;
+  }
+
+  // The previous QP coefficient is forgotten until the solve succeeds since the QP solver may be updated partially
+  last_coeff_id_ = 0;
+  Eigen::VectorXd x = solve(qp_coeff.dim_var_, qp_coeff.dim_eq_, qp_coeff.dim_ineq_, qp_coeff.obj_mat_,
+                            qp_coeff.obj_vec_, qp_coeff.eq_mat_, qp_coeff.eq_vec_, qp_coeff.ineq_mat_,
+                            qp_coeff.ineq_vec_, qp_coeff.x_min_, qp_coeff.x_max_);
+  if(!solve_failed_)
+  {
+    last_coeff_id_ = qp_coeff.id();
+    last_coeff_solve_count_ = solve_count_;
+    last_coeff_generation_list_ = qp_coeff.generationList();
+  }
+  if(use_element_ids && !solve_failed_)
+  {
+    last_id_result_.x_ = x;
+    last_id_result_.dual_eq_ = dual_eq_;
+    last_id_result_.dual_ineq_ = dual_ineq_;
+    last_id_result_.dual_bound_ = dual_bound_;
+    last_element_ids_ = qp_coeff.element_ids_;
+  }
+  return x;
+}
+
+Eigen::VectorXd QpSolver::solve(int dim_var,
+                                int dim_eq,
+                                int dim_ineq,
+                                Eigen::Ref<Eigen::MatrixXd> Q,
+                                const Eigen::Ref<const Eigen::VectorXd> & c,
+                                const Eigen::Ref<const Eigen::MatrixXd> & A,
+                                const Eigen::Ref<const Eigen::VectorXd> & b,
+                                const Eigen::Ref<const Eigen::MatrixXd> & C,
+                                const Eigen::Ref<const Eigen::VectorXd> & d,
+                                const Eigen::Ref<const Eigen::VectorXd> & x_min,
+                                const Eigen::Ref<const Eigen::VectorXd> & x_max,
+                                const WarmStart & warm_start)
+{
+  if(!warm_start.isValid(dim_var, dim_eq, dim_ineq))
+  {
+    throw std::invalid_argument("[QpSolver::solve] Dimensions of warm start are inconsistent with QP.");
+  }
+
+  ScopedValue<const WarmStart *> warm_start_scope(warm_start_, &warm_start);
+  return solve(dim_var, dim_eq, dim_ineq, Q, c, A, b, C, d, x_min, x_max);
+}
+
+Eigen::VectorXd QpSolver::solve(QpCoeff & qp_coeff, const WarmStart & warm_start)
+{
+  if(!warm_start.isValid(qp_coeff.dim_var_, qp_coeff.dim_eq_, qp_coeff.dim_ineq_))
+  {
+    throw std::invalid_argument("[QpSolver::solve] Dimensions of warm start are inconsistent with QP.");
+  }
+
+  ScopedValue<const WarmStart *> warm_start_scope(warm_start_, &warm_start);
+  return solve(qp_coeff);
+}
+
+void QpSolver::setSettings(const QpSolverSettings & settings)
+{
+  settings_ = settings;
+  settings_updated_ = true;
+}
+
+bool QpSolver::loadSettings(const std::string & path)
+{
+  auto settings_profile = loadSettingsProfile(path);
+  auto it = settings_profile.find(type_);
+  if(it == settings_profile.end())
+  {
+    QSC_WARN_STREAM("[QpSolver::loadSettings] Settings of " << std::to_string(type_) << " are not found in " << path);
+    return false;
+  }
+  setSettings(it->second);
+  return true;
+}
+
+SolveResult QpSolver::solveWithResult(QpCoeff & qp_coeff)
+{
+  SolveResult result;
+  result.x_ = solve(qp_coeff);
+  result.dual_eq_ = dual_eq_;
+  result.dual_ineq_ = dual_ineq_;
+  result.dual_bound_ = dual_bound_;
+  result.status_ = status_;
+  return result;
+}
+
+SolveResult QpSolver::solveWithResult(QpCoeff & qp_coeff, const WarmStart & warm_start)
+{
+  SolveResult result;
+  result.x_ = solve(qp_coeff, warm_start);
+  result.dual_eq_ = dual_eq_;
+  result.dual_ineq_ = dual_ineq_;
+  result.dual_bound_ = dual_bound_;
+  result.status_ = status_;
+  return result;
+}
+
+bool QpSolver::presolveFailed(const Eigen::Ref<const Eigen::MatrixXd> & A,
+                              const Eigen::Ref<const Eigen::VectorXd> & b,
+                              const Eigen::Ref<const Eigen::MatrixXd> & C,
+                              const Eigen::Ref<const Eigen::VectorXd> & d,
+                              const Eigen::Ref<const Eigen::VectorXd> & x_min,
+                              const Eigen::Ref<const Eigen::VectorXd> & x_max)
+{
+  if(!settings_.presolve_)
+  {
+    return false;
+  }
+
+  QpSolveStatus status = presolveQp(A, b, C, d, x_min, x_max);
+  if(status == QpSolveStatus::Unsolved)
+  {
+    return false;
+  }
+
+  status_ = status;
+  solve_failed_ = true;
+  iter_num_ = 0;
+  dual_eq_.resize(0);
+  dual_ineq_.resize(0);
+  dual_bound_.resize(0);
+  QSC_WARN_STREAM("[QpSolver::solve] QP is rejected by presolve: " << std::to_string(status));
+  return true;
+}
+
+size_t QpSolver::memoryUsage() const
+{
+  // Nodes of std::map hold a key-value pair and three pointers with a color flag
+  size_t params_size = settings_.params_.size() * (sizeof(std::pair<const std::string, double>) + 4 * sizeof(void *));
+  for(const auto & param : settings_.params_)
+  {
+    params_size += param.first.capacity();
+  }
+  size_t last_id_result_size = matrixMemoryUsage(last_id_result_.x_) + matrixMemoryUsage(last_id_result_.dual_eq_)
+                               + matrixMemoryUsage(last_id_result_.dual_ineq_)
+                               + matrixMemoryUsage(last_id_result_.dual_bound_);
+  size_t last_element_ids_size =
+      sizeof(int64_t)
+      * (last_element_ids_.var_id_list_.capacity() + last_element_ids_.eq_id_list_.capacity()
+         + last_element_ids_.ineq_id_list_.capacity());
+  return sizeof(QpSolver) + params_size + matrixMemoryUsage(dual_eq_) + matrixMemoryUsage(dual_ineq_)
+         + matrixMemoryUsage(dual_bound_) + matrixMemoryUsage(last_obj_mat_) + matrixMemoryUsage(obj_mat_factor_)
+         + last_id_result_size + last_element_ids_size;
+}
+
+size_t QpSolver::configHash() const
+{
+  size_t hash = static_cast<size_t>(type_);
+  hashCombine(hash, settings_.hash());
+  return hash;
+}
+
+bool QpSolver::objMatUnchanged(const Eigen::Ref<const Eigen::MatrixXd> & Q)
+{
+  if(!settings_.reuse_obj_mat_factor_)
+  {
+    last_obj_mat_.resize(0, 0);
+    return false;
+  }
+  if(last_obj_mat_.rows() == Q.rows() && last_obj_mat_.cols() == Q.cols()
+     && (settings_.obj_mat_fixed_ || coeffUnchanged(QpCoeff::Block::ObjMat) || last_obj_mat_ == Q))
+  {
+    return true;
+  }
+  last_obj_mat_ = Q;
+  return false;
+}
+
+Eigen::MatrixXd * QpSolver::objMatFactor(const Eigen::Ref<const Eigen::MatrixXd> & Q, bool upper, bool inverse)
+{
+  if(!settings_.reuse_obj_mat_factor_)
+  {
+    obj_mat_factor_.resize(0, 0);
+    obj_mat_factor_valid_ = false;
+    return nullptr;
+  }
+
+  // The objective matrix that is not positive definite is not refactorized either while it is unchanged
+  if(!objMatUnchanged(Q))
+  {
+    Eigen::LLT<Eigen::MatrixXd> llt(Q);
+    obj_mat_factor_valid_ = (llt.info() == Eigen::Success);
+    if(!obj_mat_factor_valid_)
+    {
+      obj_mat_factor_.resize(0, 0);
+    }
+    else if(inverse)
+    {
+      obj_mat_factor_.setIdentity(Q.rows(), Q.cols());
+      if(upper)
+      {
+        llt.matrixU().solveInPlace(obj_mat_factor_);
+      }
+      else
+      {
+        llt.matrixL().solveInPlace(obj_mat_factor_);
+      }
+    }
+    else
+    {
+      obj_mat_factor_ = upper ? Eigen::MatrixXd(llt.matrixU()) : Eigen::MatrixXd(llt.matrixL());
+    }
+  }
+
+  return obj_mat_factor_valid_ ? &obj_mat_factor_ : nullptr;
 }
 
 QpSolverType QpSolverCollection::getAnyQpSolverType()
@@ -150,8 +955,7 @@ QpSolverType QpSolverCollection::getAnyQpSolverType()
   }
   else
   {
-    throw std::runtime_error("[getAnyQpSolverType] No QP solver is enabled.");
-    return QpSolverType::Uninitialized;
+    return QpSolverType::Builtin;
   }
 }
 
@@ -201,6 +1005,10 @@ bool QpSolverCollection::isQpSolverEnabled(const QpSolverType & qp_solver_type)
   {
     return ENABLE_QPMAD;
   }
+  else if(qp_solver_type == QpSolverType::Builtin)
+  {
+    return true;
+  }
   else
   {
     QSC_ERROR_STREAM("[isQpSolverEnabled] Unsupported QP solver: " << std::to_string(static_cast<int>(qp_solver_type)));
@@ -240,6 +1048,7 @@ std::shared_ptr<QpSolver> allocateQpSolverProxqp();
 #if ENABLE_QPMAD
 std::shared_ptr<QpSolver> allocateQpSolverQpmad();
 #endif
+std::shared_ptr<QpSolver> allocateQpSolverBuiltin();
 } // namespace QpSolverCollection
 
 std::shared_ptr<QpSolver> QpSolverCollection::allocateQpSolver(const QpSolverType & qp_solver_type)
@@ -310,6 +1119,10 @@ std::shared_ptr<QpSolver> QpSolverCollection::allocateQpSolver(const QpSolverTyp
     qp = allocateQpSolverQpmad();
 #endif
   }
+  else if(qp_solver_type == QpSolverType::Builtin)
+  {
+    qp = allocateQpSolverBuiltin();
+  }
   else
   {
     QSC_ERROR_STREAM("[allocateQpSolver] Unsupported QP solver: " << std::to_string(static_cast<int>(qp_solver_type)));
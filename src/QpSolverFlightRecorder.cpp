@@ -0,0 +1,286 @@
+/* Author: Masaki Murooka */
+
+#include <algorithm>
+#include <sstream>
+#include <stdexcept>
+
+#include <qp_solver_collection/QpSolverFlightRecorder.h>
+
+using namespace QpSolverCollection;
+
+namespace
+{
+/** \brief Get the name of QP solver type without the prefix (e.g., "OSQP"). */
+std::string qpSolverName(QpSolverType qp_solver_type)
+{
+  std::string name = std::to_string(qp_solver_type);
+  std::size_t pos = name.find("::");
+  return pos == std::string::npos ? name : name.substr(pos + 2);
+}
+} // namespace
+
+void QpFlightRecord::dump(std::ofstream & ofs) const
+{
+  ofs << "qp_solver_type: " << qpSolverName(qp_solver_type_) << std::endl;
+  ofs << "seq: " << seq_ << std::endl;
+  ofs << "status: " << std::to_string(status_) << std::endl;
+  ofs << "solve_failed: " << solve_failed_ << std::endl;
+  ofs << "duration: " << duration_ << std::endl;
+  ofs << std::endl;
+  settings_.dump(ofs);
+  ofs << std::endl;
+  qp_coeff_.dump(ofs);
+}
+
+bool QpFlightRecord::load(std::istream & is)
+{
+  // Read "key: value" lines of the header until an empty line
+  std::string line;
+  while(std::getline(is, line) && !line.empty())
+  {
+    std::istringstream line_ss(line);
+    std::string key, value_str;
+    if(!(line_ss >> key >> value_str))
+    {
+      QSC_WARN_STREAM("[QpFlightRecord::load] Invalid line: " << line);
+      return false;
+    }
+    if(key == "qp_solver_type:")
+    {
+      qp_solver_type_ = strToQpSolverType(value_str);
+    }
+    else if(key == "seq:")
+    {
+      seq_ = std::stoull(value_str);
+    }
+    else if(key == "status:")
+    {
+      for(int i = static_cast<int>(QpSolveStatus::Unsolved); i <= static_cast<int>(QpSolveStatus::Unknown); i++)
+      {
+        if(std::to_string(static_cast<QpSolveStatus>(i)) == value_str)
+        {
+          status_ = static_cast<QpSolveStatus>(i);
+        }
+      }
+    }
+    else if(key == "solve_failed:")
+    {
+      solve_failed_ = (std::stoi(value_str) != 0);
+    }
+    else if(key == "duration:")
+    {
+      duration_ = std::stod(value_str);
+    }
+  }
+
+  if(!settings_.load(is))
+  {
+    QSC_WARN_STREAM("[QpFlightRecord::load] Failed to load settings.");
+    return false;
+  }
+  return qp_coeff_.load(is);
+}
+
+QpSolverFlightRecorder::QpSolverFlightRecorder(const QpSolverType & qp_solver_type,
+                                               const std::string & output_dir,
+                                               size_t history_size)
+: QpSolverFlightRecorder(allocateQpSolver(qp_solver_type), output_dir, history_size)
+{
+}
+
+QpSolverFlightRecorder::QpSolverFlightRecorder(const std::shared_ptr<QpSolver> & qp_solver,
+                                               const std::string & output_dir,
+                                               size_t history_size)
+: backend_(qp_solver), output_dir_(output_dir), history_list_(std::max<size_t>(history_size, 1))
+{
+  if(!backend_)
+  {
+    throw std::runtime_error("[QpSolverFlightRecorder] Backend QP solver instance is null.");
+  }
+  type_ = backend_->type();
+
+  static std::atomic<int> recorder_count{0};
+  recorder_id_ = recorder_count++;
+
+  thread_ = std::thread(&QpSolverFlightRecorder::writerLoop, this);
+}
+
+QpSolverFlightRecorder::~QpSolverFlightRecorder()
+{
+  {
+    std::lock_guard<std::mutex> lock(mtx_);
+    stop_ = true;
+  }
+  cv_.notify_all();
+  thread_.join();
+}
+
+Eigen::VectorXd QpSolverFlightRecorder::solve(int dim_var,
+                                              int dim_eq,
+                                              int dim_ineq,
+                                              Eigen::Ref<Eigen::MatrixXd> Q,
+                                              const Eigen::Ref<const Eigen::VectorXd> & c,
+                                              const Eigen::Ref<const Eigen::MatrixXd> & A,
+                                              const Eigen::Ref<const Eigen::VectorXd> & b,
+                                              const Eigen::Ref<const Eigen::MatrixXd> & C,
+                                              const Eigen::Ref<const Eigen::VectorXd> & d,
+                                              const Eigen::Ref<const Eigen::VectorXd> & x_min,
+                                              const Eigen::Ref<const Eigen::VectorXd> & x_max)
+{
+  // Copy the QP before solving since some QP solvers overwrite Q (the memory is reused if the size is the same)
+  QpFlightRecord & record = history_list_[record_count_ % history_list_.size()];
+  record.qp_solver_type_ = backend_->type();
+  record.seq_ = record_count_;
+  record.qp_coeff_.dim_var_ = dim_var;
+  record.qp_coeff_.dim_eq_ = dim_eq;
+  record.qp_coeff_.dim_ineq_ = dim_ineq;
+  record.qp_coeff_.obj_mat_ = Q;
+  record.qp_coeff_.obj_vec_ = c;
+  record.qp_coeff_.eq_mat_ = A;
+  record.qp_coeff_.eq_vec_ = b;
+  record.qp_coeff_.ineq_mat_ = C;
+  record.qp_coeff_.ineq_vec_ = d;
+  record.qp_coeff_.x_min_ = x_min;
+  record.qp_coeff_.x_max_ = x_max;
+  record_count_++;
+
+  auto start_time = clock::now();
+  Eigen::VectorXd x = warm_start_
+                          ? backend_->solve(dim_var, dim_eq, dim_ineq, Q, c, A, b, C, d, x_min, x_max, *warm_start_)
+                          : backend_->solve(dim_var, dim_eq, dim_ineq, Q, c, A, b, C, d, x_min, x_max);
+  record.duration_ =
+      1e3 * std::chrono::duration_cast<std::chrono::duration<double>>(clock::now() - start_time).count();
+  solve_failed_ = backend_->solveFailed();
+  status_ = backend_->status();
+  iter_num_ = backend_->iterNum();
+  dual_eq_ = backend_->dualEq();
+  dual_ineq_ = backend_->dualIneq();
+  dual_bound_ = backend_->dualBound();
+  record.status_ = status_;
+  record.solve_failed_ = solve_failed_;
+
+  if((persist_failure_ && solve_failed_) || (latency_threshold_ > 0 && record.duration_ > latency_threshold_))
+  {
+    persist(record);
+  }
+
+  return x;
+}
+
+void QpSolverFlightRecorder::setSettings(const QpSolverSettings & settings)
+{
+  QpSolver::setSettings(settings);
+  backend_->setSettings(settings);
+}
+
+size_t QpSolverFlightRecorder::memoryUsage() const
+{
+  size_t memory_usage = QpSolver::memoryUsage() + sizeof(*this) - sizeof(QpSolver) + backend_->memoryUsage();
+  for(const auto & record : history_list_)
+  {
+    const QpCoeff & qp_coeff = record.qp_coeff_;
+    memory_usage += sizeof(QpFlightRecord) + matrixMemoryUsage(qp_coeff.obj_mat_)
+                    + matrixMemoryUsage(qp_coeff.obj_vec_) + matrixMemoryUsage(qp_coeff.eq_mat_)
+                    + matrixMemoryUsage(qp_coeff.eq_vec_) + matrixMemoryUsage(qp_coeff.ineq_mat_)
+                    + matrixMemoryUsage(qp_coeff.ineq_vec_) + matrixMemoryUsage(qp_coeff.x_min_)
+                    + matrixMemoryUsage(qp_coeff.x_max_);
+  }
+  return memory_usage;
+}
+
+size_t QpSolverFlightRecorder::configHash() const
+{
+  return backend_->configHash();
+}
+
+void QpSolverFlightRecorder::preallocate(int dim_var, int dim_eq, int dim_ineq)
+{
+  for(auto & record : history_list_)
+  {
+    record.qp_coeff_.setup(dim_var, dim_eq, dim_ineq);
+  }
+}
+
+size_t QpSolverFlightRecorder::persistHistory()
+{
+  size_t persist_num = 0;
+  for(const auto & record : history())
+  {
+    if(persist(record))
+    {
+      persist_num++;
+    }
+  }
+  return persist_num;
+}
+
+void QpSolverFlightRecorder::flush()
+{
+  std::unique_lock<std::mutex> lock(mtx_);
+  cv_.wait(lock, [this]() { return pending_list_.empty() && !writing_; });
+}
+
+std::vector<QpFlightRecord> QpSolverFlightRecorder::history() const
+{
+  std::vector<QpFlightRecord> record_list;
+  uint64_t history_num = std::min<uint64_t>(record_count_, history_list_.size());
+  for(uint64_t seq = record_count_ - history_num; seq < record_count_; seq++)
+  {
+    record_list.push_back(history_list_[seq % history_list_.size()]);
+    record_list.back().settings_ = settings_;
+  }
+  return record_list;
+}
+
+bool QpSolverFlightRecorder::persist(const QpFlightRecord & record)
+{
+  if(persist_request_count_ >= max_persist_num_)
+  {
+    return false;
+  }
+  persist_request_count_++;
+
+  // The record is copied since the slot of the ring buffer is overwritten by the following solves
+  {
+    std::lock_guard<std::mutex> lock(mtx_);
+    pending_list_.push_back(record);
+    pending_list_.back().settings_ = settings_;
+  }
+  cv_.notify_all();
+  return true;
+}
+
+void QpSolverFlightRecorder::writerLoop()
+{
+  std::unique_lock<std::mutex> lock(mtx_);
+  while(true)
+  {
+    cv_.wait(lock, [this]() { return stop_ || !pending_list_.empty(); });
+    // Pending records are written before stopping
+    if(pending_list_.empty())
+    {
+      break;
+    }
+    QpFlightRecord record = std::move(pending_list_.front());
+    pending_list_.pop_front();
+    writing_ = true;
+    lock.unlock();
+
+    std::string path = output_dir_ + "/qp_" + qpSolverName(record.qp_solver_type_) + "_"
+                       + std::to_string(recorder_id_) + "_" + std::to_string(record.seq_) + ".txt";
+    std::ofstream ofs(path);
+    if(ofs)
+    {
+      record.dump(ofs);
+      persisted_count_++;
+    }
+    else
+    {
+      QSC_ERROR_STREAM("[QpSolverFlightRecorder] Failed to open file: " << path);
+    }
+
+    lock.lock();
+    writing_ = false;
+    cv_.notify_all();
+  }
+}
@@ -3,9 +3,12 @@
 #include <qp_solver_collection/QpSolverOptions.h>
 
 #if ENABLE_HPIPM
+#  include <algorithm>
 #  include <numeric>
 
 #  include <qp_solver_collection/QpSolverCollection.h>
+#  include <qp_solver_collection/QpSolverMetrics.h>
+#  include <qp_solver_collection/QpSolverTrace.h>
 
 #  include <hpipm_d_dense_qp_ipm.h>
 
@@ -33,8 +36,18 @@ Eigen::VectorXd QpSolverHpipm::solve(int dim_var,
                                      const Eigen::Ref<const Eigen::VectorXd> & x_min,
                                      const Eigen::Ref<const Eigen::VectorXd> & x_max)
 {
+  QSC_TRACE_SCOPE("QpSolverHpipm::solve");
+  QpMetricsGuard metrics_guard(*this, dim_var);
+  setLastDimension(dim_var, dim_eq, dim_ineq);
+
+  if(presolveFailed(A, b, C, d, x_min, x_max))
+  {
+    return Eigen::VectorXd::Zero(dim_var);
+  }
+
+  QSC_TRACE_PHASE("init");
   // Allocate memory
-  if(!(qp_dim_->nv == dim_var && qp_dim_->ne == dim_eq && qp_dim_->ng == dim_ineq))
+  if(settings_updated_ || !(qp_dim_->nv == dim_var && qp_dim_->ne == dim_eq && qp_dim_->ng == dim_ineq))
   {
     int qp_dim_size = d_dense_qp_dim_memsize();
     qp_dim_mem_ = std::make_unique<uint8_t[]>(qp_dim_size);
@@ -52,16 +65,42 @@ Eigen::VectorXd QpSolverHpipm::solve(int dim_var,
     int ipm_arg_size = d_dense_qp_ipm_arg_memsize(qp_dim_.get());
     ipm_arg_mem_ = std::make_unique<uint8_t[]>(ipm_arg_size);
     d_dense_qp_ipm_arg_create(qp_dim_.get(), ipm_arg_.get(), ipm_arg_mem_.get());
-    enum hpipm_mode mode = SPEED; // SPEED_ABS, SPEED, BALANCE, ROBUST
+    enum hpipm_mode mode = settings_.byProfile(SPEED_ABS, SPEED, ROBUST); // SPEED_ABS, SPEED, BALANCE, ROBUST
+    double value;
+    if(settings_.param("mode", value))
+    {
+      mode = static_cast<enum hpipm_mode>(static_cast<int>(value));
+    }
     d_dense_qp_ipm_arg_set_default(mode, ipm_arg_.get());
+    if(settings_.param("mu0", value))
+    {
+      d_dense_qp_ipm_arg_set_mu0(&value, ipm_arg_.get());
+    }
+    if(settings_.abs_tol_ > 0)
+    {
+      double tol = settings_.abs_tol_;
+      d_dense_qp_ipm_arg_set_tol_stat(&tol, ipm_arg_.get());
+      d_dense_qp_ipm_arg_set_tol_eq(&tol, ipm_arg_.get());
+      d_dense_qp_ipm_arg_set_tol_ineq(&tol, ipm_arg_.get());
+      d_dense_qp_ipm_arg_set_tol_comp(&tol, ipm_arg_.get());
+    }
+    if(settings_.max_iter_ > 0)
+    {
+      int iter_max = settings_.max_iter_;
+      d_dense_qp_ipm_arg_set_iter_max(&iter_max, ipm_arg_.get());
+    }
+    settings_updated_ = false;
 
     int ipm_ws_size = d_dense_qp_ipm_ws_memsize(qp_dim_.get(), ipm_arg_.get());
     ipm_ws_mem_ = std::make_unique<uint8_t[]>(ipm_ws_size);
     d_dense_qp_ipm_ws_create(qp_dim_.get(), ipm_arg_.get(), ipm_ws_.get(), ipm_ws_mem_.get());
 
     opt_x_mem_ = std::make_unique<double[]>(dim_var); // Automatic memory management for the array
+
+    hpipm_mem_size_ = static_cast<size_t>(qp_dim_size + qp_size + qp_sol_size + ipm_arg_size + ipm_ws_size);
   }
 
+  QSC_TRACE_PHASE("setup");
   // Set QP coefficients
   {
     d_dense_qp_set_H(Q.data(), qp_.get());
@@ -79,27 +118,94 @@ Eigen::VectorXd QpSolverHpipm::solve(int dim_var,
     d_dense_qp_set_ub(const_cast<double *>(x_max.cwiseMin(bound_limit_).eval().data()), qp_.get());
   }
 
+  QSC_TRACE_PHASE("iterate");
   // Solve QP
   {
+    // HPIPM starts from the primal variable set in the solution (the Lagrange multipliers are not used since the slack
+    // variables are also required)
+    int warm_start = (warm_start_ ? 1 : 0);
+    d_dense_qp_ipm_arg_set_warm_start(&warm_start, ipm_arg_.get());
+    if(warm_start_)
+    {
+      d_dense_qp_sol_set_v(const_cast<double *>(warm_start_->x_.data()), qp_sol_.get());
+    }
     d_dense_qp_ipm_solve(qp_.get(), qp_sol_.get(), ipm_arg_.get(), ipm_ws_.get());
     d_dense_qp_sol_get_v(qp_sol_.get(), opt_x_mem_.get());
+    d_dense_qp_ipm_get_iter(ipm_ws_.get(), &iter_num_);
 
+    QSC_TRACE_PHASE("postprocess");
     int status;
     d_dense_qp_ipm_get_status(ipm_ws_.get(), &status);
-    if(status == SUCCESS || status == MAX_ITER) // enum hpipm_status
+    switch(status) // enum hpipm_status
     {
-      solve_failed_ = false;
+      case SUCCESS:
+        status_ = QpSolveStatus::Solved;
+        solve_failed_ = false;
+        break;
+      case MAX_ITER:
+      {
+        // Infeasible QPs typically run up to the maximum number of iterations with large residuals
+        double res_stat, res_eq, res_ineq, res_comp;
+        d_dense_qp_ipm_get_max_res_stat(ipm_ws_.get(), &res_stat);
+        d_dense_qp_ipm_get_max_res_eq(ipm_ws_.get(), &res_eq);
+        d_dense_qp_ipm_get_max_res_ineq(ipm_ws_.get(), &res_ineq);
+        d_dense_qp_ipm_get_max_res_comp(ipm_ws_.get(), &res_comp);
+        status_ = QpSolveStatus::MaxIterReached;
+        solve_failed_ = !(std::max({res_stat, res_eq, res_ineq, res_comp}) <= max_iter_accept_tol_);
+        break;
+      }
+      case MIN_STEP:
+      case NAN_SOL:
+        status_ = QpSolveStatus::NumericalError;
+        solve_failed_ = true;
+        break;
+      default:
+        status_ = QpSolveStatus::Unknown;
+        solve_failed_ = true;
     }
-    else
+    if(solve_failed_)
     {
-      solve_failed_ = true;
-      QSC_WARN_STREAM("[QpSolverHpipm::solve] Failed to solve: " << status);
+      QSC_WARN_STREAM("[QpSolverHpipm::solve] Failed to solve: " << status << " (" << std::to_string(status_) << ")");
     }
   }
 
+  // Get Lagrange multipliers
+  {
+    Eigen::VectorXd pi(dim_eq);
+    Eigen::VectorXd lam_lb(dim_var);
+    Eigen::VectorXd lam_ub(dim_var);
+    Eigen::VectorXd lam_lg(dim_ineq);
+    Eigen::VectorXd lam_ug(dim_ineq);
+    d_dense_qp_sol_get_pi(qp_sol_.get(), pi.data());
+    d_dense_qp_sol_get_lam_lb(qp_sol_.get(), lam_lb.data());
+    d_dense_qp_sol_get_lam_ub(qp_sol_.get(), lam_ub.data());
+    d_dense_qp_sol_get_lam_lg(qp_sol_.get(), lam_lg.data());
+    d_dense_qp_sol_get_lam_ug(qp_sol_.get(), lam_ug.data());
+    // HPIPM multipliers of equality constraints have the opposite sign
+    dual_eq_ = -1 * pi;
+    dual_ineq_ = lam_ug - lam_lg;
+    dual_bound_ = lam_ub - lam_lb;
+  }
+
   return Eigen::Map<Eigen::VectorXd>(opt_x_mem_.get(), dim_var);
 }
 
+size_t QpSolverHpipm::memoryUsage() const
+{
+  size_t hpipm_size = sizeof(struct d_dense_qp_dim) + sizeof(struct d_dense_qp) + sizeof(struct d_dense_qp_sol)
+                      + sizeof(struct d_dense_qp_ipm_arg) + sizeof(struct d_dense_qp_ipm_ws) + hpipm_mem_size_
+                      + (opt_x_mem_ ? sizeof(double) * last_dim_var_ : 0);
+  return QpSolver::memoryUsage() + sizeof(*this) - sizeof(QpSolver) + hpipm_size;
+}
+
+size_t QpSolverHpipm::configHash() const
+{
+  size_t hash = QpSolver::configHash();
+  hashCombineDouble(hash, bound_limit_);
+  hashCombineDouble(hash, max_iter_accept_tol_);
+  return hash;
+}
+
 namespace QpSolverCollection
 {
 std::shared_ptr<QpSolver> allocateQpSolverHpipm()
@@ -6,6 +6,8 @@
 #  include <limits>
 
 #  include <qp_solver_collection/QpSolverCollection.h>
+#  include <qp_solver_collection/QpSolverMetrics.h>
+#  include <qp_solver_collection/QpSolverTrace.h>
 
 #  include <jrl-qp/GoldfarbIdnaniSolver.h>
 #  include <jrl-qp/utils/enumsIO.h>
@@ -30,6 +32,16 @@ Eigen::VectorXd QpSolverJrlqp::solve(int dim_var,
                                      const Eigen::Ref<const Eigen::VectorXd> & x_min,
                                      const Eigen::Ref<const Eigen::VectorXd> & x_max)
 {
+  QSC_TRACE_SCOPE("QpSolverJrlqp::solve");
+  QpMetricsGuard metrics_guard(*this, dim_var);
+  setLastDimension(dim_var, dim_eq, dim_ineq);
+
+  if(presolveFailed(A, b, C, d, x_min, x_max))
+  {
+    return Eigen::VectorXd::Zero(dim_var);
+  }
+
+  QSC_TRACE_PHASE("stack");
   Eigen::MatrixXd AC(dim_eq + dim_ineq, dim_var);
   Eigen::VectorXd bd_min(dim_eq + dim_ineq);
   Eigen::VectorXd bd_max(dim_eq + dim_ineq);
@@ -37,21 +49,62 @@ Eigen::VectorXd QpSolverJrlqp::solve(int dim_var,
   bd_min << b, Eigen::VectorXd::Constant(dim_ineq, -1 * std::numeric_limits<double>::infinity());
   bd_max << b, d;
 
+  QSC_TRACE_PHASE("factorize");
+  // JRLQP accepts the lower triangular Cholesky factor L (Q = L L^T) as a non-const reference
+  Eigen::MatrixXd * obj_mat_factor = objMatFactor(Q, false, false);
+
+  QSC_TRACE_PHASE("init");
   jrlqp_->resize(dim_var, dim_eq + dim_ineq, true);
 
+  jrl::qp::SolverOptions solver_option;
+  if(settings_.max_iter_ > 0)
+  {
+    solver_option.maxIter(settings_.max_iter_);
+  }
+  settings_updated_ = false;
   if(solve_failed_)
   {
     jrlqp_->resetActiveSet();
   }
   else
   {
-    jrl::qp::SolverOptions solver_option;
     solver_option.warmStart(true);
-    jrlqp_->options(solver_option);
   }
+  if(obj_mat_factor)
+  {
+    solver_option.gFactorization_ = jrl::qp::GFactorization::L;
+  }
+  jrlqp_->options(solver_option);
 
-  jrl::qp::TerminationStatus status = jrlqp_->solve(Q, c, AC.transpose(), bd_min, bd_max, x_min, x_max);
+  QSC_TRACE_PHASE("iterate");
+  jrl::qp::TerminationStatus status =
+      obj_mat_factor ? jrlqp_->solve(*obj_mat_factor, c, AC.transpose(), bd_min, bd_max, x_min, x_max)
+                     : jrlqp_->solve(Q, c, AC.transpose(), bd_min, bd_max, x_min, x_max);
 
+  QSC_TRACE_PHASE("postprocess");
+  switch(status)
+  {
+    case jrl::qp::TerminationStatus::SUCCESS:
+      status_ = QpSolveStatus::Solved;
+      break;
+    case jrl::qp::TerminationStatus::INCONSISTENT_INPUT:
+      status_ = QpSolveStatus::InvalidInput;
+      break;
+    case jrl::qp::TerminationStatus::NON_POS_HESSIAN:
+      status_ = QpSolveStatus::DualInfeasible;
+      break;
+    case jrl::qp::TerminationStatus::INFEASIBLE:
+      status_ = QpSolveStatus::PrimalInfeasible;
+      break;
+    case jrl::qp::TerminationStatus::MAX_ITER_REACHED:
+      status_ = QpSolveStatus::MaxIterReached;
+      break;
+    case jrl::qp::TerminationStatus::LINEAR_DEPENDENCY_DETECTED:
+      status_ = QpSolveStatus::NumericalError;
+      break;
+    default:
+      status_ = QpSolveStatus::Unknown;
+  }
   if(status == jrl::qp::TerminationStatus::SUCCESS)
   {
     solve_failed_ = false;
@@ -65,6 +118,16 @@ Eigen::VectorXd QpSolverJrlqp::solve(int dim_var,
   return jrlqp_->solution();
 }
 
+size_t QpSolverJrlqp::memoryUsage() const
+{
+  size_t n = last_dim_var_;
+  size_t m = last_dim_eq_ + last_dim_ineq_ + n;
+  // Factor of objective matrix, orthogonal basis, triangular factor of active set, and workspace of JRLQP
+  size_t jrlqp_size = sizeof(jrl::qp::GoldfarbIdnaniSolver)
+                      + sizeof(double) * (2 * n * n + n * (n + 1) / 2 + 6 * n + 4 * m) + sizeof(int) * (2 * m);
+  return QpSolver::memoryUsage() + sizeof(*this) - sizeof(QpSolver) + jrlqp_size;
+}
+
 namespace QpSolverCollection
 {
 std::shared_ptr<QpSolver> allocateQpSolverJrlqp()
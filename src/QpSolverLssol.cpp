@@ -7,6 +7,8 @@
 #  include <sstream>
 
 #  include <qp_solver_collection/QpSolverCollection.h>
+#  include <qp_solver_collection/QpSolverMetrics.h>
+#  include <qp_solver_collection/QpSolverTrace.h>
 
 #  include <eigen-lssol/LSSOL_QP.h>
 
@@ -30,6 +32,16 @@ Eigen::VectorXd QpSolverLssol::solve(int dim_var,
                                      const Eigen::Ref<const Eigen::VectorXd> & x_min,
                                      const Eigen::Ref<const Eigen::VectorXd> & x_max)
 {
+  QSC_TRACE_SCOPE("QpSolverLssol::solve");
+  QpMetricsGuard metrics_guard(*this, dim_var);
+  setLastDimension(dim_var, dim_eq, dim_ineq);
+
+  if(presolveFailed(A, b, C, d, x_min, x_max))
+  {
+    return Eigen::VectorXd::Zero(dim_var);
+  }
+
+  QSC_TRACE_PHASE("stack");
   Eigen::MatrixXd AC(dim_eq + dim_ineq, dim_var);
   Eigen::VectorXd bd_min(dim_eq + dim_ineq);
   Eigen::VectorXd bd_max(dim_eq + dim_ineq);
@@ -37,13 +49,37 @@ Eigen::VectorXd QpSolverLssol::solve(int dim_var,
   bd_min << b, Eigen::VectorXd::Constant(dim_ineq, -1 * std::numeric_limits<double>::infinity());
   bd_max << b, d;
 
+  QSC_TRACE_PHASE("init");
   lssol_->resize(dim_var, dim_eq + dim_ineq, Eigen::lssol::QP2);
 
   lssol_->persistence(!solve_failed_);
   lssol_->warm(!solve_failed_);
 
+  QSC_TRACE_PHASE("iterate");
   lssol_->solve(x_min, x_max, Q, c, AC, bd_min, bd_max);
 
+  QSC_TRACE_PHASE("postprocess");
+  // See the description of INFORM in the documentation of LSSOL
+  switch(static_cast<int>(lssol_->inform()))
+  {
+    case 0:
+      status_ = QpSolveStatus::Solved;
+      break;
+    case 2:
+      status_ = QpSolveStatus::DualInfeasible;
+      break;
+    case 3:
+      status_ = QpSolveStatus::PrimalInfeasible;
+      break;
+    case 4:
+      status_ = QpSolveStatus::MaxIterReached;
+      break;
+    case 6:
+      status_ = QpSolveStatus::InvalidInput;
+      break;
+    default:
+      status_ = QpSolveStatus::Unknown;
+  }
   if(lssol_->inform() == Eigen::lssol::STRONG_MINIMUM)
   {
     solve_failed_ = false;
@@ -59,6 +95,16 @@ Eigen::VectorXd QpSolverLssol::solve(int dim_var,
   return lssol_->result();
 }
 
+size_t QpSolverLssol::memoryUsage() const
+{
+  size_t n = last_dim_var_;
+  size_t m = last_dim_eq_ + last_dim_ineq_;
+  // Real and integer workspace (LENW and LENIW of QP2), solution, and multipliers of LSSOL
+  size_t lssol_size = sizeof(Eigen::LSSOL_QP) + sizeof(double) * (2 * n * n + 10 * n + 6 * m + 2 * (n + m))
+                      + sizeof(int) * (2 * (n + m));
+  return QpSolver::memoryUsage() + sizeof(*this) - sizeof(QpSolver) + lssol_size;
+}
+
 namespace QpSolverCollection
 {
 std::shared_ptr<QpSolver> allocateQpSolverLssol()
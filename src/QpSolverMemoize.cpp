@@ -0,0 +1,332 @@
+/* Author: Masaki Murooka */
+
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+#include <functional>
+#include <stdexcept>
+#include <typeinfo>
+
+#include <qp_solver_collection/QpSolverMemoize.h>
+
+using namespace QpSolverCollection;
+
+namespace
+{
+constexpr uint64_t prime1 = 0x9e3779b185ebca87ull;
+constexpr uint64_t prime2 = 0xc2b2ae3d27d4eb4full;
+constexpr uint64_t prime3 = 0x165667b19e3779f9ull;
+
+/** \brief Hasher that processes four 64-bit lanes independently so that the loop is vectorized. */
+class LaneHasher
+{
+public:
+  void update(uint64_t value)
+  {
+    acc_[0] = mix(acc_[0], value);
+  }
+
+  void update(const double * data, size_t size)
+  {
+    // Lanes are assigned by the position in the whole sequence so that the hash does not depend on the stride
+    size_t i = 0;
+    for(; i < size && pos_ % 4 != 0; i++)
+    {
+      updateOne(data[i]);
+    }
+    size_t block_end = i + (size - i) / 4 * 4;
+    for(; i < block_end; i += 4)
+    {
+      uint64_t word[4];
+      std::memcpy(word, data + i, sizeof(word));
+      for(int k = 0; k < 4; k++)
+      {
+        acc_[k] = mix(acc_[k], word[k]);
+      }
+      pos_ += 4;
+    }
+    for(; i < size; i++)
+    {
+      updateOne(data[i]);
+    }
+  }
+
+  void update(const Eigen::Ref<const Eigen::MatrixXd> & mat)
+  {
+    if(mat.outerStride() == mat.rows())
+    {
+      update(mat.data(), static_cast<size_t>(mat.size()));
+    }
+    else
+    {
+      for(Eigen::Index j = 0; j < mat.cols(); j++)
+      {
+        update(mat.col(j).data(), static_cast<size_t>(mat.rows()));
+      }
+    }
+  }
+
+  size_t digest() const
+  {
+    uint64_t hash = prime3 ^ pos_;
+    for(int k = 0; k < 4; k++)
+    {
+      hash = (hash ^ (acc_[k] * prime2)) * prime1;
+      hash ^= hash >> 31;
+    }
+    return static_cast<size_t>(hash);
+  }
+
+protected:
+  inline void updateOne(double value)
+  {
+    uint64_t word;
+    std::memcpy(&word, &value, sizeof(word));
+    acc_[pos_ % 4] = mix(acc_[pos_ % 4], word);
+    pos_++;
+  }
+
+  static inline uint64_t mix(uint64_t acc, uint64_t word)
+  {
+    acc = (acc ^ word) * prime1;
+    return acc ^ (acc >> 29);
+  }
+
+protected:
+  uint64_t acc_[4] = {prime1, prime2, prime3, prime1 ^ prime2};
+  size_t pos_ = 0;
+};
+
+/** \brief Whether the matrices are bitwise identical. */
+bool bitEqual(const Eigen::Ref<const Eigen::MatrixXd> & stored, const Eigen::Ref<const Eigen::MatrixXd> & mat)
+{
+  if(stored.rows() != mat.rows() || stored.cols() != mat.cols())
+  {
+    return false;
+  }
+  if(stored.outerStride() == stored.rows() && mat.outerStride() == mat.rows())
+  {
+    return std::memcmp(stored.data(), mat.data(), sizeof(double) * stored.size()) == 0;
+  }
+  for(Eigen::Index j = 0; j < mat.cols(); j++)
+  {
+    if(std::memcmp(stored.col(j).data(), mat.col(j).data(), sizeof(double) * stored.rows()) != 0)
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+/** \brief Whether the QP coefficients are bitwise identical. */
+bool bitEqual(const QpCoeff & qp_coeff1, const QpCoeff & qp_coeff2)
+{
+  return qp_coeff1.dim_var_ == qp_coeff2.dim_var_ && qp_coeff1.dim_eq_ == qp_coeff2.dim_eq_
+         && qp_coeff1.dim_ineq_ == qp_coeff2.dim_ineq_ && bitEqual(qp_coeff1.obj_mat_, qp_coeff2.obj_mat_)
+         && bitEqual(qp_coeff1.obj_vec_, qp_coeff2.obj_vec_) && bitEqual(qp_coeff1.eq_mat_, qp_coeff2.eq_mat_)
+         && bitEqual(qp_coeff1.eq_vec_, qp_coeff2.eq_vec_) && bitEqual(qp_coeff1.ineq_mat_, qp_coeff2.ineq_mat_)
+         && bitEqual(qp_coeff1.ineq_vec_, qp_coeff2.ineq_vec_) && bitEqual(qp_coeff1.x_min_, qp_coeff2.x_min_)
+         && bitEqual(qp_coeff1.x_max_, qp_coeff2.x_max_);
+}
+} // namespace
+
+size_t QpSolverCollection::computeQpHash(int dim_var,
+                                         int dim_eq,
+                                         int dim_ineq,
+                                         const Eigen::Ref<const Eigen::MatrixXd> & Q,
+                                         const Eigen::Ref<const Eigen::VectorXd> & c,
+                                         const Eigen::Ref<const Eigen::MatrixXd> & A,
+                                         const Eigen::Ref<const Eigen::VectorXd> & b,
+                                         const Eigen::Ref<const Eigen::MatrixXd> & C,
+                                         const Eigen::Ref<const Eigen::VectorXd> & d,
+                                         const Eigen::Ref<const Eigen::VectorXd> & x_min,
+                                         const Eigen::Ref<const Eigen::VectorXd> & x_max)
+{
+  LaneHasher hasher;
+  hasher.update((static_cast<uint64_t>(dim_var) << 42) ^ (static_cast<uint64_t>(dim_eq) << 21)
+                ^ static_cast<uint64_t>(dim_ineq));
+  hasher.update(Q);
+  hasher.update(c.data(), static_cast<size_t>(c.size()));
+  hasher.update(A);
+  hasher.update(b.data(), static_cast<size_t>(b.size()));
+  hasher.update(C);
+  hasher.update(d.data(), static_cast<size_t>(d.size()));
+  hasher.update(x_min.data(), static_cast<size_t>(x_min.size()));
+  hasher.update(x_max.data(), static_cast<size_t>(x_max.size()));
+  return hasher.digest();
+}
+
+QpSolveMemoCache::QpSolveMemoCache(size_t capacity)
+: shard_capacity_(std::max<size_t>((capacity + shard_num_ - 1) / shard_num_, 1))
+{
+}
+
+void QpSolveMemoCache::insert(size_t hash, Entry && entry)
+{
+  Shard & shard = shard_list_[hash % shard_num_];
+  std::lock_guard<std::mutex> lock(shard.mutex);
+
+  // Another thread may have inserted the same QP
+  auto range = shard.lru_map.equal_range(hash);
+  for(auto it = range.first; it != range.second; it++)
+  {
+    if(it->second->second.solver_key == entry.solver_key && bitEqual(it->second->second.qp_coeff, entry.qp_coeff))
+    {
+      shard.lru_list.splice(shard.lru_list.begin(), shard.lru_list, it->second);
+      return;
+    }
+  }
+
+  shard.lru_list.emplace_front(hash, std::move(entry));
+  shard.lru_map.emplace(hash, shard.lru_list.begin());
+  if(shard.lru_list.size() > shard_capacity_)
+  {
+    // Evict the least recently used one
+    auto last_it = std::prev(shard.lru_list.end());
+    auto range_last = shard.lru_map.equal_range(last_it->first);
+    for(auto it = range_last.first; it != range_last.second; it++)
+    {
+      if(it->second == last_it)
+      {
+        shard.lru_map.erase(it);
+        break;
+      }
+    }
+    shard.lru_list.pop_back();
+  }
+}
+
+void QpSolveMemoCache::clear()
+{
+  for(auto & shard : shard_list_)
+  {
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    shard.lru_list.clear();
+    shard.lru_map.clear();
+  }
+  hit_count_ = 0;
+  miss_count_ = 0;
+}
+
+size_t QpSolveMemoCache::size() const
+{
+  size_t total_size = 0;
+  for(const auto & shard : shard_list_)
+  {
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    total_size += shard.lru_list.size();
+  }
+  return total_size;
+}
+
+QpSolverMemoize::QpSolverMemoize(const QpSolverType & qp_solver_type,
+                                 const std::shared_ptr<QpSolveMemoCache> & cache)
+: QpSolverMemoize(allocateQpSolver(qp_solver_type), cache)
+{
+}
+
+QpSolverMemoize::QpSolverMemoize(const std::shared_ptr<QpSolver> & qp_solver,
+                                 const std::shared_ptr<QpSolveMemoCache> & cache)
+: backend_(qp_solver), cache_(cache ? cache : std::make_shared<QpSolveMemoCache>())
+{
+  if(!backend_)
+  {
+    throw std::runtime_error("[QpSolverMemoize] Backend QP solver instance is null.");
+  }
+  type_ = backend_->type();
+  const QpSolver & backend = *backend_;
+  backend_class_hash_ = std::hash<std::string>{}(typeid(backend).name());
+}
+
+Eigen::VectorXd QpSolverMemoize::solve(int dim_var,
+                                       int dim_eq,
+                                       int dim_ineq,
+                                       Eigen::Ref<Eigen::MatrixXd> Q,
+                                       const Eigen::Ref<const Eigen::VectorXd> & c,
+                                       const Eigen::Ref<const Eigen::MatrixXd> & A,
+                                       const Eigen::Ref<const Eigen::VectorXd> & b,
+                                       const Eigen::Ref<const Eigen::MatrixXd> & C,
+                                       const Eigen::Ref<const Eigen::VectorXd> & d,
+                                       const Eigen::Ref<const Eigen::VectorXd> & x_min,
+                                       const Eigen::Ref<const Eigen::VectorXd> & x_max)
+{
+  // The solver key is mixed so that the same QP solved by different QP solvers is distributed over the shards
+  size_t solver_key = solverKey();
+  size_t hash = computeQpHash(dim_var, dim_eq, dim_ineq, Q, c, A, b, C, d, x_min, x_max) ^ (solver_key * prime2);
+  auto match = [&](const QpCoeff & qp_coeff) {
+    return qp_coeff.dim_var_ == dim_var && qp_coeff.dim_eq_ == dim_eq && qp_coeff.dim_ineq_ == dim_ineq
+           && bitEqual(qp_coeff.obj_mat_, Q) && bitEqual(qp_coeff.obj_vec_, c) && bitEqual(qp_coeff.eq_mat_, A)
+           && bitEqual(qp_coeff.eq_vec_, b) && bitEqual(qp_coeff.ineq_mat_, C) && bitEqual(qp_coeff.ineq_vec_, d)
+           && bitEqual(qp_coeff.x_min_, x_min) && bitEqual(qp_coeff.x_max_, x_max);
+  };
+  last_hit_ = cache_->find(hash, solver_key, match, result_, solve_failed_);
+  if(last_hit_)
+  {
+    iter_num_ = 0;
+    dual_eq_ = result_.dual_eq_;
+    dual_ineq_ = result_.dual_ineq_;
+    dual_bound_ = result_.dual_bound_;
+    status_ = result_.status_;
+    return result_.x_;
+  }
+
+  // Copy the QP before solving since some QP solvers overwrite Q
+  QpSolveMemoCache::Entry entry;
+  entry.solver_key = solver_key;
+  entry.qp_coeff.dim_var_ = dim_var;
+  entry.qp_coeff.dim_eq_ = dim_eq;
+  entry.qp_coeff.dim_ineq_ = dim_ineq;
+  entry.qp_coeff.obj_mat_ = Q;
+  entry.qp_coeff.obj_vec_ = c;
+  entry.qp_coeff.eq_mat_ = A;
+  entry.qp_coeff.eq_vec_ = b;
+  entry.qp_coeff.ineq_mat_ = C;
+  entry.qp_coeff.ineq_vec_ = d;
+  entry.qp_coeff.x_min_ = x_min;
+  entry.qp_coeff.x_max_ = x_max;
+
+  Eigen::VectorXd x = warm_start_
+                          ? backend_->solve(dim_var, dim_eq, dim_ineq, Q, c, A, b, C, d, x_min, x_max, *warm_start_)
+                          : backend_->solve(dim_var, dim_eq, dim_ineq, Q, c, A, b, C, d, x_min, x_max);
+  solve_failed_ = backend_->solveFailed();
+  status_ = backend_->status();
+  iter_num_ = backend_->iterNum();
+  dual_eq_ = backend_->dualEq();
+  dual_ineq_ = backend_->dualIneq();
+  dual_bound_ = backend_->dualBound();
+
+  entry.result.x_ = x;
+  entry.result.dual_eq_ = dual_eq_;
+  entry.result.dual_ineq_ = dual_ineq_;
+  entry.result.dual_bound_ = dual_bound_;
+  entry.result.status_ = status_;
+  entry.solve_failed = solve_failed_;
+  cache_->insert(hash, std::move(entry));
+
+  return x;
+}
+
+void QpSolverMemoize::setSettings(const QpSolverSettings & settings)
+{
+  QpSolver::setSettings(settings);
+  backend_->setSettings(settings);
+}
+
+size_t QpSolverMemoize::solverKey() const
+{
+  size_t solver_key = backend_class_hash_;
+  hashCombine(solver_key, backend_->configHash());
+  return solver_key;
+}
+
+size_t QpSolverMemoize::configHash() const
+{
+  return backend_->configHash();
+}
+
+size_t QpSolverMemoize::memoryUsage() const
+{
+  return QpSolver::memoryUsage() + sizeof(*this) - sizeof(QpSolver) + backend_->memoryUsage()
+         + matrixMemoryUsage(result_.x_) + matrixMemoryUsage(result_.dual_eq_) + matrixMemoryUsage(result_.dual_ineq_)
+         + matrixMemoryUsage(result_.dual_bound_);
+}
@@ -0,0 +1,481 @@
+/* Author: Masaki Murooka */
+
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+#include <qp_solver_collection/QpSolverMetrics.h>
+
+#ifndef _WIN32
+#  include <arpa/inet.h>
+#  include <netinet/in.h>
+#  include <poll.h>
+#  include <sys/socket.h>
+#  include <unistd.h>
+#endif
+
+using namespace QpSolverCollection;
+
+namespace
+{
+/** \brief Get the exponent of the smallest power of two not less than the value (0 for 0 and 1). */
+inline int ceilLog2(uint64_t value)
+{
+  if(value <= 1)
+  {
+    return 0;
+  }
+#if defined(__GNUC__) || defined(__clang__)
+  return 64 - __builtin_clzll(value - 1);
+#else
+  int exp = 0;
+  for(uint64_t v = value - 1; v > 0; v >>= 1)
+  {
+    exp++;
+  }
+  return exp;
+#endif
+}
+
+/** \brief Increment counter that has a single writer (avoids the cost of atomic read-modify-write). */
+inline void increment(std::atomic<uint64_t> & counter, uint64_t value = 1)
+{
+  counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+}
+
+/** \brief Add histogram snapshot to the given one with the same buckets. */
+void accumulateHistogram(QpMetricsHistogramSnapshot & hist, const QpMetricsHistogramSnapshot & hist_added)
+{
+  if(hist.bucket_count_list.empty())
+  {
+    hist = hist_added;
+    return;
+  }
+  for(size_t i = 0; i < hist.bucket_count_list.size(); i++)
+  {
+    hist.bucket_count_list[i] += hist_added.bucket_count_list[i];
+  }
+  hist.count += hist_added.count;
+  hist.sum += hist_added.sum;
+}
+
+/** \brief Get the name of QP solver type used as the label value (e.g., "OSQP"). */
+std::string qpSolverLabel(QpSolverType qp_solver_type)
+{
+  std::string name = std::to_string(qp_solver_type);
+  std::size_t pos = name.find("::");
+  return pos == std::string::npos ? name : name.substr(pos + 2);
+}
+
+/** \brief Get the status string used as the label value (e.g., "Solved"). */
+std::string statusLabel(QpSolveStatus status)
+{
+  std::string name = std::to_string(status);
+  std::size_t pos = name.find("::");
+  return pos == std::string::npos ? name : name.substr(pos + 2);
+}
+
+/** \brief Write a histogram in the Prometheus text format (buckets are cumulative). */
+void writeHistogram(std::ostream & os,
+                    const std::string & name,
+                    const std::string & label,
+                    const QpMetricsHistogramSnapshot & hist)
+{
+  uint64_t cumulative_count = 0;
+  for(size_t i = 0; i < hist.upper_bound_list.size(); i++)
+  {
+    cumulative_count += hist.bucket_count_list[i];
+    os << name << "_bucket{" << label << ",le=\"" << hist.upper_bound_list[i] << "\"} " << cumulative_count << "\n";
+  }
+  os << name << "_bucket{" << label << ",le=\"+Inf\"} " << hist.count << "\n";
+  os << name << "_sum{" << label << "} " << hist.sum << "\n";
+  os << name << "_count{" << label << "} " << hist.count << "\n";
+}
+} // namespace
+
+QpMetricsHistogram::QpMetricsHistogram(int min_exp, int bucket_num)
+: min_exp_(min_exp), bucket_num_(bucket_num), bucket_count_list_(new std::atomic<uint64_t>[bucket_num + 1])
+{
+  reset();
+}
+
+void QpMetricsHistogram::observe(uint64_t value)
+{
+  int idx = ceilLog2(value) - min_exp_;
+  if(idx < 0)
+  {
+    idx = 0;
+  }
+  else if(idx > bucket_num_)
+  {
+    idx = bucket_num_;
+  }
+  increment(bucket_count_list_[idx]);
+  increment(sum_, value);
+}
+
+QpMetricsHistogramSnapshot QpMetricsHistogram::snapshot(double scale) const
+{
+  QpMetricsHistogramSnapshot hist;
+  hist.upper_bound_list.resize(bucket_num_);
+  hist.bucket_count_list.resize(bucket_num_ + 1);
+  for(int i = 0; i < bucket_num_; i++)
+  {
+    hist.upper_bound_list[i] = scale * std::ldexp(1.0, min_exp_ + i);
+  }
+  // The count is the sum of buckets so that the snapshot is consistent even if observed concurrently
+  for(int i = 0; i <= bucket_num_; i++)
+  {
+    hist.bucket_count_list[i] = bucket_count_list_[i].load(std::memory_order_relaxed);
+    hist.count += hist.bucket_count_list[i];
+  }
+  hist.sum = scale * static_cast<double>(sum_.load(std::memory_order_relaxed));
+  return hist;
+}
+
+void QpMetricsHistogram::reset()
+{
+  for(int i = 0; i <= bucket_num_; i++)
+  {
+    bucket_count_list_[i].store(0, std::memory_order_relaxed);
+  }
+  sum_.store(0, std::memory_order_relaxed);
+}
+
+QpSolverMetrics::QpSolverMetrics()
+: latency_(10, 21), // From ~1 us to ~1 s
+  iter_(0, 17), // From 1 to 65536
+  dim_var_(0, 15) // From 1 to 16384
+{
+  reset();
+}
+
+void QpSolverMetrics::record(uint64_t duration, int iter, int dim_var, QpSolveStatus status, bool solve_failed)
+{
+  latency_.observe(duration);
+  if(iter >= 0)
+  {
+    iter_.observe(static_cast<uint64_t>(iter));
+  }
+  dim_var_.observe(static_cast<uint64_t>(dim_var > 0 ? dim_var : 0));
+  increment(solve_count_);
+  if(solve_failed)
+  {
+    increment(failure_count_);
+  }
+  int status_idx = static_cast<int>(status) - static_cast<int>(QpSolveStatus::Unsolved);
+  if(0 <= status_idx && status_idx < qp_solve_status_num)
+  {
+    increment(status_count_list_[status_idx]);
+  }
+}
+
+void QpSolverMetrics::accumulateSnapshot(QpSolverMetricsSnapshot & metrics) const
+{
+  accumulateHistogram(metrics.latency, latency_.snapshot(1e-9));
+  accumulateHistogram(metrics.iter, iter_.snapshot());
+  accumulateHistogram(metrics.dim_var, dim_var_.snapshot());
+  metrics.solve_count += solve_count_.load(std::memory_order_relaxed);
+  metrics.failure_count += failure_count_.load(std::memory_order_relaxed);
+  for(int i = 0; i < qp_solve_status_num; i++)
+  {
+    metrics.status_count_list[i] += status_count_list_[i].load(std::memory_order_relaxed);
+  }
+}
+
+void QpSolverMetrics::reset()
+{
+  latency_.reset();
+  iter_.reset();
+  dim_var_.reset();
+  solve_count_.store(0, std::memory_order_relaxed);
+  failure_count_.store(0, std::memory_order_relaxed);
+  for(auto & status_count : status_count_list_)
+  {
+    status_count.store(0, std::memory_order_relaxed);
+  }
+}
+
+QpMetricsRegistry & QpMetricsRegistry::instance()
+{
+  static QpMetricsRegistry registry;
+  return registry;
+}
+
+void QpMetricsRegistry::record(QpSolverType qp_solver_type,
+                               uint64_t duration,
+                               int iter,
+                               int dim_var,
+                               QpSolveStatus status,
+                               bool solve_failed)
+{
+  int type_idx = static_cast<int>(qp_solver_type);
+  if(type_idx < 0 || type_idx >= qp_solver_type_num_)
+  {
+    return;
+  }
+  localShard().metrics_list[type_idx].record(duration, iter, dim_var, status, solve_failed);
+}
+
+std::vector<QpSolverMetricsSnapshot> QpMetricsRegistry::snapshot() const
+{
+  std::vector<QpSolverMetricsSnapshot> metrics_list;
+  std::lock_guard<std::mutex> lock(shard_mtx_);
+  for(int i = 0; i < qp_solver_type_num_; i++)
+  {
+    QpSolverMetricsSnapshot metrics;
+    metrics.qp_solver_type = static_cast<QpSolverType>(i);
+    for(const auto & shard : shard_list_)
+    {
+      shard->metrics_list[i].accumulateSnapshot(metrics);
+    }
+    if(metrics.solve_count > 0)
+    {
+      metrics_list.push_back(std::move(metrics));
+    }
+  }
+  return metrics_list;
+}
+
+void QpMetricsRegistry::reset()
+{
+  std::lock_guard<std::mutex> lock(shard_mtx_);
+  for(auto & shard : shard_list_)
+  {
+    for(auto & metrics : shard->metrics_list)
+    {
+      metrics.reset();
+    }
+  }
+}
+
+void QpMetricsRegistry::writePrometheus(std::ostream & os) const
+{
+  std::vector<QpSolverMetricsSnapshot> metrics_list = snapshot();
+
+  os << "# HELP qp_solver_solve_duration_seconds Latency of QP solve.\n"
+     << "# TYPE qp_solver_solve_duration_seconds histogram\n";
+  for(const auto & metrics : metrics_list)
+  {
+    writeHistogram(os, "qp_solver_solve_duration_seconds",
+                   "solver=\"" + qpSolverLabel(metrics.qp_solver_type) + "\"", metrics.latency);
+  }
+
+  os << "# HELP qp_solver_iterations Number of iterations of QP solve.\n"
+     << "# TYPE qp_solver_iterations histogram\n";
+  for(const auto & metrics : metrics_list)
+  {
+    if(metrics.iter.count > 0)
+    {
+      writeHistogram(os, "qp_solver_iterations", "solver=\"" + qpSolverLabel(metrics.qp_solver_type) + "\"",
+                     metrics.iter);
+    }
+  }
+
+  os << "# HELP qp_solver_dim_var Dimension of decision variable of QP.\n"
+     << "# TYPE qp_solver_dim_var histogram\n";
+  for(const auto & metrics : metrics_list)
+  {
+    writeHistogram(os, "qp_solver_dim_var", "solver=\"" + qpSolverLabel(metrics.qp_solver_type) + "\"",
+                   metrics.dim_var);
+  }
+
+  os << "# HELP qp_solver_solves_total Number of QP solves for each status.\n"
+     << "# TYPE qp_solver_solves_total counter\n";
+  for(const auto & metrics : metrics_list)
+  {
+    for(int i = 0; i < qp_solve_status_num; i++)
+    {
+      if(metrics.status_count_list[i] == 0)
+      {
+        continue;
+      }
+      QpSolveStatus status = static_cast<QpSolveStatus>(i + static_cast<int>(QpSolveStatus::Unsolved));
+      os << "qp_solver_solves_total{solver=\"" << qpSolverLabel(metrics.qp_solver_type) << "\",status=\""
+         << statusLabel(status) << "\"} " << metrics.status_count_list[i] << "\n";
+    }
+  }
+
+  os << "# HELP qp_solver_failures_total Number of failed QP solves.\n"
+     << "# TYPE qp_solver_failures_total counter\n";
+  for(const auto & metrics : metrics_list)
+  {
+    os << "qp_solver_failures_total{solver=\"" << qpSolverLabel(metrics.qp_solver_type) << "\"} "
+       << metrics.failure_count << "\n";
+  }
+}
+
+bool QpMetricsRegistry::writePrometheus(const std::string & path) const
+{
+  // Write to a temporary file and rename it so that the collector never reads a partially written file
+  std::string tmp_path = path + ".tmp";
+  {
+    std::ofstream ofs(tmp_path);
+    if(!ofs)
+    {
+      QSC_ERROR_STREAM("[QpMetricsRegistry] Failed to open file: " << tmp_path);
+      return false;
+    }
+    writePrometheus(ofs);
+    if(!ofs)
+    {
+      QSC_ERROR_STREAM("[QpMetricsRegistry] Failed to write file: " << tmp_path);
+      return false;
+    }
+  }
+  if(std::rename(tmp_path.c_str(), path.c_str()) != 0)
+  {
+    QSC_ERROR_STREAM("[QpMetricsRegistry] Failed to rename file: " << tmp_path << " -> " << path);
+    std::remove(tmp_path.c_str());
+    return false;
+  }
+  return true;
+}
+
+QpMetricsRegistry::ShardHolder::~ShardHolder()
+{
+  if(shard)
+  {
+    QpMetricsRegistry & registry = QpMetricsRegistry::instance();
+    std::lock_guard<std::mutex> lock(registry.shard_mtx_);
+    registry.free_shard_list_.push_back(shard);
+  }
+}
+
+QpMetricsRegistry::Shard & QpMetricsRegistry::localShard()
+{
+  thread_local ShardHolder shard_holder;
+  if(!shard_holder.shard)
+  {
+    std::lock_guard<std::mutex> lock(shard_mtx_);
+    if(free_shard_list_.empty())
+    {
+      shard_list_.push_back(std::make_unique<Shard>());
+      shard_holder.shard = shard_list_.back().get();
+    }
+    else
+    {
+      shard_holder.shard = free_shard_list_.back();
+      free_shard_list_.pop_back();
+    }
+  }
+  return *shard_holder.shard;
+}
+
+QpMetricsGuard::QpMetricsGuard(const QpSolver & qp_solver, int dim_var)
+: qp_solver_(qp_solver), dim_var_(dim_var), enabled_(QpMetricsRegistry::instance().enabled())
+{
+  if(enabled_)
+  {
+    start_time_ = QpSolver::clock::now();
+  }
+}
+
+QpMetricsGuard::~QpMetricsGuard()
+{
+  if(!enabled_)
+  {
+    return;
+  }
+  auto duration = std::chrono::duration_cast<std::chrono::nanoseconds>(QpSolver::clock::now() - start_time_).count();
+  QpMetricsRegistry::instance().record(qp_solver_.type(), static_cast<uint64_t>(duration > 0 ? duration : 0),
+                                       qp_solver_.iterNum(), dim_var_, qp_solver_.status(), qp_solver_.solveFailed());
+}
+
+#ifndef _WIN32
+QpMetricsHttpExporter::QpMetricsHttpExporter(int port, const std::string & address)
+{
+  socket_fd_ = socket(AF_INET, SOCK_STREAM, 0);
+  if(socket_fd_ < 0)
+  {
+    throw std::runtime_error("[QpMetricsHttpExporter] Failed to open socket.");
+  }
+  int reuse = 1;
+  setsockopt(socket_fd_, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
+  sockaddr_in addr = {};
+  addr.sin_family = AF_INET;
+  addr.sin_port = htons(static_cast<uint16_t>(port));
+  if(inet_pton(AF_INET, address.c_str(), &addr.sin_addr) != 1)
+  {
+    close(socket_fd_);
+    throw std::runtime_error("[QpMetricsHttpExporter] Invalid address: " + address);
+  }
+  if(bind(socket_fd_, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) < 0 || listen(socket_fd_, 8) < 0)
+  {
+    close(socket_fd_);
+    throw std::runtime_error("[QpMetricsHttpExporter] Failed to bind socket: " + address + ":"
+                             + std::to_string(port));
+  }
+  socklen_t addr_len = sizeof(addr);
+  getsockname(socket_fd_, reinterpret_cast<sockaddr *>(&addr), &addr_len);
+  port_ = ntohs(addr.sin_port);
+
+  thread_ = std::thread(&QpMetricsHttpExporter::serverLoop, this);
+}
+
+QpMetricsHttpExporter::~QpMetricsHttpExporter()
+{
+  stop_ = true;
+  if(thread_.joinable())
+  {
+    thread_.join();
+  }
+  close(socket_fd_);
+}
+
+void QpMetricsHttpExporter::serverLoop()
+{
+  while(!stop_)
+  {
+    // Poll with timeout to check the stop flag periodically
+    pollfd poll_fd = {socket_fd_, POLLIN, 0};
+    if(poll(&poll_fd, 1, 100) <= 0)
+    {
+      continue;
+    }
+    int client_fd = accept(socket_fd_, nullptr, nullptr);
+    if(client_fd < 0)
+    {
+      continue;
+    }
+
+    // Read the request header (its content is ignored)
+    char buf[1024];
+    pollfd client_poll_fd = {client_fd, POLLIN, 0};
+    if(poll(&client_poll_fd, 1, 1000) > 0)
+    {
+      ssize_t recv_size = recv(client_fd, buf, sizeof(buf), 0);
+      (void)recv_size;
+    }
+
+    std::ostringstream body;
+    QpMetricsRegistry::instance().writePrometheus(body);
+    std::string body_str = body.str();
+    std::string response = "HTTP/1.1 200 OK\r\nContent-Type: text/plain; version=0.0.4\r\nContent-Length: "
+                           + std::to_string(body_str.size()) + "\r\nConnection: close\r\n\r\n" + body_str;
+    size_t sent_size = 0;
+    while(sent_size < response.size())
+    {
+      ssize_t ret = send(client_fd, response.data() + sent_size, response.size() - sent_size, MSG_NOSIGNAL);
+      if(ret <= 0)
+      {
+        break;
+      }
+      sent_size += static_cast<size_t>(ret);
+    }
+    close(client_fd);
+  }
+}
+#else
+QpMetricsHttpExporter::QpMetricsHttpExporter(int, const std::string &)
+{
+  throw std::runtime_error("[QpMetricsHttpExporter] HTTP exporter is not supported on this platform.");
+}
+
+QpMetricsHttpExporter::~QpMetricsHttpExporter() {}
+
+void QpMetricsHttpExporter::serverLoop() {}
+#endif
@@ -0,0 +1,213 @@
+/* Author: Masaki Murooka */
+
+#include <algorithm>
+
+#include <qp_solver_collection/QpSolverModeCache.h>
+
+using namespace QpSolverCollection;
+
+namespace
+{
+void hashSparsityPattern(size_t & seed, const Eigen::Ref<const Eigen::MatrixXd> & mat)
+{
+  hashCombine(seed, static_cast<size_t>(mat.rows()));
+  hashCombine(seed, static_cast<size_t>(mat.cols()));
+
+  // Pack the nonzero flags into 64-bit words in column-major order
+  uint64_t word = 0;
+  int bit_idx = 0;
+  for(Eigen::Index j = 0; j < mat.cols(); j++)
+  {
+    for(Eigen::Index i = 0; i < mat.rows(); i++)
+    {
+      if(mat(i, j) != 0.0)
+      {
+        word |= (uint64_t(1) << bit_idx);
+      }
+      if(++bit_idx == 64)
+      {
+        hashCombine(seed, static_cast<size_t>(word));
+        word = 0;
+        bit_idx = 0;
+      }
+    }
+  }
+  hashCombine(seed, static_cast<size_t>(word));
+}
+} // namespace
+
+size_t QpSignatureHash::operator()(const QpSignature & signature) const
+{
+  size_t seed = 0;
+  hashCombine(seed, static_cast<size_t>(signature.dim_var));
+  hashCombine(seed, static_cast<size_t>(signature.dim_eq));
+  hashCombine(seed, static_cast<size_t>(signature.dim_ineq));
+  hashCombine(seed, signature.sparsity_hash);
+  hashCombine(seed, signature.mode_tag);
+  return seed;
+}
+
+QpSignature QpSolverCollection::computeQpSignature(const Eigen::Ref<const Eigen::MatrixXd> & Q,
+                                                   const Eigen::Ref<const Eigen::MatrixXd> & A,
+                                                   const Eigen::Ref<const Eigen::MatrixXd> & C,
+                                                   size_t mode_tag,
+                                                   bool use_sparsity_hash)
+{
+  QpSignature signature;
+  signature.dim_var = static_cast<int>(Q.cols());
+  signature.dim_eq = static_cast<int>(A.rows());
+  signature.dim_ineq = static_cast<int>(C.rows());
+  signature.mode_tag = mode_tag;
+  if(use_sparsity_hash)
+  {
+    size_t seed = 0;
+    hashSparsityPattern(seed, Q);
+    hashSparsityPattern(seed, A);
+    hashSparsityPattern(seed, C);
+    signature.sparsity_hash = seed;
+  }
+  return signature;
+}
+
+QpSolverModeCache::QpSolverModeCache(const QpSolverType & qp_solver_type, size_t capacity)
+{
+  type_ = (qp_solver_type == QpSolverType::Any ? getAnyQpSolverType() : qp_solver_type);
+  QpSolverType backend_type = type_;
+  qp_solver_factory_ = [backend_type]() { return allocateQpSolver(backend_type); };
+  setCapacity(capacity);
+}
+
+QpSolverModeCache::QpSolverModeCache(const QpSolverFactory & qp_solver_factory, size_t capacity)
+: qp_solver_factory_(qp_solver_factory)
+{
+  setCapacity(capacity);
+}
+
+Eigen::VectorXd QpSolverModeCache::solve(int dim_var,
+                                         int dim_eq,
+                                         int dim_ineq,
+                                         Eigen::Ref<Eigen::MatrixXd> Q,
+                                         const Eigen::Ref<const Eigen::VectorXd> & c,
+                                         const Eigen::Ref<const Eigen::MatrixXd> & A,
+                                         const Eigen::Ref<const Eigen::VectorXd> & b,
+                                         const Eigen::Ref<const Eigen::MatrixXd> & C,
+                                         const Eigen::Ref<const Eigen::VectorXd> & d,
+                                         const Eigen::Ref<const Eigen::VectorXd> & x_min,
+                                         const Eigen::Ref<const Eigen::VectorXd> & x_max)
+{
+  last_signature_ = computeQpSignature(Q, A, C, mode_tag_, use_sparsity_hash_);
+  CacheEntry * entry = findOrAllocate(last_signature_);
+  if(!entry)
+  {
+    last_solver_.reset();
+    solve_failed_ = true;
+    status_ = QpSolveStatus::Unknown;
+    return Eigen::VectorXd::Zero(dim_var);
+  }
+  last_solver_ = entry->qp_solver;
+
+  // The warm start given explicitly takes precedence over the stored solution
+  SolveResult & last_result = entry->last_result;
+  const WarmStart * warm_start = warm_start_;
+  WarmStart stored_warm_start;
+  if(!warm_start && restore_solution_ && last_result.x_.size() == dim_var)
+  {
+    stored_warm_start = WarmStart(last_result);
+    warm_start = &stored_warm_start;
+  }
+  Eigen::VectorXd x = warm_start
+                          ? last_solver_->solve(dim_var, dim_eq, dim_ineq, Q, c, A, b, C, d, x_min, x_max, *warm_start)
+                          : last_solver_->solve(dim_var, dim_eq, dim_ineq, Q, c, A, b, C, d, x_min, x_max);
+  solve_failed_ = last_solver_->solveFailed();
+  status_ = last_solver_->status();
+  iter_num_ = last_solver_->iterNum();
+  dual_eq_ = last_solver_->dualEq();
+  dual_ineq_ = last_solver_->dualIneq();
+  dual_bound_ = last_solver_->dualBound();
+
+  if(!solve_failed_)
+  {
+    last_result.x_ = x;
+    last_result.dual_eq_ = dual_eq_;
+    last_result.dual_ineq_ = dual_ineq_;
+    last_result.dual_bound_ = dual_bound_;
+    last_result.status_ = status_;
+  }
+  return x;
+}
+
+void QpSolverModeCache::setSettings(const QpSolverSettings & settings)
+{
+  QpSolver::setSettings(settings);
+  for(auto & entry : lru_list_)
+  {
+    entry.qp_solver->setSettings(settings);
+  }
+}
+
+size_t QpSolverModeCache::memoryUsage() const
+{
+  size_t memory_usage = QpSolver::memoryUsage() + sizeof(*this) - sizeof(QpSolver);
+  for(const auto & entry : lru_list_)
+  {
+    const SolveResult & last_result = entry.last_result;
+    memory_usage += sizeof(CacheEntry) + entry.qp_solver->memoryUsage() + matrixMemoryUsage(last_result.x_)
+                    + matrixMemoryUsage(last_result.dual_eq_) + matrixMemoryUsage(last_result.dual_ineq_)
+                    + matrixMemoryUsage(last_result.dual_bound_);
+  }
+  return memory_usage;
+}
+
+void QpSolverModeCache::setCapacity(size_t capacity)
+{
+  capacity_ = std::max<size_t>(capacity, 1);
+  while(lru_list_.size() > capacity_)
+  {
+    lru_map_.erase(lru_list_.back().signature);
+    lru_list_.pop_back();
+  }
+}
+
+void QpSolverModeCache::clear()
+{
+  lru_list_.clear();
+  lru_map_.clear();
+  last_solver_.reset();
+  hit_count_ = 0;
+  miss_count_ = 0;
+}
+
+QpSolverModeCache::CacheEntry * QpSolverModeCache::findOrAllocate(const QpSignature & signature)
+{
+  auto map_it = lru_map_.find(signature);
+  if(map_it != lru_map_.end())
+  {
+    hit_count_++;
+    // Move to the front as the most recently used one
+    lru_list_.splice(lru_list_.begin(), lru_list_, map_it->second);
+    return &lru_list_.front();
+  }
+
+  miss_count_++;
+  std::shared_ptr<QpSolver> qp_solver = qp_solver_factory_();
+  if(!qp_solver)
+  {
+    return nullptr;
+  }
+  if(type_ == QpSolverType::Uninitialized)
+  {
+    type_ = qp_solver->type();
+  }
+  qp_solver->setSettings(settings_);
+
+  lru_list_.push_front(CacheEntry{signature, qp_solver, SolveResult()});
+  lru_map_.emplace(signature, lru_list_.begin());
+  if(lru_list_.size() > capacity_)
+  {
+    // Evict the least recently used one
+    lru_map_.erase(lru_list_.back().signature);
+    lru_list_.pop_back();
+  }
+
+  return &lru_list_.front();
+}
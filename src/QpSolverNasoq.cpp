@@ -4,6 +4,8 @@
 
 #if ENABLE_NASOQ
 #  include <qp_solver_collection/QpSolverCollection.h>
+#  include <qp_solver_collection/QpSolverMetrics.h>
+#  include <qp_solver_collection/QpSolverTrace.h>
 
 #  include <nasoq/nasoq_eigen.h>
 
@@ -26,6 +28,16 @@ Eigen::VectorXd QpSolverNasoq::solve(int dim_var,
                                      const Eigen::Ref<const Eigen::VectorXd> & x_min,
                                      const Eigen::Ref<const Eigen::VectorXd> & x_max)
 {
+  QSC_TRACE_SCOPE("QpSolverNasoq::solve");
+  QpMetricsGuard metrics_guard(*this, dim_var);
+  setLastDimension(dim_var, dim_eq, dim_ineq);
+
+  if(presolveFailed(A, b, C, d, x_min, x_max))
+  {
+    return Eigen::VectorXd::Zero(dim_var);
+  }
+
+  QSC_TRACE_PHASE("stack");
   int dim_ineq_with_bound = dim_ineq + 2 * dim_var;
   Eigen::MatrixXd C_with_bound(dim_ineq_with_bound, dim_var);
   Eigen::VectorXd d_with_bound(dim_ineq_with_bound);
@@ -33,6 +45,7 @@ Eigen::VectorXd QpSolverNasoq::solve(int dim_var,
   C_with_bound << C, I, -I;
   d_with_bound << d, x_max, -x_min;
 
+  QSC_TRACE_PHASE("sparseView");
   auto sparse_start_time = clock::now();
   // Matrices and vectors must be hold during solver's lifetime
   Q_sparse_ = Q.sparseView();
@@ -42,11 +55,47 @@ Eigen::VectorXd QpSolverNasoq::solve(int dim_var,
   sparse_duration_ =
       1e3 * std::chrono::duration_cast<std::chrono::duration<double>>(sparse_end_time - sparse_start_time).count();
 
+  QSC_TRACE_PHASE("init");
   Eigen::VectorXd sol(dim_var), dual_eq(dim_eq), dual_ineq(dim_ineq_with_bound);
   nasoq::QPSettings settings;
+  if(settings_.abs_tol_ > 0)
+  {
+    settings.eps = settings_.abs_tol_;
+  }
+  if(settings_.max_iter_ > 0)
+  {
+    settings.max_iter = settings_.max_iter_;
+  }
+  if(settings_.profile_ == QpAccuracyProfile::Fast)
+  {
+    settings.nasoq_variant = "FIXED";
+  }
+  else if(settings_.profile_ == QpAccuracyProfile::Robust)
+  {
+    settings.nasoq_variant = "AUTO";
+  }
+  settings_updated_ = false;
+  QSC_TRACE_PHASE("iterate");
   int solve_ret = nasoq::quadprog(Q_sparse_.triangularView<Eigen::Lower>(), c, A_sparse_, b, C_with_bound_sparse_,
                                   d_with_bound, sol, dual_eq, dual_ineq, &settings);
 
+  QSC_TRACE_PHASE("postprocess");
+  if(solve_ret == nasoq::Optimal)
+  {
+    status_ = QpSolveStatus::Solved;
+  }
+  else if(solve_ret == nasoq::Infeasible)
+  {
+    status_ = QpSolveStatus::PrimalInfeasible;
+  }
+  else if(solve_ret == nasoq::NotConverged)
+  {
+    status_ = QpSolveStatus::MaxIterReached;
+  }
+  else
+  {
+    status_ = QpSolveStatus::Unknown;
+  }
   if(solve_ret == nasoq::Optimal)
   {
     solve_failed_ = false;
@@ -57,9 +106,28 @@ Eigen::VectorXd QpSolverNasoq::solve(int dim_var,
     QSC_WARN_STREAM("[QpSolverNasoq::solve] Failed to solve: " << solve_ret);
   }
 
+  dual_eq_ = dual_eq;
+  dual_ineq_ = dual_ineq.head(dim_ineq);
+  dual_bound_ = dual_ineq.segment(dim_ineq, dim_var) - dual_ineq.tail(dim_var);
+
   return sol;
 }
 
+size_t QpSolverNasoq::memoryUsage() const
+{
+  size_t wrapper_size =
+      matrixMemoryUsage(Q_sparse_) + matrixMemoryUsage(A_sparse_) + matrixMemoryUsage(C_with_bound_sparse_);
+
+  size_t n = last_dim_var_;
+  size_t m = last_dim_eq_ + last_dim_ineq_ + 2 * n;
+  size_t nnz = static_cast<size_t>(Q_sparse_.nonZeros() + A_sparse_.nonZeros() + C_with_bound_sparse_.nonZeros());
+  // KKT matrix of the working set and its LDL factor (assuming fill-in comparable to the KKT matrix), and iterates of
+  // NASOQ
+  size_t nasoq_size = (sizeof(double) + sizeof(int)) * 3 * (nnz + n + m) + sizeof(double) * 10 * (n + m);
+
+  return QpSolver::memoryUsage() + sizeof(*this) - sizeof(QpSolver) + wrapper_size + nasoq_size;
+}
+
 namespace QpSolverCollection
 {
 std::shared_ptr<QpSolver> allocateQpSolverNasoq()
@@ -3,9 +3,14 @@
 #include <qp_solver_collection/QpSolverOptions.h>
 
 #if ENABLE_OSQP
+#  include <algorithm>
 #  include <limits>
+#  include <stdexcept>
+#  include <vector>
 
 #  include <qp_solver_collection/QpSolverCollection.h>
+#  include <qp_solver_collection/QpSolverMetrics.h>
+#  include <qp_solver_collection/QpSolverTrace.h>
 
 #  include <OsqpEigen/OsqpEigen.h>
 #  define OSQP_EIGEN_DEBUG_OUTPUT
@@ -33,6 +38,82 @@ static inline std::string to_string(OsqpEigen::ErrorExitFlag flag)
   }
 }
 
+namespace
+{
+/** \brief Write the dense matrix into the rows [row_offset, row_offset + dense.rows()) of the sparse matrix without
+   changing the sparsity pattern.
+    \returns false if a nonzero element of the dense matrix is out of the sparsity pattern (the sparse matrix is then
+   partially written)
+ */
+bool assignToSparsityPattern(const Eigen::Ref<const Eigen::MatrixXd> & dense,
+                             Eigen::SparseMatrix<double> & sparse,
+                             Eigen::Index row_offset)
+{
+  for(Eigen::Index j = 0; j < dense.cols(); j++)
+  {
+    Eigen::SparseMatrix<double>::InnerIterator it(sparse, j);
+    while(it && it.row() < row_offset)
+    {
+      ++it;
+    }
+    for(Eigen::Index i = 0; i < dense.rows(); i++)
+    {
+      if(it && it.row() == row_offset + i)
+      {
+        it.valueRef() = dense(i, j);
+        ++it;
+      }
+      else if(dense(i, j) != 0.0)
+      {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+/** \brief Extend the sparsity pattern of the sparse matrix with the nonzero elements of the dense matrix placed from
+   row_offset. */
+void extendSparsityPattern(const Eigen::Ref<const Eigen::MatrixXd> & dense,
+                           Eigen::SparseMatrix<double> & sparse,
+                           Eigen::Index row_offset)
+{
+  std::vector<Eigen::Triplet<double>> triplet_list;
+  triplet_list.reserve(static_cast<size_t>(sparse.nonZeros()));
+  for(Eigen::Index j = 0; j < sparse.outerSize(); j++)
+  {
+    for(Eigen::SparseMatrix<double>::InnerIterator it(sparse, j); it; ++it)
+    {
+      triplet_list.emplace_back(it.row(), it.col(), it.value());
+    }
+  }
+  for(Eigen::Index j = 0; j < dense.cols(); j++)
+  {
+    for(Eigen::Index i = 0; i < dense.rows(); i++)
+    {
+      if(dense(i, j) != 0.0)
+      {
+        triplet_list.emplace_back(row_offset + i, j, 0.0);
+      }
+    }
+  }
+  sparse.setFromTriplets(triplet_list.begin(), triplet_list.end());
+}
+
+/** \brief Clear the stacked constraint matrix leaving only the identity matrix of bounds in the bottom rows. */
+void resetConstraintPattern(Eigen::SparseMatrix<double> & AC_with_bound, int dim_eq_ineq, int dim_var)
+{
+  std::vector<Eigen::Triplet<double>> triplet_list;
+  triplet_list.reserve(static_cast<size_t>(dim_var));
+  for(int i = 0; i < dim_var; i++)
+  {
+    triplet_list.emplace_back(dim_eq_ineq + i, i, 1.0);
+  }
+  AC_with_bound.resize(dim_eq_ineq + dim_var, dim_var);
+  AC_with_bound.setFromTriplets(triplet_list.begin(), triplet_list.end());
+}
+} // namespace
+
 using namespace QpSolverCollection;
 
 QpSolverOsqp::QpSolverOsqp()
@@ -53,45 +134,129 @@ Eigen::VectorXd QpSolverOsqp::solve(int dim_var,
                                     const Eigen::Ref<const Eigen::VectorXd> & x_min,
                                     const Eigen::Ref<const Eigen::VectorXd> & x_max)
 {
+  QSC_TRACE_SCOPE("QpSolverOsqp::solve");
+  QpMetricsGuard metrics_guard(*this, dim_var);
+  setLastDimension(dim_var, dim_eq, dim_ineq);
+
+  if(presolveFailed(A, b, C, d, x_min, x_max))
+  {
+    return Eigen::VectorXd::Zero(dim_var);
+  }
+
   int dim_eq_ineq_with_bound = dim_eq + dim_ineq + dim_var;
-  Eigen::MatrixXd AC_with_bound(dim_eq_ineq_with_bound, dim_var);
-  Eigen::VectorXd bd_with_bound_min(dim_eq_ineq_with_bound);
-  Eigen::VectorXd bd_with_bound_max(dim_eq_ineq_with_bound);
-  Eigen::MatrixXd I = Eigen::MatrixXd::Identity(dim_var, dim_var);
-  AC_with_bound << A, C, I;
-  bd_with_bound_min << b, Eigen::VectorXd::Constant(dim_ineq, -1 * std::numeric_limits<double>::infinity()), x_min;
-  bd_with_bound_max << b, d, x_max;
+  bool update_only = !solve_failed_ && !force_initialize_ && !settings_updated_ && !sparsity_pattern_declared_
+                     && osqp_->isInitialized() && dim_var == osqp_->data()->getData()->n
+                     && dim_eq_ineq_with_bound == osqp_->data()->getData()->m;
+  // Blocks of QpCoeff that are unchanged since the previous solve are not updated (see QpSolver::coeffUnchanged)
+  bool update_obj_mat = !(update_only && coeffUnchanged(QpCoeff::Block::ObjMat));
+  bool update_obj_vec = !(update_only && coeffUnchanged(QpCoeff::Block::ObjVec));
+  bool update_cstr_mat =
+      !(update_only && coeffUnchanged(QpCoeff::Block::EqMat) && coeffUnchanged(QpCoeff::Block::IneqMat));
+  bool update_cstr_vec = !(update_only && coeffUnchanged(QpCoeff::Block::EqVec)
+                           && coeffUnchanged(QpCoeff::Block::IneqVec) && coeffUnchanged(QpCoeff::Block::Bound));
 
+  QSC_TRACE_PHASE("stack");
+  if(update_cstr_vec)
+  {
+    // You must pass unconst vectors to OSQP
+    bd_with_bound_min_.resize(dim_eq_ineq_with_bound);
+    bd_with_bound_max_.resize(dim_eq_ineq_with_bound);
+    bd_with_bound_min_ << b, Eigen::VectorXd::Constant(dim_ineq, -1 * std::numeric_limits<double>::infinity()), x_min;
+    bd_with_bound_max_ << b, d, x_max;
+  }
+  if(update_obj_vec)
+  {
+    c_ = c;
+  }
+
+  QSC_TRACE_PHASE("sparseView");
   auto sparse_start_time = clock::now();
   // Matrices and vectors must be hold during solver's lifetime
-  Q_sparse_ = Q.sparseView();
-  AC_with_bound_sparse_ = AC_with_bound.sparseView();
-  // You must pass unconst vectors to OSQP
-  c_ = c;
-  bd_with_bound_min_ = bd_with_bound_min;
-  bd_with_bound_max_ = bd_with_bound_max;
+  // If the sparsity pattern is fixed, the values are written into it and the pattern is extended only if needed
+  bool sparsity_changed = false;
+  if(update_obj_mat)
+  {
+    if(fix_sparsity_pattern_ && Q_sparse_.rows() == dim_var && Q_sparse_.cols() == dim_var)
+    {
+      if(!assignToSparsityPattern(Q, Q_sparse_, 0))
+      {
+        extendSparsityPattern(Q, Q_sparse_, 0);
+        assignToSparsityPattern(Q, Q_sparse_, 0);
+        sparsity_changed = true;
+      }
+    }
+    else
+    {
+      Q_sparse_ = Q.sparseView();
+    }
+  }
+  if(update_cstr_mat)
+  {
+    // The identity matrix of bounds is always in the sparsity pattern and its values are not rewritten
+    bool fixed = fix_sparsity_pattern_ && AC_with_bound_sparse_.rows() == dim_eq_ineq_with_bound
+                 && AC_with_bound_sparse_.cols() == dim_var;
+    if(!fixed)
+    {
+      resetConstraintPattern(AC_with_bound_sparse_, dim_eq + dim_ineq, dim_var);
+    }
+    if(!fixed || !assignToSparsityPattern(A, AC_with_bound_sparse_, 0)
+       || !assignToSparsityPattern(C, AC_with_bound_sparse_, dim_eq))
+    {
+      extendSparsityPattern(A, AC_with_bound_sparse_, 0);
+      extendSparsityPattern(C, AC_with_bound_sparse_, dim_eq);
+      assignToSparsityPattern(A, AC_with_bound_sparse_, 0);
+      assignToSparsityPattern(C, AC_with_bound_sparse_, dim_eq);
+      sparsity_changed = sparsity_changed || fixed;
+    }
+  }
   auto sparse_end_time = clock::now();
   sparse_duration_ =
       1e3 * std::chrono::duration_cast<std::chrono::duration<double>>(sparse_end_time - sparse_start_time).count();
 
-  // osqp_->settings()->setAbsoluteTolerance(1e-2);
-  // osqp_->settings()->setRelativeTolerance(1e-2);
-  // osqp_->settings()->setScaledTerimination(1);
-  // QSC_INFO_STREAM("max_iter: " << osqp_->settings()->getSettings()->max_iter << ", " <<
-  //                 "eps_abs: " << osqp_->settings()->getSettings()->eps_abs << ", " <<
-  //                 "eps_rel: " << osqp_->settings()->getSettings()->eps_rel << ", " <<
-  //                 "scaled_termination: " << osqp_->settings()->getSettings()->scaled_termination);
-
-  osqp_->settings()->setVerbosity(false);
+  QSC_TRACE_PHASE("init");
+  // Settings are reflected when the solver is initialized
+  if(settings_updated_)
+  {
+    osqp_->settings()->setAbsoluteTolerance(settings_.absTol(1e-2, 1e-3, 1e-5));
+    osqp_->settings()->setRelativeTolerance(settings_.relTol(1e-2, 1e-3, 1e-5));
+    osqp_->settings()->setMaxIteration(settings_.maxIter(1000, 4000, 10000));
+    osqp_->settings()->setPolish(settings_.profile_ == QpAccuracyProfile::Robust);
+    double value;
+    if(settings_.param("rho", value))
+    {
+      osqp_->settings()->setRho(value);
+    }
+    if(settings_.param("sigma", value))
+    {
+      osqp_->settings()->setSigma(value);
+    }
+    if(settings_.param("alpha", value))
+    {
+      osqp_->settings()->setAlpha(value);
+    }
+  }
+  osqp_->settings()->setVerbosity(settings_.verbose_);
   osqp_->settings()->setWarmStart(true);
-  if(!solve_failed_ && !force_initialize_ && osqp_->isInitialized() && dim_var == osqp_->data()->getData()->n
-     && dim_eq_ineq_with_bound == osqp_->data()->getData()->m)
+  // OsqpEigen also initializes the solver fully in the update if the sparsity pattern is changed
+  if(update_only && !sparsity_changed)
   {
     // Update only matrices and vectors
-    osqp_->updateHessianMatrix(Q_sparse_);
-    osqp_->updateGradient(c_);
-    osqp_->updateLinearConstraintsMatrix(AC_with_bound_sparse_);
-    osqp_->updateBounds(bd_with_bound_min_, bd_with_bound_max_);
+    if(update_obj_mat)
+    {
+      osqp_->updateHessianMatrix(Q_sparse_);
+    }
+    if(update_obj_vec)
+    {
+      osqp_->updateGradient(c_);
+    }
+    if(update_cstr_mat)
+    {
+      osqp_->updateLinearConstraintsMatrix(AC_with_bound_sparse_);
+    }
+    if(update_cstr_vec)
+    {
+      osqp_->updateBounds(bd_with_bound_min_, bd_with_bound_max_);
+    }
   }
   else
   {
@@ -111,23 +276,129 @@ Eigen::VectorXd QpSolverOsqp::solve(int dim_var,
     osqp_->data()->setLowerBound(bd_with_bound_min_);
     osqp_->data()->setUpperBound(bd_with_bound_max_);
     osqp_->initSolver();
+    settings_updated_ = false;
+    sparsity_pattern_declared_ = false;
+    init_num_++;
+  }
+
+  // OSQP multipliers are ordered as equality constraints, inequality constraints, and bounds
+  if(warm_start_)
+  {
+    if(warm_start_->hasDual())
+    {
+      osqp_->setWarmStart(warm_start_->x_, warm_start_->stackedDual(dim_var, dim_eq, dim_ineq));
+    }
+    else
+    {
+      osqp_->setPrimalVariable(warm_start_->x_);
+    }
   }
 
+  QSC_TRACE_PHASE("iterate");
   auto status = osqp_->solveProblem();
+  iter_num_ = static_cast<int>(osqp_->workspace()->info->iter);
+  QSC_TRACE_PHASE("postprocess");
 
   if(status == OsqpEigen::ErrorExitFlag::NoError)
+  {
+    // OSQP terminates early with certificates of infeasibility, which are reported only in the solver status
+    switch(osqp_->getStatus())
+    {
+      case OsqpEigen::Status::Solved:
+      case OsqpEigen::Status::SolvedInaccurate:
+        status_ = QpSolveStatus::Solved;
+        break;
+      case OsqpEigen::Status::MaxIterReached:
+        status_ = QpSolveStatus::MaxIterReached;
+        break;
+      case OsqpEigen::Status::PrimalInfeasible:
+      case OsqpEigen::Status::PrimalInfeasibleInaccurate:
+        status_ = QpSolveStatus::PrimalInfeasible;
+        break;
+      case OsqpEigen::Status::DualInfeasible:
+      case OsqpEigen::Status::DualInfeasibleInaccurate:
+        status_ = QpSolveStatus::DualInfeasible;
+        break;
+      case OsqpEigen::Status::NonCvx:
+        status_ = QpSolveStatus::InvalidInput;
+        break;
+      default:
+        status_ = QpSolveStatus::Unknown;
+    }
+  }
+  else
+  {
+    status_ = QpSolveStatus::Unknown;
+  }
+  if(status_ == QpSolveStatus::Solved)
   {
     solve_failed_ = false;
   }
+  else if(status_ == QpSolveStatus::MaxIterReached
+          && std::max(osqp_->workspace()->info->pri_res, osqp_->workspace()->info->dua_res) <= max_iter_accept_tol_)
+  {
+    // Infeasible QPs typically run up to the maximum number of iterations with large residuals
+    solve_failed_ = false;
+  }
   else
   {
     solve_failed_ = true;
-    QSC_WARN_STREAM("[QpSolverOsqp::solve] Failed to solve: " << to_string(status));
+    QSC_WARN_STREAM("[QpSolverOsqp::solve] Failed to solve: " << to_string(status) << " ("
+                                                               << std::to_string(status_) << ")");
   }
 
+  // OSQP multipliers are ordered as equality constraints, inequality constraints, and bounds
+  Eigen::VectorXd dual = osqp_->getDualSolution();
+  dual_eq_ = dual.head(dim_eq);
+  dual_ineq_ = dual.segment(dim_eq, dim_ineq);
+  dual_bound_ = dual.tail(dim_var);
+
   return osqp_->getSolution();
 }
 
+void QpSolverOsqp::setSparsityPattern(const Eigen::Ref<const Eigen::MatrixXd> & Q_pattern,
+                                      const Eigen::Ref<const Eigen::MatrixXd> & A_pattern,
+                                      const Eigen::Ref<const Eigen::MatrixXd> & C_pattern)
+{
+  Eigen::Index dim_var = Q_pattern.rows();
+  if(Q_pattern.cols() != dim_var || A_pattern.cols() != dim_var || C_pattern.cols() != dim_var)
+  {
+    throw std::invalid_argument("[QpSolverOsqp::setSparsityPattern] Dimensions of matrices are inconsistent.");
+  }
+
+  Q_sparse_.resize(dim_var, dim_var);
+  extendSparsityPattern(Q_pattern, Q_sparse_, 0);
+  Eigen::Index dim_eq = A_pattern.rows();
+  resetConstraintPattern(AC_with_bound_sparse_, static_cast<int>(dim_eq + C_pattern.rows()), static_cast<int>(dim_var));
+  extendSparsityPattern(A_pattern, AC_with_bound_sparse_, 0);
+  extendSparsityPattern(C_pattern, AC_with_bound_sparse_, dim_eq);
+  sparsity_pattern_declared_ = true;
+}
+
+size_t QpSolverOsqp::memoryUsage() const
+{
+  size_t wrapper_size = matrixMemoryUsage(Q_sparse_) + matrixMemoryUsage(c_) + matrixMemoryUsage(AC_with_bound_sparse_)
+                        + matrixMemoryUsage(bd_with_bound_min_) + matrixMemoryUsage(bd_with_bound_max_);
+
+  size_t n = last_dim_var_;
+  size_t m = last_dim_eq_ + last_dim_ineq_ + n;
+  size_t nnz = static_cast<size_t>(Q_sparse_.nonZeros() + AC_with_bound_sparse_.nonZeros());
+  // Copies of matrices, KKT matrix and its LDL factor (assuming fill-in comparable to the KKT matrix), and iterates of
+  // OSQP
+  size_t osqp_size = sizeof(OsqpEigen::Solver) + (sizeof(double) + sizeof(int)) * (nnz + 3 * (nnz + n + m))
+                     + sizeof(double) * 15 * (n + m);
+
+  return QpSolver::memoryUsage() + sizeof(*this) - sizeof(QpSolver) + wrapper_size + osqp_size;
+}
+
+size_t QpSolverOsqp::configHash() const
+{
+  size_t hash = QpSolver::configHash();
+  hashCombine(hash, static_cast<size_t>(force_initialize_));
+  hashCombineDouble(hash, max_iter_accept_tol_);
+  return hash;
+}
+
 namespace QpSolverCollection
 {
 std::shared_ptr<QpSolver> allocateQpSolverOsqp()
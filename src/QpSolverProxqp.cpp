@@ -4,6 +4,8 @@
 
 #if ENABLE_PROXQP
 #  include <qp_solver_collection/QpSolverCollection.h>
+#  include <qp_solver_collection/QpSolverMetrics.h>
+#  include <qp_solver_collection/QpSolverTrace.h>
 
 #  include <proxsuite/proxqp/dense/dense.hpp>
 
@@ -26,24 +28,106 @@ Eigen::VectorXd QpSolverProxqp::solve(int dim_var,
                                       const Eigen::Ref<const Eigen::VectorXd> & x_min,
                                       const Eigen::Ref<const Eigen::VectorXd> & x_max)
 {
+  QSC_TRACE_SCOPE("QpSolverProxqp::solve");
+  QpMetricsGuard metrics_guard(*this, dim_var);
+  setLastDimension(dim_var, dim_eq, dim_ineq);
+
+  if(presolveFailed(A, b, C, d, x_min, x_max))
+  {
+    return Eigen::VectorXd::Zero(dim_var);
+  }
+
   int dim_ineq_with_bound = dim_ineq + dim_var;
-  if(!(proxqp_ && proxqp_->model.dim == dim_var && proxqp_->model.n_eq == dim_eq
-       && proxqp_->model.n_in == dim_ineq_with_bound))
+  QSC_TRACE_PHASE("init");
+  // Proximal parameters are reflected when the solver is initialized
+  bool allocate = settings_updated_
+                  || !(proxqp_ && proxqp_->model.dim == dim_var && proxqp_->model.n_eq == dim_eq
+                       && proxqp_->model.n_in == dim_ineq_with_bound);
+  if(allocate)
   {
     proxqp_ = std::make_unique<proxsuite::proxqp::dense::QP<double>>(dim_var, dim_eq, dim_ineq_with_bound);
+
+    proxqp_->settings.eps_abs = settings_.absTol(1e-3, 1e-5, 1e-8);
+    proxqp_->settings.eps_rel = (settings_.rel_tol_ > 0 ? settings_.rel_tol_ : 0.0);
+    proxqp_->settings.max_iter = settings_.maxIter(10000, 10000, 10000);
+    proxqp_->settings.verbose = settings_.verbose_;
+    double value;
+    if(settings_.param("rho", value))
+    {
+      proxqp_->settings.default_rho = value;
+    }
+    if(settings_.param("mu_eq", value))
+    {
+      proxqp_->settings.default_mu_eq = value;
+    }
+    if(settings_.param("mu_in", value))
+    {
+      proxqp_->settings.default_mu_in = value;
+    }
+    settings_updated_ = false;
   }
 
-  Eigen::MatrixXd C_with_bound(dim_ineq_with_bound, dim_var);
+  // Matrices of QpCoeff that are unchanged since the previous solve are not passed (see QpSolver::coeffUnchanged)
+  bool update_obj_mat = allocate || !coeffUnchanged(QpCoeff::Block::ObjMat);
+  bool update_eq_mat = allocate || !coeffUnchanged(QpCoeff::Block::EqMat);
+  bool update_ineq_mat = allocate || !coeffUnchanged(QpCoeff::Block::IneqMat);
+
+  QSC_TRACE_PHASE("stack");
+  Eigen::MatrixXd C_with_bound;
+  if(update_ineq_mat)
+  {
+    C_with_bound.resize(dim_ineq_with_bound, dim_var);
+    Eigen::MatrixXd I = Eigen::MatrixXd::Identity(dim_var, dim_var);
+    C_with_bound << C, I;
+  }
   Eigen::VectorXd d_with_bound_min(dim_ineq_with_bound);
   Eigen::VectorXd d_with_bound_max(dim_ineq_with_bound);
-  Eigen::MatrixXd I = Eigen::MatrixXd::Identity(dim_var, dim_var);
-  C_with_bound << C, I;
   d_with_bound_min << Eigen::VectorXd::Constant(dim_ineq, -1 * std::numeric_limits<double>::infinity()), x_min;
   d_with_bound_max << d, x_max;
 
-  proxqp_->update(Q, c, A, b, C_with_bound, d_with_bound_min, d_with_bound_max);
-  proxqp_->solve();
+  QSC_TRACE_PHASE("update");
+  using OptionalMatRef = proxsuite::optional<proxsuite::proxqp::dense::MatRef<double>>;
+  OptionalMatRef obj_mat = update_obj_mat ? OptionalMatRef(Q) : proxsuite::nullopt;
+  OptionalMatRef eq_mat = update_eq_mat ? OptionalMatRef(A) : proxsuite::nullopt;
+  OptionalMatRef ineq_mat = update_ineq_mat ? OptionalMatRef(C_with_bound) : proxsuite::nullopt;
+  proxqp_->update(obj_mat, c, eq_mat, b, ineq_mat, d_with_bound_min, d_with_bound_max);
+  QSC_TRACE_PHASE("iterate");
+  if(warm_start_)
+  {
+    // PROXQP multipliers of inequality constraints are followed by those of bounds
+    Eigen::VectorXd dual = warm_start_->stackedDual(dim_var, dim_eq, dim_ineq);
+    Eigen::VectorXd dual_eq = dual.head(dim_eq);
+    Eigen::VectorXd dual_ineq_with_bound = dual.tail(dim_ineq_with_bound);
+    // The initial guess setting is overwritten by PROXQP for the warm start
+    auto initial_guess = proxqp_->settings.initial_guess;
+    proxqp_->solve(warm_start_->x_, dual_eq, dual_ineq_with_bound);
+    proxqp_->settings.initial_guess = initial_guess;
+  }
+  else
+  {
+    proxqp_->solve();
+  }
+  iter_num_ = static_cast<int>(proxqp_->results.info.iter);
 
+  QSC_TRACE_PHASE("postprocess");
+  // PROXQP terminates early with certificates of infeasibility
+  switch(proxqp_->results.info.status)
+  {
+    case proxsuite::proxqp::QPSolverOutput::PROXQP_SOLVED:
+      status_ = QpSolveStatus::Solved;
+      break;
+    case proxsuite::proxqp::QPSolverOutput::PROXQP_MAX_ITER_REACHED:
+      status_ = QpSolveStatus::MaxIterReached;
+      break;
+    case proxsuite::proxqp::QPSolverOutput::PROXQP_PRIMAL_INFEASIBLE:
+      status_ = QpSolveStatus::PrimalInfeasible;
+      break;
+    case proxsuite::proxqp::QPSolverOutput::PROXQP_DUAL_INFEASIBLE:
+      status_ = QpSolveStatus::DualInfeasible;
+      break;
+    default:
+      status_ = QpSolveStatus::Unknown;
+  }
   if(proxqp_->results.info.status == proxsuite::proxqp::QPSolverOutput::PROXQP_SOLVED)
   {
     solve_failed_ = false;
@@ -54,9 +138,27 @@ Eigen::VectorXd QpSolverProxqp::solve(int dim_var,
     QSC_WARN_STREAM("[QpSolverProxqp::solve] Failed to solve: " << static_cast<int>(proxqp_->results.info.status));
   }
 
+  dual_eq_ = proxqp_->results.y;
+  dual_ineq_ = proxqp_->results.z.head(dim_ineq);
+  dual_bound_ = proxqp_->results.z.tail(dim_var);
+
   return proxqp_->results.x;
 }
 
+size_t QpSolverProxqp::memoryUsage() const
+{
+  if(!proxqp_)
+  {
+    return QpSolver::memoryUsage() + sizeof(*this) - sizeof(QpSolver);
+  }
+  size_t n = last_dim_var_;
+  size_t m = last_dim_eq_ + last_dim_ineq_ + n;
+  // Model and its scaled copy, KKT matrix and its LDLT factor, and iterates of PROXQP
+  size_t proxqp_size = sizeof(proxsuite::proxqp::dense::QP<double>)
+                       + sizeof(double) * (2 * (n * n + m * n) + 2 * (n + m) * (n + m) + 30 * (n + m));
+  return QpSolver::memoryUsage() + sizeof(*this) - sizeof(QpSolver) + proxqp_size;
+}
+
 namespace QpSolverCollection
 {
 std::shared_ptr<QpSolver> allocateQpSolverProxqp()
@@ -4,6 +4,8 @@
 
 #if ENABLE_QLD
 #  include <qp_solver_collection/QpSolverCollection.h>
+#  include <qp_solver_collection/QpSolverMetrics.h>
+#  include <qp_solver_collection/QpSolverTrace.h>
 
 #  include <eigen-qld/QLD.h>
 
@@ -27,27 +29,97 @@ Eigen::VectorXd QpSolverQld::solve(int dim_var,
                                    const Eigen::Ref<const Eigen::VectorXd> & x_min,
                                    const Eigen::Ref<const Eigen::VectorXd> & x_max)
 {
+  QSC_TRACE_SCOPE("QpSolverQld::solve");
+  QpMetricsGuard metrics_guard(*this, dim_var);
+  setLastDimension(dim_var, dim_eq, dim_ineq);
+
+  if(presolveFailed(A, b, C, d, x_min, x_max))
+  {
+    return Eigen::VectorXd::Zero(dim_var);
+  }
+
+  QSC_TRACE_PHASE("stack");
   Eigen::MatrixXd AC(dim_eq + dim_ineq, dim_var);
   Eigen::VectorXd bd(dim_eq + dim_ineq);
   AC << -A, -C;
   bd << b, d;
 
+  QSC_TRACE_PHASE("factorize");
+  // QLD accepts the upper triangular Cholesky factor R (Q = R^T R)
+  const Eigen::MatrixXd * obj_mat_factor = objMatFactor(Q, true, false);
+
+  QSC_TRACE_PHASE("init");
   qld_->problem(dim_var, dim_eq, dim_ineq);
-  qld_->solve(Q, c, AC, bd, x_min, x_max, dim_eq);
+  settings_updated_ = false;
+  double eps = settings_.absTol(1e-8, 1e-12, 1e-14);
+  QSC_TRACE_PHASE("iterate");
+  if(obj_mat_factor)
+  {
+    qld_->solve(*obj_mat_factor, c, AC, bd, x_min, x_max, dim_eq, true, eps);
+  }
+  else
+  {
+    qld_->solve(Q, c, AC, bd, x_min, x_max, dim_eq, false, eps);
+  }
 
-  if(qld_->fail() == 0)
+  QSC_TRACE_PHASE("postprocess");
+  // See the description of IFAIL in the documentation of QL0001
+  int fail = qld_->fail();
+  if(fail == 0)
+  {
+    status_ = QpSolveStatus::Solved;
+  }
+  else if(fail == 1)
+  {
+    status_ = QpSolveStatus::MaxIterReached;
+  }
+  else if(fail == 2)
+  {
+    status_ = QpSolveStatus::NumericalError;
+  }
+  else if(fail == 5)
+  {
+    status_ = QpSolveStatus::InvalidInput;
+  }
+  else if(fail > 10)
+  {
+    // Constraint of index (fail - 10) is inconsistent
+    status_ = QpSolveStatus::PrimalInfeasible;
+  }
+  else
+  {
+    status_ = QpSolveStatus::Unknown;
+  }
+  if(fail == 0)
   {
     solve_failed_ = false;
   }
   else
   {
     solve_failed_ = true;
-    QSC_WARN_STREAM("[QpSolverQld::solve] Failed to solve: " << qld_->fail());
+    QSC_WARN_STREAM("[QpSolverQld::solve] Failed to solve: " << fail << " (" << std::to_string(status_) << ")");
   }
 
+  // QLD multipliers are ordered as constraints, lower bounds, and upper bounds
+  const Eigen::VectorXd & multipliers = qld_->multipliers();
+  int dim_eq_ineq = dim_eq + dim_ineq;
+  dual_eq_ = multipliers.head(dim_eq);
+  dual_ineq_ = multipliers.segment(dim_eq, dim_ineq);
+  dual_bound_ = multipliers.segment(dim_eq_ineq + dim_var, dim_var) - multipliers.segment(dim_eq_ineq, dim_var);
+
   return qld_->result();
 }
 
+size_t QpSolverQld::memoryUsage() const
+{
+  size_t n = last_dim_var_;
+  size_t m = last_dim_eq_ + last_dim_ineq_;
+  // Real workspace (LWAR), multipliers, solution, and integer workspace (LIWAR) of QLD
+  size_t qld_size = sizeof(Eigen::QLDDirect) + sizeof(double) * (3 * n * n / 2 + 10 * n + 2 * (m + 1) + (m + 2 * n) + n)
+                    + sizeof(int) * n;
+  return QpSolver::memoryUsage() + sizeof(*this) - sizeof(QpSolver) + qld_size;
+}
+
 namespace QpSolverCollection
 {
 std::shared_ptr<QpSolver> allocateQpSolverQld()
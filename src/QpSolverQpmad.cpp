@@ -4,6 +4,8 @@
 
 #if ENABLE_QPMAD
 #  include <qp_solver_collection/QpSolverCollection.h>
+#  include <qp_solver_collection/QpSolverMetrics.h>
+#  include <qp_solver_collection/QpSolverTrace.h>
 
 #  include <qpmad/solver.h>
 
@@ -27,6 +29,16 @@ Eigen::VectorXd QpSolverQpmad::solve(int dim_var,
                                      const Eigen::Ref<const Eigen::VectorXd> & x_min,
                                      const Eigen::Ref<const Eigen::VectorXd> & x_max)
 {
+  QSC_TRACE_SCOPE("QpSolverQpmad::solve");
+  QpMetricsGuard metrics_guard(*this, dim_var);
+  setLastDimension(dim_var, dim_eq, dim_ineq);
+
+  if(presolveFailed(A, b, C, d, x_min, x_max))
+  {
+    return Eigen::VectorXd::Zero(dim_var);
+  }
+
+  QSC_TRACE_PHASE("stack");
   Eigen::MatrixXd AC(dim_eq + dim_ineq, dim_var);
   Eigen::VectorXd bd_min(dim_eq + dim_ineq);
   Eigen::VectorXd bd_max(dim_eq + dim_ineq);
@@ -34,15 +46,60 @@ Eigen::VectorXd QpSolverQpmad::solve(int dim_var,
   bd_min << b, Eigen::VectorXd::Constant(dim_ineq, -1 * std::numeric_limits<double>::infinity());
   bd_max << b, d;
 
+  QSC_TRACE_PHASE("factorize");
+  // QPMAD accepts the lower triangular Cholesky factor L (Q = L L^T), which is not modified unlike the objective matrix
+  Eigen::MatrixXd * obj_mat_factor = objMatFactor(Q, false, false);
+
+  QSC_TRACE_PHASE("init");
+  qpmad::SolverParameters param;
+  if(obj_mat_factor)
+  {
+    param.hessian_type_ = qpmad::SolverParameters::HESSIAN_CHOLESKY_FACTOR;
+  }
+  param.tolerance_ = settings_.absTol(1e-8, 1e-12, 1e-14);
+  if(settings_.max_iter_ > 0)
+  {
+    param.max_iter_ = settings_.max_iter_;
+  }
+  settings_updated_ = false;
+
+  QSC_TRACE_PHASE("iterate");
   Eigen::VectorXd sol;
-  qpmad::Solver::ReturnStatus status = qpmad_->solve(sol, Q, c, x_min, x_max, AC, bd_min, bd_max);
+  qpmad::Solver::ReturnStatus status = qpmad::Solver::UNDEFINED;
+  try
+  {
+    if(obj_mat_factor)
+    {
+      status = qpmad_->solve(sol, *obj_mat_factor, c, x_min, x_max, AC, bd_min, bd_max, param);
+    }
+    else
+    {
+      status = qpmad_->solve(sol, Q, c, x_min, x_max, AC, bd_min, bd_max, param);
+    }
+  }
+  catch(const std::exception & e)
+  {
+    // QPMAD reports infeasibility only by throwing std::runtime_error without a dedicated exception type or return
+    // status, with messages such as "Infeasible equality constraints" and "Infeasible inequality constraints" (see
+    // qpmad/solver.h). The infeasibility is therefore detected from the message, which is checked in
+    // TestQpSolveStatus.InfeasibleQP.
+    status_ = (std::string(e.what()).find("nfeasib") != std::string::npos ? QpSolveStatus::PrimalInfeasible
+                                                                           : QpSolveStatus::NumericalError);
+    solve_failed_ = true;
+    QSC_WARN_STREAM("[QpSolverQpmad::solve] Failed to solve: " << e.what() << " (" << std::to_string(status_) << ")");
+    return Eigen::VectorXd::Zero(dim_var);
+  }
 
+  QSC_TRACE_PHASE("postprocess");
   if(status == qpmad::Solver::OK)
   {
+    status_ = QpSolveStatus::Solved;
     solve_failed_ = false;
   }
   else
   {
+    status_ = (status == qpmad::Solver::MAXIMAL_NUMBER_OF_ITERATIONS ? QpSolveStatus::MaxIterReached
+                                                                      : QpSolveStatus::Unknown);
     solve_failed_ = true;
     QSC_WARN_STREAM("[QpSolverQpmad::solve] Failed to solve: " << static_cast<int>(status));
   }
@@ -50,6 +107,15 @@ Eigen::VectorXd QpSolverQpmad::solve(int dim_var,
   return sol;
 }
 
+size_t QpSolverQpmad::memoryUsage() const
+{
+  size_t n = last_dim_var_;
+  size_t m = last_dim_eq_ + last_dim_ineq_ + n;
+  // Cholesky factor of objective matrix (computed in place), orthogonal basis, and vectors of active set of QPMAD
+  size_t qpmad_size = sizeof(qpmad::Solver) + sizeof(double) * (n * n + 10 * (n + m)) + sizeof(int) * 2 * m;
+  return QpSolver::memoryUsage() + sizeof(*this) - sizeof(QpSolver) + qpmad_size;
+}
+
 namespace QpSolverCollection
 {
 std::shared_ptr<QpSolver> allocateQpSolverQpmad()
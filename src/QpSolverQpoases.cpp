@@ -6,6 +6,8 @@
 #  include <limits>
 
 #  include <qp_solver_collection/QpSolverCollection.h>
+#  include <qp_solver_collection/QpSolverMetrics.h>
+#  include <qp_solver_collection/QpSolverTrace.h>
 
 #  include <qpOASES.hpp>
 
@@ -28,30 +30,124 @@ Eigen::VectorXd QpSolverQpoases::solve(int dim_var,
                                        const Eigen::Ref<const Eigen::VectorXd> & x_min,
                                        const Eigen::Ref<const Eigen::VectorXd> & x_max)
 {
-  Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor> AC_row_major(dim_eq + dim_ineq, dim_var);
+  QSC_TRACE_SCOPE("QpSolverQpoases::solve");
+  QpMetricsGuard metrics_guard(*this, dim_var);
+  setLastDimension(dim_var, dim_eq, dim_ineq);
+
+  if(presolveFailed(A, b, C, d, x_min, x_max))
+  {
+    return Eigen::VectorXd::Zero(dim_var);
+  }
+
+  bool hotstart = !solve_failed_ && !force_initialize_ && !settings_updated_ && qpoases_
+                  && qpoases_->getNV() == dim_var && qpoases_->getNC() == dim_eq + dim_ineq;
+  // Matrices of QpCoeff that are unchanged since the previous solve are not passed (see QpSolver::coeffUnchanged)
+  bool update_mat = !(hotstart && coeffUnchanged(QpCoeff::Block::ObjMat) && coeffUnchanged(QpCoeff::Block::EqMat)
+                      && coeffUnchanged(QpCoeff::Block::IneqMat));
+
+  QSC_TRACE_PHASE("stack");
+  if(update_mat)
+  {
+    Q_ = Q;
+    AC_row_major_.resize(dim_eq + dim_ineq, dim_var);
+    AC_row_major_ << A, C;
+  }
   Eigen::VectorXd bd_min(dim_eq + dim_ineq);
   Eigen::VectorXd bd_max(dim_eq + dim_ineq);
-  AC_row_major << A, C;
   bd_min << b, Eigen::VectorXd::Constant(dim_ineq, -1 * std::numeric_limits<double>::infinity());
   bd_max << b, d;
 
+  // nWSR is overwritten with the number of working set recalculations actually performed
+  int n_wsr = settings_.max_iter_ > 0 ? settings_.max_iter_ : n_wsr_;
+
+  QSC_TRACE_PHASE("hotstart");
   qpOASES::returnValue status = qpOASES::TERMINAL_LIST_ELEMENT;
-  if(!solve_failed_ && !force_initialize_ && qpoases_ && qpoases_->getNV() == dim_var
-     && qpoases_->getNC() == dim_eq + dim_ineq)
+  if(hotstart && update_mat)
   {
     status = qpoases_->hotstart(
         // Since Q is a symmetric matrix, row/column-majors are interchangeable
-        Q.data(), c.data(), AC_row_major.data(), x_min.data(), x_max.data(), bd_min.data(), bd_max.data(), n_wsr_);
+        Q_.data(), c.data(), AC_row_major_.data(), x_min.data(), x_max.data(), bd_min.data(), bd_max.data(), n_wsr);
+  }
+  else if(hotstart)
+  {
+    // Hotstart of QProblem, which keeps the matrices and their factorization
+    status = static_cast<qpOASES::QProblem &>(*qpoases_).hotstart(c.data(), x_min.data(), x_max.data(),
+                                                                  bd_min.data(), bd_max.data(), n_wsr);
   }
   if(status != qpOASES::SUCCESSFUL_RETURN)
   {
+    QSC_TRACE_PHASE("init");
     qpoases_ = std::make_unique<qpOASES::SQProblem>(dim_var, dim_eq + dim_ineq);
-    qpoases_->setPrintLevel(qpOASES::PL_LOW);
-    status = qpoases_->init(
-        // Since Q is a symmetric matrix, row/column-majors are interchangeable
-        Q.data(), c.data(), AC_row_major.data(), x_min.data(), x_max.data(), bd_min.data(), bd_max.data(), n_wsr_);
+
+    qpOASES::Options options;
+    if(settings_.profile_ == QpAccuracyProfile::Fast)
+    {
+      options.setToMPC();
+    }
+    else if(settings_.profile_ == QpAccuracyProfile::Robust)
+    {
+      options.setToReliable();
+    }
+    if(settings_.abs_tol_ > 0)
+    {
+      options.terminationTolerance = settings_.abs_tol_;
+    }
+    options.printLevel = (settings_.verbose_ ? qpOASES::PL_MEDIUM : qpOASES::PL_LOW);
+    auto setBooleanOption = [&](const std::string & key, qpOASES::BooleanType & option) {
+      double value;
+      if(settings_.param(key, value))
+      {
+        option = (value != 0 ? qpOASES::BT_TRUE : qpOASES::BT_FALSE);
+      }
+    };
+    setBooleanOption("enable_regularisation", options.enableRegularisation);
+    setBooleanOption("enable_ramping", options.enableRamping);
+    setBooleanOption("enable_far_bounds", options.enableFarBounds);
+    setBooleanOption("enable_flipping_bounds", options.enableFlippingBounds);
+    qpoases_->setOptions(options);
+    settings_updated_ = false;
+
+    n_wsr = settings_.max_iter_ > 0 ? settings_.max_iter_ : n_wsr_;
+    if(warm_start_)
+    {
+      // The working set is guessed from the nonzero multipliers, which are ordered and signed as those of qpOASES
+      Eigen::VectorXd dual = warm_start_->stackedDual(dim_var, dim_eq, dim_ineq);
+      Eigen::VectorXd y_opt(dim_var + dim_eq + dim_ineq);
+      y_opt << -1 * dual.tail(dim_var), -1 * dual.head(dim_eq + dim_ineq);
+      status = qpoases_->init(Q_.data(), c.data(), AC_row_major_.data(), x_min.data(), x_max.data(), bd_min.data(),
+                              bd_max.data(), n_wsr, nullptr, warm_start_->x_.data(), y_opt.data());
+    }
+    else
+    {
+      status = qpoases_->init(
+          // Since Q is a symmetric matrix, row/column-majors are interchangeable
+          Q_.data(), c.data(), AC_row_major_.data(), x_min.data(), x_max.data(), bd_min.data(), bd_max.data(), n_wsr);
+    }
   }
 
+  QSC_TRACE_PHASE("postprocess");
+  iter_num_ = n_wsr;
+
+  if(status == qpOASES::SUCCESSFUL_RETURN)
+  {
+    status_ = QpSolveStatus::Solved;
+  }
+  else if(qpoases_->isInfeasible() == qpOASES::BT_TRUE)
+  {
+    status_ = QpSolveStatus::PrimalInfeasible;
+  }
+  else if(qpoases_->isUnbounded() == qpOASES::BT_TRUE)
+  {
+    status_ = QpSolveStatus::DualInfeasible;
+  }
+  else if(status == qpOASES::RET_MAX_NWSR_REACHED)
+  {
+    status_ = QpSolveStatus::MaxIterReached;
+  }
+  else
+  {
+    status_ = QpSolveStatus::Unknown;
+  }
   if(status == qpOASES::SUCCESSFUL_RETURN)
   {
     solve_failed_ = false;
@@ -64,9 +160,40 @@ Eigen::VectorXd QpSolverQpoases::solve(int dim_var,
 
   Eigen::VectorXd sol(dim_var);
   qpoases_->getPrimalSolution(sol.data());
+
+  // qpOASES multipliers are ordered as bounds and constraints, and have the opposite sign
+  Eigen::VectorXd dual(dim_var + dim_eq + dim_ineq);
+  qpoases_->getDualSolution(dual.data());
+  dual_bound_ = -1 * dual.head(dim_var);
+  dual_eq_ = -1 * dual.segment(dim_var, dim_eq);
+  dual_ineq_ = -1 * dual.tail(dim_ineq);
+
   return sol;
 }
 
+size_t QpSolverQpoases::memoryUsage() const
+{
+  size_t mat_size = matrixMemoryUsage(Q_) + matrixMemoryUsage(AC_row_major_);
+  if(!qpoases_)
+  {
+    return QpSolver::memoryUsage() + sizeof(*this) - sizeof(QpSolver) + mat_size;
+  }
+  size_t n = last_dim_var_;
+  size_t m = last_dim_eq_ + last_dim_ineq_;
+  // Copies of objective and constraint matrices, factors (Q, R, T), and vectors of bounds and working sets of qpOASES
+  size_t qpoases_size = sizeof(qpOASES::SQProblem) + sizeof(double) * (4 * n * n + m * n + 20 * (n + m))
+                        + sizeof(int) * 6 * (n + m);
+  return QpSolver::memoryUsage() + sizeof(*this) - sizeof(QpSolver) + mat_size + qpoases_size;
+}
+
+size_t QpSolverQpoases::configHash() const
+{
+  size_t hash = QpSolver::configHash();
+  hashCombine(hash, static_cast<size_t>(n_wsr_));
+  hashCombine(hash, static_cast<size_t>(force_initialize_));
+  return hash;
+}
+
 namespace QpSolverCollection
 {
 std::shared_ptr<QpSolver> allocateQpSolverQpoases()
@@ -3,7 +3,11 @@
 #include <qp_solver_collection/QpSolverOptions.h>
 
 #if ENABLE_QUADPROG
+#  include <algorithm>
+
 #  include <qp_solver_collection/QpSolverCollection.h>
+#  include <qp_solver_collection/QpSolverMetrics.h>
+#  include <qp_solver_collection/QpSolverTrace.h>
 
 #  include <eigen-quadprog/QuadProg.h>
 
@@ -27,6 +31,16 @@ Eigen::VectorXd QpSolverQuadprog::solve(int dim_var,
                                         const Eigen::Ref<const Eigen::VectorXd> & x_min,
                                         const Eigen::Ref<const Eigen::VectorXd> & x_max)
 {
+  QSC_TRACE_SCOPE("QpSolverQuadprog::solve");
+  QpMetricsGuard metrics_guard(*this, dim_var);
+  setLastDimension(dim_var, dim_eq, dim_ineq);
+
+  if(presolveFailed(A, b, C, d, x_min, x_max))
+  {
+    return Eigen::VectorXd::Zero(dim_var);
+  }
+
+  QSC_TRACE_PHASE("stack");
   int dim_ineq_with_bound = dim_ineq + 2 * dim_var;
   Eigen::MatrixXd C_with_bound(dim_ineq_with_bound, dim_var);
   Eigen::VectorXd d_with_bound(dim_ineq_with_bound);
@@ -34,22 +48,53 @@ Eigen::VectorXd QpSolverQuadprog::solve(int dim_var,
   C_with_bound << C, I, -I;
   d_with_bound << d, x_max, -x_min;
 
+  QSC_TRACE_PHASE("factorize");
+  // QuadProg accepts the inverse of the upper triangular Cholesky factor R^{-1} (Q = R^T R)
+  const Eigen::MatrixXd * obj_mat_factor = objMatFactor(Q, true, true);
+
+  QSC_TRACE_PHASE("init");
   quadprog_->problem(dim_var, dim_eq, dim_ineq_with_bound);
-  quadprog_->solve(Q, c, A, b, C_with_bound, d_with_bound);
+  QSC_TRACE_PHASE("iterate");
+  if(obj_mat_factor)
+  {
+    quadprog_->solve(*obj_mat_factor, c, A, b, C_with_bound, d_with_bound, true);
+  }
+  else
+  {
+    quadprog_->solve(Q, c, A, b, C_with_bound, d_with_bound);
+  }
 
-  if(quadprog_->fail() == 0)
+  QSC_TRACE_PHASE("postprocess");
+  int fail = quadprog_->fail();
+  if(fail == 0)
   {
+    status_ = QpSolveStatus::Solved;
     solve_failed_ = false;
   }
   else
   {
+    // 1: constraints are inconsistent, 2: objective matrix is not positive definite
+    status_ = (fail == 1 ? QpSolveStatus::PrimalInfeasible
+                         : (fail == 2 ? QpSolveStatus::DualInfeasible : QpSolveStatus::Unknown));
     solve_failed_ = true;
-    QSC_WARN_STREAM("[QpSolverQuadprog::solve] Failed to solve: " << quadprog_->fail());
+    QSC_WARN_STREAM("[QpSolverQuadprog::solve] Failed to solve: " << fail << " (" << std::to_string(status_) << ")");
   }
 
   return quadprog_->result();
 }
 
+size_t QpSolverQuadprog::memoryUsage() const
+{
+  size_t n = last_dim_var_;
+  size_t m = last_dim_eq_ + last_dim_ineq_ + 2 * n;
+  size_t r = std::min(n, m);
+  // Factor of objective matrix, transposed constraints, and workspace of QuadProg
+  size_t quadprog_size = sizeof(Eigen::QuadProgDense)
+                         + sizeof(double) * (n * n + n * m + 3 * n + m + r * (r + 5) / 2 + 2 * m + 1)
+                         + sizeof(int) * (m + 2 * n);
+  return QpSolver::memoryUsage() + sizeof(*this) - sizeof(QpSolver) + quadprog_size;
+}
+
 namespace QpSolverCollection
 {
 std::shared_ptr<QpSolver> allocateQpSolverQuadprog()
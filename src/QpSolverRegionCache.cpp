@@ -0,0 +1,255 @@
+/* Author: Masaki Murooka */
+
+#include <stdexcept>
+
+#include <Eigen/LU>
+
+#include <qp_solver_collection/QpSolverRegionCache.h>
+
+#include "QpActiveSet.h"
+
+using namespace QpSolverCollection;
+using detail::isFiniteBound;
+
+size_t QpCriticalRegion::memoryUsage() const
+{
+  return sizeof(QpCriticalRegion) + sizeof(double) * kkt_inv.size()
+         + sizeof(int) * (active_ineq_list.size() + active_lower_list.size() + active_upper_list.size());
+}
+
+QpSolverRegionCache::QpSolverRegionCache(const QpSolverType & qp_solver_type)
+: QpSolverRegionCache(allocateQpSolver(qp_solver_type))
+{
+}
+
+QpSolverRegionCache::QpSolverRegionCache(const std::shared_ptr<QpSolver> & qp_solver) : backend_(qp_solver)
+{
+  if(!backend_)
+  {
+    throw std::runtime_error("[QpSolverRegionCache] Backend QP solver instance is null.");
+  }
+  type_ = backend_->type();
+}
+
+Eigen::VectorXd QpSolverRegionCache::solve(int dim_var,
+                                           int dim_eq,
+                                           int dim_ineq,
+                                           Eigen::Ref<Eigen::MatrixXd> Q,
+                                           const Eigen::Ref<const Eigen::VectorXd> & c,
+                                           const Eigen::Ref<const Eigen::MatrixXd> & A,
+                                           const Eigen::Ref<const Eigen::VectorXd> & b,
+                                           const Eigen::Ref<const Eigen::MatrixXd> & C,
+                                           const Eigen::Ref<const Eigen::VectorXd> & d,
+                                           const Eigen::Ref<const Eigen::VectorXd> & x_min,
+                                           const Eigen::Ref<const Eigen::VectorXd> & x_max)
+{
+  updateMatrices(Q, A, C);
+
+  // Point location in the cached regions
+  for(auto it = region_list_.begin(); it != region_list_.end(); it++)
+  {
+    if(evaluateRegion(*it, c, b, d, x_min, x_max, sol_))
+    {
+      hit_count_++;
+      region_list_.splice(region_list_.begin(), region_list_, it);
+      setDual(region_list_.front(), sol_);
+      solve_failed_ = false;
+      status_ = QpSolveStatus::Solved;
+      iter_num_ = 0;
+      return sol_.head(dim_var);
+    }
+  }
+
+  // Solve with the backend
+  miss_count_++;
+  Eigen::VectorXd x = warm_start_
+                          ? backend_->solve(dim_var, dim_eq, dim_ineq, Q, c, A, b, C, d, x_min, x_max, *warm_start_)
+                          : backend_->solve(dim_var, dim_eq, dim_ineq, Q, c, A, b, C, d, x_min, x_max);
+  solve_failed_ = backend_->solveFailed();
+  status_ = backend_->status();
+  iter_num_ = backend_->iterNum();
+  dual_eq_ = backend_->dualEq();
+  dual_ineq_ = backend_->dualIneq();
+  dual_bound_ = backend_->dualBound();
+  if(!solve_failed_)
+  {
+    addRegion(x, c, b, d, x_min, x_max);
+  }
+  return x;
+}
+
+void QpSolverRegionCache::setSettings(const QpSolverSettings & settings)
+{
+  QpSolver::setSettings(settings);
+  backend_->setSettings(settings);
+}
+
+size_t QpSolverRegionCache::memoryUsage() const
+{
+  return QpSolver::memoryUsage() + sizeof(*this) - sizeof(QpSolver) + backend_->memoryUsage() + memory_usage_
+         + matrixMemoryUsage(Q_) + matrixMemoryUsage(A_) + matrixMemoryUsage(C_) + matrixMemoryUsage(rhs_)
+         + matrixMemoryUsage(sol_);
+}
+
+size_t QpSolverRegionCache::configHash() const
+{
+  size_t hash = backend_->configHash();
+  hashCombineDouble(hash, feasibility_tol_);
+  hashCombineDouble(hash, active_tol_);
+  return hash;
+}
+
+void QpSolverRegionCache::clear()
+{
+  region_list_.clear();
+  memory_usage_ = 0;
+  hit_count_ = 0;
+  miss_count_ = 0;
+}
+
+void QpSolverRegionCache::updateMatrices(const Eigen::Ref<const Eigen::MatrixXd> & Q,
+                                         const Eigen::Ref<const Eigen::MatrixXd> & A,
+                                         const Eigen::Ref<const Eigen::MatrixXd> & C)
+{
+  auto isSame = [](const Eigen::MatrixXd & stored, const Eigen::Ref<const Eigen::MatrixXd> & mat) {
+    return stored.rows() == mat.rows() && stored.cols() == mat.cols() && stored == mat;
+  };
+  if(isSame(Q_, Q) && isSame(A_, A) && isSame(C_, C))
+  {
+    return;
+  }
+
+  // The solution laws of the cached regions are no longer valid
+  region_list_.clear();
+  memory_usage_ = 0;
+  Q_ = Q;
+  A_ = A;
+  C_ = C;
+}
+
+bool QpSolverRegionCache::evaluateRegion(const QpCriticalRegion & region,
+                                         const Eigen::Ref<const Eigen::VectorXd> & c,
+                                         const Eigen::Ref<const Eigen::VectorXd> & b,
+                                         const Eigen::Ref<const Eigen::VectorXd> & d,
+                                         const Eigen::Ref<const Eigen::VectorXd> & x_min,
+                                         const Eigen::Ref<const Eigen::VectorXd> & x_max,
+                                         Eigen::VectorXd & sol)
+{
+  Eigen::Index dim_var = c.size();
+  Eigen::Index dim_eq = b.size();
+
+  // Active bounds may have been removed
+  for(int i : region.active_lower_list)
+  {
+    if(!isFiniteBound(x_min[i]))
+    {
+      return false;
+    }
+  }
+  for(int i : region.active_upper_list)
+  {
+    if(!isFiniteBound(x_max[i]))
+    {
+      return false;
+    }
+  }
+
+  // Assemble the right-hand side of KKT system
+  rhs_.resize(region.kkt_inv.rows());
+  rhs_.head(dim_var) = -c;
+  detail::assembleActiveVec(b, d, x_min, x_max, region.active_ineq_list, region.active_lower_list,
+                            region.active_upper_list, rhs_.tail(rhs_.size() - dim_var));
+
+  sol.noalias() = region.kkt_inv * rhs_;
+
+  // Check dual feasibility
+  Eigen::Index row_idx = dim_var + dim_eq;
+  for(size_t i = 0; i < region.active_ineq_list.size(); i++)
+  {
+    if(sol[row_idx++] < -feasibility_tol_)
+    {
+      return false;
+    }
+  }
+  for(size_t i = 0; i < region.active_lower_list.size(); i++)
+  {
+    if(sol[row_idx++] > feasibility_tol_)
+    {
+      return false;
+    }
+  }
+  for(size_t i = 0; i < region.active_upper_list.size(); i++)
+  {
+    if(sol[row_idx++] < -feasibility_tol_)
+    {
+      return false;
+    }
+  }
+
+  // Check primal feasibility
+  const auto & x = sol.head(dim_var);
+  if((x - x_min).minCoeff() < -feasibility_tol_ || (x_max - x).minCoeff() < -feasibility_tol_)
+  {
+    return false;
+  }
+  if(C_.rows() > 0 && (d - C_ * x).minCoeff() < -feasibility_tol_)
+  {
+    return false;
+  }
+
+  return true;
+}
+
+void QpSolverRegionCache::addRegion(const Eigen::VectorXd & x,
+                                    const Eigen::Ref<const Eigen::VectorXd> & c,
+                                    const Eigen::Ref<const Eigen::VectorXd> & b,
+                                    const Eigen::Ref<const Eigen::VectorXd> & d,
+                                    const Eigen::Ref<const Eigen::VectorXd> & x_min,
+                                    const Eigen::Ref<const Eigen::VectorXd> & x_max)
+{
+  // Determine the active set from Lagrange multipliers if available, otherwise from the constraint slacks
+  QpCriticalRegion region;
+  detail::detectActiveSet(x, C_, d, x_min, x_max, dual_ineq_, dual_bound_, active_tol_, region.active_ineq_list,
+                          region.active_lower_list, region.active_upper_list);
+
+  // Skip if the active set is already cached (i.e., the vectors are slightly outside of the region)
+  for(const auto & cached_region : region_list_)
+  {
+    if(cached_region.active_ineq_list == region.active_ineq_list
+       && cached_region.active_lower_list == region.active_lower_list
+       && cached_region.active_upper_list == region.active_upper_list)
+    {
+      return;
+    }
+  }
+
+  // Degenerate active sets (e.g., linearly dependent active constraints) are not cached
+  Eigen::FullPivLU<Eigen::MatrixXd> lu(detail::assembleKktMat(Q_, A_, C_, region.active_ineq_list,
+                                                              region.active_lower_list, region.active_upper_list));
+  if(!lu.isInvertible())
+  {
+    return;
+  }
+  region.kkt_inv = lu.inverse();
+
+  // Cache only if the current vectors are in the region, which guards against the misidentified active set
+  if(!evaluateRegion(region, c, b, d, x_min, x_max, sol_))
+  {
+    return;
+  }
+
+  memory_usage_ += region.memoryUsage();
+  region_list_.push_front(std::move(region));
+  while(memory_usage_ > memory_limit_ && !region_list_.empty())
+  {
+    memory_usage_ -= region_list_.back().memoryUsage();
+    region_list_.pop_back();
+  }
+}
+
+void QpSolverRegionCache::setDual(const QpCriticalRegion & region, const Eigen::VectorXd & sol)
+{
+  Eigen::Index dim_var = Q_.rows();
+  detail::scatterDual(sol.tail(sol.size() - dim_var), dim_var, A_.rows(), C_.rows(), region.active_ineq_list,
+                      region.active_lower_list, region.active_upper_list, dual_eq_, dual_ineq_, dual_bound_);
+}
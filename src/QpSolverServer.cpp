@@ -0,0 +1,689 @@
+/* Author: Masaki Murooka */
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <new>
+#include <stdexcept>
+
+#include <qp_solver_collection/QpSolverServer.h>
+
+using namespace QpSolverCollection;
+
+namespace
+{
+//! Magic number to check that the shared memory is initialized (ASCII "QSCSHM04" including the layout version)
+constexpr uint64_t shm_magic = 0x51534353484d3034ull;
+
+//! Number of busy-wait iterations before yielding
+constexpr int spin_num = 1000;
+
+static_assert(std::atomic<uint32_t>::is_always_lock_free && std::atomic<uint64_t>::is_always_lock_free,
+              "Atomic variables in shared memory must be lock-free.");
+
+enum SlotState : uint32_t
+{
+  Free = 0,
+  Writing,
+  Requested,
+  Done,
+  //! Given up by the client after timeout, and reclaimed by the server
+  Abandoned
+};
+
+struct ShmHeader
+{
+  std::atomic<uint64_t> magic;
+  int32_t qp_solver_type;
+  int32_t max_dim_var;
+  int32_t max_dim_eq;
+  int32_t max_dim_ineq;
+  uint32_t slot_num;
+  uint32_t ring_mask;
+  uint64_t slot_stride;
+  alignas(64) std::atomic<uint64_t> enqueue_pos;
+  alignas(64) std::atomic<uint64_t> dequeue_pos;
+};
+
+struct RingCell
+{
+  std::atomic<uint64_t> sequence;
+  uint32_t slot_idx;
+};
+
+struct SlotHeader
+{
+  std::atomic<uint32_t> state;
+  int32_t dim_var;
+  int32_t dim_eq;
+  int32_t dim_ineq;
+  int32_t solve_failed;
+  int32_t status;
+  int32_t has_dual;
+};
+
+constexpr size_t alignUp(size_t size, size_t align = 64)
+{
+  return (size + align - 1) / align * align;
+}
+
+/** \brief Number of doubles in a slot with the dimensions (coefficients, solution, and Lagrange multipliers).
+
+    This must be consistent with the layout in the constructor of QpShmRequest: Q and c, A and b, C and d, x_min,
+   x_max, x, and the Lagrange multipliers of equality constraints, inequality constraints, and bounds.
+ */
+inline size_t slotDataSize(size_t dim_var, size_t dim_eq, size_t dim_ineq)
+{
+  return (dim_var + dim_eq + dim_ineq + 1) * dim_var + dim_eq + dim_ineq + 3 * dim_var + dim_eq + dim_ineq + dim_var;
+}
+
+/** \brief Size of a slot (header and data) with the maximum dimensions. */
+inline size_t slotStride(size_t max_dim_var, size_t max_dim_eq, size_t max_dim_ineq)
+{
+  return alignUp(sizeof(SlotHeader)) + alignUp(sizeof(double) * slotDataSize(max_dim_var, max_dim_eq, max_dim_ineq));
+}
+
+/** \brief Size of the whole shared memory. */
+inline size_t shmSize(size_t ring_capacity, size_t slot_stride, size_t slot_num)
+{
+  return alignUp(sizeof(ShmHeader)) + alignUp(sizeof(RingCell) * ring_capacity) + slot_stride * slot_num;
+}
+
+std::string shmName(const std::string & name)
+{
+  return (!name.empty() && name[0] == '/') ? name : "/" + name;
+}
+
+inline void spinWait(int & spin_count)
+{
+  if(++spin_count > spin_num)
+  {
+    std::this_thread::yield();
+  }
+}
+} // namespace
+
+namespace QpSolverCollection
+{
+namespace detail
+{
+/** \brief Mapped region of shared memory. */
+class QpShmRegion
+{
+public:
+  /** \brief Create shared memory. */
+  QpShmRegion(const std::string & name, QpSolverType qp_solver_type, const QpShmConfig & config)
+  : name_(shmName(name)), owner_(true)
+  {
+    if(config.max_dim_var <= 0 || config.max_dim_eq < 0 || config.max_dim_ineq < 0 || config.slot_num <= 0)
+    {
+      throw std::runtime_error("[QpShmRegion] Invalid configuration of shared memory.");
+    }
+
+    uint32_t ring_capacity = 1;
+    while(ring_capacity < static_cast<uint32_t>(config.slot_num))
+    {
+      ring_capacity <<= 1;
+    }
+    size_t slot_stride = slotStride(config.max_dim_var, config.max_dim_eq, config.max_dim_ineq);
+    size_ = shmSize(ring_capacity, slot_stride, config.slot_num);
+
+    // The existing one may be used by a running server, so it is removed only if requested explicitly
+    if(config.remove_existing)
+    {
+      shm_unlink(name_.c_str());
+    }
+    int fd = shm_open(name_.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+    if(fd < 0)
+    {
+      std::string hint = (errno == EEXIST ? " (set QpShmConfig::remove_existing to remove the stale one)" : "");
+      throw std::runtime_error("[QpShmRegion] Failed to create shared memory " + name_ + ": " + std::strerror(errno)
+                               + hint);
+    }
+    if(ftruncate(fd, static_cast<off_t>(size_)) != 0)
+    {
+      close(fd);
+      shm_unlink(name_.c_str());
+      throw std::runtime_error("[QpShmRegion] Failed to resize shared memory " + name_ + ": " + std::strerror(errno));
+    }
+    map(fd);
+
+    header_ = new(addr_) ShmHeader;
+    header_->qp_solver_type = static_cast<int32_t>(qp_solver_type);
+    header_->max_dim_var = config.max_dim_var;
+    header_->max_dim_eq = config.max_dim_eq;
+    header_->max_dim_ineq = config.max_dim_ineq;
+    header_->slot_num = static_cast<uint32_t>(config.slot_num);
+    header_->ring_mask = ring_capacity - 1;
+    header_->slot_stride = slot_stride;
+    header_->enqueue_pos.store(0, std::memory_order_relaxed);
+    header_->dequeue_pos.store(0, std::memory_order_relaxed);
+    setupLayout(config.max_dim_var, config.max_dim_eq, config.max_dim_ineq, config.slot_num, ring_capacity,
+                slot_stride);
+    for(uint32_t i = 0; i < ring_capacity; i++)
+    {
+      new(&ring_[i]) RingCell;
+      ring_[i].sequence.store(i, std::memory_order_relaxed);
+    }
+    for(int i = 0; i < config.slot_num; i++)
+    {
+      new(slot(i)) SlotHeader;
+      slot(i)->state.store(SlotState::Free, std::memory_order_relaxed);
+    }
+    header_->magic.store(shm_magic, std::memory_order_release);
+  }
+
+  /** \brief Open shared memory. */
+  explicit QpShmRegion(const std::string & name) : name_(shmName(name)), owner_(false)
+  {
+    int fd = shm_open(name_.c_str(), O_RDWR, 0600);
+    if(fd < 0)
+    {
+      throw std::runtime_error("[QpShmRegion] Failed to open shared memory " + name_ + ": " + std::strerror(errno));
+    }
+    struct stat st;
+    if(fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < sizeof(ShmHeader))
+    {
+      close(fd);
+      throw std::runtime_error("[QpShmRegion] Invalid size of shared memory " + name_);
+    }
+    size_ = static_cast<size_t>(st.st_size);
+    map(fd);
+
+    header_ = reinterpret_cast<ShmHeader *>(addr_);
+    if(header_->magic.load(std::memory_order_acquire) != shm_magic)
+    {
+      munmap(addr_, size_);
+      throw std::runtime_error("[QpShmRegion] Shared memory " + name_ + " is not initialized by QpSolverServer.");
+    }
+
+    // The layout is copied and checked against the size so that later modifications of the header by other
+    // processes cannot make this process access outside the mapping
+    int max_dim_var = header_->max_dim_var;
+    int max_dim_eq = header_->max_dim_eq;
+    int max_dim_ineq = header_->max_dim_ineq;
+    int slot_num = static_cast<int>(header_->slot_num);
+    uint32_t ring_capacity = header_->ring_mask + 1;
+    if(max_dim_var <= 0 || max_dim_eq < 0 || max_dim_ineq < 0 || slot_num <= 0 || ring_capacity == 0
+       || (ring_capacity & (ring_capacity - 1)) != 0 || ring_capacity < static_cast<uint32_t>(slot_num)
+       || header_->slot_stride != slotStride(max_dim_var, max_dim_eq, max_dim_ineq)
+       || shmSize(ring_capacity, header_->slot_stride, slot_num) > size_)
+    {
+      munmap(addr_, size_);
+      throw std::runtime_error("[QpShmRegion] Invalid layout of shared memory " + name_);
+    }
+    setupLayout(max_dim_var, max_dim_eq, max_dim_ineq, slot_num, ring_capacity, header_->slot_stride);
+  }
+
+  /** \brief Destructor. */
+  ~QpShmRegion()
+  {
+    munmap(addr_, size_);
+    if(owner_)
+    {
+      shm_unlink(name_.c_str());
+    }
+  }
+
+  /** \brief Push the slot index to the ring (multi-producer). */
+  bool enqueue(uint32_t slot_idx)
+  {
+    uint64_t pos = header_->enqueue_pos.load(std::memory_order_relaxed);
+    RingCell * cell;
+    while(true)
+    {
+      cell = &ring_[pos & ring_mask_];
+      uint64_t seq = cell->sequence.load(std::memory_order_acquire);
+      int64_t diff = static_cast<int64_t>(seq) - static_cast<int64_t>(pos);
+      if(diff == 0)
+      {
+        if(header_->enqueue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+        {
+          break;
+        }
+      }
+      else if(diff < 0)
+      {
+        return false;
+      }
+      else
+      {
+        pos = header_->enqueue_pos.load(std::memory_order_relaxed);
+      }
+    }
+    cell->slot_idx = slot_idx;
+    cell->sequence.store(pos + 1, std::memory_order_release);
+    return true;
+  }
+
+  /** \brief Pop the slot index from the ring (multi-consumer). */
+  bool dequeue(uint32_t & slot_idx)
+  {
+    uint64_t pos = header_->dequeue_pos.load(std::memory_order_relaxed);
+    RingCell * cell;
+    while(true)
+    {
+      cell = &ring_[pos & ring_mask_];
+      uint64_t seq = cell->sequence.load(std::memory_order_acquire);
+      int64_t diff = static_cast<int64_t>(seq) - static_cast<int64_t>(pos + 1);
+      if(diff == 0)
+      {
+        if(header_->dequeue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+        {
+          break;
+        }
+      }
+      else if(diff < 0)
+      {
+        return false;
+      }
+      else
+      {
+        pos = header_->dequeue_pos.load(std::memory_order_relaxed);
+      }
+    }
+    slot_idx = cell->slot_idx;
+    cell->sequence.store(pos + ring_mask_ + 1, std::memory_order_release);
+    return true;
+  }
+
+  /** \brief Get the header of the slot. */
+  inline SlotHeader * slot(size_t slot_idx) const
+  {
+    return reinterpret_cast<SlotHeader *>(slots_ + slot_idx * slot_stride_);
+  }
+
+  /** \brief Get the coefficient data of the slot. */
+  inline double * slotData(size_t slot_idx) const
+  {
+    return reinterpret_cast<double *>(slots_ + slot_idx * slot_stride_ + alignUp(sizeof(SlotHeader)));
+  }
+
+  /** \brief Check whether the slot index and the dimensions are within the layout. */
+  inline bool validRequest(uint32_t slot_idx, int dim_var, int dim_eq, int dim_ineq) const
+  {
+    return slot_idx < static_cast<uint32_t>(slot_num_) && dim_var >= 0 && dim_var <= max_dim_var_ && dim_eq >= 0
+           && dim_eq <= max_dim_eq_ && dim_ineq >= 0 && dim_ineq <= max_dim_ineq_;
+  }
+
+  /** \brief Make the request mapped onto the slot. */
+  inline QpShmRequest request(int slot_idx) const
+  {
+    const SlotHeader * slot_header = slot(slot_idx);
+    return QpShmRequest(slot_idx, slot_header->dim_var, slot_header->dim_eq, slot_header->dim_ineq,
+                        slotData(slot_idx));
+  }
+
+protected:
+  void map(int fd)
+  {
+    addr_ = mmap(nullptr, size_, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if(addr_ == MAP_FAILED)
+    {
+      if(owner_)
+      {
+        shm_unlink(name_.c_str());
+      }
+      throw std::runtime_error("[QpShmRegion] Failed to map shared memory " + name_ + ": " + std::strerror(errno));
+    }
+  }
+
+  void setupLayout(int max_dim_var,
+                   int max_dim_eq,
+                   int max_dim_ineq,
+                   int slot_num,
+                   uint32_t ring_capacity,
+                   size_t slot_stride)
+  {
+    max_dim_var_ = max_dim_var;
+    max_dim_eq_ = max_dim_eq;
+    max_dim_ineq_ = max_dim_ineq;
+    slot_num_ = slot_num;
+    ring_mask_ = ring_capacity - 1;
+    slot_stride_ = slot_stride;
+    ring_ = reinterpret_cast<RingCell *>(static_cast<char *>(addr_) + alignUp(sizeof(ShmHeader)));
+    slots_ = reinterpret_cast<char *>(ring_) + alignUp(sizeof(RingCell) * ring_capacity);
+  }
+
+public:
+  std::string name_;
+  bool owner_;
+  size_t size_ = 0;
+  void * addr_ = nullptr;
+  ShmHeader * header_ = nullptr;
+  RingCell * ring_ = nullptr;
+  char * slots_ = nullptr;
+
+  //! Layout copied from the header when the shared memory is created or opened
+  int max_dim_var_ = 0;
+  int max_dim_eq_ = 0;
+  int max_dim_ineq_ = 0;
+  int slot_num_ = 0;
+  uint64_t ring_mask_ = 0;
+  size_t slot_stride_ = 0;
+};
+} // namespace detail
+} // namespace QpSolverCollection
+
+QpShmRequest::QpShmRequest(int slot_idx, int dim_var, int dim_eq, int dim_ineq, double * data)
+: slot_idx_(slot_idx), obj_mat_(data, dim_var, dim_var), obj_vec_(obj_mat_.data() + obj_mat_.size(), dim_var),
+  eq_mat_(obj_vec_.data() + dim_var, dim_eq, dim_var), eq_vec_(eq_mat_.data() + eq_mat_.size(), dim_eq),
+  ineq_mat_(eq_vec_.data() + dim_eq, dim_ineq, dim_var), ineq_vec_(ineq_mat_.data() + ineq_mat_.size(), dim_ineq),
+  x_min_(ineq_vec_.data() + dim_ineq, dim_var), x_max_(x_min_.data() + dim_var, dim_var),
+  x_(x_max_.data() + dim_var, dim_var), dual_eq_(x_.data() + dim_var, dim_eq),
+  dual_ineq_(dual_eq_.data() + dim_eq, dim_ineq), dual_bound_(dual_ineq_.data() + dim_ineq, dim_var)
+{
+}
+
+QpSolverServer::QpSolverServer(const std::string & name,
+                               const QpSolverType & qp_solver_type,
+                               const QpShmConfig & config,
+                               int thread_num)
+{
+  QpSolverType resolved_type = (qp_solver_type == QpSolverType::Any ? getAnyQpSolverType() : qp_solver_type);
+  for(int i = 0; i < std::max(thread_num, 1); i++)
+  {
+    std::shared_ptr<QpSolver> qp_solver = allocateQpSolver(resolved_type);
+    if(!qp_solver)
+    {
+      throw std::runtime_error("[QpSolverServer] Failed to allocate QP solver " + std::to_string(resolved_type));
+    }
+    qp_solver_list_.push_back(qp_solver);
+  }
+  region_ = std::make_unique<detail::QpShmRegion>(name, resolved_type, config);
+}
+
+QpSolverServer::~QpSolverServer()
+{
+  stop();
+}
+
+void QpSolverServer::start()
+{
+  if(running_)
+  {
+    return;
+  }
+  running_ = true;
+  for(size_t i = 0; i < qp_solver_list_.size(); i++)
+  {
+    thread_list_.emplace_back(&QpSolverServer::workerLoop, this, static_cast<int>(i));
+  }
+}
+
+void QpSolverServer::stop()
+{
+  running_ = false;
+  for(auto & thread : thread_list_)
+  {
+    thread.join();
+  }
+  thread_list_.clear();
+}
+
+void QpSolverServer::setSettings(const QpSolverSettings & settings)
+{
+  if(running_)
+  {
+    QSC_WARN_STREAM("[QpSolverServer::setSettings] Settings cannot be changed while worker threads are running.");
+    return;
+  }
+  for(auto & qp_solver : qp_solver_list_)
+  {
+    qp_solver->setSettings(settings);
+  }
+}
+
+void QpSolverServer::workerLoop(int thread_idx)
+{
+  const std::shared_ptr<QpSolver> & qp_solver = qp_solver_list_[thread_idx];
+  int spin_count = 0;
+  while(running_.load(std::memory_order_relaxed))
+  {
+    uint32_t slot_idx;
+    if(!region_->dequeue(slot_idx))
+    {
+      spinWait(spin_count);
+      continue;
+    }
+    spin_count = 0;
+
+    // The slot index and the dimensions written by other processes are checked before mapping the slot
+    if(slot_idx >= static_cast<uint32_t>(region_->slot_num_))
+    {
+      QSC_ERROR_STREAM("[QpSolverServer] Invalid slot index: " << slot_idx);
+      continue;
+    }
+    SlotHeader * slot_header = region_->slot(slot_idx);
+    uint32_t state = slot_header->state.load(std::memory_order_acquire);
+    if(state == SlotState::Abandoned)
+    {
+      slot_header->state.store(SlotState::Free, std::memory_order_release);
+      continue;
+    }
+    if(state != SlotState::Requested)
+    {
+      QSC_ERROR_STREAM("[QpSolverServer] Slot " << slot_idx << " is not requested: " << state);
+      continue;
+    }
+
+    int dim_var = slot_header->dim_var;
+    int dim_eq = slot_header->dim_eq;
+    int dim_ineq = slot_header->dim_ineq;
+    if(!region_->validRequest(slot_idx, dim_var, dim_eq, dim_ineq))
+    {
+      QSC_ERROR_STREAM("[QpSolverServer] Invalid dimensions (" << dim_var << ", " << dim_eq << ", " << dim_ineq
+                                                               << ") in slot " << slot_idx);
+      slot_header->solve_failed = 1;
+      slot_header->status = static_cast<int32_t>(QpSolveStatus::InvalidInput);
+      slot_header->has_dual = 0;
+    }
+    else
+    {
+      QpShmRequest request(static_cast<int>(slot_idx), dim_var, dim_eq, dim_ineq, region_->slotData(slot_idx));
+      try
+      {
+        request.x_ = qp_solver->solve(dim_var, dim_eq, dim_ineq, request.obj_mat_, request.obj_vec_, request.eq_mat_,
+                                      request.eq_vec_, request.ineq_mat_, request.ineq_vec_, request.x_min_,
+                                      request.x_max_);
+        slot_header->solve_failed = qp_solver->solveFailed();
+        slot_header->status = static_cast<int32_t>(qp_solver->status());
+        const Eigen::VectorXd & dual_eq = qp_solver->dualEq();
+        const Eigen::VectorXd & dual_ineq = qp_solver->dualIneq();
+        const Eigen::VectorXd & dual_bound = qp_solver->dualBound();
+        slot_header->has_dual =
+            (dual_eq.size() == dim_eq && dual_ineq.size() == dim_ineq && dual_bound.size() == dim_var);
+        if(slot_header->has_dual)
+        {
+          request.dual_eq_ = dual_eq;
+          request.dual_ineq_ = dual_ineq;
+          request.dual_bound_ = dual_bound;
+        }
+      }
+      catch(const std::exception & e)
+      {
+        QSC_ERROR_STREAM("[QpSolverServer] Exception while solving: " << e.what());
+        request.x_.setZero();
+        slot_header->solve_failed = 1;
+        slot_header->status = static_cast<int32_t>(QpSolveStatus::Unknown);
+        slot_header->has_dual = 0;
+      }
+    }
+
+    // The slot abandoned by the client during the solve is reclaimed
+    uint32_t expected = SlotState::Requested;
+    if(!slot_header->state.compare_exchange_strong(expected, SlotState::Done, std::memory_order_acq_rel))
+    {
+      slot_header->state.store(SlotState::Free, std::memory_order_release);
+    }
+    solved_count_++;
+  }
+}
+
+QpSolverClient::QpSolverClient(const std::string & name)
+{
+  region_ = std::make_unique<detail::QpShmRegion>(name);
+  type_ = static_cast<QpSolverType>(region_->header_->qp_solver_type);
+}
+
+QpSolverClient::~QpSolverClient() {}
+
+Eigen::VectorXd QpSolverClient::solve(int dim_var,
+                                      int dim_eq,
+                                      int dim_ineq,
+                                      Eigen::Ref<Eigen::MatrixXd> Q,
+                                      const Eigen::Ref<const Eigen::VectorXd> & c,
+                                      const Eigen::Ref<const Eigen::MatrixXd> & A,
+                                      const Eigen::Ref<const Eigen::VectorXd> & b,
+                                      const Eigen::Ref<const Eigen::MatrixXd> & C,
+                                      const Eigen::Ref<const Eigen::VectorXd> & d,
+                                      const Eigen::Ref<const Eigen::VectorXd> & x_min,
+                                      const Eigen::Ref<const Eigen::VectorXd> & x_max)
+{
+  QpShmRequest request = acquire(dim_var, dim_eq, dim_ineq);
+  request.obj_mat_ = Q;
+  request.obj_vec_ = c;
+  request.eq_mat_ = A;
+  request.eq_vec_ = b;
+  request.ineq_mat_ = C;
+  request.ineq_vec_ = d;
+  request.x_min_ = x_min;
+  request.x_max_ = x_max;
+  submit(request);
+
+  if(!wait(request))
+  {
+    // The slot is not released because the server may still write to it, but handed over to the server
+    QSC_ERROR_STREAM("[QpSolverClient::solve] Timeout of waiting for the server.");
+    abandon(request);
+    solve_failed_ = true;
+    status_ = QpSolveStatus::Unknown;
+    dual_eq_.resize(0);
+    dual_ineq_.resize(0);
+    dual_bound_.resize(0);
+    return Eigen::VectorXd::Zero(dim_var);
+  }
+
+  Eigen::VectorXd x = request.x_;
+  solve_failed_ = requestFailed(request);
+  status_ = requestStatus(request);
+  if(requestHasDual(request))
+  {
+    dual_eq_ = request.dual_eq_;
+    dual_ineq_ = request.dual_ineq_;
+    dual_bound_ = request.dual_bound_;
+  }
+  else
+  {
+    dual_eq_.resize(0);
+    dual_ineq_.resize(0);
+    dual_bound_.resize(0);
+  }
+  release(request);
+  return x;
+}
+
+QpShmRequest QpSolverClient::acquire(int dim_var, int dim_eq, int dim_ineq)
+{
+  if(!region_->validRequest(0, dim_var, dim_eq, dim_ineq))
+  {
+    throw std::runtime_error("[QpSolverClient::acquire] Dimensions (" + std::to_string(dim_var) + ", "
+                             + std::to_string(dim_eq) + ", " + std::to_string(dim_ineq)
+                             + ") exceed the maximum dimensions of shared memory.");
+  }
+
+  int slot_num = region_->slot_num_;
+  auto start_time = clock::now();
+  int spin_count = 0;
+  while(true)
+  {
+    for(int i = 0; i < slot_num; i++)
+    {
+      int slot_idx = (slot_hint_ + i) % slot_num;
+      SlotHeader * slot_header = region_->slot(slot_idx);
+      uint32_t expected = SlotState::Free;
+      if(slot_header->state.compare_exchange_strong(expected, SlotState::Writing, std::memory_order_acquire))
+      {
+        slot_hint_ = (slot_idx + 1) % slot_num;
+        slot_header->dim_var = dim_var;
+        slot_header->dim_eq = dim_eq;
+        slot_header->dim_ineq = dim_ineq;
+        slot_header->solve_failed = 0;
+        slot_header->status = static_cast<int32_t>(QpSolveStatus::Unsolved);
+        slot_header->has_dual = 0;
+        return region_->request(slot_idx);
+      }
+    }
+    spinWait(spin_count);
+    if(spin_count > spin_num
+       && std::chrono::duration_cast<std::chrono::duration<double>>(clock::now() - start_time).count() > timeout_)
+    {
+      throw std::runtime_error("[QpSolverClient::acquire] Timeout of waiting for a free slot.");
+    }
+  }
+}
+
+void QpSolverClient::submit(const QpShmRequest & request)
+{
+  region_->slot(request.slotIdx())->state.store(SlotState::Requested, std::memory_order_release);
+  // The ring never overflows since its capacity is not less than the number of slots
+  region_->enqueue(static_cast<uint32_t>(request.slotIdx()));
+}
+
+bool QpSolverClient::poll(const QpShmRequest & request) const
+{
+  return region_->slot(request.slotIdx())->state.load(std::memory_order_acquire) == SlotState::Done;
+}
+
+bool QpSolverClient::wait(const QpShmRequest & request)
+{
+  auto start_time = clock::now();
+  int spin_count = 0;
+  while(!poll(request))
+  {
+    spinWait(spin_count);
+    if(spin_count > spin_num
+       && std::chrono::duration_cast<std::chrono::duration<double>>(clock::now() - start_time).count() > timeout_)
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool QpSolverClient::requestFailed(const QpShmRequest & request) const
+{
+  return region_->slot(request.slotIdx())->solve_failed != 0;
+}
+
+QpSolveStatus QpSolverClient::requestStatus(const QpShmRequest & request) const
+{
+  return static_cast<QpSolveStatus>(region_->slot(request.slotIdx())->status);
+}
+
+bool QpSolverClient::requestHasDual(const QpShmRequest & request) const
+{
+  return region_->slot(request.slotIdx())->has_dual != 0;
+}
+
+void QpSolverClient::release(const QpShmRequest & request)
+{
+  region_->slot(request.slotIdx())->state.store(SlotState::Free, std::memory_order_release);
+}
+
+void QpSolverClient::abandon(const QpShmRequest & request)
+{
+  // The server reclaims the slot when it finishes or skips the request. The slot solved in the meantime is released.
+  std::atomic<uint32_t> & state = region_->slot(request.slotIdx())->state;
+  uint32_t expected = SlotState::Requested;
+  if(!state.compare_exchange_strong(expected, SlotState::Abandoned, std::memory_order_acq_rel))
+  {
+    state.store(SlotState::Free, std::memory_order_release);
+  }
+}
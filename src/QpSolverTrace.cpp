@@ -0,0 +1,211 @@
+/* Author: Masaki Murooka */
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+
+#include <qp_solver_collection/QpSolverTrace.h>
+
+using namespace QpSolverCollection;
+
+namespace
+{
+/** \brief Write string escaped for JSON. */
+void writeJsonString(std::ostream & os, const char * str)
+{
+  os << '"';
+  for(const char * ch = str; *ch != '\0'; ch++)
+  {
+    if(*ch == '"' || *ch == '\\')
+    {
+      os << '\\' << *ch;
+    }
+    else if(static_cast<unsigned char>(*ch) < 0x20)
+    {
+      os << ' ';
+    }
+    else
+    {
+      os << *ch;
+    }
+  }
+  os << '"';
+}
+} // namespace
+
+QpTracer & QpTracer::instance()
+{
+  static QpTracer tracer;
+  return tracer;
+}
+
+QpTracer::QpTracer() : start_time_(QpSolver::clock::now()) {}
+
+void QpTracer::setBufferCapacity(size_t capacity)
+{
+  std::lock_guard<std::mutex> lock(buffer_mtx_);
+  buffer_capacity_ = std::max<size_t>(capacity, 1);
+}
+
+void QpTracer::record(const char * name, QpSolver::clock::time_point begin_time, QpSolver::clock::time_point end_time)
+{
+  Buffer & buffer = localBuffer();
+  uint64_t write_count = buffer.write_count.load(std::memory_order_relaxed);
+  Buffer::Slot & slot = buffer.slot_list[write_count % buffer.capacity];
+  slot.name.store(name, std::memory_order_relaxed);
+  slot.begin.store(
+      static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(begin_time - start_time_).count()),
+      std::memory_order_relaxed);
+  slot.duration.store(
+      static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(end_time - begin_time).count()),
+      std::memory_order_relaxed);
+  buffer.write_count.store(write_count + 1, std::memory_order_release);
+}
+
+std::vector<QpTraceEvent> QpTracer::events() const
+{
+  std::vector<QpTraceEvent> event_list;
+  std::lock_guard<std::mutex> lock(buffer_mtx_);
+  for(const auto & buffer : buffer_list_)
+  {
+    uint64_t write_count = buffer->write_count.load(std::memory_order_acquire);
+    uint64_t first_count = buffer->clear_count.load(std::memory_order_relaxed);
+    if(write_count > buffer->capacity)
+    {
+      first_count = std::max<uint64_t>(first_count, write_count - buffer->capacity);
+    }
+    size_t event_begin_idx = event_list.size();
+    for(uint64_t count = first_count; count < write_count; count++)
+    {
+      const Buffer::Slot & slot = buffer->slot_list[count % buffer->capacity];
+      QpTraceEvent event;
+      event.name = slot.name.load(std::memory_order_relaxed);
+      event.tid = buffer->tid;
+      event.begin = slot.begin.load(std::memory_order_relaxed);
+      event.duration = slot.duration.load(std::memory_order_relaxed);
+      event_list.push_back(event);
+    }
+
+    // Discard events that may have been overwritten by the writer thread while being read
+    uint64_t write_count_after = buffer->write_count.load(std::memory_order_acquire);
+    if(write_count_after >= buffer->capacity && write_count_after - buffer->capacity + 1 > first_count)
+    {
+      uint64_t overwritten_num = std::min(write_count_after - buffer->capacity + 1 - first_count,
+                                          static_cast<uint64_t>(event_list.size() - event_begin_idx));
+      event_list.erase(event_list.begin() + event_begin_idx,
+                       event_list.begin() + event_begin_idx + static_cast<std::ptrdiff_t>(overwritten_num));
+    }
+  }
+
+  // Buffers may be reused by other threads, so the events are sorted by thread and begin time
+  std::stable_sort(event_list.begin(), event_list.end(), [](const QpTraceEvent & event1, const QpTraceEvent & event2) {
+    return event1.tid != event2.tid ? event1.tid < event2.tid : event1.begin < event2.begin;
+  });
+  return event_list;
+}
+
+void QpTracer::clear()
+{
+  std::lock_guard<std::mutex> lock(buffer_mtx_);
+  for(auto & buffer : buffer_list_)
+  {
+    buffer->clear_count.store(buffer->write_count.load(std::memory_order_acquire), std::memory_order_relaxed);
+  }
+}
+
+void QpTracer::writeChromeTrace(std::ostream & os) const
+{
+  std::vector<QpTraceEvent> event_list = events();
+  os << "{\"traceEvents\":[";
+  for(size_t i = 0; i < event_list.size(); i++)
+  {
+    const QpTraceEvent & event = event_list[i];
+    os << (i == 0 ? "\n" : ",\n") << "{\"name\":";
+    writeJsonString(os, event.name ? event.name : "");
+    // Timestamps are in microseconds
+    os << ",\"cat\":\"qp\",\"ph\":\"X\",\"pid\":1,\"tid\":" << event.tid << std::fixed << std::setprecision(3)
+       << ",\"ts\":" << 1e-3 * static_cast<double>(event.begin)
+       << ",\"dur\":" << 1e-3 * static_cast<double>(event.duration) << "}";
+    os.unsetf(std::ios_base::floatfield);
+  }
+  os << "\n],\"displayTimeUnit\":\"ns\"}\n";
+}
+
+bool QpTracer::writeChromeTrace(const std::string & path) const
+{
+  std::ofstream ofs(path);
+  if(!ofs)
+  {
+    QSC_ERROR_STREAM("[QpTracer] Failed to open file: " << path);
+    return false;
+  }
+  writeChromeTrace(ofs);
+  return static_cast<bool>(ofs);
+}
+
+QpTracer::BufferHolder::~BufferHolder()
+{
+  if(buffer)
+  {
+    QpTracer & tracer = QpTracer::instance();
+    std::lock_guard<std::mutex> lock(tracer.buffer_mtx_);
+    tracer.free_buffer_list_.push_back(buffer);
+  }
+}
+
+QpTracer::Buffer & QpTracer::localBuffer()
+{
+  thread_local BufferHolder buffer_holder;
+  if(!buffer_holder.buffer)
+  {
+    std::lock_guard<std::mutex> lock(buffer_mtx_);
+    if(free_buffer_list_.empty())
+    {
+      buffer_list_.push_back(std::make_unique<Buffer>(static_cast<int>(buffer_list_.size()) + 1, buffer_capacity_));
+      buffer_holder.buffer = buffer_list_.back().get();
+    }
+    else
+    {
+      buffer_holder.buffer = free_buffer_list_.back();
+      free_buffer_list_.pop_back();
+    }
+  }
+  return *buffer_holder.buffer;
+}
+
+QpTraceScope::QpTraceScope(const char * name) : name_(name), enabled_(QpTracer::instance().enabled())
+{
+  if(enabled_)
+  {
+    begin_time_ = QpSolver::clock::now();
+  }
+}
+
+QpTraceScope::~QpTraceScope()
+{
+  if(!enabled_)
+  {
+    return;
+  }
+  auto end_time = QpSolver::clock::now();
+  if(phase_name_)
+  {
+    QpTracer::instance().record(phase_name_, phase_begin_time_, end_time);
+  }
+  QpTracer::instance().record(name_, begin_time_, end_time);
+}
+
+void QpTraceScope::phase(const char * name)
+{
+  if(!enabled_)
+  {
+    return;
+  }
+  auto time = QpSolver::clock::now();
+  if(phase_name_)
+  {
+    QpTracer::instance().record(phase_name_, phase_begin_time_, time);
+  }
+  phase_name_ = name;
+  phase_begin_time_ = time;
+}
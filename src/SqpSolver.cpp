@@ -0,0 +1,248 @@
+/* Author: Masaki Murooka */
+
+#include <stdexcept>
+
+#include <qp_solver_collection/SqpSolver.h>
+
+using namespace QpSolverCollection;
+
+SqpSolver::SqpSolver(const QpSolverType & qp_solver_type) : SqpSolver(allocateQpSolver(qp_solver_type))
+{
+  // QP subproblems of consecutive iterations are similar, so the backend is warm-started. This is done only for the
+  // instance allocated here so as not to change the settings of the instance passed by the user.
+#if ENABLE_QPOASES
+  if(auto qp_solver_qpoases = std::dynamic_pointer_cast<QpSolverQpoases>(qp_solver_))
+  {
+    qp_solver_qpoases->force_initialize_ = false;
+  }
+#endif
+#if ENABLE_OSQP
+  if(auto qp_solver_osqp = std::dynamic_pointer_cast<QpSolverOsqp>(qp_solver_))
+  {
+    qp_solver_osqp->force_initialize_ = false;
+  }
+#endif
+}
+
+SqpSolver::SqpSolver(const std::shared_ptr<QpSolver> & qp_solver) : qp_solver_(qp_solver)
+{
+  if(!qp_solver_)
+  {
+    throw std::runtime_error("[SqpSolver] QP solver instance is null.");
+  }
+
+  // The blocks of the QP coefficient are overwritten in place, so their modifications are notified explicitly
+  qp_coeff_.track_modification_ = true;
+}
+
+Eigen::VectorXd SqpSolver::solve(const SqpProblem & problem, const Eigen::VectorXd & x_init)
+{
+  int dim_var = problem.dim_var_;
+  int dim_eq = problem.dim_eq_;
+  int dim_ineq = problem.dim_ineq_;
+  if(x_init.size() != dim_var || !problem.cost_func_ || !problem.cost_grad_func_
+     || (dim_eq > 0 && (!problem.eq_func_ || !problem.eq_jac_func_))
+     || (dim_ineq > 0 && (!problem.ineq_func_ || !problem.ineq_jac_func_)))
+  {
+    throw std::invalid_argument("[SqpSolver] Dimension of initial guess is inconsistent or functions are missing.");
+  }
+
+  // Allocate buffers only if the dimensions change
+  if(qp_coeff_.dim_var_ != dim_var || qp_coeff_.dim_eq_ != dim_eq || qp_coeff_.dim_ineq_ != dim_ineq)
+  {
+    qp_coeff_.setup(dim_var, dim_eq, dim_ineq);
+    hess_.resize(dim_var, dim_var);
+    cost_grad_.resize(dim_var);
+    eq_val_.resize(dim_eq);
+    ineq_val_.resize(dim_ineq);
+  }
+  Eigen::VectorXd x_min =
+      problem.x_min_.size() == dim_var ? problem.x_min_ : Eigen::VectorXd::Constant(dim_var, -bound_inf_);
+  Eigen::VectorXd x_max =
+      problem.x_max_.size() == dim_var ? problem.x_max_ : Eigen::VectorXd::Constant(dim_var, bound_inf_);
+  Eigen::VectorXd x = x_init.cwiseMax(x_min).cwiseMin(x_max);
+  dual_eq_.setZero(dim_eq);
+  dual_ineq_.setZero(dim_ineq);
+  qp_warm_start_ = WarmStart();
+  if(!problem.hess_func_)
+  {
+    hess_.setIdentity();
+  }
+
+  evalValue(problem, x);
+  evalDerivative(problem, x, true);
+
+  Eigen::VectorXd lagrangian_grad(dim_var);
+  Eigen::VectorXd lagrangian_grad_next(dim_var);
+  Eigen::VectorXd x_next(dim_var);
+  double merit_coeff = 0;
+  solve_failed_ = true;
+  status_ = QpSolveStatus::MaxIterReached;
+  for(iter_num_ = 0; iter_num_ < max_iter_; iter_num_++)
+  {
+    // Update QP subproblem
+    if(problem.hess_func_)
+    {
+      problem.hess_func_(x, dual_eq_, dual_ineq_, hess_);
+    }
+    qp_coeff_.obj_mat_ = hess_;
+    qp_coeff_.obj_vec_ = cost_grad_;
+    qp_coeff_.eq_vec_ = -eq_val_;
+    qp_coeff_.ineq_vec_ = -ineq_val_;
+    qp_coeff_.x_min_ = x_min - x;
+    qp_coeff_.x_max_ = x_max - x;
+    qp_coeff_.setModified(QpCoeff::Block::ObjMat);
+    qp_coeff_.setModified(QpCoeff::Block::ObjVec);
+    qp_coeff_.setModified(QpCoeff::Block::EqVec);
+    qp_coeff_.setModified(QpCoeff::Block::IneqVec);
+    qp_coeff_.setModified(QpCoeff::Block::Bound);
+
+    // Solve QP subproblem warm-started from the step and Lagrange multipliers of the previous iteration
+    Eigen::VectorXd step = (qp_warm_start_.x_.size() == dim_var ? qp_solver_->solve(qp_coeff_, qp_warm_start_)
+                                                                 : qp_solver_->solve(qp_coeff_));
+    if(qp_solver_->solveFailed())
+    {
+      status_ = qp_solver_->status();
+      QSC_WARN_STREAM("[SqpSolver] QP subproblem failed in iteration " << iter_num_
+                                                                        << ". status: " << std::to_string(status_));
+      break;
+    }
+    if(qp_solver_->dualEq().size() == dim_eq)
+    {
+      dual_eq_ = qp_solver_->dualEq();
+    }
+    if(qp_solver_->dualIneq().size() == dim_ineq)
+    {
+      dual_ineq_ = qp_solver_->dualIneq();
+    }
+    qp_warm_start_.x_ = step;
+    qp_warm_start_.dual_eq_ = (qp_solver_->dualEq().size() == dim_eq ? qp_solver_->dualEq() : Eigen::VectorXd());
+    qp_warm_start_.dual_ineq_ =
+        (qp_solver_->dualIneq().size() == dim_ineq ? qp_solver_->dualIneq() : Eigen::VectorXd());
+    qp_warm_start_.dual_bound_ =
+        (qp_solver_->dualBound().size() == dim_var ? qp_solver_->dualBound() : Eigen::VectorXd());
+
+    // Check convergence
+    double violation = computeViolation();
+    double violation_max = (dim_eq > 0 ? eq_val_.cwiseAbs().maxCoeff() : 0.0);
+    if(dim_ineq > 0)
+    {
+      violation_max = std::max(violation_max, ineq_val_.maxCoeff());
+    }
+    if(verbose_)
+    {
+      QSC_INFO_STREAM("[SqpSolver] iter: " << iter_num_ << ", cost: " << cost_ << ", violation: " << violation_max
+                                           << ", step: " << step.lpNorm<Eigen::Infinity>());
+    }
+    if(step.lpNorm<Eigen::Infinity>() <= tol_ && violation_max <= tol_)
+    {
+      solve_failed_ = false;
+      status_ = QpSolveStatus::Solved;
+      break;
+    }
+
+    // Line search on l1 merit function
+    double dual_max = std::max(dim_eq > 0 ? dual_eq_.lpNorm<Eigen::Infinity>() : 0.0,
+                               dim_ineq > 0 ? dual_ineq_.lpNorm<Eigen::Infinity>() : 0.0);
+    merit_coeff = std::max(merit_coeff, 1.1 * dual_max + tol_);
+    double merit = cost_ + merit_coeff * violation;
+    double merit_deriv = cost_grad_.dot(step) - merit_coeff * violation;
+    computeLagrangianGrad(lagrangian_grad);
+    double step_size = 1.0;
+    bool accepted = false;
+    while(step_size >= min_step_size_)
+    {
+      x_next = x + step_size * step;
+      evalValue(problem, x_next);
+      if(cost_ + merit_coeff * computeViolation() <= merit + armijo_coeff_ * step_size * merit_deriv)
+      {
+        accepted = true;
+        break;
+      }
+      step_size *= backtrack_scale_;
+    }
+    if(!accepted)
+    {
+      evalValue(problem, x);
+      status_ = QpSolveStatus::NumericalError;
+      QSC_WARN_STREAM("[SqpSolver] Line search failed in iteration " << iter_num_ << ".");
+      break;
+    }
+    x.swap(x_next);
+    evalDerivative(problem, x, false);
+
+    // Damped BFGS update of the Hessian of Lagrangian
+    if(!problem.hess_func_)
+    {
+      computeLagrangianGrad(lagrangian_grad_next);
+      Eigen::VectorXd s = step_size * step;
+      Eigen::VectorXd y = lagrangian_grad_next - lagrangian_grad;
+      Eigen::VectorXd hess_s = hess_ * s;
+      double s_hess_s = s.dot(hess_s);
+      double s_y = s.dot(y);
+      if(s_hess_s > 0)
+      {
+        if(s_y < 0.2 * s_hess_s)
+        {
+          double theta = 0.8 * s_hess_s / (s_hess_s - s_y);
+          y = theta * y + (1.0 - theta) * hess_s;
+          s_y = s.dot(y);
+        }
+        hess_.noalias() -= hess_s * hess_s.transpose() / s_hess_s;
+        hess_.noalias() += y * y.transpose() / s_y;
+      }
+    }
+  }
+
+  constraint_violation_ = (dim_eq > 0 ? eq_val_.cwiseAbs().maxCoeff() : 0.0);
+  if(dim_ineq > 0)
+  {
+    constraint_violation_ = std::max(constraint_violation_, ineq_val_.maxCoeff());
+  }
+  constraint_violation_ = std::max(constraint_violation_, 0.0);
+  return x;
+}
+
+void SqpSolver::evalValue(const SqpProblem & problem, const Eigen::VectorXd & x)
+{
+  cost_ = problem.cost_func_(x);
+  if(problem.dim_eq_ > 0)
+  {
+    problem.eq_func_(x, eq_val_);
+  }
+  if(problem.dim_ineq_ > 0)
+  {
+    problem.ineq_func_(x, ineq_val_);
+  }
+}
+
+void SqpSolver::evalDerivative(const SqpProblem & problem, const Eigen::VectorXd & x, bool first)
+{
+  problem.cost_grad_func_(x, cost_grad_);
+  if(first || !problem.linear_constraint_)
+  {
+    // Jacobians are written directly into the QP coefficient
+    if(problem.dim_eq_ > 0)
+    {
+      problem.eq_jac_func_(x, qp_coeff_.eq_mat_);
+      qp_coeff_.setModified(QpCoeff::Block::EqMat);
+    }
+    if(problem.dim_ineq_ > 0)
+    {
+      problem.ineq_jac_func_(x, qp_coeff_.ineq_mat_);
+      qp_coeff_.setModified(QpCoeff::Block::IneqMat);
+    }
+  }
+}
+
+double SqpSolver::computeViolation() const
+{
+  return eq_val_.lpNorm<1>() + ineq_val_.cwiseMax(0.0).sum();
+}
+
+void SqpSolver::computeLagrangianGrad(Eigen::VectorXd & lagrangian_grad) const
+{
+  lagrangian_grad = cost_grad_;
+  lagrangian_grad.noalias() += qp_coeff_.eq_mat_.transpose() * dual_eq_;
+  lagrangian_grad.noalias() += qp_coeff_.ineq_mat_.transpose() * dual_ineq_;
+}
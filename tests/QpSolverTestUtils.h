@@ -0,0 +1,92 @@
+/* Author: Masaki Murooka */
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+#include <Eigen/Cholesky>
+
+#include <qp_solver_collection/QpSolverCollection.h>
+
+/** \brief QP solver that ignores constraints, used to test the wrappers of QP solvers independently of QP solvers.
+
+    Only the presolve is applied to the constraints. Failures, latency, and the overwriting of Q done by some QP solvers
+   can be emulated.
+ */
+class QpSolverUnconstrained : public QpSolverCollection::QpSolver
+{
+public:
+  using QpSolver::solve;
+
+  QpSolverUnconstrained()
+  {
+    type_ = QpSolverCollection::QpSolverType::QLD;
+  }
+
+  virtual Eigen::VectorXd solve(int dim_var,
+                                int,
+                                int,
+                                Eigen::Ref<Eigen::MatrixXd> Q,
+                                const Eigen::Ref<const Eigen::VectorXd> & c,
+                                const Eigen::Ref<const Eigen::MatrixXd> & A,
+                                const Eigen::Ref<const Eigen::VectorXd> & b,
+                                const Eigen::Ref<const Eigen::MatrixXd> & C,
+                                const Eigen::Ref<const Eigen::VectorXd> & d,
+                                const Eigen::Ref<const Eigen::VectorXd> & x_min,
+                                const Eigen::Ref<const Eigen::VectorXd> & x_max) override
+  {
+    if(presolveFailed(A, b, C, d, x_min, x_max))
+    {
+      return Eigen::VectorXd::Zero(dim_var);
+    }
+    if(sleep_ms_ > 0)
+    {
+      std::this_thread::sleep_for(std::chrono::milliseconds(sleep_ms_));
+    }
+    call_count_++;
+    solve_failed_ = fail_;
+    status_ = (fail_ ? QpSolverCollection::QpSolveStatus::NumericalError : QpSolverCollection::QpSolveStatus::Solved);
+    iter_num_ = 1;
+    Eigen::VectorXd x = -Q.ldlt().solve(c);
+    if(overwrite_obj_mat_)
+    {
+      Q.setZero();
+    }
+    return x;
+  }
+
+  //! Number of solves passing the presolve
+  std::atomic<int> call_count_{0};
+
+  //! Whether to report a failure
+  bool fail_ = false;
+
+  //! Sleep duration in each solve [ms]
+  int sleep_ms_ = 0;
+
+  //! Whether to overwrite Q after solving
+  bool overwrite_obj_mat_ = false;
+};
+
+/** \brief Make a QP coefficient parametrized by the first element of the objective vector.
+
+    The equality constraint is satisfied and the inequality constraint is inactive at the unconstrained minimizer, so
+   that the solution of QpSolverUnconstrained coincides with that of the actual QP solvers unless the bounds are active
+   (i.e., |offset| < 10).
+ */
+inline QpSolverCollection::QpCoeff makeQpCoeff(double offset)
+{
+  QpSolverCollection::QpCoeff qp_coeff;
+  qp_coeff.setup(3, 1, 1);
+  qp_coeff.obj_mat_.diagonal() << 1.0, 2.0, 4.0;
+  qp_coeff.obj_vec_ << offset, 1.0, -1.0;
+  qp_coeff.eq_mat_ << 0.0, 1.0, 2.0;
+  qp_coeff.eq_vec_ << 0.0;
+  qp_coeff.ineq_mat_ << 0.0, 1.0, -1.0;
+  qp_coeff.ineq_vec_ << 2.0;
+  qp_coeff.x_min_.setConstant(-10.0);
+  qp_coeff.x_max_.setConstant(10.0);
+  return qp_coeff;
+}
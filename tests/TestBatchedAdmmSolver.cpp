@@ -0,0 +1,126 @@
+/* Author: Masaki Murooka */
+
+#include <gtest/gtest.h>
+
+#include <qp_solver_collection/BatchedAdmmSolver.h>
+
+using QpSolverCollection::QpCoeff;
+using QpSolverCollection::QpSolveStatus;
+using QpSolverCollection::QpSolverType;
+
+namespace
+{
+/** \brief Make a feasible QP with dense random coefficients. */
+QpCoeff makeQpCoeff(int dim_var, int dim_eq, int dim_ineq)
+{
+  QpCoeff qp_coeff;
+  qp_coeff.setup(dim_var, dim_eq, dim_ineq);
+  Eigen::MatrixXd tmp_mat = Eigen::MatrixXd::Random(dim_var, dim_var);
+  qp_coeff.obj_mat_ = tmp_mat.transpose() * tmp_mat + Eigen::MatrixXd::Identity(dim_var, dim_var);
+  qp_coeff.obj_vec_ = 5.0 * Eigen::VectorXd::Random(dim_var);
+  Eigen::VectorXd x_feasible = 0.5 * Eigen::VectorXd::Random(dim_var);
+  qp_coeff.eq_mat_.setRandom();
+  qp_coeff.eq_vec_ = qp_coeff.eq_mat_ * x_feasible;
+  qp_coeff.ineq_mat_.setRandom();
+  qp_coeff.ineq_vec_ = qp_coeff.ineq_mat_ * x_feasible + 0.1 * Eigen::VectorXd::Ones(dim_ineq);
+  qp_coeff.x_min_.setConstant(-1.0);
+  qp_coeff.x_max_.setConstant(1.0);
+  return qp_coeff;
+}
+} // namespace
+
+TEST(TestBatchedAdmmSolver, CompareWithBuiltin)
+{
+  constexpr int batch_size = 37;
+  int dim_var = 6;
+  int dim_eq = 1;
+  int dim_ineq = 4;
+
+  std::vector<QpCoeff> qp_coeff_list;
+  QpSolverCollection::BatchedAdmmSolver batch_solver;
+  // The last block has fewer QPs than the block size
+  batch_solver.setup(batch_size, dim_var, dim_eq, dim_ineq, 8);
+  for(int idx = 0; idx < batch_size; idx++)
+  {
+    qp_coeff_list.push_back(makeQpCoeff(dim_var, dim_eq, dim_ineq));
+    batch_solver.setQpCoeff(idx, qp_coeff_list.back());
+  }
+  batch_solver.solve();
+  EXPECT_EQ(batch_solver.solvedNum(), batch_size);
+
+  auto qp_solver = QpSolverCollection::allocateQpSolver(QpSolverType::Builtin);
+  for(int idx = 0; idx < batch_size; idx++)
+  {
+    QpCoeff qp_coeff_copied = qp_coeff_list[idx];
+    Eigen::VectorXd x_gt = qp_solver->solve(qp_coeff_copied);
+    QpSolverCollection::SolveResult result = batch_solver.result(idx);
+    EXPECT_EQ(result.status_, QpSolveStatus::Solved) << "idx: " << idx;
+    EXPECT_LT((result.x_ - x_gt).norm(), 1e-3) << "idx: " << idx;
+    EXPECT_TRUE(QpSolverCollection::computeKkt(qp_coeff_list[idx], result).satisfied(1e-3)) << "idx: " << idx;
+  }
+}
+
+TEST(TestBatchedAdmmSolver, ConvergenceMask)
+{
+  int dim_var = 4;
+  int dim_eq = 0;
+  int dim_ineq = 3;
+
+  // Unconstrained QP converges much earlier than the others
+  QpCoeff qp_coeff_easy;
+  qp_coeff_easy.setup(dim_var, dim_eq, dim_ineq);
+  qp_coeff_easy.obj_mat_.setIdentity();
+  qp_coeff_easy.obj_vec_.setConstant(0.1);
+  QpCoeff qp_coeff_hard = makeQpCoeff(dim_var, dim_eq, dim_ineq);
+  qp_coeff_hard.obj_mat_ *= 1e-2;
+
+  QpSolverCollection::BatchedAdmmSolver single_solver;
+  single_solver.setup(1, dim_var, dim_eq, dim_ineq);
+  single_solver.setQpCoeff(0, qp_coeff_easy);
+  single_solver.solve();
+
+  QpSolverCollection::BatchedAdmmSolver batch_solver;
+  batch_solver.setup(3, dim_var, dim_eq, dim_ineq);
+  batch_solver.setQpCoeff(0, qp_coeff_hard);
+  batch_solver.setQpCoeff(1, qp_coeff_easy);
+  batch_solver.setQpCoeff(2, qp_coeff_hard);
+  batch_solver.solve();
+
+  EXPECT_EQ(batch_solver.status(1), QpSolveStatus::Solved);
+  EXPECT_LT(batch_solver.iterNum(1), batch_solver.iterNum(0));
+  // The converged QP is frozen while the others iterate
+  EXPECT_EQ(batch_solver.iterNum(1), single_solver.iterNum(0));
+  EXPECT_LT((batch_solver.result(1).x_ - single_solver.result(0).x_).norm(), 1e-12);
+  EXPECT_LT((batch_solver.result(1).x_ + 0.1 * Eigen::VectorXd::Ones(dim_var)).norm(), 1e-4);
+}
+
+TEST(TestBatchedAdmmSolver, Failure)
+{
+  int dim_var = 2;
+  QpCoeff qp_coeff = makeQpCoeff(dim_var, 0, 1);
+  QpCoeff qp_coeff_not_convex = qp_coeff;
+  qp_coeff_not_convex.obj_mat_ = -1.0 * Eigen::MatrixXd::Identity(dim_var, dim_var);
+
+  QpSolverCollection::BatchedAdmmSolver batch_solver;
+  batch_solver.setup(2, dim_var, 0, 1);
+  batch_solver.setQpCoeff(0, qp_coeff);
+  batch_solver.setQpCoeff(1, qp_coeff_not_convex);
+  batch_solver.solve();
+  EXPECT_EQ(batch_solver.status(0), QpSolveStatus::Solved);
+  EXPECT_EQ(batch_solver.status(1), QpSolveStatus::DualInfeasible);
+  EXPECT_TRUE(batch_solver.result(1).x_.isZero());
+
+  batch_solver.max_iter_ = 1;
+  batch_solver.solve();
+  EXPECT_EQ(batch_solver.status(0), QpSolveStatus::MaxIterReached);
+  EXPECT_EQ(batch_solver.iterNum(0), 1);
+
+  EXPECT_THROW(batch_solver.setQpCoeff(2, qp_coeff), std::out_of_range);
+  EXPECT_THROW(batch_solver.setQpCoeff(0, makeQpCoeff(3, 0, 1)), std::invalid_argument);
+}
+
+int main(int argc, char ** argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,192 @@
+/* Author: Masaki Murooka */
+
+#include <limits>
+
+#include <gtest/gtest.h>
+
+#include <qp_solver_collection/GoldfarbIdnaniSolver.h>
+#include <qp_solver_collection/QpSolverCollection.h>
+
+using QpSolverCollection::QpCoeff;
+using QpSolverCollection::QpSolveStatus;
+using QpSolverCollection::QpSolverType;
+
+namespace
+{
+/** \brief Make a feasible QP with dense random coefficients (bound must be larger than 0.5). */
+QpCoeff makeQpCoeff(int dim_var, int dim_eq, int dim_ineq, double bound)
+{
+  QpCoeff qp_coeff;
+  qp_coeff.setup(dim_var, dim_eq, dim_ineq);
+  Eigen::MatrixXd tmp_mat = Eigen::MatrixXd::Random(dim_var, dim_var);
+  qp_coeff.obj_mat_ = tmp_mat.transpose() * tmp_mat + 1e-2 * Eigen::MatrixXd::Identity(dim_var, dim_var);
+  qp_coeff.obj_vec_ = 10.0 * Eigen::VectorXd::Random(dim_var);
+  Eigen::VectorXd x_feasible = 0.5 * Eigen::VectorXd::Random(dim_var);
+  qp_coeff.eq_mat_.setRandom();
+  qp_coeff.eq_vec_ = qp_coeff.eq_mat_ * x_feasible;
+  qp_coeff.ineq_mat_.setRandom();
+  qp_coeff.ineq_vec_ = qp_coeff.ineq_mat_ * x_feasible + 0.1 * Eigen::VectorXd::Ones(dim_ineq);
+  qp_coeff.x_min_.setConstant(-bound);
+  qp_coeff.x_max_.setConstant(bound);
+  return qp_coeff;
+}
+} // namespace
+
+TEST(TestGoldfarbIdnaniSolver, RandomQp)
+{
+  auto qp_solver = QpSolverCollection::allocateQpSolver(QpSolverType::Builtin);
+  for(int dim_var : {1, 5, 20, 60})
+  {
+    for(int trial = 0; trial < 20; trial++)
+    {
+      int dim_eq = trial % 3 == 0 ? 0 : dim_var / 4;
+      int dim_ineq = trial % 2 == 0 ? dim_var : 2 * dim_var;
+      double bound = (trial % 4 == 0 ? std::numeric_limits<double>::infinity() : 1.0);
+      QpCoeff qp_coeff = makeQpCoeff(dim_var, dim_eq, dim_ineq, bound);
+      QpCoeff qp_coeff_copied = qp_coeff;
+      QpSolverCollection::SolveResult result = qp_solver->solveWithResult(qp_coeff_copied);
+      std::string label = "dim_var: " + std::to_string(dim_var) + ", trial: " + std::to_string(trial);
+
+      EXPECT_FALSE(qp_solver->solveFailed()) << label;
+      EXPECT_EQ(result.status_, QpSolveStatus::Solved) << label;
+      ASSERT_TRUE(result.hasDual()) << label;
+      QpSolverCollection::KktResidual kkt = QpSolverCollection::computeKkt(qp_coeff, result);
+      EXPECT_TRUE(kkt.satisfied(1e-6)) << label << "\n  primal_feas: " << kkt.primal_feas_
+                                       << "\n  dual_feas: " << kkt.dual_feas_
+                                       << "\n  complementarity: " << kkt.complementarity_
+                                       << "\n  duality_gap: " << kkt.duality_gap_;
+    }
+  }
+}
+
+TEST(TestGoldfarbIdnaniSolver, Objective)
+{
+  QpCoeff qp_coeff = makeQpCoeff(10, 2, 10, 1.0);
+  QpSolverCollection::GoldfarbIdnaniSolver gi;
+  ASSERT_EQ(gi.solve(qp_coeff.obj_mat_, qp_coeff.obj_vec_, qp_coeff.eq_mat_, qp_coeff.eq_vec_, qp_coeff.ineq_mat_,
+                     qp_coeff.ineq_vec_, qp_coeff.x_min_, qp_coeff.x_max_, 1000),
+            QpSolverCollection::GoldfarbIdnaniSolver::Status::Solved);
+  const Eigen::VectorXd & x = gi.x();
+  EXPECT_NEAR(gi.obj(), 0.5 * x.dot(qp_coeff.obj_mat_ * x) + qp_coeff.obj_vec_.dot(x), 1e-8);
+  EXPECT_GT(gi.iterNum(), 0);
+
+  // The workspace is reused for the same dimensions
+  size_t memory_usage = gi.memoryUsage();
+  qp_coeff.obj_vec_.setRandom();
+  gi.solve(qp_coeff.obj_mat_, qp_coeff.obj_vec_, qp_coeff.eq_mat_, qp_coeff.eq_vec_, qp_coeff.ineq_mat_,
+           qp_coeff.ineq_vec_, qp_coeff.x_min_, qp_coeff.x_max_, 1000);
+  EXPECT_EQ(gi.memoryUsage(), memory_usage);
+}
+
+TEST(TestGoldfarbIdnaniSolver, ObjMatFactorReuse)
+{
+  auto qp_solver = QpSolverCollection::allocateQpSolver(QpSolverType::Builtin);
+  auto qp_solver_gt = QpSolverCollection::allocateQpSolver(QpSolverType::Builtin);
+  QpSolverCollection::QpSolverSettings settings_gt;
+  settings_gt.reuse_obj_mat_factor_ = false;
+  qp_solver_gt->setSettings(settings_gt);
+
+  auto checkSolution = [&](QpCoeff & qp_coeff, const std::string & label) {
+    QpCoeff qp_coeff_copied = qp_coeff;
+    Eigen::VectorXd x_gt = qp_solver_gt->solve(qp_coeff_copied);
+    Eigen::VectorXd x = qp_solver->solve(qp_coeff);
+    EXPECT_FALSE(qp_solver->solveFailed()) << label;
+    EXPECT_LT((x - x_gt).norm(), 1e-10) << label;
+  };
+
+  // The vectors and the dimensions of constraints change while the objective matrix is unchanged
+  QpCoeff qp_coeff = makeQpCoeff(10, 2, 10, 1.0);
+  Eigen::MatrixXd obj_mat = qp_coeff.obj_mat_;
+  for(int i = 0; i < 5; i++)
+  {
+    qp_coeff = makeQpCoeff(10, 2, 10 + i, 1.0);
+    qp_coeff.obj_mat_ = obj_mat;
+    checkSolution(qp_coeff, "unchanged: " + std::to_string(i));
+  }
+
+  // The change of the objective matrix is detected
+  qp_coeff.obj_mat_(0, 0) += 1.0;
+  checkSolution(qp_coeff, "changed");
+
+  // The change of the objective matrix is not detected if it is assumed to be fixed
+  QpSolverCollection::QpSolverSettings settings;
+  settings.obj_mat_fixed_ = true;
+  qp_solver->setSettings(settings);
+  QpCoeff qp_coeff_copied = qp_coeff;
+  Eigen::VectorXd x_prev = qp_solver->solve(qp_coeff_copied);
+  qp_coeff.obj_mat_ *= 2.0;
+  Eigen::VectorXd x = qp_solver->solve(qp_coeff);
+  EXPECT_LT((x - x_prev).norm(), 1e-10);
+
+  // The dimension change is detected even if the objective matrix is assumed to be fixed
+  qp_coeff = makeQpCoeff(8, 2, 10, 1.0);
+  checkSolution(qp_coeff, "dimension changed");
+}
+
+TEST(TestGoldfarbIdnaniSolver, Failure)
+{
+  auto qp_solver = QpSolverCollection::allocateQpSolver(QpSolverType::Builtin);
+
+  // Inconsistent inequality constraints that are not detected by presolve: x0 + x1 <= -1 and x0, x1 >= 0
+  QpCoeff qp_coeff;
+  qp_coeff.setup(2, 0, 1);
+  qp_coeff.obj_mat_.setIdentity();
+  qp_coeff.obj_vec_.setZero();
+  qp_coeff.ineq_mat_ << 1.0, 1.0;
+  qp_coeff.ineq_vec_ << -1.0;
+  qp_coeff.x_min_.setZero();
+  qp_coeff.x_max_.setConstant(1.0);
+  qp_solver->solve(qp_coeff);
+  EXPECT_TRUE(qp_solver->solveFailed());
+  EXPECT_EQ(qp_solver->status(), QpSolveStatus::PrimalInfeasible);
+
+  // Objective matrix is not positive definite
+  qp_coeff.ineq_vec_ << 1.0;
+  qp_coeff.obj_mat_(1, 1) = -1.0;
+  qp_solver->solve(qp_coeff);
+  EXPECT_TRUE(qp_solver->solveFailed());
+  EXPECT_EQ(qp_solver->status(), QpSolveStatus::DualInfeasible);
+}
+
+TEST(TestGoldfarbIdnaniSolver, DependentEquality)
+{
+  auto qp_solver = QpSolverCollection::allocateQpSolver(QpSolverType::Builtin);
+
+  // More equality constraints than variables, where the last one is redundant
+  QpCoeff qp_coeff;
+  qp_coeff.setup(2, 3, 0);
+  qp_coeff.obj_mat_.setIdentity();
+  qp_coeff.obj_vec_.setZero();
+  qp_coeff.eq_mat_ << 1.0, 0.0, 0.0, 1.0, 1.0, 1.0;
+  qp_coeff.eq_vec_ << 1.0, 1.0, 2.0;
+  QpCoeff qp_coeff_copied = qp_coeff;
+  QpSolverCollection::SolveResult result = qp_solver->solveWithResult(qp_coeff_copied);
+  EXPECT_FALSE(qp_solver->solveFailed());
+  EXPECT_LT((result.x_ - Eigen::Vector2d(1.0, 1.0)).norm(), 1e-10);
+  ASSERT_TRUE(result.hasDual());
+  EXPECT_TRUE(QpSolverCollection::computeKkt(qp_coeff, result).satisfied(1e-8));
+
+  // The dependent equality constraint is inconsistent
+  qp_coeff.eq_vec_ << 1.0, 1.0, 3.0;
+  qp_solver->solve(qp_coeff);
+  EXPECT_TRUE(qp_solver->solveFailed());
+  EXPECT_EQ(qp_solver->status(), QpSolveStatus::PrimalInfeasible);
+
+  // Dependent equality constraints with fewer rows than variables
+  qp_coeff.setup(3, 2, 0);
+  qp_coeff.obj_mat_.setIdentity();
+  qp_coeff.obj_vec_.setZero();
+  qp_coeff.eq_mat_ << 1.0, 1.0, 0.0, 2.0, 2.0, 0.0;
+  qp_coeff.eq_vec_ << 1.0, 2.0;
+  qp_solver->solve(qp_coeff);
+  EXPECT_FALSE(qp_solver->solveFailed());
+  qp_coeff.eq_vec_ << 1.0, 1.0;
+  qp_solver->solve(qp_coeff);
+  EXPECT_EQ(qp_solver->status(), QpSolveStatus::PrimalInfeasible);
+}
+
+int main(int argc, char ** argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
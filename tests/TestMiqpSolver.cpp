@@ -0,0 +1,219 @@
+/* Author: Masaki Murooka */
+
+#include <algorithm>
+#include <cmath>
+
+#include <gtest/gtest.h>
+
+#include <qp_solver_collection/MiqpSolver.h>
+
+using QpSolverCollection::MiqpSearchStrategy;
+using QpSolverCollection::QpCoeff;
+using QpSolverCollection::QpSolveStatus;
+
+/** \brief QP solver with only bounds, which solves the QP by projected coordinate descent. */
+class QpSolverBox : public QpSolverCollection::QpSolver
+{
+public:
+  using QpSolver::solve;
+
+  QpSolverBox()
+  {
+    type_ = QpSolverCollection::QpSolverType::QLD;
+  }
+
+  virtual Eigen::VectorXd solve(int dim_var,
+                                int dim_eq,
+                                int dim_ineq,
+                                Eigen::Ref<Eigen::MatrixXd> Q,
+                                const Eigen::Ref<const Eigen::VectorXd> & c,
+                                const Eigen::Ref<const Eigen::MatrixXd> &,
+                                const Eigen::Ref<const Eigen::VectorXd> &,
+                                const Eigen::Ref<const Eigen::MatrixXd> &,
+                                const Eigen::Ref<const Eigen::VectorXd> &,
+                                const Eigen::Ref<const Eigen::VectorXd> & x_min,
+                                const Eigen::Ref<const Eigen::VectorXd> & x_max) override
+  {
+    EXPECT_EQ(dim_eq, 0);
+    EXPECT_EQ(dim_ineq, 0);
+    solve_num_++;
+    solve_failed_ = (x_min.array() > x_max.array()).any();
+    status_ = solve_failed_ ? QpSolveStatus::PrimalInfeasible : QpSolveStatus::Solved;
+    Eigen::VectorXd x = Eigen::VectorXd::Zero(dim_var);
+    if(warm_start_)
+    {
+      warm_start_num_++;
+      x = warm_start_->x_;
+    }
+    x = x.cwiseMax(x_min).cwiseMin(x_max);
+    if(solve_failed_)
+    {
+      return x;
+    }
+    for(int iter = 0; iter < 10000; iter++)
+    {
+      double max_diff = 0;
+      for(int i = 0; i < dim_var; i++)
+      {
+        double x_i = std::clamp(x[i] - (Q.row(i).dot(x) + c[i]) / Q(i, i), x_min[i], x_max[i]);
+        max_diff = std::max(max_diff, std::abs(x_i - x[i]));
+        x[i] = x_i;
+      }
+      if(max_diff < 1e-12)
+      {
+        break;
+      }
+    }
+    return x;
+  }
+
+  //! Number of solves
+  int solve_num_ = 0;
+
+  //! Number of solves with warm start
+  int warm_start_num_ = 0;
+};
+
+namespace
+{
+std::shared_ptr<QpSolverCollection::QpSolver> makeQpSolverBox()
+{
+  return std::make_shared<QpSolverBox>();
+}
+
+QpCoeff makeQpCoeff(int dim_var)
+{
+  QpCoeff qp_coeff;
+  qp_coeff.setup(dim_var, 0, 0);
+  Eigen::MatrixXd tmp_mat = Eigen::MatrixXd::Random(dim_var, dim_var);
+  qp_coeff.obj_mat_ = tmp_mat.transpose() * tmp_mat + Eigen::MatrixXd::Identity(dim_var, dim_var);
+  qp_coeff.obj_vec_ = 3.0 * Eigen::VectorXd::Random(dim_var);
+  qp_coeff.x_min_.setConstant(-2.0);
+  qp_coeff.x_max_.setConstant(2.0);
+  return qp_coeff;
+}
+
+/** \brief Solve mixed-integer QP by enumerating the values of integer variables in [x_min, x_max]. */
+double solveByEnumeration(const QpCoeff & qp_coeff, const std::vector<int> & integer_idx_list)
+{
+  QpCoeff qp_coeff_fixed = qp_coeff;
+  std::vector<int> value_list(integer_idx_list.size());
+  for(size_t i = 0; i < integer_idx_list.size(); i++)
+  {
+    value_list[i] = static_cast<int>(qp_coeff.x_min_[integer_idx_list[i]]);
+  }
+
+  double min_obj = std::numeric_limits<double>::infinity();
+  QpSolverBox qp_solver;
+  while(true)
+  {
+    for(size_t i = 0; i < integer_idx_list.size(); i++)
+    {
+      qp_coeff_fixed.x_min_[integer_idx_list[i]] = value_list[i];
+      qp_coeff_fixed.x_max_[integer_idx_list[i]] = value_list[i];
+    }
+    qp_coeff_fixed.obj_mat_ = qp_coeff.obj_mat_;
+    Eigen::VectorXd x = qp_solver.solve(qp_coeff_fixed);
+    min_obj = std::min(min_obj, 0.5 * x.dot(qp_coeff.obj_mat_ * x) + qp_coeff.obj_vec_.dot(x));
+
+    size_t i = 0;
+    for(; i < integer_idx_list.size(); i++)
+    {
+      if(value_list[i] < static_cast<int>(qp_coeff.x_max_[integer_idx_list[i]]))
+      {
+        value_list[i]++;
+        break;
+      }
+      value_list[i] = static_cast<int>(qp_coeff.x_min_[integer_idx_list[i]]);
+    }
+    if(i == integer_idx_list.size())
+    {
+      break;
+    }
+  }
+  return min_obj;
+}
+} // namespace
+
+TEST(TestMiqpSolver, Optimality)
+{
+  for(int trial = 0; trial < 5; trial++)
+  {
+    int dim_var = 8;
+    QpCoeff qp_coeff = makeQpCoeff(dim_var);
+    // Binary variables and general integer variables
+    std::vector<int> integer_idx_list = {0, 2, 3, 5, 6};
+    qp_coeff.x_min_.head<3>().setZero();
+    qp_coeff.x_max_.head<3>().setOnes();
+    double obj_expected = solveByEnumeration(qp_coeff, integer_idx_list);
+
+    for(auto strategy : {MiqpSearchStrategy::BestBound, MiqpSearchStrategy::DepthFirst})
+    {
+      for(int thread_num : {1, 4})
+      {
+        QpSolverCollection::MiqpSolver miqp_solver(makeQpSolverBox);
+        miqp_solver.strategy_ = strategy;
+        miqp_solver.thread_num_ = thread_num;
+        Eigen::VectorXd x = miqp_solver.solve(qp_coeff, integer_idx_list);
+
+        std::string label = std::to_string(strategy) + " with " + std::to_string(thread_num) + " threads";
+        EXPECT_FALSE(miqp_solver.solveFailed()) << label;
+        EXPECT_EQ(miqp_solver.status(), QpSolveStatus::Solved) << label;
+        EXPECT_NEAR(miqp_solver.objValue(), obj_expected, 1e-6) << label;
+        EXPECT_NEAR(0.5 * x.dot(qp_coeff.obj_mat_ * x) + qp_coeff.obj_vec_.dot(x), obj_expected, 1e-6) << label;
+        EXPECT_NEAR(miqp_solver.lowerBound(), miqp_solver.objValue(), 1e-10) << label;
+        EXPECT_GT(miqp_solver.nodeNum(), 0) << label;
+        for(int idx : integer_idx_list)
+        {
+          EXPECT_EQ(x[idx], std::round(x[idx])) << label;
+        }
+        EXPECT_TRUE((x.array() >= qp_coeff.x_min_.array()).all() && (x.array() <= qp_coeff.x_max_.array()).all())
+            << label;
+      }
+    }
+  }
+}
+
+TEST(TestMiqpSolver, Failure)
+{
+  QpCoeff qp_coeff = makeQpCoeff(4);
+  QpSolverCollection::MiqpSolver miqp_solver(makeQpSolverBox);
+
+  // No integer in the bounds
+  qp_coeff.x_min_[1] = 0.2;
+  qp_coeff.x_max_[1] = 0.8;
+  miqp_solver.solve(qp_coeff, {1, 2});
+  EXPECT_TRUE(miqp_solver.solveFailed());
+  EXPECT_EQ(miqp_solver.status(), QpSolveStatus::PrimalInfeasible);
+  EXPECT_TRUE(std::isinf(miqp_solver.objValue()));
+
+  // Node limit
+  qp_coeff = makeQpCoeff(4);
+  qp_coeff.obj_vec_ << 0.5, 0.5, 0.5, 0.5;
+  qp_coeff.obj_mat_.setIdentity();
+  miqp_solver.max_node_num_ = 1;
+  miqp_solver.solve(qp_coeff, {0, 1, 2, 3});
+  EXPECT_EQ(miqp_solver.status(), QpSolveStatus::MaxIterReached);
+  EXPECT_EQ(miqp_solver.nodeNum(), 1);
+  EXPECT_LE(miqp_solver.lowerBound(), miqp_solver.objValue());
+
+  EXPECT_THROW(miqp_solver.solve(qp_coeff, {4}), std::invalid_argument);
+}
+
+TEST(TestMiqpSolver, WarmStart)
+{
+  QpCoeff qp_coeff = makeQpCoeff(6);
+  auto qp_solver = std::make_shared<QpSolverBox>();
+  QpSolverCollection::MiqpSolver miqp_solver([qp_solver]() { return qp_solver; });
+  miqp_solver.solve(qp_coeff, {0, 1, 2, 3, 4, 5});
+  EXPECT_FALSE(miqp_solver.solveFailed());
+  EXPECT_GT(qp_solver->solve_num_, 1);
+  // All the relaxations except the root one are warm-started from the parent
+  EXPECT_EQ(qp_solver->warm_start_num_, qp_solver->solve_num_ - 1);
+}
+
+int main(int argc, char ** argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,195 @@
+/* Author: Masaki Murooka */
+
+#include <algorithm>
+#include <stdexcept>
+
+#include <gtest/gtest.h>
+
+#include <qp_solver_collection/QpSolverCollection.h>
+
+using QpSolverCollection::QpCoeff;
+using Block = QpSolverCollection::QpCoeff::Block;
+
+/** \brief QP solver that records the unchanged blocks, used to check the modification tracking. */
+class QpSolverRecorder : public QpSolverCollection::QpSolver
+{
+public:
+  using QpSolver::solve;
+
+  virtual Eigen::VectorXd solve(int dim_var,
+                                int dim_eq,
+                                int dim_ineq,
+                                Eigen::Ref<Eigen::MatrixXd>,
+                                const Eigen::Ref<const Eigen::VectorXd> &,
+                                const Eigen::Ref<const Eigen::MatrixXd> &,
+                                const Eigen::Ref<const Eigen::VectorXd> &,
+                                const Eigen::Ref<const Eigen::MatrixXd> &,
+                                const Eigen::Ref<const Eigen::VectorXd> &,
+                                const Eigen::Ref<const Eigen::VectorXd> &,
+                                const Eigen::Ref<const Eigen::VectorXd> &) override
+  {
+    setLastDimension(dim_var, dim_eq, dim_ineq);
+    unchanged_list_.clear();
+    for(int i = 0; i < QpCoeff::block_num; i++)
+    {
+      if(coeffUnchanged(static_cast<Block>(i)))
+      {
+        unchanged_list_.push_back(static_cast<Block>(i));
+      }
+    }
+    if(throw_)
+    {
+      throw std::runtime_error("[QpSolverRecorder::solve] Exception for test.");
+    }
+    solve_failed_ = fail_;
+    return Eigen::VectorXd::Zero(dim_var);
+  }
+
+  //! Unchanged blocks in the last solve
+  std::vector<Block> unchanged_list_;
+
+  //! Whether to make the solve fail
+  bool fail_ = false;
+
+  //! Whether to make the solve throw an exception
+  bool throw_ = false;
+};
+
+namespace
+{
+const std::vector<Block> all_block_list = {Block::ObjMat,  Block::ObjVec,  Block::EqMat, Block::EqVec,
+                                           Block::IneqMat, Block::IneqVec, Block::Bound};
+
+std::vector<Block> allBlocksExcept(const std::vector<Block> & modified_list)
+{
+  std::vector<Block> block_list;
+  for(Block block : all_block_list)
+  {
+    if(std::find(modified_list.begin(), modified_list.end(), block) == modified_list.end())
+    {
+      block_list.push_back(block);
+    }
+  }
+  return block_list;
+}
+} // namespace
+
+TEST(TestQpCoeffModification, Setters)
+{
+  QpSolverRecorder qp_solver;
+  QpCoeff qp_coeff;
+  qp_coeff.setup(3, 1, 2);
+  qp_coeff.track_modification_ = true;
+
+  // All the blocks are regarded as modified in the first solve
+  qp_solver.solve(qp_coeff);
+  EXPECT_TRUE(qp_solver.unchanged_list_.empty());
+  qp_solver.solve(qp_coeff);
+  EXPECT_EQ(qp_solver.unchanged_list_, all_block_list);
+
+  // Only the blocks modified by the setters are updated
+  qp_coeff.setObjVec(Eigen::VectorXd::Ones(3));
+  qp_coeff.setBound(-Eigen::VectorXd::Ones(3), Eigen::VectorXd::Ones(3));
+  qp_solver.solve(qp_coeff);
+  EXPECT_EQ(qp_solver.unchanged_list_, allBlocksExcept({Block::ObjVec, Block::Bound}));
+  qp_coeff.setObjMat(Eigen::MatrixXd::Identity(3, 3));
+  qp_coeff.setEqMat(Eigen::MatrixXd::Ones(1, 3));
+  qp_coeff.setEqVec(Eigen::VectorXd::Ones(1));
+  qp_solver.solve(qp_coeff);
+  EXPECT_EQ(qp_solver.unchanged_list_, allBlocksExcept({Block::ObjMat, Block::EqMat, Block::EqVec}));
+  qp_coeff.setIneqMat(Eigen::MatrixXd::Ones(2, 3));
+  qp_coeff.setIneqVec(Eigen::VectorXd::Ones(2));
+  qp_solver.solve(qp_coeff);
+  EXPECT_EQ(qp_solver.unchanged_list_, allBlocksExcept({Block::IneqMat, Block::IneqVec}));
+
+  // Direct modifications must be notified
+  qp_coeff.obj_vec_[0] = 2.0;
+  qp_coeff.setModified(Block::ObjVec);
+  qp_solver.solve(qp_coeff);
+  EXPECT_EQ(qp_solver.unchanged_list_, allBlocksExcept({Block::ObjVec}));
+  qp_coeff.setModified();
+  qp_solver.solve(qp_coeff);
+  EXPECT_TRUE(qp_solver.unchanged_list_.empty());
+
+  // Setup modifies all the blocks
+  qp_solver.solve(qp_coeff);
+  qp_coeff.setup(3, 1, 2);
+  qp_solver.solve(qp_coeff);
+  EXPECT_TRUE(qp_solver.unchanged_list_.empty());
+
+  // No blocks are regarded as unchanged without the tracking
+  qp_coeff.track_modification_ = false;
+  qp_solver.solve(qp_coeff);
+  qp_solver.solve(qp_coeff);
+  EXPECT_TRUE(qp_solver.unchanged_list_.empty());
+}
+
+TEST(TestQpCoeffModification, Invalidation)
+{
+  QpSolverRecorder qp_solver;
+  QpCoeff qp_coeff;
+  qp_coeff.setup(3, 1, 2);
+  qp_coeff.track_modification_ = true;
+  qp_solver.solve(qp_coeff);
+
+  // Copy is a different instance
+  QpCoeff qp_coeff_copied = qp_coeff;
+  EXPECT_NE(qp_coeff_copied.id(), qp_coeff.id());
+  qp_solver.solve(qp_coeff_copied);
+  EXPECT_TRUE(qp_solver.unchanged_list_.empty());
+
+  // Solve of another instance in between
+  qp_solver.solve(qp_coeff);
+  EXPECT_TRUE(qp_solver.unchanged_list_.empty());
+  qp_solver.solve(qp_coeff);
+  EXPECT_EQ(qp_solver.unchanged_list_, all_block_list);
+
+  // Solve without QpCoeff in between
+  qp_solver.solve(qp_coeff.dim_var_, qp_coeff.dim_eq_, qp_coeff.dim_ineq_, qp_coeff.obj_mat_, qp_coeff.obj_vec_,
+                  qp_coeff.eq_mat_, qp_coeff.eq_vec_, qp_coeff.ineq_mat_, qp_coeff.ineq_vec_, qp_coeff.x_min_,
+                  qp_coeff.x_max_);
+  qp_solver.solve(qp_coeff);
+  EXPECT_TRUE(qp_solver.unchanged_list_.empty());
+
+  // Failed solve
+  qp_solver.fail_ = true;
+  qp_solver.solve(qp_coeff);
+  EXPECT_EQ(qp_solver.unchanged_list_, all_block_list);
+  qp_solver.fail_ = false;
+  qp_solver.solve(qp_coeff);
+  EXPECT_TRUE(qp_solver.unchanged_list_.empty());
+
+  // Exceptions do not leave the unchanged blocks for the following solve without QpCoeff
+  auto solveRaw = [&]() {
+    qp_solver.solve(qp_coeff.dim_var_, qp_coeff.dim_eq_, qp_coeff.dim_ineq_, qp_coeff.obj_mat_, qp_coeff.obj_vec_,
+                    qp_coeff.eq_mat_, qp_coeff.eq_vec_, qp_coeff.ineq_mat_, qp_coeff.ineq_vec_, qp_coeff.x_min_,
+                    qp_coeff.x_max_);
+  };
+  qp_solver.solve(qp_coeff);
+  qp_solver.throw_ = true;
+  EXPECT_THROW(qp_solver.solve(qp_coeff), std::runtime_error);
+  qp_solver.throw_ = false;
+  solveRaw();
+  EXPECT_TRUE(qp_solver.unchanged_list_.empty());
+  qp_solver.solve(qp_coeff);
+  qp_solver.solve(qp_coeff);
+  qp_coeff.element_ids_.var_id_list_ = {0, 1};
+  EXPECT_THROW(qp_solver.solve(qp_coeff), std::invalid_argument);
+  qp_coeff.element_ids_.var_id_list_.clear();
+  solveRaw();
+  EXPECT_TRUE(qp_solver.unchanged_list_.empty());
+  qp_solver.solve(qp_coeff);
+
+  // Another QP solver instance
+  QpSolverRecorder qp_solver2;
+  qp_solver2.solve(qp_coeff);
+  EXPECT_TRUE(qp_solver2.unchanged_list_.empty());
+  qp_solver.solve(qp_coeff);
+  EXPECT_EQ(qp_solver.unchanged_list_, all_block_list);
+}
+
+int main(int argc, char ** argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,126 @@
+/* Author: Masaki Murooka */
+
+#include <gtest/gtest.h>
+
+#include <qp_solver_collection/QpMultiRhsSolver.h>
+
+using QpSolverCollection::QpCoeff;
+using QpSolverCollection::QpSolveStatus;
+using QpSolverCollection::QpSolverType;
+
+namespace
+{
+/** \brief Make QPs that share the matrices and bounds, and differ in the vectors.
+    \param qp_coeff QP coefficient whose matrices and bounds are set
+    \param rhs_num number of QPs
+    \param vec_scale scale of the random variation of the vectors
+ */
+void makeMultiRhs(QpCoeff & qp_coeff,
+                  Eigen::MatrixXd & c_mat,
+                  Eigen::MatrixXd & b_mat,
+                  Eigen::MatrixXd & d_mat,
+                  int rhs_num,
+                  double vec_scale)
+{
+  int dim_var = qp_coeff.dim_var_;
+  Eigen::MatrixXd tmp_mat = Eigen::MatrixXd::Random(dim_var, dim_var);
+  qp_coeff.obj_mat_ = tmp_mat.transpose() * tmp_mat + Eigen::MatrixXd::Identity(dim_var, dim_var);
+  qp_coeff.eq_mat_.setRandom();
+  qp_coeff.ineq_mat_.setRandom();
+  qp_coeff.x_min_.setConstant(-1.0);
+  qp_coeff.x_max_.setConstant(1.0);
+
+  Eigen::VectorXd c_nominal = 5.0 * Eigen::VectorXd::Random(dim_var);
+  Eigen::VectorXd x_feasible = 0.5 * Eigen::VectorXd::Random(dim_var);
+  c_mat.resize(dim_var, rhs_num);
+  b_mat.resize(qp_coeff.dim_eq_, rhs_num);
+  d_mat.resize(qp_coeff.dim_ineq_, rhs_num);
+  for(int j = 0; j < rhs_num; j++)
+  {
+    c_mat.col(j) = c_nominal + vec_scale * Eigen::VectorXd::Random(dim_var);
+    Eigen::VectorXd x_feasible_j = x_feasible + 0.1 * vec_scale * Eigen::VectorXd::Random(dim_var);
+    b_mat.col(j) = qp_coeff.eq_mat_ * x_feasible_j;
+    d_mat.col(j) = qp_coeff.ineq_mat_ * x_feasible_j + 0.1 * Eigen::VectorXd::Ones(qp_coeff.dim_ineq_);
+  }
+}
+} // namespace
+
+TEST(TestQpMultiRhsSolver, CompareWithBackend)
+{
+  int rhs_num = 50;
+  QpCoeff qp_coeff;
+  qp_coeff.setup(8, 2, 6);
+
+  // Small variations share a few active sets, and large variations require many groups and the fallback
+  for(double vec_scale : {0.01, 1.0})
+  {
+    Eigen::MatrixXd c_mat, b_mat, d_mat;
+    makeMultiRhs(qp_coeff, c_mat, b_mat, d_mat, rhs_num, vec_scale);
+
+    QpSolverCollection::QpMultiRhsSolver multi_rhs_solver(QpSolverType::Builtin);
+    auto result_list = multi_rhs_solver.solveMultiRhs(qp_coeff.obj_mat_, qp_coeff.eq_mat_, qp_coeff.ineq_mat_,
+                                                      c_mat, b_mat, d_mat, qp_coeff.x_min_, qp_coeff.x_max_);
+    ASSERT_EQ(result_list.size(), static_cast<size_t>(rhs_num));
+    EXPECT_LE(multi_rhs_solver.groupNum(), multi_rhs_solver.max_group_num_);
+    if(vec_scale < 0.1)
+    {
+      EXPECT_LT(multi_rhs_solver.backendSolveNum(), rhs_num / 2);
+    }
+
+    auto qp_solver = QpSolverCollection::allocateQpSolver(QpSolverType::Builtin);
+    for(int j = 0; j < rhs_num; j++)
+    {
+      QpCoeff qp_coeff_j = qp_coeff;
+      qp_coeff_j.obj_vec_ = c_mat.col(j);
+      qp_coeff_j.eq_vec_ = b_mat.col(j);
+      qp_coeff_j.ineq_vec_ = d_mat.col(j);
+      QpCoeff qp_coeff_copied = qp_coeff_j;
+      Eigen::VectorXd x_gt = qp_solver->solve(qp_coeff_copied);
+      const auto & result = result_list[j];
+      EXPECT_EQ(result.status_, QpSolveStatus::Solved) << "vec_scale: " << vec_scale << ", j: " << j;
+      EXPECT_LT((result.x_ - x_gt).norm(), 1e-6) << "vec_scale: " << vec_scale << ", j: " << j;
+      EXPECT_TRUE(QpSolverCollection::computeKkt(qp_coeff_j, result).satisfied(1e-6))
+          << "vec_scale: " << vec_scale << ", j: " << j;
+    }
+  }
+}
+
+TEST(TestQpMultiRhsSolver, Fallback)
+{
+  int rhs_num = 10;
+  QpCoeff qp_coeff;
+  qp_coeff.setup(4, 1, 3);
+  Eigen::MatrixXd c_mat, b_mat, d_mat;
+  makeMultiRhs(qp_coeff, c_mat, b_mat, d_mat, rhs_num, 0.01);
+
+  QpSolverCollection::QpMultiRhsSolver multi_rhs_solver(QpSolverType::Builtin);
+  multi_rhs_solver.max_group_num_ = 0;
+  auto result_list = multi_rhs_solver.solveMultiRhs(qp_coeff.obj_mat_, qp_coeff.eq_mat_, qp_coeff.ineq_mat_, c_mat,
+                                                    b_mat, d_mat, qp_coeff.x_min_, qp_coeff.x_max_);
+  EXPECT_EQ(multi_rhs_solver.groupNum(), 0);
+  EXPECT_EQ(multi_rhs_solver.backendSolveNum(), rhs_num);
+  for(const auto & result : result_list)
+  {
+    EXPECT_EQ(result.status_, QpSolveStatus::Solved);
+  }
+
+  // Objective matrix that is not positive definite is not factorized
+  multi_rhs_solver.max_group_num_ = 8;
+  Eigen::MatrixXd obj_mat = qp_coeff.obj_mat_;
+  obj_mat.row(0).setZero();
+  obj_mat.col(0).setZero();
+  multi_rhs_solver.solveMultiRhs(obj_mat, qp_coeff.eq_mat_, qp_coeff.ineq_mat_, c_mat, b_mat, d_mat,
+                                 qp_coeff.x_min_, qp_coeff.x_max_);
+  EXPECT_EQ(multi_rhs_solver.groupNum(), 0);
+  EXPECT_EQ(multi_rhs_solver.backendSolveNum(), rhs_num);
+
+  EXPECT_THROW(multi_rhs_solver.solveMultiRhs(qp_coeff.obj_mat_, qp_coeff.eq_mat_, qp_coeff.ineq_mat_, c_mat,
+                                              b_mat.leftCols(rhs_num - 1), d_mat, qp_coeff.x_min_, qp_coeff.x_max_),
+               std::invalid_argument);
+}
+
+int main(int argc, char ** argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,163 @@
+/* Author: Masaki Murooka */
+
+#include <gtest/gtest.h>
+
+#include <qp_solver_collection/QpSensitivity.h>
+
+using QpSolverCollection::QpCoeff;
+
+namespace
+{
+/** \brief Solve QP with the given active set (which does not change under small perturbations of coefficient). */
+Eigen::VectorXd solveWithActiveSet(const QpCoeff & qp_coeff,
+                                   const std::vector<int> & active_ineq_list,
+                                   const std::vector<int> & active_lower_list,
+                                   const std::vector<int> & active_upper_list)
+{
+  int dim_var = qp_coeff.dim_var_;
+  int dim_eq = qp_coeff.dim_eq_;
+  int dim_active =
+      dim_eq + static_cast<int>(active_ineq_list.size() + active_lower_list.size() + active_upper_list.size());
+  Eigen::MatrixXd G = Eigen::MatrixXd::Zero(dim_active, dim_var);
+  Eigen::VectorXd h(dim_active);
+  G.topRows(dim_eq) = qp_coeff.eq_mat_;
+  h.head(dim_eq) = qp_coeff.eq_vec_;
+  int row_idx = dim_eq;
+  for(int i : active_ineq_list)
+  {
+    G.row(row_idx) = qp_coeff.ineq_mat_.row(i);
+    h[row_idx++] = qp_coeff.ineq_vec_[i];
+  }
+  for(int i : active_lower_list)
+  {
+    G(row_idx, i) = 1.0;
+    h[row_idx++] = qp_coeff.x_min_[i];
+  }
+  for(int i : active_upper_list)
+  {
+    G(row_idx, i) = 1.0;
+    h[row_idx++] = qp_coeff.x_max_[i];
+  }
+  Eigen::MatrixXd kkt_mat = Eigen::MatrixXd::Zero(dim_var + dim_active, dim_var + dim_active);
+  kkt_mat.topLeftCorner(dim_var, dim_var) = qp_coeff.obj_mat_;
+  kkt_mat.topRightCorner(dim_var, dim_active) = G.transpose();
+  kkt_mat.bottomLeftCorner(dim_active, dim_var) = G;
+  Eigen::VectorXd kkt_vec(dim_var + dim_active);
+  kkt_vec << -qp_coeff.obj_vec_, h;
+  return kkt_mat.fullPivLu().solve(kkt_vec).head(dim_var);
+}
+} // namespace
+
+TEST(TestQpSensitivity, FiniteDifference)
+{
+  // Construct QP whose solution and active set are known
+  int dim_var = 6;
+  int dim_eq = 1;
+  int dim_ineq = 3;
+  QpCoeff qp_coeff;
+  qp_coeff.setup(dim_var, dim_eq, dim_ineq);
+  Eigen::MatrixXd tmp_mat = Eigen::MatrixXd::Random(dim_var, dim_var);
+  qp_coeff.obj_mat_ = tmp_mat.transpose() * tmp_mat + Eigen::MatrixXd::Identity(dim_var, dim_var);
+  qp_coeff.eq_mat_.setRandom();
+  qp_coeff.ineq_mat_.setRandom();
+
+  QpSolverCollection::SolveResult result;
+  result.x_.setRandom(dim_var);
+  result.dual_eq_.setRandom(dim_eq);
+  result.dual_ineq_.resize(dim_ineq);
+  result.dual_ineq_ << 0.5, 0.0, 1.0; // The second inequality constraint is inactive
+  result.dual_bound_.setZero(dim_var);
+  result.dual_bound_[1] = -0.7; // Lower bound is active
+  result.dual_bound_[4] = 0.3; // Upper bound is active
+  qp_coeff.eq_vec_ = qp_coeff.eq_mat_ * result.x_;
+  qp_coeff.ineq_vec_ = qp_coeff.ineq_mat_ * result.x_;
+  qp_coeff.ineq_vec_[1] += 1.0;
+  qp_coeff.x_min_.setConstant(-10.0);
+  qp_coeff.x_max_.setConstant(10.0);
+  qp_coeff.x_min_[1] = result.x_[1];
+  qp_coeff.x_max_[4] = result.x_[4];
+  qp_coeff.obj_vec_ = -(qp_coeff.obj_mat_ * result.x_ + qp_coeff.eq_mat_.transpose() * result.dual_eq_
+                        + qp_coeff.ineq_mat_.transpose() * result.dual_ineq_ + result.dual_bound_);
+  EXPECT_TRUE(QpSolverCollection::computeKkt(qp_coeff, result).satisfied(1e-10));
+
+  // The active set is the same with and without Lagrange multipliers
+  QpSolverCollection::QpSensitivity sensitivity;
+  QpSolverCollection::SolveResult result_without_dual;
+  result_without_dual.x_ = result.x_;
+  EXPECT_TRUE(sensitivity.factorize(qp_coeff, result_without_dual));
+  std::vector<int> active_ineq_list = sensitivity.activeIneqList();
+  EXPECT_TRUE(sensitivity.factorize(qp_coeff, result));
+  EXPECT_EQ(sensitivity.activeIneqList(), active_ineq_list);
+  EXPECT_EQ(sensitivity.activeIneqList(), std::vector<int>({0, 2}));
+  EXPECT_EQ(sensitivity.activeLowerList(), std::vector<int>({1}));
+  EXPECT_EQ(sensitivity.activeUpperList(), std::vector<int>({4}));
+
+  // Loss is the linear function of the solution
+  Eigen::VectorXd grad_x = Eigen::VectorXd::Random(dim_var);
+  QpCoeff grad = sensitivity.backward(grad_x);
+  auto loss = [&](const QpCoeff & qp_coeff_perturbed) {
+    return grad_x.dot(solveWithActiveSet(qp_coeff_perturbed, sensitivity.activeIneqList(),
+                                         sensitivity.activeLowerList(), sensitivity.activeUpperList()));
+  };
+  EXPECT_NEAR(loss(qp_coeff), grad_x.dot(result.x_), 1e-10);
+
+  // Compare with central difference
+  constexpr double eps = 1e-6;
+  constexpr double tol = 1e-6;
+  auto checkGrad = [&](auto getter, const Eigen::MatrixXd & grad_analytical, bool symmetric) {
+    Eigen::MatrixXd grad_numerical = Eigen::MatrixXd::Zero(grad_analytical.rows(), grad_analytical.cols());
+    for(Eigen::Index i = 0; i < grad_analytical.rows(); i++)
+    {
+      for(Eigen::Index j = 0; j < grad_analytical.cols(); j++)
+      {
+        QpCoeff qp_coeff_plus = qp_coeff;
+        QpCoeff qp_coeff_minus = qp_coeff;
+        getter(qp_coeff_plus)(i, j) += eps;
+        getter(qp_coeff_minus)(i, j) -= eps;
+        grad_numerical(i, j) = (loss(qp_coeff_plus) - loss(qp_coeff_minus)) / (2 * eps);
+      }
+    }
+    if(symmetric)
+    {
+      grad_numerical = 0.5 * (grad_numerical + grad_numerical.transpose()).eval();
+    }
+    EXPECT_LT((grad_numerical - grad_analytical).cwiseAbs().maxCoeff(), tol)
+        << "grad_numerical:\n"
+        << grad_numerical << "\ngrad_analytical:\n"
+        << grad_analytical;
+  };
+  checkGrad([](QpCoeff & q) -> Eigen::MatrixXd & { return q.obj_mat_; }, grad.obj_mat_, true);
+  checkGrad([](QpCoeff & q) -> Eigen::VectorXd & { return q.obj_vec_; }, grad.obj_vec_, false);
+  checkGrad([](QpCoeff & q) -> Eigen::MatrixXd & { return q.eq_mat_; }, grad.eq_mat_, false);
+  checkGrad([](QpCoeff & q) -> Eigen::VectorXd & { return q.eq_vec_; }, grad.eq_vec_, false);
+  checkGrad([](QpCoeff & q) -> Eigen::MatrixXd & { return q.ineq_mat_; }, grad.ineq_mat_, false);
+  checkGrad([](QpCoeff & q) -> Eigen::VectorXd & { return q.ineq_vec_; }, grad.ineq_vec_, false);
+  checkGrad([](QpCoeff & q) -> Eigen::VectorXd & { return q.x_min_; }, grad.x_min_, false);
+  checkGrad([](QpCoeff & q) -> Eigen::VectorXd & { return q.x_max_; }, grad.x_max_, false);
+}
+
+TEST(TestQpSensitivity, Degenerate)
+{
+  // Duplicated active constraints make the reduced KKT matrix singular
+  QpCoeff qp_coeff;
+  qp_coeff.setup(2, 0, 2);
+  qp_coeff.obj_mat_.setIdentity();
+  qp_coeff.obj_vec_ << -1.0, -1.0;
+  qp_coeff.ineq_mat_ << 1.0, 0.0, 1.0, 0.0;
+  qp_coeff.ineq_vec_ << 0.0, 0.0;
+
+  QpSolverCollection::SolveResult result;
+  result.x_.resize(2);
+  result.x_ << 0.0, 1.0;
+
+  QpSolverCollection::QpSensitivity sensitivity;
+  EXPECT_FALSE(sensitivity.factorize(qp_coeff, result));
+  EXPECT_FALSE(sensitivity.factorized());
+  EXPECT_THROW(sensitivity.backward(Eigen::VectorXd::Ones(2)), std::runtime_error);
+}
+
+int main(int argc, char ** argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
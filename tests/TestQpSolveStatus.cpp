@@ -0,0 +1,186 @@
+/* Author: Masaki Murooka */
+
+#include <limits>
+#include <sstream>
+
+#include <gtest/gtest.h>
+
+#include <qp_solver_collection/QpSolverCollection.h>
+
+#include "QpSolverTestUtils.h"
+
+using QpSolverCollection::QpCoeff;
+using QpSolverCollection::QpSolveStatus;
+using QpSolverCollection::QpSolverType;
+
+namespace
+{
+QpCoeff makeFeasibleQpCoeff()
+{
+  QpCoeff qp_coeff;
+  qp_coeff.setup(3, 2, 1);
+  qp_coeff.obj_mat_.setIdentity();
+  qp_coeff.eq_mat_ << 1.0, 1.0, 0.0, 0.0, 1.0, 1.0;
+  qp_coeff.eq_vec_ << 1.0, 2.0;
+  qp_coeff.ineq_mat_ << 1.0, 0.0, 0.0;
+  qp_coeff.ineq_vec_ << 5.0;
+  qp_coeff.x_min_.setConstant(-10.0);
+  qp_coeff.x_max_.setConstant(10.0);
+  return qp_coeff;
+}
+
+QpSolveStatus presolve(const QpCoeff & qp_coeff)
+{
+  return QpSolverCollection::presolveQp(qp_coeff.eq_mat_, qp_coeff.eq_vec_, qp_coeff.ineq_mat_, qp_coeff.ineq_vec_,
+                                        qp_coeff.x_min_, qp_coeff.x_max_);
+}
+} // namespace
+
+TEST(TestQpSolveStatus, Presolve)
+{
+  EXPECT_EQ(presolve(makeFeasibleQpCoeff()), QpSolveStatus::Unsolved);
+
+  // Absent bounds
+  {
+    QpCoeff qp_coeff = makeFeasibleQpCoeff();
+    qp_coeff.x_min_.setConstant(std::numeric_limits<double>::lowest());
+    qp_coeff.x_max_.setConstant(std::numeric_limits<double>::infinity());
+    EXPECT_EQ(presolve(qp_coeff), QpSolveStatus::Unsolved);
+  }
+
+  // Crossed bounds
+  {
+    QpCoeff qp_coeff = makeFeasibleQpCoeff();
+    qp_coeff.x_min_[1] = 1.0;
+    qp_coeff.x_max_[1] = 0.0;
+    EXPECT_EQ(presolve(qp_coeff), QpSolveStatus::PrimalInfeasible);
+  }
+
+  // Zero row of inequality constraint
+  {
+    QpCoeff qp_coeff = makeFeasibleQpCoeff();
+    qp_coeff.ineq_mat_.setZero();
+    EXPECT_EQ(presolve(qp_coeff), QpSolveStatus::Unsolved);
+    qp_coeff.ineq_vec_ << -1.0;
+    EXPECT_EQ(presolve(qp_coeff), QpSolveStatus::PrimalInfeasible);
+  }
+
+  // Rank-deficient equality constraints are consistent only if the vector is in the range
+  {
+    QpCoeff qp_coeff = makeFeasibleQpCoeff();
+    qp_coeff.eq_mat_.row(1) = 2.0 * qp_coeff.eq_mat_.row(0);
+    qp_coeff.eq_vec_ << 1.0, 2.0;
+    EXPECT_EQ(presolve(qp_coeff), QpSolveStatus::Unsolved);
+    qp_coeff.eq_vec_ << 1.0, 3.0;
+    EXPECT_EQ(presolve(qp_coeff), QpSolveStatus::PrimalInfeasible);
+  }
+
+  // NaN
+  {
+    QpCoeff qp_coeff = makeFeasibleQpCoeff();
+    qp_coeff.ineq_vec_[0] = std::numeric_limits<double>::quiet_NaN();
+    EXPECT_EQ(presolve(qp_coeff), QpSolveStatus::InvalidInput);
+  }
+}
+
+TEST(TestQpSolveStatus, PresolveInSolver)
+{
+  QpSolverUnconstrained qp_solver;
+  EXPECT_EQ(qp_solver.status(), QpSolveStatus::Unsolved);
+
+  QpCoeff qp_coeff = makeFeasibleQpCoeff();
+  qp_coeff.x_min_[1] = 1.0;
+  qp_coeff.x_max_[1] = 0.0;
+
+  // Presolve is disabled by default
+  qp_solver.solve(qp_coeff);
+  EXPECT_EQ(qp_solver.call_count_, 1);
+  EXPECT_EQ(qp_solver.status(), QpSolveStatus::Solved);
+
+  // Infeasible QP is rejected without calling the QP solver
+  QpSolverCollection::QpSolverSettings settings;
+  settings.presolve_ = true;
+  qp_solver.setSettings(settings);
+  QpSolverCollection::SolveResult result = qp_solver.solveWithResult(qp_coeff);
+  EXPECT_EQ(qp_solver.call_count_, 1);
+  EXPECT_TRUE(qp_solver.solveFailed());
+  EXPECT_EQ(qp_solver.status(), QpSolveStatus::PrimalInfeasible);
+  EXPECT_EQ(result.status_, QpSolveStatus::PrimalInfeasible);
+  EXPECT_FALSE(result.hasDual());
+
+  QpCoeff qp_coeff_feasible = makeFeasibleQpCoeff();
+  qp_solver.solve(qp_coeff_feasible);
+  EXPECT_EQ(qp_solver.call_count_, 2);
+  EXPECT_FALSE(qp_solver.solveFailed());
+
+  // Settings are dumped and loaded
+  std::stringstream ss;
+  settings.dump(ss);
+  QpSolverCollection::QpSolverSettings settings_loaded;
+  EXPECT_TRUE(settings_loaded.load(ss));
+  EXPECT_TRUE(settings_loaded.presolve_);
+}
+
+TEST(TestQpSolveStatus, InfeasibleQP)
+{
+  // Inequality constraint x0 <= -1 conflicts with lower bound x0 >= 0
+  QpCoeff qp_coeff;
+  qp_coeff.setup(2, 0, 1);
+  qp_coeff.obj_mat_.setIdentity();
+  qp_coeff.obj_vec_ << 1.0, -1.0;
+  qp_coeff.ineq_mat_ << 1.0, 0.0;
+  qp_coeff.ineq_vec_ << -1.0;
+  qp_coeff.x_min_.setZero();
+  qp_coeff.x_max_.setConstant(10.0);
+
+  for(int i = static_cast<int>(QpSolverType::QLD); i <= static_cast<int>(QpSolverType::Builtin); i++)
+  {
+    QpSolverType qp_solver_type = static_cast<QpSolverType>(i);
+    if(!QpSolverCollection::isQpSolverEnabled(qp_solver_type))
+    {
+      continue;
+    }
+
+    auto qp_solver = QpSolverCollection::allocateQpSolver(qp_solver_type);
+    QpCoeff qp_coeff_copied = qp_coeff;
+    qp_solver->solve(qp_coeff_copied);
+    EXPECT_TRUE(qp_solver->solveFailed()) << std::to_string(qp_solver_type);
+    EXPECT_NE(qp_solver->status(), QpSolveStatus::Solved) << std::to_string(qp_solver_type);
+    if(qp_solver_type == QpSolverType::QPMAD)
+    {
+      // QpSolverQpmad depends on the message of the exception thrown by QPMAD
+      EXPECT_EQ(qp_solver->status(), QpSolveStatus::PrimalInfeasible);
+    }
+  }
+}
+
+TEST(TestQpSolveStatus, NotPositiveDefiniteQP)
+{
+  QpCoeff qp_coeff;
+  qp_coeff.setup(2, 0, 0);
+  qp_coeff.obj_mat_.diagonal() << 1.0, -1.0;
+  qp_coeff.obj_vec_ << 1.0, -1.0;
+  qp_coeff.x_min_.setConstant(-10.0);
+  qp_coeff.x_max_.setConstant(10.0);
+
+  // QP solvers that require the positive definite objective matrix report it as dual infeasibility
+  for(QpSolverType qp_solver_type : {QpSolverType::QuadProg, QpSolverType::JRLQP, QpSolverType::Builtin})
+  {
+    if(!QpSolverCollection::isQpSolverEnabled(qp_solver_type))
+    {
+      continue;
+    }
+
+    auto qp_solver = QpSolverCollection::allocateQpSolver(qp_solver_type);
+    QpCoeff qp_coeff_copied = qp_coeff;
+    qp_solver->solve(qp_coeff_copied);
+    EXPECT_TRUE(qp_solver->solveFailed()) << std::to_string(qp_solver_type);
+    EXPECT_EQ(qp_solver->status(), QpSolveStatus::DualInfeasible) << std::to_string(qp_solver_type);
+  }
+}
+
+int main(int argc, char ** argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
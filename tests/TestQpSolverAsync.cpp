@@ -0,0 +1,135 @@
+/* Author: Masaki Murooka */
+
+#include <atomic>
+
+#include <gtest/gtest.h>
+
+#include <Eigen/Dense>
+
+#include <qp_solver_collection/QpSolverAsync.h>
+
+#include "QpSolverTestUtils.h"
+
+using QpSolverCollection::QpAsyncResult;
+using QpSolverCollection::QpCoeff;
+using QpSolverCollection::QpSolverType;
+
+Eigen::VectorXd solutionOf(const QpCoeff & qp_coeff)
+{
+  return -qp_coeff.obj_mat_.ldlt().solve(qp_coeff.obj_vec_);
+}
+
+TEST(TestQpSolverAsync, Future)
+{
+  auto qp_solver = std::make_shared<QpSolverUnconstrained>();
+  QpSolverCollection::QpSolverAsync qp_solver_async(qp_solver);
+
+  std::vector<std::future<QpAsyncResult>> future_list;
+  for(int i = 0; i < 10; i++)
+  {
+    QpCoeff qp_coeff = makeQpCoeff(i);
+    const double * obj_mat_data = qp_coeff.obj_mat_.data();
+    future_list.push_back(qp_solver_async.solveAsync(std::move(qp_coeff)));
+    if(i == 0)
+    {
+      // Buffer is moved without copying
+      QpAsyncResult result = future_list.back().get();
+      EXPECT_EQ(result.qp_coeff_.obj_mat_.data(), obj_mat_data);
+      future_list.pop_back();
+      future_list.push_back(qp_solver_async.solveAsync(std::move(result.qp_coeff_)));
+    }
+  }
+  for(int i = 0; i < 10; i++)
+  {
+    QpAsyncResult result = future_list[i].get();
+    EXPECT_FALSE(result.solve_failed_);
+    EXPECT_LT((result.result_.x_ - solutionOf(makeQpCoeff(i))).norm(), 1e-10);
+  }
+  EXPECT_EQ(qp_solver->call_count_, 11);
+}
+
+TEST(TestQpSolverAsync, Callback)
+{
+  auto qp_solver = std::make_shared<QpSolverUnconstrained>();
+  std::atomic<int> callback_count(0);
+  std::atomic<int> error_count(0);
+  {
+    QpSolverCollection::QpSolverAsync qp_solver_async(qp_solver);
+    for(int i = 0; i < 10; i++)
+    {
+      qp_solver_async.solveAsync(makeQpCoeff(i), [&, i](QpAsyncResult && result) {
+        if((result.result_.x_ - solutionOf(makeQpCoeff(i))).norm() > 1e-10)
+        {
+          error_count++;
+        }
+        callback_count++;
+      });
+    }
+    qp_solver_async.waitIdle();
+    EXPECT_EQ(callback_count, 10);
+    qp_solver_async.solveAsync(makeQpCoeff(10), [&](QpAsyncResult &&) { callback_count++; });
+    // Destructor solves the pending requests
+  }
+  EXPECT_EQ(callback_count, 11);
+  EXPECT_EQ(error_count, 0);
+}
+
+TEST(TestQpSolverAsync, DoubleBuffer)
+{
+  QpSolverCollection::QpSolverAsync qp_solver_async(std::make_shared<QpSolverUnconstrained>());
+
+  std::future<QpAsyncResult> future;
+  std::vector<const double *> buffer_data_list;
+  for(int i = 0; i < 10; i++)
+  {
+    QpCoeff & qp_coeff = qp_solver_async.backBuffer();
+    if(qp_coeff.dim_var_ != 3)
+    {
+      qp_coeff = makeQpCoeff(0);
+    }
+    qp_coeff.obj_vec_[0] = i;
+    if(i >= 2)
+    {
+      // Only two buffers are used alternately
+      EXPECT_EQ(qp_coeff.obj_mat_.data(), buffer_data_list[i - 2]);
+    }
+    buffer_data_list.push_back(qp_coeff.obj_mat_.data());
+
+    if(future.valid())
+    {
+      QpAsyncResult result = future.get();
+      EXPECT_LT((result.result_.x_ - solutionOf(makeQpCoeff(i - 1))).norm(), 1e-10);
+    }
+    future = qp_solver_async.swapBuffers();
+  }
+  QpAsyncResult result = future.get();
+  EXPECT_LT((result.result_.x_ - solutionOf(makeQpCoeff(9))).norm(), 1e-10);
+}
+
+TEST(TestQpSolverAsync, QpSolverType)
+{
+  for(int i = static_cast<int>(QpSolverType::QLD); i <= static_cast<int>(QpSolverType::Builtin); i++)
+  {
+    QpSolverType qp_solver_type = static_cast<QpSolverType>(i);
+    if(!QpSolverCollection::isQpSolverEnabled(qp_solver_type))
+    {
+      EXPECT_THROW(QpSolverCollection::QpSolverAsync qp_solver_async(qp_solver_type), std::runtime_error);
+      continue;
+    }
+
+    QpSolverCollection::QpSolverAsync qp_solver_async(qp_solver_type);
+    EXPECT_EQ(qp_solver_async.qpSolver()->type(), qp_solver_type);
+    QpCoeff qp_coeff = makeQpCoeff(1.0);
+    qp_coeff.x_min_.setConstant(-1e3);
+    qp_coeff.x_max_.setConstant(1e3);
+    QpAsyncResult result = qp_solver_async.solveAsync(std::move(qp_coeff)).get();
+    EXPECT_FALSE(result.solve_failed_);
+    EXPECT_LT((result.result_.x_ - solutionOf(makeQpCoeff(1.0))).norm(), 1e-3);
+  }
+}
+
+int main(int argc, char ** argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
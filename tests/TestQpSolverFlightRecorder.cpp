@@ -0,0 +1,154 @@
+/* Author: Masaki Murooka */
+
+#include <cstdio>
+#include <fstream>
+
+#include <gtest/gtest.h>
+
+#include <Eigen/Dense>
+
+#include <qp_solver_collection/QpSolverFlightRecorder.h>
+
+#include "QpSolverTestUtils.h"
+
+using QpSolverCollection::QpCoeff;
+using QpSolverCollection::QpSolveStatus;
+
+namespace
+{
+std::string recordPath(int recorder_id, uint64_t seq)
+{
+  return testing::TempDir() + "/qp_QLD_" + std::to_string(recorder_id) + "_" + std::to_string(seq) + ".txt";
+}
+
+/** \brief Find the ID of the recorder from the file of the given sequence number. */
+int findRecorderId(uint64_t seq)
+{
+  for(int recorder_id = 0; recorder_id < 100; recorder_id++)
+  {
+    if(std::ifstream(recordPath(recorder_id, seq)))
+    {
+      return recorder_id;
+    }
+  }
+  return -1;
+}
+} // namespace
+
+TEST(TestQpSolverFlightRecorder, History)
+{
+  auto backend = std::make_shared<QpSolverUnconstrained>();
+  backend->overwrite_obj_mat_ = true;
+  QpSolverCollection::QpSolverFlightRecorder qp_solver(backend, testing::TempDir(), 4);
+  qp_solver.preallocate(3, 1, 1);
+  for(int i = 0; i < 6; i++)
+  {
+    QpCoeff qp_coeff = makeQpCoeff(i);
+    qp_solver.solve(qp_coeff);
+  }
+
+  // The last QPs are kept before being overwritten by the QP solver
+  std::vector<QpSolverCollection::QpFlightRecord> record_list = qp_solver.history();
+  ASSERT_EQ(record_list.size(), 4);
+  for(size_t i = 0; i < record_list.size(); i++)
+  {
+    EXPECT_EQ(record_list[i].seq_, i + 2);
+    EXPECT_EQ(record_list[i].qp_coeff_.obj_vec_[0], static_cast<double>(i + 2));
+    EXPECT_EQ(record_list[i].qp_coeff_.obj_mat_, makeQpCoeff(0).obj_mat_);
+    EXPECT_EQ(record_list[i].status_, QpSolveStatus::Solved);
+  }
+  qp_solver.flush();
+  EXPECT_EQ(qp_solver.persistedCount(), 0);
+}
+
+TEST(TestQpSolverFlightRecorder, PersistFailure)
+{
+  auto backend = std::make_shared<QpSolverUnconstrained>();
+  QpSolverCollection::QpSolverFlightRecorder qp_solver(backend, testing::TempDir());
+  QpSolverCollection::QpSolverSettings settings;
+  settings.max_iter_ = 123;
+  qp_solver.setSettings(settings);
+
+  QpCoeff qp_coeff = makeQpCoeff(1.0);
+  qp_solver.solve(qp_coeff);
+  backend->fail_ = true;
+  qp_coeff = makeQpCoeff(2.0);
+  qp_solver.solve(qp_coeff);
+  EXPECT_TRUE(qp_solver.solveFailed());
+  EXPECT_EQ(qp_solver.status(), QpSolveStatus::NumericalError);
+  qp_solver.flush();
+  EXPECT_EQ(qp_solver.persistedCount(), 1);
+
+  // Only the failed QP is persisted, and it is loaded with the information to reproduce the solve
+  int recorder_id = findRecorderId(1);
+  ASSERT_GE(recorder_id, 0);
+  EXPECT_FALSE(std::ifstream(recordPath(recorder_id, 0)));
+  std::ifstream ifs(recordPath(recorder_id, 1));
+  QpSolverCollection::QpFlightRecord record;
+  ASSERT_TRUE(record.load(ifs));
+  QpCoeff qp_coeff_expected = makeQpCoeff(2.0);
+  EXPECT_EQ(record.qp_solver_type_, QpSolverCollection::QpSolverType::QLD);
+  EXPECT_EQ(record.seq_, 1);
+  EXPECT_EQ(record.status_, QpSolveStatus::NumericalError);
+  EXPECT_TRUE(record.solve_failed_);
+  EXPECT_EQ(record.settings_.max_iter_, 123);
+  EXPECT_EQ(record.qp_coeff_.obj_mat_, qp_coeff_expected.obj_mat_);
+  EXPECT_EQ(record.qp_coeff_.obj_vec_, qp_coeff_expected.obj_vec_);
+  EXPECT_EQ(record.qp_coeff_.ineq_mat_, qp_coeff_expected.ineq_mat_);
+  EXPECT_EQ(record.qp_coeff_.x_max_, qp_coeff_expected.x_max_);
+  std::remove(recordPath(recorder_id, 1).c_str());
+
+  // The number of persisted records is limited
+  qp_solver.max_persist_num_ = 3;
+  for(int i = 0; i < 5; i++)
+  {
+    qp_coeff = makeQpCoeff(3.0);
+    qp_solver.solve(qp_coeff);
+  }
+  qp_solver.flush();
+  EXPECT_EQ(qp_solver.persistedCount(), 3);
+  for(uint64_t seq = 2; seq < 7; seq++)
+  {
+    std::remove(recordPath(recorder_id, seq).c_str());
+  }
+}
+
+TEST(TestQpSolverFlightRecorder, PersistLatency)
+{
+  auto backend = std::make_shared<QpSolverUnconstrained>();
+  QpSolverCollection::QpSolverFlightRecorder qp_solver(backend, testing::TempDir());
+  qp_solver.latency_threshold_ = 5.0;
+
+  QpCoeff qp_coeff = makeQpCoeff(1.0);
+  qp_solver.solve(qp_coeff);
+  backend->sleep_ms_ = 10;
+  qp_coeff = makeQpCoeff(1.0);
+  qp_solver.solve(qp_coeff);
+  qp_solver.flush();
+  EXPECT_EQ(qp_solver.persistedCount(), 1);
+
+  int recorder_id = findRecorderId(1);
+  ASSERT_GE(recorder_id, 0);
+  std::ifstream ifs(recordPath(recorder_id, 1));
+  QpSolverCollection::QpFlightRecord record;
+  ASSERT_TRUE(record.load(ifs));
+  EXPECT_FALSE(record.solve_failed_);
+  EXPECT_GE(record.duration_, 5.0);
+  std::remove(recordPath(recorder_id, 1).c_str());
+
+  // All the QPs in the ring buffer are persisted on demand
+  EXPECT_EQ(qp_solver.persistHistory(), 2);
+  qp_solver.flush();
+  EXPECT_EQ(qp_solver.persistedCount(), 3);
+  for(uint64_t seq = 0; seq < 2; seq++)
+  {
+    EXPECT_TRUE(std::ifstream(recordPath(recorder_id, seq)));
+    std::remove(recordPath(recorder_id, seq).c_str());
+  }
+}
+
+int main(int argc, char ** argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
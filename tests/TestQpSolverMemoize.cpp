@@ -0,0 +1,193 @@
+/* Author: Masaki Murooka */
+
+#include <thread>
+
+#include <gtest/gtest.h>
+
+#include <Eigen/Dense>
+
+#include <qp_solver_collection/QpSolverMemoize.h>
+
+#include "QpSolverTestUtils.h"
+
+using QpSolverCollection::QpCoeff;
+
+TEST(TestQpSolverMemoize, Hash)
+{
+  QpCoeff qp_coeff1 = makeQpCoeff(1.0);
+  QpCoeff qp_coeff2 = makeQpCoeff(1.0);
+  auto hash = [](const QpCoeff & qp_coeff) {
+    return QpSolverCollection::computeQpHash(qp_coeff.dim_var_, qp_coeff.dim_eq_, qp_coeff.dim_ineq_,
+                                             qp_coeff.obj_mat_, qp_coeff.obj_vec_, qp_coeff.eq_mat_,
+                                             qp_coeff.eq_vec_, qp_coeff.ineq_mat_, qp_coeff.ineq_vec_,
+                                             qp_coeff.x_min_, qp_coeff.x_max_);
+  };
+  EXPECT_EQ(hash(qp_coeff1), hash(qp_coeff2));
+
+  // Any field changes the hash
+  qp_coeff2.x_max_[2] = 1.0;
+  EXPECT_NE(hash(qp_coeff1), hash(qp_coeff2));
+  qp_coeff2 = makeQpCoeff(1.0);
+  qp_coeff2.ineq_vec_[0] = 1e-300;
+  EXPECT_NE(hash(qp_coeff1), hash(qp_coeff2));
+
+  // Hash of the submatrix with outer stride equals that of the contiguous copy
+  Eigen::MatrixXd Q_large = Eigen::MatrixXd::Zero(5, 3);
+  Q_large.topRows(3) = qp_coeff1.obj_mat_;
+  EXPECT_EQ(hash(qp_coeff1),
+            QpSolverCollection::computeQpHash(qp_coeff1.dim_var_, qp_coeff1.dim_eq_, qp_coeff1.dim_ineq_,
+                                              Q_large.topRows(3), qp_coeff1.obj_vec_, qp_coeff1.eq_mat_,
+                                              qp_coeff1.eq_vec_, qp_coeff1.ineq_mat_, qp_coeff1.ineq_vec_,
+                                              qp_coeff1.x_min_, qp_coeff1.x_max_));
+}
+
+TEST(TestQpSolverMemoize, Memoize)
+{
+  auto backend = std::make_shared<QpSolverUnconstrained>();
+  QpSolverCollection::QpSolverMemoize qp_solver(backend);
+
+  for(int i = 0; i < 3; i++)
+  {
+    for(int j = 0; j < 5; j++)
+    {
+      QpCoeff qp_coeff = makeQpCoeff(j);
+      Eigen::VectorXd x = qp_solver.solve(qp_coeff);
+      EXPECT_EQ(qp_solver.lastHit(), i > 0);
+      EXPECT_LT((x - (-qp_coeff.obj_mat_.ldlt().solve(qp_coeff.obj_vec_))).norm(), 1e-10);
+    }
+  }
+  EXPECT_EQ(backend->call_count_, 5);
+  EXPECT_EQ(qp_solver.cache()->hitCount(), 10);
+  EXPECT_EQ(qp_solver.cache()->missCount(), 5);
+
+  // Bounded capacity
+  auto cache = std::make_shared<QpSolverCollection::QpSolveMemoCache>(16);
+  QpSolverCollection::QpSolverMemoize qp_solver_bounded(backend, cache);
+  for(int j = 0; j < 100; j++)
+  {
+    QpCoeff qp_coeff = makeQpCoeff(j);
+    qp_solver_bounded.solve(qp_coeff);
+  }
+  EXPECT_LE(cache->size(), 16);
+}
+
+/** \brief QP solver that always returns zero, used to check that the solutions of other QP solvers are not returned.
+ */
+class QpSolverZero : public QpSolverUnconstrained
+{
+public:
+  using QpSolver::solve;
+
+  virtual Eigen::VectorXd solve(int dim_var,
+                                int,
+                                int,
+                                Eigen::Ref<Eigen::MatrixXd>,
+                                const Eigen::Ref<const Eigen::VectorXd> &,
+                                const Eigen::Ref<const Eigen::MatrixXd> &,
+                                const Eigen::Ref<const Eigen::VectorXd> &,
+                                const Eigen::Ref<const Eigen::MatrixXd> &,
+                                const Eigen::Ref<const Eigen::VectorXd> &,
+                                const Eigen::Ref<const Eigen::VectorXd> &,
+                                const Eigen::Ref<const Eigen::VectorXd> &) override
+  {
+    call_count_++;
+    solve_failed_ = false;
+    return Eigen::VectorXd::Zero(dim_var);
+  }
+};
+
+TEST(TestQpSolverMemoize, SolverKey)
+{
+  auto cache = std::make_shared<QpSolverCollection::QpSolveMemoCache>();
+  auto backend1 = std::make_shared<QpSolverUnconstrained>();
+  auto backend2 = std::make_shared<QpSolverZero>();
+  QpSolverCollection::QpSolverMemoize qp_solver1(backend1, cache);
+  QpSolverCollection::QpSolverMemoize qp_solver2(backend2, cache);
+  QpCoeff qp_coeff = makeQpCoeff(1.0);
+
+  // The solution of another backend is not returned
+  Eigen::VectorXd x1 = qp_solver1.solve(qp_coeff);
+  EXPECT_EQ(qp_solver1.iterNum(), 1);
+  EXPECT_TRUE(qp_solver2.solve(qp_coeff).isZero());
+  EXPECT_FALSE(qp_solver2.lastHit());
+  EXPECT_EQ(qp_solver1.solve(qp_coeff), x1);
+  EXPECT_TRUE(qp_solver1.lastHit());
+  EXPECT_EQ(qp_solver1.iterNum(), 0);
+  EXPECT_EQ(cache->size(), 2);
+
+  // The solution with other settings is not returned, while the entries of other instances are kept
+  QpSolverCollection::QpSolverMemoize qp_solver3(std::make_shared<QpSolverUnconstrained>(), cache);
+  QpSolverCollection::QpSolverSettings settings;
+  settings.max_iter_ = 10;
+  qp_solver3.setSettings(settings);
+  EXPECT_NE(qp_solver3.solverKey(), qp_solver1.solverKey());
+  qp_solver3.solve(qp_coeff);
+  EXPECT_FALSE(qp_solver3.lastHit());
+  EXPECT_EQ(cache->size(), 3);
+  qp_solver1.setSettings(settings);
+  EXPECT_EQ(cache->size(), 3);
+  EXPECT_EQ(qp_solver1.solve(qp_coeff), x1);
+  EXPECT_TRUE(qp_solver1.lastHit());
+  qp_solver2.solve(qp_coeff);
+  EXPECT_TRUE(qp_solver2.lastHit());
+  EXPECT_EQ(backend1->call_count_, 1);
+  EXPECT_EQ(backend2->call_count_, 1);
+
+  // Settings differing only in the low digits and settings changed directly on the backend are distinguished
+  size_t solver_key = qp_solver1.solverKey();
+  settings.abs_tol_ = 1e-8;
+  qp_solver1.setSettings(settings);
+  size_t solver_key_tol = qp_solver1.solverKey();
+  EXPECT_NE(solver_key_tol, solver_key);
+  settings.abs_tol_ = 1.0000001e-8;
+  qp_solver1.setSettings(settings);
+  EXPECT_NE(qp_solver1.solverKey(), solver_key_tol);
+  settings.params_["rho"] = 0.1;
+  backend1->setSettings(settings);
+  EXPECT_NE(qp_solver1.solverKey(), solver_key_tol);
+  qp_solver1.solve(qp_coeff);
+  EXPECT_FALSE(qp_solver1.lastHit());
+  EXPECT_EQ(backend1->call_count_, 2);
+  settings.params_["rho"] = 0.1000001;
+  backend1->setSettings(settings);
+  qp_solver1.solve(qp_coeff);
+  EXPECT_FALSE(qp_solver1.lastHit());
+  EXPECT_EQ(backend1->call_count_, 3);
+}
+
+TEST(TestQpSolverMemoize, SharedCache)
+{
+  auto cache = std::make_shared<QpSolverCollection::QpSolveMemoCache>();
+  constexpr int thread_num = 4;
+  std::vector<std::shared_ptr<QpSolverUnconstrained>> backend_list;
+  std::vector<std::thread> thread_list;
+  for(int i = 0; i < thread_num; i++)
+  {
+    backend_list.push_back(std::make_shared<QpSolverUnconstrained>());
+    thread_list.emplace_back([&, i]() {
+      QpSolverCollection::QpSolverMemoize qp_solver(backend_list[i], cache);
+      for(int j = 0; j < 100; j++)
+      {
+        QpCoeff qp_coeff = makeQpCoeff(j % 10);
+        qp_solver.solve(qp_coeff);
+      }
+    });
+  }
+  int solve_count = 0;
+  for(int i = 0; i < thread_num; i++)
+  {
+    thread_list[i].join();
+    solve_count += backend_list[i]->call_count_;
+  }
+  // Each QP is solved by the backend at least once, and at most once in each thread
+  EXPECT_GE(solve_count, 10);
+  EXPECT_LE(solve_count, 10 * thread_num);
+  EXPECT_EQ(cache->size(), 10);
+  EXPECT_EQ(cache->hitCount() + cache->missCount(), 100 * thread_num);
+}
+
+int main(int argc, char ** argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,256 @@
+/* Author: Masaki Murooka */
+
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+
+#include <gtest/gtest.h>
+
+#include <qp_solver_collection/QpSolverMetrics.h>
+
+#ifndef _WIN32
+#  include <arpa/inet.h>
+#  include <netinet/in.h>
+#  include <sys/socket.h>
+#  include <unistd.h>
+#endif
+
+using QpSolverCollection::QpMetricsRegistry;
+using QpSolverCollection::QpSolveStatus;
+using QpSolverCollection::QpSolverType;
+
+/** \brief QP solver that reports the given results to the metrics registry, used to test metrics independently of QP
+    solvers. */
+class QpSolverMock : public QpSolverCollection::QpSolver
+{
+public:
+  using QpSolver::solve;
+
+  QpSolverMock(QpSolverType type)
+  {
+    type_ = type;
+  }
+
+  virtual Eigen::VectorXd solve(int dim_var,
+                                int,
+                                int,
+                                Eigen::Ref<Eigen::MatrixXd>,
+                                const Eigen::Ref<const Eigen::VectorXd> &,
+                                const Eigen::Ref<const Eigen::MatrixXd> &,
+                                const Eigen::Ref<const Eigen::VectorXd> &,
+                                const Eigen::Ref<const Eigen::MatrixXd> &,
+                                const Eigen::Ref<const Eigen::VectorXd> &,
+                                const Eigen::Ref<const Eigen::VectorXd> &,
+                                const Eigen::Ref<const Eigen::VectorXd> &) override
+  {
+    QpSolverCollection::QpMetricsGuard metrics_guard(*this, dim_var);
+    iter_num_ = next_iter_num_;
+    status_ = next_status_;
+    solve_failed_ = (next_status_ != QpSolveStatus::Solved);
+    return Eigen::VectorXd::Zero(dim_var);
+  }
+
+  int next_iter_num_ = 5;
+  QpSolveStatus next_status_ = QpSolveStatus::Solved;
+};
+
+namespace
+{
+void solveMock(QpSolverMock & qp_solver, int dim_var)
+{
+  QpSolverCollection::QpCoeff qp_coeff;
+  qp_coeff.setup(dim_var, 0, 0);
+  qp_solver.solve(qp_coeff);
+}
+} // namespace
+
+TEST(TestQpSolverMetrics, Histogram)
+{
+  QpSolverCollection::QpMetricsHistogram hist(0, 4);
+  for(uint64_t value : {0, 1, 2, 3, 4, 5, 8, 9, 100})
+  {
+    hist.observe(value);
+  }
+  QpSolverCollection::QpMetricsHistogramSnapshot snapshot = hist.snapshot();
+  EXPECT_EQ(snapshot.upper_bound_list, std::vector<double>({1.0, 2.0, 4.0, 8.0}));
+  EXPECT_EQ(snapshot.bucket_count_list, std::vector<uint64_t>({2, 1, 2, 2, 2}));
+  EXPECT_EQ(snapshot.count, 9);
+  EXPECT_EQ(snapshot.sum, 132.0);
+
+  hist.reset();
+  EXPECT_EQ(hist.snapshot().count, 0);
+}
+
+TEST(TestQpSolverMetrics, Record)
+{
+  QpMetricsRegistry & registry = QpMetricsRegistry::instance();
+  registry.reset();
+  QpSolverMock qp_solver(QpSolverType::OSQP);
+
+  // Nothing is recorded while disabled
+  EXPECT_FALSE(registry.enabled());
+  solveMock(qp_solver, 10);
+  EXPECT_TRUE(registry.snapshot().empty());
+
+  registry.setEnabled(true);
+  solveMock(qp_solver, 10);
+  solveMock(qp_solver, 100);
+  qp_solver.next_iter_num_ = 1000;
+  qp_solver.next_status_ = QpSolveStatus::MaxIterReached;
+  solveMock(qp_solver, 10);
+  registry.setEnabled(false);
+
+  std::vector<QpSolverCollection::QpSolverMetricsSnapshot> snapshot_list = registry.snapshot();
+  ASSERT_EQ(snapshot_list.size(), 1);
+  const auto & snapshot = snapshot_list[0];
+  EXPECT_EQ(snapshot.qp_solver_type, QpSolverType::OSQP);
+  EXPECT_EQ(snapshot.solve_count, 3);
+  EXPECT_EQ(snapshot.failure_count, 1);
+  EXPECT_EQ(snapshot.latency.count, 3);
+  EXPECT_EQ(snapshot.iter.count, 3);
+  EXPECT_EQ(snapshot.iter.sum, 1010.0);
+  EXPECT_EQ(snapshot.dim_var.sum, 120.0);
+  auto statusCount = [&](QpSolveStatus status) {
+    return snapshot.status_count_list[static_cast<int>(status) - static_cast<int>(QpSolveStatus::Unsolved)];
+  };
+  EXPECT_EQ(statusCount(QpSolveStatus::Solved), 2);
+  EXPECT_EQ(statusCount(QpSolveStatus::MaxIterReached), 1);
+
+  registry.reset();
+  EXPECT_TRUE(registry.snapshot().empty());
+}
+
+TEST(TestQpSolverMetrics, Prometheus)
+{
+  QpMetricsRegistry & registry = QpMetricsRegistry::instance();
+  registry.reset();
+  registry.setEnabled(true);
+  QpSolverMock qp_solver(QpSolverType::HPIPM);
+  solveMock(qp_solver, 3);
+  qp_solver.next_status_ = QpSolveStatus::PrimalInfeasible;
+  solveMock(qp_solver, 3);
+  registry.setEnabled(false);
+
+  std::stringstream ss;
+  registry.writePrometheus(ss);
+  std::string text = ss.str();
+  EXPECT_NE(text.find("# TYPE qp_solver_solve_duration_seconds histogram"), std::string::npos) << text;
+  EXPECT_NE(text.find("qp_solver_solve_duration_seconds_count{solver=\"HPIPM\"} 2"), std::string::npos) << text;
+  EXPECT_NE(text.find("qp_solver_dim_var_bucket{solver=\"HPIPM\",le=\"4\"} 2"), std::string::npos) << text;
+  EXPECT_NE(text.find("qp_solver_solves_total{solver=\"HPIPM\",status=\"Solved\"} 1"), std::string::npos) << text;
+  EXPECT_NE(text.find("qp_solver_solves_total{solver=\"HPIPM\",status=\"PrimalInfeasible\"} 1"), std::string::npos)
+      << text;
+  EXPECT_NE(text.find("qp_solver_failures_total{solver=\"HPIPM\"} 1"), std::string::npos) << text;
+
+  // Write to file
+  std::string path = testing::TempDir() + "qp_solver_metrics.prom";
+  EXPECT_TRUE(registry.writePrometheus(path));
+  std::ifstream ifs(path);
+  std::stringstream ss_file;
+  ss_file << ifs.rdbuf();
+  EXPECT_EQ(ss_file.str(), text);
+  std::remove(path.c_str());
+
+  registry.reset();
+}
+
+TEST(TestQpSolverMetrics, RecordCost)
+{
+  QpMetricsRegistry & registry = QpMetricsRegistry::instance();
+  registry.reset();
+
+  constexpr int record_num = 100000;
+  auto start_time = std::chrono::steady_clock::now();
+  for(int i = 0; i < record_num; i++)
+  {
+    registry.record(QpSolverType::QLD, static_cast<uint64_t>(i), i % 100, 10, QpSolveStatus::Solved, false);
+  }
+  double duration =
+      std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start_time).count() / record_num;
+  std::cout << "[TestQpSolverMetrics] Cost of recording: " << duration << " [ns]" << std::endl;
+  EXPECT_EQ(registry.snapshot()[0].solve_count, record_num);
+
+  registry.reset();
+}
+
+TEST(TestQpSolverMetrics, MultiThread)
+{
+  QpMetricsRegistry & registry = QpMetricsRegistry::instance();
+  registry.reset();
+
+  // Counts are not lost with concurrent recording, and are kept after the threads exit
+  constexpr int thread_num = 4;
+  constexpr int record_num = 10000;
+  for(int trial = 0; trial < 2; trial++)
+  {
+    std::vector<std::thread> thread_list;
+    for(int i = 0; i < thread_num; i++)
+    {
+      thread_list.emplace_back([&]() {
+        for(int j = 0; j < record_num; j++)
+        {
+          registry.record(QpSolverType::JRLQP, 1000, 3, 10, QpSolveStatus::Solved, false);
+        }
+      });
+    }
+    for(auto & thread : thread_list)
+    {
+      thread.join();
+    }
+  }
+  std::vector<QpSolverCollection::QpSolverMetricsSnapshot> snapshot_list = registry.snapshot();
+  ASSERT_EQ(snapshot_list.size(), 1);
+  EXPECT_EQ(snapshot_list[0].solve_count, 2 * thread_num * record_num);
+  EXPECT_EQ(snapshot_list[0].iter.count, 2 * thread_num * record_num);
+  EXPECT_EQ(snapshot_list[0].iter.sum, 3.0 * 2 * thread_num * record_num);
+
+  registry.reset();
+}
+
+#ifndef _WIN32
+TEST(TestQpSolverMetrics, HttpExporter)
+{
+  QpMetricsRegistry & registry = QpMetricsRegistry::instance();
+  registry.reset();
+  registry.setEnabled(true);
+  QpSolverMock qp_solver(QpSolverType::QPMAD);
+  solveMock(qp_solver, 3);
+  registry.setEnabled(false);
+
+  QpSolverCollection::QpMetricsHttpExporter exporter(0);
+  ASSERT_GT(exporter.port(), 0);
+
+  int fd = socket(AF_INET, SOCK_STREAM, 0);
+  ASSERT_GE(fd, 0);
+  sockaddr_in addr = {};
+  addr.sin_family = AF_INET;
+  addr.sin_port = htons(static_cast<uint16_t>(exporter.port()));
+  inet_pton(AF_INET, "127.0.0.1", &addr.sin_addr);
+  ASSERT_EQ(connect(fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)), 0);
+  std::string request = "GET /metrics HTTP/1.1\r\nHost: localhost\r\n\r\n";
+  ASSERT_EQ(send(fd, request.data(), request.size(), 0), static_cast<ssize_t>(request.size()));
+  std::string response;
+  char buf[4096];
+  ssize_t recv_size;
+  while((recv_size = recv(fd, buf, sizeof(buf), 0)) > 0)
+  {
+    response.append(buf, static_cast<size_t>(recv_size));
+  }
+  close(fd);
+
+  EXPECT_EQ(response.rfind("HTTP/1.1 200 OK", 0), 0) << response;
+  EXPECT_NE(response.find("qp_solver_solves_total{solver=\"QPMAD\",status=\"Solved\"} 1"), std::string::npos)
+      << response;
+
+  registry.reset();
+}
+#endif
+
+int main(int argc, char ** argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,213 @@
+/* Author: Masaki Murooka */
+
+#include <gtest/gtest.h>
+
+#include <Eigen/Cholesky>
+
+#include <qp_solver_collection/QpSolverModeCache.h>
+
+using QpSolverCollection::QpCoeff;
+using QpSolverCollection::QpSolverType;
+
+/** \brief QP solver that records the warm start given in each solve, used to test the cache independently of QP
+    solvers. */
+class QpSolverWarmStartRecorder : public QpSolverCollection::QpSolver
+{
+public:
+  using QpSolver::solve;
+
+  QpSolverWarmStartRecorder()
+  {
+    type_ = QpSolverType::QLD;
+  }
+
+  virtual Eigen::VectorXd solve(int dim_var,
+                                int dim_eq,
+                                int dim_ineq,
+                                Eigen::Ref<Eigen::MatrixXd> Q,
+                                const Eigen::Ref<const Eigen::VectorXd> & c,
+                                const Eigen::Ref<const Eigen::MatrixXd> &,
+                                const Eigen::Ref<const Eigen::VectorXd> &,
+                                const Eigen::Ref<const Eigen::MatrixXd> &,
+                                const Eigen::Ref<const Eigen::VectorXd> &,
+                                const Eigen::Ref<const Eigen::VectorXd> &,
+                                const Eigen::Ref<const Eigen::VectorXd> &) override
+  {
+    warm_start_x_list_.push_back(warm_start_ ? warm_start_->x_ : Eigen::VectorXd());
+    solve_failed_ = false;
+    status_ = QpSolverCollection::QpSolveStatus::Solved;
+    dual_eq_.setZero(dim_eq);
+    dual_ineq_.setZero(dim_ineq);
+    dual_bound_.setZero(dim_var);
+    return -Q.ldlt().solve(c);
+  }
+
+  //! Primal variable of the warm start given in each solve (empty if not given)
+  std::vector<Eigen::VectorXd> warm_start_x_list_;
+};
+
+QpCoeff makeQpCoeff(int dim_var, int dim_eq, int dim_ineq)
+{
+  QpCoeff qp_coeff;
+  qp_coeff.setup(dim_var, dim_eq, dim_ineq);
+  qp_coeff.obj_mat_.setIdentity();
+  qp_coeff.obj_vec_.setConstant(1.0);
+  qp_coeff.eq_mat_.setConstant(1.0);
+  qp_coeff.eq_vec_.setConstant(1.0);
+  qp_coeff.ineq_mat_.setConstant(-1.0);
+  qp_coeff.ineq_vec_.setZero();
+  qp_coeff.x_min_.setConstant(-10.0);
+  qp_coeff.x_max_.setConstant(10.0);
+  return qp_coeff;
+}
+
+TEST(TestQpSolverModeCache, Signature)
+{
+  QpCoeff qp_coeff1 = makeQpCoeff(4, 1, 2);
+  QpCoeff qp_coeff2 = makeQpCoeff(4, 1, 2);
+  qp_coeff2.obj_mat_ *= 2.0;
+  qp_coeff2.ineq_mat_ *= 3.0;
+
+  auto signature1 =
+      QpSolverCollection::computeQpSignature(qp_coeff1.obj_mat_, qp_coeff1.eq_mat_, qp_coeff1.ineq_mat_);
+  auto signature2 =
+      QpSolverCollection::computeQpSignature(qp_coeff2.obj_mat_, qp_coeff2.eq_mat_, qp_coeff2.ineq_mat_);
+  // Only values are different
+  EXPECT_TRUE(signature1 == signature2);
+  EXPECT_EQ(QpSolverCollection::QpSignatureHash{}(signature1), QpSolverCollection::QpSignatureHash{}(signature2));
+
+  // Sparsity pattern is different
+  qp_coeff2.ineq_mat_(1, 2) = 0.0;
+  auto signature3 =
+      QpSolverCollection::computeQpSignature(qp_coeff2.obj_mat_, qp_coeff2.eq_mat_, qp_coeff2.ineq_mat_);
+  EXPECT_FALSE(signature1 == signature3);
+  EXPECT_TRUE(
+      QpSolverCollection::computeQpSignature(qp_coeff1.obj_mat_, qp_coeff1.eq_mat_, qp_coeff1.ineq_mat_, 0, false)
+      == QpSolverCollection::computeQpSignature(qp_coeff2.obj_mat_, qp_coeff2.eq_mat_, qp_coeff2.ineq_mat_, 0, false));
+
+  // Mode tag is different
+  auto signature4 =
+      QpSolverCollection::computeQpSignature(qp_coeff1.obj_mat_, qp_coeff1.eq_mat_, qp_coeff1.ineq_mat_, 1);
+  EXPECT_FALSE(signature1 == signature4);
+
+  // Dimension is different
+  QpCoeff qp_coeff5 = makeQpCoeff(4, 1, 3);
+  auto signature5 =
+      QpSolverCollection::computeQpSignature(qp_coeff5.obj_mat_, qp_coeff5.eq_mat_, qp_coeff5.ineq_mat_);
+  EXPECT_FALSE(signature1 == signature5);
+}
+
+TEST(TestQpSolverModeCache, ModeSwitch)
+{
+  // clang-format off
+  const std::vector<QpSolverType> qp_solver_type_list = {
+      QpSolverType::QLD,
+      QpSolverType::QuadProg,
+      QpSolverType::LSSOL,
+      QpSolverType::JRLQP,
+      QpSolverType::qpOASES,
+      QpSolverType::OSQP,
+      QpSolverType::NASOQ,
+      QpSolverType::HPIPM,
+      QpSolverType::PROXQP,
+      QpSolverType::QPMAD,
+      QpSolverType::Builtin
+  };
+  // clang-format on
+  for(const auto & qp_solver_type : qp_solver_type_list)
+  {
+    if(!QpSolverCollection::isQpSolverEnabled(qp_solver_type))
+    {
+      continue;
+    }
+
+    QpSolverCollection::QpSolverModeCache qp_solver(qp_solver_type, 2);
+    EXPECT_EQ(qp_solver.type(), qp_solver_type);
+
+    std::vector<QpCoeff> qp_coeff_list = {makeQpCoeff(4, 1, 2), makeQpCoeff(4, 1, 2), makeQpCoeff(3, 0, 1)};
+    for(int i = 0; i < 3; i++)
+    {
+      for(size_t mode = 0; mode < qp_coeff_list.size(); mode++)
+      {
+        qp_solver.mode_tag_ = mode;
+        QpCoeff qp_coeff = qp_coeff_list[mode];
+        Eigen::VectorXd x_opt = qp_solver.solve(qp_coeff);
+        EXPECT_EQ(x_opt.size(), qp_coeff.dim_var_);
+        EXPECT_LE(qp_solver.size(), 2);
+      }
+    }
+    // The cache capacity is smaller than the number of modes, so that every solve misses the cache
+    EXPECT_EQ(qp_solver.hitCount(), 0);
+    EXPECT_EQ(qp_solver.missCount(), 9);
+
+    qp_solver.setCapacity(3);
+    qp_solver.clear();
+    for(int i = 0; i < 3; i++)
+    {
+      for(size_t mode = 0; mode < qp_coeff_list.size(); mode++)
+      {
+        qp_solver.mode_tag_ = mode;
+        QpCoeff qp_coeff = qp_coeff_list[mode];
+        qp_solver.solve(qp_coeff);
+      }
+    }
+    EXPECT_EQ(qp_solver.hitCount(), 6);
+    EXPECT_EQ(qp_solver.missCount(), 3);
+  }
+}
+
+TEST(TestQpSolverModeCache, RestoreSolution)
+{
+  std::vector<std::shared_ptr<QpSolverWarmStartRecorder>> backend_list;
+  QpSolverCollection::QpSolverModeCache qp_solver([&]() {
+    backend_list.push_back(std::make_shared<QpSolverWarmStartRecorder>());
+    return backend_list.back();
+  });
+  EXPECT_EQ(qp_solver.type(), QpSolverType::Uninitialized);
+
+  // Alternate two modes with different solutions
+  std::vector<QpCoeff> qp_coeff_list = {makeQpCoeff(4, 1, 2), makeQpCoeff(4, 1, 2)};
+  qp_coeff_list[1].obj_vec_.setConstant(-2.0);
+  std::vector<Eigen::VectorXd> x_list(2);
+  for(int i = 0; i < 3; i++)
+  {
+    for(size_t mode = 0; mode < qp_coeff_list.size(); mode++)
+    {
+      qp_solver.mode_tag_ = mode;
+      QpCoeff qp_coeff = qp_coeff_list[mode];
+      x_list[mode] = qp_solver.solve(qp_coeff);
+    }
+  }
+  EXPECT_EQ(qp_solver.type(), QpSolverType::QLD);
+  ASSERT_EQ(backend_list.size(), 2);
+  EXPECT_NE(x_list[0], x_list[1]);
+
+  // Each backend is warm-started from the last solution of its own mode, not from that of the other mode
+  for(size_t mode = 0; mode < backend_list.size(); mode++)
+  {
+    const auto & warm_start_x_list = backend_list[mode]->warm_start_x_list_;
+    ASSERT_EQ(warm_start_x_list.size(), 3);
+    EXPECT_EQ(warm_start_x_list[0].size(), 0);
+    EXPECT_EQ(warm_start_x_list[1], x_list[mode]);
+    EXPECT_EQ(warm_start_x_list[2], x_list[mode]);
+  }
+
+  // The warm start given explicitly takes precedence
+  qp_solver.mode_tag_ = 0;
+  QpCoeff qp_coeff = qp_coeff_list[0];
+  Eigen::VectorXd x_given = Eigen::VectorXd::Constant(4, 3.0);
+  qp_solver.solve(qp_coeff, QpSolverCollection::WarmStart(x_given));
+  EXPECT_EQ(backend_list[0]->warm_start_x_list_.back(), x_given);
+
+  // The stored solution is not passed if disabled
+  qp_solver.restore_solution_ = false;
+  qp_coeff = qp_coeff_list[0];
+  qp_solver.solve(qp_coeff);
+  EXPECT_EQ(backend_list[0]->warm_start_x_list_.back().size(), 0);
+}
+
+int main(int argc, char ** argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,153 @@
+/* Author: Masaki Murooka */
+
+#include <gtest/gtest.h>
+
+#include <qp_solver_collection/QpSolverRegionCache.h>
+
+using QpSolverCollection::QpCoeff;
+using QpSolverCollection::QpSolverType;
+
+/** \brief QP solver for diagonal objective matrix and bounds, used to test the cache independently of QP solvers. */
+class QpSolverDiagonalBox : public QpSolverCollection::QpSolver
+{
+public:
+  using QpSolver::solve;
+
+  virtual Eigen::VectorXd solve(int,
+                                int,
+                                int,
+                                Eigen::Ref<Eigen::MatrixXd> Q,
+                                const Eigen::Ref<const Eigen::VectorXd> & c,
+                                const Eigen::Ref<const Eigen::MatrixXd> &,
+                                const Eigen::Ref<const Eigen::VectorXd> &,
+                                const Eigen::Ref<const Eigen::MatrixXd> &,
+                                const Eigen::Ref<const Eigen::VectorXd> &,
+                                const Eigen::Ref<const Eigen::VectorXd> & x_min,
+                                const Eigen::Ref<const Eigen::VectorXd> & x_max) override
+  {
+    call_count_++;
+    solve_failed_ = false;
+    iter_num_ = 1;
+    return (-c.cwiseQuotient(Q.diagonal())).cwiseMax(x_min).cwiseMin(x_max);
+  }
+
+  int call_count_ = 0;
+};
+
+TEST(TestQpSolverRegionCache, DiagonalBox)
+{
+  auto backend = std::make_shared<QpSolverDiagonalBox>();
+  QpSolverCollection::QpSolverRegionCache qp_solver(backend);
+
+  QpCoeff qp_coeff;
+  qp_coeff.setup(2, 0, 0);
+  qp_coeff.obj_mat_.diagonal() << 1.0, 2.0;
+  qp_coeff.x_min_.setConstant(-1.0);
+  qp_coeff.x_max_.setConstant(1.0);
+
+  // The vectors move over the 9 regions (each variable is at the lower bound, inactive, or at the upper bound)
+  for(int i = 0; i < 200; i++)
+  {
+    double t = 0.1 * i;
+    qp_coeff.obj_vec_ << 2.0 * std::sin(t), 3.0 * std::cos(0.7 * t);
+    QpCoeff qp_coeff_copied = qp_coeff;
+    Eigen::VectorXd x_gt = QpSolverDiagonalBox().solve(qp_coeff_copied);
+    size_t miss_count = qp_solver.missCount();
+    Eigen::VectorXd x = qp_solver.solve(qp_coeff);
+    EXPECT_FALSE(qp_solver.solveFailed());
+    EXPECT_LT((x - x_gt).norm(), 1e-10);
+
+    // The number of iterations is zero on cache hits, not that of the previous miss
+    EXPECT_EQ(qp_solver.iterNum(), static_cast<int>(qp_solver.missCount() - miss_count));
+
+    // Lagrange multipliers follow the sign convention of SolveResult
+    QpSolverCollection::SolveResult result;
+    result.x_ = x;
+    result.dual_eq_ = qp_solver.dualEq();
+    result.dual_ineq_ = qp_solver.dualIneq();
+    result.dual_bound_ = qp_solver.dualBound();
+    if(result.hasDual())
+    {
+      EXPECT_TRUE(QpSolverCollection::computeKkt(qp_coeff, result).satisfied(1e-8));
+    }
+  }
+  EXPECT_LE(qp_solver.regionNum(), 9);
+  EXPECT_EQ(qp_solver.missCount(), backend->call_count_);
+  EXPECT_EQ(qp_solver.hitCount() + qp_solver.missCount(), 200);
+  EXPECT_GT(qp_solver.hitRate(), 0.9);
+
+  // Cache is cleared when the matrices change
+  qp_coeff.obj_mat_(0, 0) = 3.0;
+  qp_solver.solve(qp_coeff);
+  EXPECT_EQ(qp_solver.regionNum(), 1);
+
+  // Memory limit
+  qp_solver.memory_limit_ = qp_solver.cacheMemoryUsage();
+  for(int i = 0; i < 50; i++)
+  {
+    double t = 0.1 * i;
+    qp_coeff.obj_vec_ << 2.0 * std::sin(t), 3.0 * std::cos(0.7 * t);
+    qp_solver.solve(qp_coeff);
+    EXPECT_LE(qp_solver.cacheMemoryUsage(), qp_solver.memory_limit_);
+  }
+}
+
+TEST(TestQpSolverRegionCache, ParametricQP)
+{
+  // clang-format off
+  const std::vector<QpSolverType> qp_solver_type_list = {
+      QpSolverType::QLD,
+      QpSolverType::QuadProg,
+      QpSolverType::LSSOL,
+      QpSolverType::JRLQP,
+      QpSolverType::qpOASES,
+      QpSolverType::OSQP,
+      QpSolverType::NASOQ,
+      QpSolverType::HPIPM,
+      QpSolverType::PROXQP,
+      QpSolverType::QPMAD,
+      QpSolverType::Builtin
+  };
+  // clang-format on
+  for(const auto & qp_solver_type : qp_solver_type_list)
+  {
+    if(!QpSolverCollection::isQpSolverEnabled(qp_solver_type))
+    {
+      continue;
+    }
+
+    QpSolverCollection::QpSolverRegionCache qp_solver(qp_solver_type);
+    auto qp_solver_ref = QpSolverCollection::allocateQpSolver(qp_solver_type);
+
+    // Parametric QP whose objective vector and inequality constraint vector vary
+    QpCoeff qp_coeff;
+    qp_coeff.setup(3, 1, 2);
+    qp_coeff.obj_mat_ << 2.0, 0.5, 0.0, 0.5, 1.0, 0.0, 0.0, 0.0, 1.0;
+    qp_coeff.eq_mat_ << 1.0, 1.0, 1.0;
+    qp_coeff.eq_vec_ << 1.0;
+    qp_coeff.ineq_mat_ << 1.0, -1.0, 0.0, 0.0, 1.0, 1.0;
+    qp_coeff.x_min_.setConstant(-2.0);
+    qp_coeff.x_max_.setConstant(2.0);
+
+    for(int i = 0; i < 100; i++)
+    {
+      double t = 0.2 * i;
+      qp_coeff.obj_vec_ << std::sin(t), std::cos(t), 0.5 * std::sin(2.0 * t);
+      qp_coeff.ineq_vec_ << 0.5 + 0.3 * std::cos(t), 0.8;
+      QpCoeff qp_coeff_copied = qp_coeff;
+      Eigen::VectorXd x_ref = qp_solver_ref->solve(qp_coeff_copied);
+      qp_coeff_copied = qp_coeff;
+      Eigen::VectorXd x = qp_solver.solve(qp_coeff_copied);
+      EXPECT_FALSE(qp_solver.solveFailed());
+      double thre = (qp_solver_type == QpSolverType::OSQP || qp_solver_type == QpSolverType::PROXQP) ? 1e-3 : 1e-6;
+      EXPECT_LT((x - x_ref).norm(), thre) << "Solution of " << std::to_string(qp_solver_type) << " is incorrect.";
+    }
+    EXPECT_GT(qp_solver.hitCount(), 0);
+  }
+}
+
+int main(int argc, char ** argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
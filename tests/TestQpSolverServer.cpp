@@ -0,0 +1,214 @@
+/* Author: Masaki Murooka */
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <memory>
+#include <thread>
+
+#include <gtest/gtest.h>
+
+#include <qp_solver_collection/QpSolverServer.h>
+
+using QpSolverCollection::QpCoeff;
+using QpSolverCollection::QpSolverType;
+
+QpCoeff makeQpCoeff(double offset)
+{
+  // Same as TestSampleQP1 except for the offset of the objective vector
+  QpCoeff qp_coeff;
+  qp_coeff.setup(2, 1, 0);
+  qp_coeff.obj_mat_ << 2.0, 0.5, 0.5, 1.0;
+  qp_coeff.obj_vec_ << 1.0 + offset, 1.0;
+  qp_coeff.eq_mat_ << 1.0, 1.0;
+  qp_coeff.eq_vec_ << 1.0;
+  qp_coeff.x_min_.setZero();
+  qp_coeff.x_max_.setConstant(1000.0);
+  return qp_coeff;
+}
+
+TEST(TestQpSolverServer, ServerClient)
+{
+  // clang-format off
+  const std::vector<QpSolverType> qp_solver_type_list = {
+      QpSolverType::QLD,
+      QpSolverType::QuadProg,
+      QpSolverType::LSSOL,
+      QpSolverType::JRLQP,
+      QpSolverType::qpOASES,
+      QpSolverType::OSQP,
+      QpSolverType::NASOQ,
+      QpSolverType::HPIPM,
+      QpSolverType::PROXQP,
+      QpSolverType::QPMAD,
+      QpSolverType::Builtin
+  };
+  // clang-format on
+  for(const auto & qp_solver_type : qp_solver_type_list)
+  {
+    if(!QpSolverCollection::isQpSolverEnabled(qp_solver_type))
+    {
+      continue;
+    }
+
+    const std::string name = "/TestQpSolverServer";
+    QpSolverCollection::QpShmConfig config;
+    config.max_dim_var = 4;
+    config.max_dim_eq = 2;
+    config.max_dim_ineq = 2;
+    config.slot_num = 4;
+    QpSolverCollection::QpSolverServer server(name, qp_solver_type, config, 2);
+    server.start();
+
+    QpSolverCollection::QpSolverClient client(name);
+    EXPECT_EQ(client.type(), qp_solver_type);
+
+    // Solve via the interface of QpSolver
+    QpCoeff qp_coeff = makeQpCoeff(0.0);
+    auto local_solver = QpSolverCollection::allocateQpSolver(qp_solver_type);
+    QpCoeff qp_coeff_copied = qp_coeff;
+    Eigen::VectorXd x_local = local_solver->solve(qp_coeff_copied);
+    Eigen::VectorXd x_remote = client.solve(qp_coeff);
+    EXPECT_FALSE(client.solveFailed());
+    EXPECT_LT((x_remote - x_local).norm(), 1e-10);
+
+    // Lagrange multipliers are transferred from the server
+    EXPECT_EQ(client.dualEq().size(), local_solver->dualEq().size());
+    if(local_solver->dualEq().size() > 0)
+    {
+      EXPECT_LT((client.dualEq() - local_solver->dualEq()).norm(), 1e-10);
+      EXPECT_LT((client.dualBound() - local_solver->dualBound()).norm(), 1e-10);
+      QpSolverCollection::SolveResult result;
+      result.x_ = x_remote;
+      result.dual_eq_ = client.dualEq();
+      result.dual_ineq_ = client.dualIneq();
+      result.dual_bound_ = client.dualBound();
+      EXPECT_TRUE(QpSolverCollection::computeKkt(makeQpCoeff(0.0), result).satisfied(1e-6));
+    }
+
+    // Solve by writing coefficients directly into the shared memory
+    QpSolverCollection::QpShmRequest request = client.acquire(2, 1, 0);
+    request.obj_mat_ << 2.0, 0.5, 0.5, 1.0;
+    request.obj_vec_ << 1.0, 1.0;
+    request.eq_mat_ << 1.0, 1.0;
+    request.eq_vec_ << 1.0;
+    request.x_min_.setZero();
+    request.x_max_.setConstant(1000.0);
+    client.submit(request);
+    EXPECT_TRUE(client.wait(request));
+    EXPECT_FALSE(client.requestFailed(request));
+    EXPECT_LT((request.x_ - x_local).norm(), 1e-10);
+    if(client.requestHasDual(request))
+    {
+      EXPECT_LT((request.dual_eq_ - local_solver->dualEq()).norm(), 1e-10);
+    }
+    client.release(request);
+
+    // Solve from multiple clients concurrently
+    constexpr int client_num = 4;
+    constexpr int solve_num = 50;
+    std::vector<std::thread> thread_list;
+    std::vector<double> max_error_list(client_num, 0.0);
+    for(int i = 0; i < client_num; i++)
+    {
+      thread_list.emplace_back([&, i]() {
+        QpSolverCollection::QpSolverClient thread_client(name);
+        auto thread_local_solver = QpSolverCollection::allocateQpSolver(qp_solver_type);
+        for(int j = 0; j < solve_num; j++)
+        {
+          QpCoeff thread_qp_coeff = makeQpCoeff(0.01 * (i * solve_num + j));
+          QpCoeff thread_qp_coeff_copied = thread_qp_coeff;
+          Eigen::VectorXd x_expected = thread_local_solver->solve(thread_qp_coeff_copied);
+          Eigen::VectorXd x = thread_client.solve(thread_qp_coeff);
+          max_error_list[i] = std::max(max_error_list[i], (x - x_expected).norm());
+        }
+      });
+    }
+    for(auto & thread : thread_list)
+    {
+      thread.join();
+    }
+    for(int i = 0; i < client_num; i++)
+    {
+      EXPECT_LT(max_error_list[i], 1e-10);
+    }
+    EXPECT_EQ(server.solvedCount(), 2 + client_num * solve_num);
+
+    // Dimensions exceed the maximum dimensions
+    EXPECT_THROW(client.acquire(5, 0, 0), std::runtime_error);
+  }
+}
+
+TEST(TestQpSolverServer, ExistingName)
+{
+  const std::string name = "/TestQpSolverServerExisting";
+  QpSolverCollection::QpShmConfig config;
+  config.max_dim_var = 2;
+  config.max_dim_eq = 1;
+  config.max_dim_ineq = 0;
+  config.remove_existing = true;
+  auto server = std::make_unique<QpSolverCollection::QpSolverServer>(name, QpSolverType::Builtin, config);
+
+  // The shared memory of a running server is not taken over silently
+  config.remove_existing = false;
+  EXPECT_THROW(QpSolverCollection::QpSolverServer(name, QpSolverType::Builtin, config), std::runtime_error);
+  server->start();
+  QpSolverCollection::QpSolverClient client(name);
+  QpCoeff qp_coeff = makeQpCoeff(0.0);
+  client.solve(qp_coeff);
+  EXPECT_FALSE(client.solveFailed());
+
+  // The stale one left by a crashed server is removed only if requested explicitly
+  server.reset();
+  int fd = shm_open(name.c_str(), O_CREAT | O_RDWR, 0600);
+  ASSERT_GE(fd, 0);
+  close(fd);
+  config.remove_existing = false;
+  EXPECT_THROW(QpSolverCollection::QpSolverServer(name, QpSolverType::Builtin, config), std::runtime_error);
+  config.remove_existing = true;
+  EXPECT_NO_THROW(QpSolverCollection::QpSolverServer(name, QpSolverType::Builtin, config));
+}
+
+TEST(TestQpSolverServer, Timeout)
+{
+  const std::string name = "/TestQpSolverServerTimeout";
+  QpSolverCollection::QpShmConfig config;
+  config.max_dim_var = 2;
+  config.max_dim_eq = 1;
+  config.max_dim_ineq = 0;
+  config.slot_num = 2;
+  config.remove_existing = true;
+  QpSolverCollection::QpSolverServer server(name, QpSolverType::Builtin, config);
+  QpSolverCollection::QpSolverClient client(name);
+  client.timeout_ = 0.01;
+
+  // All the slots are abandoned since the server is not running
+  QpCoeff qp_coeff = makeQpCoeff(0.0);
+  for(int i = 0; i < config.slot_num; i++)
+  {
+    client.solve(qp_coeff);
+    EXPECT_TRUE(client.solveFailed());
+  }
+  EXPECT_THROW(client.acquire(2, 1, 0), std::runtime_error);
+
+  // The abandoned slots are reclaimed by the server
+  server.start();
+  client.timeout_ = 1.0;
+  for(int i = 0; i < 2 * config.slot_num; i++)
+  {
+    client.solve(qp_coeff);
+    EXPECT_FALSE(client.solveFailed());
+  }
+}
+
+TEST(TestQpSolverServer, OpenFailure)
+{
+  EXPECT_THROW(QpSolverCollection::QpSolverClient("/TestQpSolverServerNonexistent"), std::runtime_error);
+}
+
+int main(int argc, char ** argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
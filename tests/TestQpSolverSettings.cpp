@@ -0,0 +1,127 @@
+/* Author: Masaki Murooka */
+
+#include <cstdio>
+#include <fstream>
+#include <limits>
+
+#include <gtest/gtest.h>
+
+#include <qp_solver_collection/QpSolverCollection.h>
+
+using QpSolverCollection::QpAccuracyProfile;
+using QpSolverCollection::QpCoeff;
+using QpSolverCollection::QpSolverSettings;
+using QpSolverCollection::QpSolverType;
+
+TEST(TestQpSolverSettings, ByProfile)
+{
+  QpSolverSettings settings;
+  EXPECT_EQ(settings.absTol(1e-2, 1e-3, 1e-5), 1e-3);
+  settings.profile_ = QpAccuracyProfile::Fast;
+  EXPECT_EQ(settings.absTol(1e-2, 1e-3, 1e-5), 1e-2);
+  settings.profile_ = QpAccuracyProfile::Robust;
+  EXPECT_EQ(settings.absTol(1e-2, 1e-3, 1e-5), 1e-5);
+  EXPECT_EQ(settings.maxIter(10, 20, 30), 30);
+  settings.abs_tol_ = 1e-7;
+  settings.max_iter_ = 100;
+  EXPECT_EQ(settings.absTol(1e-2, 1e-3, 1e-5), 1e-7);
+  EXPECT_EQ(settings.maxIter(10, 20, 30), 100);
+
+  double value = 0;
+  EXPECT_FALSE(settings.param("rho", value));
+  settings.params_["rho"] = 0.1;
+  EXPECT_TRUE(settings.param("rho", value));
+  EXPECT_EQ(value, 0.1);
+}
+
+TEST(TestQpSolverSettings, SettingsProfile)
+{
+  std::map<QpSolverType, QpSolverSettings> settings_profile;
+  settings_profile[QpSolverType::OSQP].profile_ = QpAccuracyProfile::Robust;
+  settings_profile[QpSolverType::OSQP].abs_tol_ = 1e-6;
+  settings_profile[QpSolverType::OSQP].params_["rho"] = 0.01;
+  settings_profile[QpSolverType::OSQP].params_["alpha"] = 1.6;
+  settings_profile[QpSolverType::HPIPM].profile_ = QpAccuracyProfile::Fast;
+  settings_profile[QpSolverType::HPIPM].max_iter_ = 30;
+  settings_profile[QpSolverType::HPIPM].verbose_ = true;
+  settings_profile[QpSolverType::HPIPM].reuse_obj_mat_factor_ = false;
+  settings_profile[QpSolverType::HPIPM].warm_start_by_id_ = false;
+
+  const std::string path = "/tmp/TestQpSolverSettingsProfile.txt";
+  QpSolverCollection::saveSettingsProfile(path, settings_profile);
+  auto loaded_profile = QpSolverCollection::loadSettingsProfile(path);
+  std::remove(path.c_str());
+
+  ASSERT_EQ(loaded_profile.size(), 2);
+  const auto & osqp_settings = loaded_profile.at(QpSolverType::OSQP);
+  EXPECT_EQ(osqp_settings.profile_, QpAccuracyProfile::Robust);
+  EXPECT_EQ(osqp_settings.abs_tol_, 1e-6);
+  EXPECT_EQ(osqp_settings.params_, settings_profile[QpSolverType::OSQP].params_);
+  const auto & hpipm_settings = loaded_profile.at(QpSolverType::HPIPM);
+  EXPECT_EQ(hpipm_settings.profile_, QpAccuracyProfile::Fast);
+  EXPECT_EQ(hpipm_settings.max_iter_, 30);
+  EXPECT_TRUE(hpipm_settings.verbose_);
+  EXPECT_FALSE(hpipm_settings.reuse_obj_mat_factor_);
+  EXPECT_TRUE(osqp_settings.reuse_obj_mat_factor_);
+  EXPECT_FALSE(hpipm_settings.warm_start_by_id_);
+  EXPECT_TRUE(osqp_settings.warm_start_by_id_);
+  EXPECT_TRUE(hpipm_settings.params_.empty());
+}
+
+TEST(TestQpSolverSettings, DumpAndLoadQpCoeff)
+{
+  std::vector<QpCoeff> qp_coeff_list(2);
+  qp_coeff_list[0].setup(3, 1, 2);
+  qp_coeff_list[0].obj_mat_.setRandom();
+  qp_coeff_list[0].obj_vec_.setRandom();
+  qp_coeff_list[0].eq_mat_.setRandom();
+  qp_coeff_list[0].eq_vec_.setRandom();
+  qp_coeff_list[0].ineq_mat_.setRandom();
+  qp_coeff_list[0].ineq_vec_.setRandom();
+  qp_coeff_list[0].x_min_ << -1.0, -std::numeric_limits<double>::infinity(), std::numeric_limits<double>::lowest();
+  qp_coeff_list[1].setup(2, 0, 0);
+  qp_coeff_list[1].obj_mat_.setIdentity();
+
+  const std::string path = "/tmp/TestQpSolverSettingsQpCoeff.txt";
+  {
+    std::ofstream ofs(path);
+    for(const auto & qp_coeff : qp_coeff_list)
+    {
+      qp_coeff.dump(ofs);
+    }
+  }
+  std::vector<QpCoeff> loaded_list;
+  {
+    std::ifstream ifs(path);
+    QpCoeff qp_coeff;
+    while(qp_coeff.load(ifs))
+    {
+      loaded_list.push_back(qp_coeff);
+    }
+  }
+  std::remove(path.c_str());
+
+  ASSERT_EQ(loaded_list.size(), qp_coeff_list.size());
+  for(size_t i = 0; i < qp_coeff_list.size(); i++)
+  {
+    const QpCoeff & expected = qp_coeff_list[i];
+    const QpCoeff & actual = loaded_list[i];
+    EXPECT_EQ(actual.dim_var_, expected.dim_var_);
+    EXPECT_EQ(actual.dim_eq_, expected.dim_eq_);
+    EXPECT_EQ(actual.dim_ineq_, expected.dim_ineq_);
+    EXPECT_TRUE(actual.obj_mat_ == expected.obj_mat_);
+    EXPECT_TRUE(actual.obj_vec_ == expected.obj_vec_);
+    EXPECT_TRUE(actual.eq_mat_ == expected.eq_mat_);
+    EXPECT_TRUE(actual.eq_vec_ == expected.eq_vec_);
+    EXPECT_TRUE(actual.ineq_mat_ == expected.ineq_mat_);
+    EXPECT_TRUE(actual.ineq_vec_ == expected.ineq_vec_);
+    EXPECT_TRUE(actual.x_min_ == expected.x_min_);
+    EXPECT_TRUE(actual.x_max_ == expected.x_max_);
+  }
+}
+
+int main(int argc, char ** argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,142 @@
+/* Author: Masaki Murooka */
+
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+
+#include <gtest/gtest.h>
+
+#include <qp_solver_collection/QpSolverTrace.h>
+
+using QpSolverCollection::QpTraceEvent;
+using QpSolverCollection::QpTracer;
+
+namespace
+{
+std::vector<QpTraceEvent> eventsOf(const std::vector<QpTraceEvent> & event_list, const std::string & name)
+{
+  std::vector<QpTraceEvent> event_list_filtered;
+  for(const auto & event : event_list)
+  {
+    if(event.name == name)
+    {
+      event_list_filtered.push_back(event);
+    }
+  }
+  return event_list_filtered;
+}
+} // namespace
+
+TEST(TestQpSolverTrace, Scope)
+{
+  QpTracer & tracer = QpTracer::instance();
+  tracer.clear();
+
+  {
+    QpSolverCollection::QpTraceScope scope("solve");
+    scope.phase("stack");
+    std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    scope.phase("iterate");
+    std::this_thread::sleep_for(std::chrono::milliseconds(2));
+  }
+
+  std::vector<QpTraceEvent> event_list = tracer.events();
+  ASSERT_EQ(event_list.size(), 3);
+  QpTraceEvent solve_event = eventsOf(event_list, "solve").at(0);
+  QpTraceEvent stack_event = eventsOf(event_list, "stack").at(0);
+  QpTraceEvent iterate_event = eventsOf(event_list, "iterate").at(0);
+
+  // Phases are consecutive and nested in the scope
+  EXPECT_LE(solve_event.begin, stack_event.begin);
+  EXPECT_EQ(stack_event.begin + stack_event.duration, iterate_event.begin);
+  EXPECT_EQ(iterate_event.begin + iterate_event.duration, solve_event.begin + solve_event.duration);
+  EXPECT_GE(stack_event.duration, 2000000);
+  EXPECT_GE(iterate_event.duration, 2000000);
+
+  // Nothing is recorded while disabled
+  tracer.clear();
+  tracer.setEnabled(false);
+  {
+    QpSolverCollection::QpTraceScope scope("solve");
+    scope.phase("stack");
+  }
+  tracer.setEnabled(true);
+  EXPECT_TRUE(tracer.events().empty());
+}
+
+TEST(TestQpSolverTrace, RingBuffer)
+{
+  QpTracer & tracer = QpTracer::instance();
+  tracer.clear();
+  tracer.setBufferCapacity(16);
+
+  // The buffer of a new thread has the new capacity and keeps the latest events
+  std::thread thread([&]() {
+    for(int i = 0; i < 100; i++)
+    {
+      QpSolverCollection::QpTraceScope scope(i < 90 ? "old" : "new");
+    }
+  });
+  thread.join();
+  tracer.setBufferCapacity(8192);
+
+  // The oldest slot is discarded when the buffer is full since it may be being overwritten
+  std::vector<QpTraceEvent> event_list = tracer.events();
+  EXPECT_EQ(event_list.size(), 15);
+  EXPECT_EQ(eventsOf(event_list, "new").size(), 10);
+  for(size_t i = 1; i < event_list.size(); i++)
+  {
+    EXPECT_LE(event_list[i - 1].begin, event_list[i].begin);
+  }
+
+  tracer.clear();
+}
+
+TEST(TestQpSolverTrace, ChromeTrace)
+{
+  QpTracer & tracer = QpTracer::instance();
+  tracer.clear();
+  {
+    QpSolverCollection::QpTraceScope scope("QpSolver\"Quoted\"::solve");
+  }
+
+  std::stringstream ss;
+  tracer.writeChromeTrace(ss);
+  std::string json = ss.str();
+  EXPECT_EQ(json.rfind("{\"traceEvents\":[", 0), 0) << json;
+  EXPECT_NE(json.find("\"name\":\"QpSolver\\\"Quoted\\\"::solve\""), std::string::npos) << json;
+  EXPECT_NE(json.find("\"ph\":\"X\""), std::string::npos) << json;
+  EXPECT_NE(json.find("\"dur\":"), std::string::npos) << json;
+
+  std::string path = testing::TempDir() + "qp_solver_trace.json";
+  EXPECT_TRUE(tracer.writeChromeTrace(path));
+  std::ifstream ifs(path);
+  std::stringstream ss_file;
+  ss_file << ifs.rdbuf();
+  EXPECT_EQ(ss_file.str(), json);
+  std::remove(path.c_str());
+
+  tracer.clear();
+}
+
+#if ENABLE_TRACING
+TEST(TestQpSolverTrace, Macro)
+{
+  QpTracer & tracer = QpTracer::instance();
+  tracer.clear();
+  {
+    QSC_TRACE_SCOPE("scope");
+    QSC_TRACE_PHASE("phase");
+  }
+  EXPECT_EQ(tracer.events().size(), 2);
+  tracer.clear();
+}
+#endif
+
+int main(int argc, char ** argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,219 @@
+/* Author: Masaki Murooka */
+
+#include <stdexcept>
+
+#include <gtest/gtest.h>
+
+#include <qp_solver_collection/QpSolverMemoize.h>
+
+using QpSolverCollection::QpCoeff;
+using QpSolverCollection::WarmStart;
+
+/** \brief QP solver that returns the primal variable of the initial guess, used to check that it is passed. */
+class QpSolverWarmStartEcho : public QpSolverCollection::QpSolver
+{
+public:
+  using QpSolver::solve;
+
+  virtual Eigen::VectorXd solve(int dim_var,
+                                int dim_eq,
+                                int dim_ineq,
+                                Eigen::Ref<Eigen::MatrixXd>,
+                                const Eigen::Ref<const Eigen::VectorXd> &,
+                                const Eigen::Ref<const Eigen::MatrixXd> &,
+                                const Eigen::Ref<const Eigen::VectorXd> &,
+                                const Eigen::Ref<const Eigen::MatrixXd> &,
+                                const Eigen::Ref<const Eigen::VectorXd> &,
+                                const Eigen::Ref<const Eigen::VectorXd> &,
+                                const Eigen::Ref<const Eigen::VectorXd> &) override
+  {
+    setLastDimension(dim_var, dim_eq, dim_ineq);
+    if(throw_)
+    {
+      throw std::runtime_error("[QpSolverWarmStartEcho::solve] Exception for test.");
+    }
+    solve_failed_ = false;
+    if(!warm_start_)
+    {
+      dual_eq_.setZero(dim_eq);
+      dual_ineq_.setZero(dim_ineq);
+      dual_bound_.setZero(dim_var);
+      return Eigen::VectorXd::Zero(dim_var);
+    }
+    Eigen::VectorXd dual = warm_start_->stackedDual(dim_var, dim_eq, dim_ineq);
+    dual_eq_ = dual.head(dim_eq);
+    dual_ineq_ = dual.segment(dim_eq, dim_ineq);
+    dual_bound_ = dual.tail(dim_var);
+    return warm_start_->x_;
+  }
+
+  //! Whether to make the solve throw an exception
+  bool throw_ = false;
+};
+
+TEST(TestQpSolverWarmStart, PassToSolver)
+{
+  QpCoeff qp_coeff;
+  qp_coeff.setup(3, 1, 2);
+  QpSolverWarmStartEcho qp_solver;
+
+  // Empty Lagrange multipliers are regarded as zero
+  WarmStart warm_start{Eigen::Vector3d(1.0, 2.0, 3.0), Eigen::VectorXd(), Eigen::Vector2d(0.5, 0.0)};
+  EXPECT_TRUE(warm_start.hasDual());
+  EXPECT_FALSE(WarmStart(Eigen::Vector3d::Zero()).hasDual());
+  Eigen::VectorXd dual = warm_start.stackedDual(3, 1, 2);
+  ASSERT_EQ(dual.size(), 6);
+  EXPECT_EQ(dual[1], 0.5);
+  EXPECT_EQ(dual.norm(), 0.5);
+
+  QpSolverCollection::SolveResult result = qp_solver.solveWithResult(qp_coeff, warm_start);
+  EXPECT_EQ(result.x_, warm_start.x_);
+  EXPECT_EQ(result.dual_ineq_, warm_start.dual_ineq_);
+
+  // The initial guess is used only in that solve
+  EXPECT_TRUE(qp_solver.solve(qp_coeff).isZero());
+
+  // The solution of the previous QP is passed as it is
+  result.dual_eq_.setConstant(-1.0);
+  EXPECT_EQ(qp_solver.solve(qp_coeff.dim_var_, qp_coeff.dim_eq_, qp_coeff.dim_ineq_, qp_coeff.obj_mat_,
+                            qp_coeff.obj_vec_, qp_coeff.eq_mat_, qp_coeff.eq_vec_, qp_coeff.ineq_mat_,
+                            qp_coeff.ineq_vec_, qp_coeff.x_min_, qp_coeff.x_max_, result),
+            result.x_);
+  EXPECT_EQ(qp_solver.dualEq(), result.dual_eq_);
+
+  // Dimensions are checked
+  EXPECT_FALSE(WarmStart(Eigen::Vector2d::Zero()).isValid(3, 1, 2));
+  EXPECT_FALSE(WarmStart(Eigen::Vector3d::Zero(), Eigen::Vector2d::Zero()).isValid(3, 1, 2));
+  EXPECT_THROW(qp_solver.solve(qp_coeff, WarmStart(Eigen::Vector2d::Zero())), std::invalid_argument);
+}
+
+TEST(TestQpSolverWarmStart, Wrapper)
+{
+  QpCoeff qp_coeff;
+  qp_coeff.setup(3, 1, 2);
+  QpSolverCollection::QpSolverMemoize qp_solver(std::make_shared<QpSolverWarmStartEcho>());
+  WarmStart warm_start(Eigen::Vector3d(1.0, 2.0, 3.0));
+  EXPECT_EQ(qp_solver.solve(qp_coeff, warm_start), warm_start.x_);
+}
+
+TEST(TestQpSolverWarmStart, Builtin)
+{
+  // QP solvers that do not support the initial guess ignore it
+  QpCoeff qp_coeff;
+  qp_coeff.setup(2, 0, 0);
+  qp_coeff.obj_mat_.setIdentity();
+  qp_coeff.obj_vec_ << 1.0, -1.0;
+  qp_coeff.x_min_.setConstant(-10.0);
+  qp_coeff.x_max_.setConstant(10.0);
+  auto qp_solver = QpSolverCollection::allocateQpSolver(QpSolverCollection::QpSolverType::Builtin);
+  Eigen::VectorXd x = qp_solver->solve(qp_coeff, WarmStart(Eigen::Vector2d(5.0, 5.0)));
+  EXPECT_LT((x - Eigen::Vector2d(-1.0, 1.0)).norm(), 1e-10);
+}
+
+TEST(TestQpSolverWarmStart, RemapById)
+{
+  QpSolverCollection::SolveResult result;
+  result.x_ = Eigen::Vector3d(1.0, 2.0, 3.0);
+  result.dual_eq_ = Eigen::Vector2d(-1.0, -2.0);
+  result.dual_ineq_ = Eigen::Vector2d(0.1, 0.2);
+  result.dual_bound_ = Eigen::Vector3d(0.0, -0.5, 0.5);
+  QpSolverCollection::QpElementIds element_ids;
+  element_ids.var_id_list_ = {10, 20, 30};
+  element_ids.eq_id_list_ = {1, 2};
+  element_ids.ineq_id_list_ = {5, 6};
+
+  // The variable 20 and the inequality constraint 5 are removed, and the variable 40 and the inequality constraint 7
+  // are added
+  QpCoeff qp_coeff;
+  qp_coeff.setup(3, 2, 2);
+  qp_coeff.x_min_.setConstant(-10.0);
+  qp_coeff.x_max_.setConstant(10.0);
+  qp_coeff.x_min_[1] = 0.5;
+  qp_coeff.element_ids_.var_id_list_ = {30, 40, 10};
+  qp_coeff.element_ids_.eq_id_list_ = {2, 1};
+  qp_coeff.element_ids_.ineq_id_list_ = {7, 6};
+
+  WarmStart warm_start = QpSolverCollection::remapWarmStart(result, element_ids, qp_coeff);
+  EXPECT_EQ(warm_start.x_, Eigen::Vector3d(3.0, 0.5, 1.0));
+  EXPECT_EQ(warm_start.dual_eq_, Eigen::Vector2d(-2.0, -1.0));
+  EXPECT_EQ(warm_start.dual_ineq_, Eigen::Vector2d(0.0, 0.2));
+  EXPECT_EQ(warm_start.dual_bound_, Eigen::Vector3d(0.5, 0.0, 0.0));
+
+  // The Lagrange multipliers of constraints without identifiers are not remapped
+  qp_coeff.element_ids_.ineq_id_list_.clear();
+  warm_start = QpSolverCollection::remapWarmStart(result, element_ids, qp_coeff);
+  EXPECT_EQ(warm_start.dual_ineq_.size(), 0);
+  EXPECT_TRUE(warm_start.isValid(3, 2, 2));
+
+  qp_coeff.element_ids_.var_id_list_.pop_back();
+  EXPECT_THROW(QpSolverCollection::remapWarmStart(result, element_ids, qp_coeff), std::invalid_argument);
+}
+
+TEST(TestQpSolverWarmStart, SolveWithIds)
+{
+  QpCoeff qp_coeff;
+  qp_coeff.setup(3, 0, 1);
+  qp_coeff.element_ids_.var_id_list_ = {10, 20, 30};
+  qp_coeff.element_ids_.ineq_id_list_ = {5};
+  QpSolverWarmStartEcho qp_solver;
+  qp_solver.solve(qp_coeff, WarmStart(Eigen::Vector3d(1.0, 2.0, 3.0), Eigen::VectorXd(), Eigen::VectorXd::Ones(1)));
+
+  // The solution of the previous QP is remapped onto the QP with a different structure
+  qp_coeff.setup(2, 0, 1);
+  EXPECT_TRUE(qp_coeff.element_ids_.empty());
+  qp_coeff.element_ids_.var_id_list_ = {30, 10};
+  qp_coeff.element_ids_.ineq_id_list_ = {5};
+  QpSolverCollection::SolveResult result = qp_solver.solveWithResult(qp_coeff);
+  EXPECT_EQ(result.x_, Eigen::Vector2d(3.0, 1.0));
+  EXPECT_EQ(result.dual_ineq_, Eigen::VectorXd::Ones(1));
+
+  // The initial guess given explicitly takes precedence
+  EXPECT_EQ(qp_solver.solve(qp_coeff, WarmStart(Eigen::Vector2d(-1.0, -2.0))), Eigen::Vector2d(-1.0, -2.0));
+  qp_coeff.element_ids_.var_id_list_ = {10, 30};
+  EXPECT_EQ(qp_solver.solve(qp_coeff), Eigen::Vector2d(-2.0, -1.0));
+
+  // The remapping is disabled by the settings
+  QpSolverCollection::QpSolverSettings settings;
+  settings.warm_start_by_id_ = false;
+  qp_solver.setSettings(settings);
+  EXPECT_TRUE(qp_solver.solve(qp_coeff).isZero());
+
+  // The numbers of identifiers are checked
+  settings.warm_start_by_id_ = true;
+  qp_solver.setSettings(settings);
+  qp_coeff.element_ids_.var_id_list_ = {10};
+  EXPECT_THROW(qp_solver.solve(qp_coeff), std::invalid_argument);
+}
+
+TEST(TestQpSolverWarmStart, SolveWithIdsException)
+{
+  QpCoeff qp_coeff;
+  qp_coeff.setup(2, 0, 0);
+  QpSolverWarmStartEcho qp_solver;
+  size_t memory_usage = qp_solver.memoryUsage();
+  qp_coeff.element_ids_.var_id_list_ = {10, 20};
+  qp_solver.solve(qp_coeff, WarmStart(Eigen::Vector2d(1.0, 2.0)));
+  EXPECT_GT(qp_solver.memoryUsage(), memory_usage);
+
+  // The remapped or given initial guess is not passed to the following solve after an exception
+  qp_solver.throw_ = true;
+  EXPECT_THROW(qp_solver.solve(qp_coeff), std::runtime_error);
+  EXPECT_THROW(qp_solver.solve(qp_coeff, WarmStart(Eigen::Vector2d(3.0, 4.0))), std::runtime_error);
+  EXPECT_THROW(qp_solver.solve(qp_coeff.dim_var_, qp_coeff.dim_eq_, qp_coeff.dim_ineq_, qp_coeff.obj_mat_,
+                               qp_coeff.obj_vec_, qp_coeff.eq_mat_, qp_coeff.eq_vec_, qp_coeff.ineq_mat_,
+                               qp_coeff.ineq_vec_, qp_coeff.x_min_, qp_coeff.x_max_,
+                               WarmStart(Eigen::Vector2d(3.0, 4.0))),
+               std::runtime_error);
+  qp_solver.throw_ = false;
+  EXPECT_TRUE(qp_solver.solve(qp_coeff.dim_var_, qp_coeff.dim_eq_, qp_coeff.dim_ineq_, qp_coeff.obj_mat_,
+                              qp_coeff.obj_vec_, qp_coeff.eq_mat_, qp_coeff.eq_vec_, qp_coeff.ineq_mat_,
+                              qp_coeff.ineq_vec_, qp_coeff.x_min_, qp_coeff.x_max_)
+                  .isZero());
+  EXPECT_EQ(qp_solver.solve(qp_coeff), Eigen::Vector2d(1.0, 2.0));
+}
+
+int main(int argc, char ** argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -86,6 +86,11 @@ TEST(TestQpSolversEnabled, QPMAD)
 }
 #endif
 
+TEST(TestQpSolversEnabled, Builtin)
+{
+  checkOneSolver(QpSolverType::Builtin);
+}
+
 int main(int argc, char ** argv)
 {
   testing::InitGoogleTest(&argc, argv);
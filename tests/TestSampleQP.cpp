@@ -1,5 +1,6 @@
 /* Author: Masaki Murooka */
 
+#include <cmath>
 #include <limits>
 
 #include <gtest/gtest.h>
@@ -9,7 +10,9 @@
 using QpSolverCollection::QpCoeff;
 using QpSolverCollection::QpSolverType;
 
-void solveOneQP(const QpCoeff & qp_coeff, const Eigen::VectorXd & x_gt)
+void solveOneQP(const QpCoeff & qp_coeff,
+                const Eigen::VectorXd & x_gt,
+                const QpSolverCollection::QpSolverSettings & settings = QpSolverCollection::QpSolverSettings())
 {
   // clang-format off
   const std::vector<QpSolverType> qp_solver_type_list = {
@@ -22,7 +25,8 @@ void solveOneQP(const QpCoeff & qp_coeff, const Eigen::VectorXd & x_gt)
       QpSolverType::NASOQ,
       QpSolverType::HPIPM,
       QpSolverType::PROXQP,
-      QpSolverType::QPMAD
+      QpSolverType::QPMAD,
+      QpSolverType::Builtin
   };
   // clang-format on
   for(const auto & qp_solver_type : qp_solver_type_list)
@@ -40,24 +44,39 @@ void solveOneQP(const QpCoeff & qp_coeff, const Eigen::VectorXd & x_gt)
     {
       continue;
     }
+    qp_solver->setSettings(settings);
 
     QpCoeff qp_coeff_copied = qp_coeff;
-    Eigen::VectorXd x_opt = qp_solver->solve(qp_coeff_copied);
+    QpSolverCollection::SolveResult result = qp_solver->solveWithResult(qp_coeff_copied);
+    const Eigen::VectorXd & x_opt = result.x_;
 
     double thre = 1e-6;
     if(qp_solver_type == QpSolverType::OSQP)
     {
       thre = 1e-3;
     }
-    else if(qp_solver_type == QpSolverType::PROXQP)
+    else if(qp_solver_type == QpSolverType::PROXQP
+            && settings.profile_ != QpSolverCollection::QpAccuracyProfile::Robust)
     {
-      // Set proxqp_->settings.eps_abs to 1e-8 to satisfy thre of 1e-6
+      // Robust profile sets proxqp_->settings.eps_abs to 1e-8 to satisfy thre of 1e-6
       thre = 1e-4;
     }
     EXPECT_LT((x_opt - x_gt).norm(), thre)
         << "QP solution of " << std::to_string(qp_solver_type) << " is incorrect:\n"
         << "  solution: " << x_opt.transpose() << "\n  ground truth: " << x_gt.transpose()
         << "\n  error: " << (x_opt - x_gt).norm() << std::endl;
+
+    QpSolverCollection::KktResidual kkt = QpSolverCollection::computeKkt(qp_coeff, result);
+    EXPECT_LT(kkt.primal_feas_, thre) << "Primal feasibility of " << std::to_string(qp_solver_type)
+                                      << " is violated: " << kkt.primal_feas_ << std::endl;
+    if(result.hasDual())
+    {
+      // Check the sign convention of Lagrange multipliers with loose tolerance
+      constexpr double dual_thre = 1e-2;
+      EXPECT_TRUE(kkt.satisfied(dual_thre))
+          << "KKT condition of " << std::to_string(qp_solver_type) << " is violated:\n  dual_feas: " << kkt.dual_feas_
+          << "\n  complementarity: " << kkt.complementarity_ << "\n  duality_gap: " << kkt.duality_gap_ << std::endl;
+    }
   }
 }
 
@@ -122,6 +141,81 @@ TEST(TestSampleQP, OnlyEqConst)
   solveOneQP(qp_coeff, x_gt);
 }
 
+TEST(TestSampleQP, RobustProfile)
+{
+  int dim_var = 6;
+  int dim_eq = 3;
+  int dim_ineq = 2;
+  QpCoeff qp_coeff;
+  qp_coeff.setup(dim_var, dim_eq, dim_ineq);
+  qp_coeff.obj_mat_.setIdentity();
+  qp_coeff.obj_vec_ << 1., 2., 3., 4., 5., 6.;
+  qp_coeff.eq_mat_ << 1., -1., 1., 0., 3., 1., -1., 0., -3., -4., 5., 6., 2., 5., 3., 0., 1., 0.;
+  qp_coeff.eq_vec_ << 1., 2., 3.;
+  qp_coeff.ineq_mat_ << 0., 1., 0., 1., 2., -1., -1., 0., 2., 1., 1., 0.;
+  qp_coeff.ineq_vec_ << -1., 2.5;
+  qp_coeff.x_min_ << -1000., -10000., 0., -1000., -1000., -1000.;
+  qp_coeff.x_max_ << 10000., 100., 1.5, 100., 100., 1000.;
+  Eigen::VectorXd x_gt(dim_var);
+  x_gt << 1.7975426, -0.3381487, 0.1633880, -4.9884023, 0.6054943, -3.1155623;
+
+  QpSolverCollection::QpSolverSettings settings;
+  settings.profile_ = QpSolverCollection::QpAccuracyProfile::Robust;
+  solveOneQP(qp_coeff, x_gt, settings);
+}
+
+TEST(TestSampleQP, KktResidual)
+{
+  int dim_var = 2;
+  int dim_eq = 1;
+  int dim_ineq = 1;
+  QpCoeff qp_coeff;
+  qp_coeff.setup(dim_var, dim_eq, dim_ineq);
+  qp_coeff.obj_mat_ << 2, 0.5, 0.5, 1;
+  qp_coeff.obj_vec_ << 1, 1;
+  qp_coeff.eq_mat_ << 1, 1;
+  qp_coeff.eq_vec_ << 1;
+  qp_coeff.ineq_mat_ << 1, 0;
+  qp_coeff.ineq_vec_ << 0.5;
+  qp_coeff.x_min_.setZero();
+
+  // Exact solution and Lagrange multipliers
+  QpSolverCollection::SolveResult result;
+  result.x_.resize(dim_var);
+  result.x_ << 0.25, 0.75;
+  result.dual_eq_.resize(dim_eq);
+  result.dual_eq_ << -1.875;
+  result.dual_ineq_.setZero(dim_ineq);
+  result.dual_bound_.setZero(dim_var);
+  ASSERT_TRUE(result.hasDual());
+
+  QpSolverCollection::KktResidual kkt = QpSolverCollection::computeKkt(qp_coeff, result);
+  EXPECT_TRUE(kkt.satisfied(1e-10));
+  EXPECT_NEAR(kkt.obj_, 1.4375, 1e-10);
+
+  // Perturbed primal solution
+  result.x_ << 0.6, 0.5;
+  kkt = QpSolverCollection::computeKkt(qp_coeff, result);
+  EXPECT_NEAR(kkt.primal_feas_, 0.1, 1e-10);
+  EXPECT_GT(kkt.dual_feas_, 1e-2);
+  EXPECT_FALSE(kkt.satisfied(1e-2));
+
+  // Wrong sign of Lagrange multiplier of inequality constraint
+  result.x_ << 0.25, 0.75;
+  result.dual_ineq_ << -1.0;
+  kkt = QpSolverCollection::computeKkt(qp_coeff, result);
+  EXPECT_NEAR(kkt.dual_feas_, 1.0, 1e-10);
+
+  // Without Lagrange multipliers
+  result.dual_eq_.resize(0);
+  result.dual_ineq_.resize(0);
+  result.dual_bound_.resize(0);
+  ASSERT_FALSE(result.hasDual());
+  kkt = QpSolverCollection::computeKkt(qp_coeff, result);
+  EXPECT_TRUE(kkt.satisfied(1e-10));
+  EXPECT_TRUE(std::isnan(kkt.dual_feas_));
+}
+
 int main(int argc, char ** argv)
 {
   testing::InitGoogleTest(&argc, argv);
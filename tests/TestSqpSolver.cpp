@@ -0,0 +1,243 @@
+/* Author: Masaki Murooka */
+
+#include <gtest/gtest.h>
+
+#include <Eigen/Dense>
+
+#include <qp_solver_collection/SqpSolver.h>
+
+using QpSolverCollection::QpSolveStatus;
+using QpSolverCollection::SqpProblem;
+
+/** \brief QP solver that enumerates active sets of inequality constraints for small QPs (bounds are ignored). */
+class QpSolverEnumeration : public QpSolverCollection::QpSolver
+{
+public:
+  using QpSolver::solve;
+
+  QpSolverEnumeration()
+  {
+    type_ = QpSolverCollection::QpSolverType::QLD;
+  }
+
+  virtual Eigen::VectorXd solve(int dim_var,
+                                int dim_eq,
+                                int dim_ineq,
+                                Eigen::Ref<Eigen::MatrixXd> Q,
+                                const Eigen::Ref<const Eigen::VectorXd> & c,
+                                const Eigen::Ref<const Eigen::MatrixXd> & A,
+                                const Eigen::Ref<const Eigen::VectorXd> & b,
+                                const Eigen::Ref<const Eigen::MatrixXd> & C,
+                                const Eigen::Ref<const Eigen::VectorXd> & d,
+                                const Eigen::Ref<const Eigen::VectorXd> &,
+                                const Eigen::Ref<const Eigen::VectorXd> &) override
+  {
+    solve_num_++;
+    if(warm_start_)
+    {
+      warm_start_num_++;
+    }
+    if(coeffUnchanged(QpSolverCollection::QpCoeff::Block::IneqMat))
+    {
+      ineq_mat_unchanged_num_++;
+    }
+    for(int active_set = 0; active_set < (1 << dim_ineq); active_set++)
+    {
+      std::vector<int> active_idx_list;
+      for(int i = 0; i < dim_ineq; i++)
+      {
+        if(active_set & (1 << i))
+        {
+          active_idx_list.push_back(i);
+        }
+      }
+      int dim_active = dim_eq + static_cast<int>(active_idx_list.size());
+      Eigen::MatrixXd kkt_mat = Eigen::MatrixXd::Zero(dim_var + dim_active, dim_var + dim_active);
+      Eigen::VectorXd kkt_vec(dim_var + dim_active);
+      kkt_mat.topLeftCorner(dim_var, dim_var) = Q;
+      kkt_vec.head(dim_var) = -c;
+      kkt_mat.block(dim_var, 0, dim_eq, dim_var) = A;
+      kkt_vec.segment(dim_var, dim_eq) = b;
+      for(size_t i = 0; i < active_idx_list.size(); i++)
+      {
+        kkt_mat.row(dim_var + dim_eq + i).head(dim_var) = C.row(active_idx_list[i]);
+        kkt_vec[dim_var + dim_eq + i] = d[active_idx_list[i]];
+      }
+      kkt_mat.topRightCorner(dim_var, dim_active) = kkt_mat.bottomLeftCorner(dim_active, dim_var).transpose();
+      Eigen::VectorXd sol = kkt_mat.fullPivLu().solve(kkt_vec);
+
+      Eigen::VectorXd x = sol.head(dim_var);
+      Eigen::VectorXd dual_ineq = Eigen::VectorXd::Zero(dim_ineq);
+      for(size_t i = 0; i < active_idx_list.size(); i++)
+      {
+        dual_ineq[active_idx_list[i]] = sol[dim_var + dim_eq + i];
+      }
+      if(dim_ineq == 0 || ((C * x - d).maxCoeff() <= 1e-9 && dual_ineq.minCoeff() >= -1e-9))
+      {
+        solve_failed_ = false;
+        status_ = QpSolveStatus::Solved;
+        dual_eq_ = sol.segment(dim_var, dim_eq);
+        dual_ineq_ = dual_ineq;
+        dual_bound_.setZero(dim_var);
+        return x;
+      }
+    }
+    solve_failed_ = true;
+    status_ = QpSolveStatus::PrimalInfeasible;
+    return Eigen::VectorXd::Zero(dim_var);
+  }
+
+  int solve_num_ = 0;
+
+  //! Number of solves with warm start
+  int warm_start_num_ = 0;
+
+  //! Number of solves in which the inequality matrix is notified as unchanged
+  int ineq_mat_unchanged_num_ = 0;
+};
+
+namespace
+{
+/** \brief Problem to minimize the distance from (2, 1) on or in the unit circle.
+
+    The solution is (2, 1) / sqrt(5).
+ */
+SqpProblem makeCircleProblem(bool eq, bool user_hessian)
+{
+  SqpProblem problem;
+  problem.dim_var_ = 2;
+  problem.cost_func_ = [](const Eigen::VectorXd & x) { return (x - Eigen::Vector2d(2.0, 1.0)).squaredNorm(); };
+  problem.cost_grad_func_ = [](const Eigen::VectorXd & x, Eigen::Ref<Eigen::VectorXd> grad) {
+    grad = 2.0 * (x - Eigen::Vector2d(2.0, 1.0));
+  };
+  auto circle_func = [](const Eigen::VectorXd & x, Eigen::Ref<Eigen::VectorXd> val) { val[0] = x.squaredNorm() - 1; };
+  auto circle_jac_func = [](const Eigen::VectorXd & x, Eigen::Ref<Eigen::MatrixXd> jac) {
+    jac.row(0) = 2.0 * x.transpose();
+  };
+  if(eq)
+  {
+    problem.dim_eq_ = 1;
+    problem.eq_func_ = circle_func;
+    problem.eq_jac_func_ = circle_jac_func;
+  }
+  else
+  {
+    // The second constraint (-x0 - x1 <= 0) is inactive at the solution
+    problem.dim_ineq_ = 2;
+    problem.ineq_func_ = [circle_func](const Eigen::VectorXd & x, Eigen::Ref<Eigen::VectorXd> val) {
+      circle_func(x, val.head(1));
+      val[1] = -x[0] - x[1];
+    };
+    problem.ineq_jac_func_ = [circle_jac_func](const Eigen::VectorXd & x, Eigen::Ref<Eigen::MatrixXd> jac) {
+      circle_jac_func(x, jac.topRows(1));
+      jac.row(1) << -1.0, -1.0;
+    };
+  }
+  if(user_hessian)
+  {
+    problem.hess_func_ = [eq](const Eigen::VectorXd &, const Eigen::VectorXd & dual_eq,
+                              const Eigen::VectorXd & dual_ineq, Eigen::Ref<Eigen::MatrixXd> hess) {
+      double dual = (eq ? dual_eq[0] : dual_ineq[0]);
+      // Regularized to be positive definite
+      hess.setIdentity();
+      hess *= std::max(2.0 + 2.0 * dual, 1e-3);
+    };
+  }
+  return problem;
+}
+} // namespace
+
+TEST(TestSqpSolver, Circle)
+{
+  Eigen::Vector2d x_expected = Eigen::Vector2d(2.0, 1.0) / std::sqrt(5.0);
+  for(bool eq : {true, false})
+  {
+    for(bool user_hessian : {false, true})
+    {
+      std::string label =
+          std::string(eq ? "equality" : "inequality") + (user_hessian ? " with Hessian" : " with BFGS");
+      auto qp_solver = std::make_shared<QpSolverEnumeration>();
+      QpSolverCollection::SqpSolver sqp_solver(qp_solver);
+      Eigen::VectorXd x = sqp_solver.solve(makeCircleProblem(eq, user_hessian), Eigen::Vector2d(0.3, 1.5));
+
+      EXPECT_FALSE(sqp_solver.solveFailed()) << label;
+      EXPECT_EQ(sqp_solver.status(), QpSolveStatus::Solved) << label;
+      EXPECT_LT((x - x_expected).norm(), 1e-5) << label;
+      EXPECT_LT(sqp_solver.constraintViolation(), 1e-6) << label;
+      EXPECT_NEAR(sqp_solver.cost(), (x_expected - Eigen::Vector2d(2.0, 1.0)).squaredNorm(), 1e-6) << label;
+      // Stationarity: 2 (x - (2, 1)) + 2 x lambda = 0
+      double dual = (eq ? sqp_solver.dualEq()[0] : sqp_solver.dualIneq()[0]);
+      EXPECT_NEAR(dual, std::sqrt(5.0) - 1.0, 1e-4) << label;
+      if(!eq)
+      {
+        EXPECT_NEAR(sqp_solver.dualIneq()[1], 0.0, 1e-9) << label;
+      }
+      EXPECT_EQ(qp_solver->solve_num_, sqp_solver.iterNum() + 1) << label;
+    }
+  }
+}
+
+TEST(TestSqpSolver, Rosenbrock)
+{
+  SqpProblem problem;
+  problem.dim_var_ = 2;
+  problem.cost_func_ = [](const Eigen::VectorXd & x) {
+    return std::pow(1.0 - x[0], 2) + 100.0 * std::pow(x[1] - x[0] * x[0], 2);
+  };
+  problem.cost_grad_func_ = [](const Eigen::VectorXd & x, Eigen::Ref<Eigen::VectorXd> grad) {
+    grad[0] = -2.0 * (1.0 - x[0]) - 400.0 * x[0] * (x[1] - x[0] * x[0]);
+    grad[1] = 200.0 * (x[1] - x[0] * x[0]);
+  };
+
+  QpSolverCollection::SqpSolver sqp_solver(std::make_shared<QpSolverEnumeration>());
+  sqp_solver.max_iter_ = 200;
+  Eigen::VectorXd x = sqp_solver.solve(problem, Eigen::Vector2d(-1.2, 1.0));
+  EXPECT_FALSE(sqp_solver.solveFailed());
+  EXPECT_LT((x - Eigen::Vector2d(1.0, 1.0)).norm(), 1e-4);
+
+  // Not converged within the iteration limit
+  sqp_solver.max_iter_ = 3;
+  sqp_solver.solve(problem, Eigen::Vector2d(-1.2, 1.0));
+  EXPECT_TRUE(sqp_solver.solveFailed());
+  EXPECT_EQ(sqp_solver.status(), QpSolveStatus::MaxIterReached);
+  EXPECT_EQ(sqp_solver.iterNum(), 3);
+}
+
+TEST(TestSqpSolver, WarmStart)
+{
+  // Minimize (x0 - 2)^4 + (x1 - 1)^2 s.t. x0 + x1 <= 1, whose solution satisfies x1 - 1 = 2 (x0 - 2)^3
+  SqpProblem problem;
+  problem.dim_var_ = 2;
+  problem.dim_ineq_ = 1;
+  problem.cost_func_ = [](const Eigen::VectorXd & x) { return std::pow(x[0] - 2.0, 4) + std::pow(x[1] - 1.0, 2); };
+  problem.cost_grad_func_ = [](const Eigen::VectorXd & x, Eigen::Ref<Eigen::VectorXd> grad) {
+    grad[0] = 4.0 * std::pow(x[0] - 2.0, 3);
+    grad[1] = 2.0 * (x[1] - 1.0);
+  };
+  problem.ineq_func_ = [](const Eigen::VectorXd & x, Eigen::Ref<Eigen::VectorXd> val) { val[0] = x[0] + x[1] - 1.0; };
+  problem.ineq_jac_func_ = [](const Eigen::VectorXd &, Eigen::Ref<Eigen::MatrixXd> jac) { jac << 1.0, 1.0; };
+
+  for(bool linear_constraint : {false, true})
+  {
+    problem.linear_constraint_ = linear_constraint;
+    auto qp_solver = std::make_shared<QpSolverEnumeration>();
+    QpSolverCollection::SqpSolver sqp_solver(qp_solver);
+    Eigen::VectorXd x = sqp_solver.solve(problem, Eigen::Vector2d::Zero());
+
+    EXPECT_FALSE(sqp_solver.solveFailed()) << linear_constraint;
+    EXPECT_NEAR(x[0] + x[1], 1.0, 1e-6) << linear_constraint;
+    EXPECT_NEAR(x[1] - 1.0, 2.0 * std::pow(x[0] - 2.0, 3), 1e-4) << linear_constraint;
+    EXPECT_GT(qp_solver->solve_num_, 1) << linear_constraint;
+    // All the QP subproblems except the first one are warm-started
+    EXPECT_EQ(qp_solver->warm_start_num_, qp_solver->solve_num_ - 1) << linear_constraint;
+    // The Jacobian is notified as unchanged only if it is not re-evaluated
+    EXPECT_EQ(qp_solver->ineq_mat_unchanged_num_, linear_constraint ? qp_solver->solve_num_ - 1 : 0)
+        << linear_constraint;
+  }
+}
+
+int main(int argc, char ** argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,350 @@
+/* Author: Masaki Murooka */
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <vector>
+
+#include <qp_solver_collection/QpSolverCollection.h>
+
+using namespace QpSolverCollection;
+
+namespace
+{
+/** \brief Configuration of autotuner. */
+struct AutotuneConfig
+{
+  //! Path of settings profile to write
+  std::string output_path = "qp_settings_profile.txt";
+
+  //! QP solvers to tune (all enabled ones if empty)
+  std::vector<QpSolverType> qp_solver_type_list;
+
+  //! Whether to minimize 99th percentile latency instead of median latency
+  bool use_p99 = false;
+
+  //! KKT accuracy target
+  double kkt_tol = 1e-4;
+
+  //! Number of repetitions of each problem
+  int repeat_num = 5;
+
+  //! Paths of files of QpCoeff dumped by QpCoeff::dump
+  std::vector<std::string> problem_path_list;
+};
+
+/** \brief Result of evaluating one candidate settings. */
+struct CandidateResult
+{
+  QpSolverSettings settings;
+  bool accepted = false;
+  double median = 0; // [ms]
+  double p99 = 0; // [ms]
+  double max_kkt = 0;
+};
+
+void printUsage()
+{
+  std::cout << "Usage: qp_autotune [options] <problem files>...\n"
+            << "  Search the parameters of each QP solver for the minimum latency on the problems dumped by "
+               "QpCoeff::dump, subject to the KKT accuracy target.\n"
+            << "Options:\n"
+            << "  --output <path>       path of settings profile to write (default: qp_settings_profile.txt)\n"
+            << "  --solvers <names>     comma-separated QP solver names, e.g., OSQP,HPIPM (default: all enabled)\n"
+            << "  --objective <type>    median or p99 (default: median)\n"
+            << "  --tol <value>         KKT accuracy target (default: 1e-4)\n"
+            << "  --repeat <num>        number of repetitions of each problem (default: 5)\n"
+            << "The settings profile can be loaded by QpSolver::loadSettings." << std::endl;
+}
+
+bool parseArgs(int argc, char ** argv, AutotuneConfig & config)
+{
+  for(int i = 1; i < argc; i++)
+  {
+    std::string arg = argv[i];
+    bool has_value = (i + 1 < argc);
+    if(arg == "-h" || arg == "--help")
+    {
+      return false;
+    }
+    else if(arg == "--output" && has_value)
+    {
+      config.output_path = argv[++i];
+    }
+    else if(arg == "--solvers" && has_value)
+    {
+      std::istringstream ss(argv[++i]);
+      std::string name;
+      while(std::getline(ss, name, ','))
+      {
+        config.qp_solver_type_list.push_back(strToQpSolverType(name));
+      }
+    }
+    else if(arg == "--objective" && has_value)
+    {
+      std::string objective = argv[++i];
+      if(objective != "median" && objective != "p99")
+      {
+        std::cerr << "Unsupported objective: " << objective << std::endl;
+        return false;
+      }
+      config.use_p99 = (objective == "p99");
+    }
+    else if(arg == "--tol" && has_value)
+    {
+      config.kkt_tol = std::stod(argv[++i]);
+    }
+    else if(arg == "--repeat" && has_value)
+    {
+      config.repeat_num = std::max(std::stoi(argv[++i]), 1);
+    }
+    else if(arg.compare(0, 2, "--") == 0)
+    {
+      std::cerr << "Unknown option: " << arg << std::endl;
+      return false;
+    }
+    else
+    {
+      config.problem_path_list.push_back(arg);
+    }
+  }
+
+  if(config.qp_solver_type_list.empty())
+  {
+    for(int i = static_cast<int>(QpSolverType::QLD); i <= static_cast<int>(QpSolverType::Builtin); i++)
+    {
+      QpSolverType qp_solver_type = static_cast<QpSolverType>(i);
+      if(isQpSolverEnabled(qp_solver_type))
+      {
+        config.qp_solver_type_list.push_back(qp_solver_type);
+      }
+    }
+  }
+
+  return !config.problem_path_list.empty();
+}
+
+/** \brief Make the list of candidate settings of the QP solver.
+
+    Accuracy profiles are combined with grids of solver-specific parameters around their defaults.
+ */
+std::vector<QpSolverSettings> makeCandidates(QpSolverType qp_solver_type)
+{
+  using ParamGrid = std::vector<std::pair<std::string, std::vector<double>>>;
+  ParamGrid param_grid;
+  if(qp_solver_type == QpSolverType::OSQP)
+  {
+    param_grid = {{"rho", {0.01, 0.1, 1.0}}, {"sigma", {1e-7, 1e-6, 1e-5}}, {"alpha", {1.0, 1.6, 1.8}}};
+  }
+  else if(qp_solver_type == QpSolverType::HPIPM)
+  {
+    param_grid = {{"mode", {0, 1, 2, 3}}, {"mu0", {1e0, 1e2, 1e4}}};
+  }
+  else if(qp_solver_type == QpSolverType::PROXQP)
+  {
+    param_grid = {{"rho", {1e-7, 1e-6, 1e-5}}, {"mu_eq", {1e-4, 1e-3, 1e-2}}, {"mu_in", {1e-2, 1e-1}}};
+  }
+  else if(qp_solver_type == QpSolverType::qpOASES)
+  {
+    param_grid = {{"enable_regularisation", {0, 1}}, {"enable_ramping", {0, 1}}, {"enable_far_bounds", {0, 1}}};
+  }
+
+  std::vector<QpSolverSettings> candidate_list;
+  for(auto profile : {QpAccuracyProfile::Fast, QpAccuracyProfile::Balanced, QpAccuracyProfile::Robust})
+  {
+    QpSolverSettings settings;
+    settings.profile_ = profile;
+    candidate_list.push_back(settings);
+  }
+
+  // Cartesian product of parameter grid
+  for(const auto & param : param_grid)
+  {
+    std::vector<QpSolverSettings> new_candidate_list;
+    for(const auto & candidate : candidate_list)
+    {
+      for(double value : param.second)
+      {
+        QpSolverSettings settings = candidate;
+        settings.params_[param.first] = value;
+        new_candidate_list.push_back(settings);
+      }
+    }
+    candidate_list = std::move(new_candidate_list);
+  }
+
+  return candidate_list;
+}
+
+double percentile(std::vector<double> sample_list, double ratio)
+{
+  if(sample_list.empty())
+  {
+    return 0;
+  }
+  size_t idx = std::min(static_cast<size_t>(ratio * static_cast<double>(sample_list.size())), sample_list.size() - 1);
+  std::nth_element(sample_list.begin(), sample_list.begin() + idx, sample_list.end());
+  return sample_list[idx];
+}
+
+CandidateResult evaluateCandidate(QpSolverType qp_solver_type,
+                                  const QpSolverSettings & settings,
+                                  const std::vector<QpCoeff> & qp_coeff_list,
+                                  const AutotuneConfig & config)
+{
+  CandidateResult result;
+  result.settings = settings;
+
+  auto qp_solver = allocateQpSolver(qp_solver_type);
+  if(!qp_solver)
+  {
+    return result;
+  }
+  // Each repetition solves the same QP, so reusing the factor of the objective matrix would skip the factorization
+  // that the recorded QPs with different objective matrices require
+  QpSolverSettings solver_settings = settings;
+  solver_settings.reuse_obj_mat_factor_ = false;
+  qp_solver->setSettings(solver_settings);
+
+  std::vector<double> duration_list;
+  duration_list.reserve(qp_coeff_list.size() * config.repeat_num);
+  for(const auto & qp_coeff : qp_coeff_list)
+  {
+    for(int i = 0; i < config.repeat_num; i++)
+    {
+      // Some QP solvers overwrite the objective matrix
+      QpCoeff qp_coeff_copied = qp_coeff;
+      auto start_time = QpSolver::clock::now();
+      Eigen::VectorXd x = qp_solver->solve(qp_coeff_copied);
+      auto end_time = QpSolver::clock::now();
+      duration_list.push_back(1e3
+                              * std::chrono::duration_cast<std::chrono::duration<double>>(end_time - start_time).count());
+
+      if(qp_solver->solveFailed())
+      {
+        return result;
+      }
+      if(i == 0)
+      {
+        SolveResult solve_result;
+        solve_result.x_ = x;
+        solve_result.dual_eq_ = qp_solver->dualEq();
+        solve_result.dual_ineq_ = qp_solver->dualIneq();
+        solve_result.dual_bound_ = qp_solver->dualBound();
+        KktResidual kkt = computeKkt(qp_coeff, solve_result);
+        if(!kkt.satisfied(config.kkt_tol))
+        {
+          return result;
+        }
+        result.max_kkt = std::max(result.max_kkt, kkt.primal_feas_);
+        if(!std::isnan(kkt.dual_feas_))
+        {
+          result.max_kkt = std::max({result.max_kkt, kkt.dual_feas_, kkt.complementarity_, kkt.duality_gap_});
+        }
+      }
+    }
+  }
+
+  result.accepted = true;
+  result.median = percentile(duration_list, 0.5);
+  result.p99 = percentile(duration_list, 0.99);
+  return result;
+}
+
+std::string paramsToString(const QpSolverSettings & settings)
+{
+  std::ostringstream ss;
+  ss << std::to_string(settings.profile_);
+  for(const auto & param : settings.params_)
+  {
+    ss << " " << param.first << "=" << param.second;
+  }
+  return ss.str();
+}
+} // namespace
+
+int main(int argc, char ** argv)
+{
+  AutotuneConfig config;
+  if(!parseArgs(argc, argv, config))
+  {
+    printUsage();
+    return 1;
+  }
+
+  // Load problems
+  std::vector<QpCoeff> qp_coeff_list;
+  for(const auto & path : config.problem_path_list)
+  {
+    std::ifstream ifs(path);
+    if(!ifs)
+    {
+      std::cerr << "Failed to open " << path << std::endl;
+      return 1;
+    }
+    QpCoeff qp_coeff;
+    while(qp_coeff.load(ifs))
+    {
+      qp_coeff_list.push_back(qp_coeff);
+    }
+  }
+  if(qp_coeff_list.empty())
+  {
+    std::cerr << "No problem is loaded." << std::endl;
+    return 1;
+  }
+  std::cout << "Loaded " << qp_coeff_list.size() << " problems." << std::endl;
+
+  // Tune each QP solver
+  std::map<QpSolverType, QpSolverSettings> settings_profile;
+  for(const auto & qp_solver_type : config.qp_solver_type_list)
+  {
+    if(!isQpSolverEnabled(qp_solver_type))
+    {
+      std::cout << "Skip " << std::to_string(qp_solver_type) << " because it is not enabled." << std::endl;
+      continue;
+    }
+
+    std::vector<QpSolverSettings> candidate_list = makeCandidates(qp_solver_type);
+    std::cout << "Tune " << std::to_string(qp_solver_type) << " with " << candidate_list.size() << " candidates."
+              << std::endl;
+
+    bool found = false;
+    CandidateResult best_result;
+    for(const auto & candidate : candidate_list)
+    {
+      CandidateResult result = evaluateCandidate(qp_solver_type, candidate, qp_coeff_list, config);
+      if(!result.accepted)
+      {
+        continue;
+      }
+      double objective = (config.use_p99 ? result.p99 : result.median);
+      double best_objective = (config.use_p99 ? best_result.p99 : best_result.median);
+      if(!found || objective < best_objective)
+      {
+        found = true;
+        best_result = result;
+      }
+    }
+
+    if(found)
+    {
+      std::cout << "  best: " << paramsToString(best_result.settings) << std::setprecision(4)
+                << " (median: " << best_result.median << " [ms], p99: " << best_result.p99
+                << " [ms], KKT residual: " << best_result.max_kkt << ")" << std::endl;
+      settings_profile[qp_solver_type] = best_result.settings;
+    }
+    else
+    {
+      std::cout << "  No candidate satisfies the KKT accuracy target." << std::endl;
+    }
+  }
+
+  saveSettingsProfile(config.output_path, settings_profile);
+  std::cout << "Settings profile is written to " << config.output_path << std::endl;
+
+  return 0;
+}
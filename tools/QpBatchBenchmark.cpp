@@ -0,0 +1,113 @@
+/* Author: Masaki Murooka */
+
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <qp_solver_collection/BatchedAdmmSolver.h>
+
+using namespace QpSolverCollection;
+
+namespace
+{
+/** \brief Make a feasible QP with dense random coefficients. */
+QpCoeff makeQpCoeff(int dim_var)
+{
+  int dim_ineq = dim_var;
+  QpCoeff qp_coeff;
+  qp_coeff.setup(dim_var, 0, dim_ineq);
+  Eigen::MatrixXd tmp_mat = Eigen::MatrixXd::Random(dim_var, dim_var);
+  qp_coeff.obj_mat_ = tmp_mat.transpose() * tmp_mat + Eigen::MatrixXd::Identity(dim_var, dim_var);
+  qp_coeff.obj_vec_ = 5.0 * Eigen::VectorXd::Random(dim_var);
+  Eigen::VectorXd x_feasible = 0.5 * Eigen::VectorXd::Random(dim_var);
+  qp_coeff.ineq_mat_.setRandom();
+  qp_coeff.ineq_vec_ = qp_coeff.ineq_mat_ * x_feasible + 0.1 * Eigen::VectorXd::Ones(dim_ineq);
+  qp_coeff.x_min_.setConstant(-1.0);
+  qp_coeff.x_max_.setConstant(1.0);
+  return qp_coeff;
+}
+
+/** \brief Get elapsed time [s] from start_time. */
+double elapsedTime(const QpSolver::clock::time_point & start_time)
+{
+  return std::chrono::duration_cast<std::chrono::duration<double>>(QpSolver::clock::now() - start_time).count();
+}
+} // namespace
+
+int main(int argc, char ** argv)
+{
+  if(argc > 1 && (std::string(argv[1]) == "-h" || std::string(argv[1]) == "--help"))
+  {
+    std::cout << "Usage: qp_batch_benchmark [dim_var] [problem_num]\n"
+              << "  Print the throughput [problems/s] of BatchedAdmmSolver for each batch size (1, 4, 16, ...,\n"
+              << "  problem_num) and of solving the problems one by one with each enabled QP solver, on random QPs\n"
+              << "  with the given dimension of decision variable and the same dimension of inequality constraints\n"
+              << "  (default: dim_var 8, problem_num 1024). The number of solved problems is shown in parentheses."
+              << std::endl;
+    return 0;
+  }
+
+  int dim_var = argc > 1 ? std::stoi(argv[1]) : 8;
+  int problem_num = argc > 2 ? std::stoi(argv[2]) : 1024;
+
+  std::vector<QpCoeff> qp_coeff_list;
+  for(int i = 0; i < problem_num; i++)
+  {
+    qp_coeff_list.push_back(makeQpCoeff(dim_var));
+  }
+
+  std::cout << "| method | problems/s | solved |\n"
+            << "|---|---:|---:|\n";
+
+  for(int batch_size = 1; batch_size <= problem_num; batch_size *= 4)
+  {
+    // The problems are solved in chunks of the batch size (the remainder is dropped)
+    int solved_problem_num = 0;
+    int solve_num = problem_num / batch_size;
+    BatchedAdmmSolver batch_solver;
+    batch_solver.setup(batch_size, dim_var, 0, dim_var);
+    auto start_time = QpSolver::clock::now();
+    for(int i = 0; i < solve_num; i++)
+    {
+      for(int idx = 0; idx < batch_size; idx++)
+      {
+        batch_solver.setQpCoeff(idx, qp_coeff_list[i * batch_size + idx]);
+      }
+      batch_solver.solve();
+      solved_problem_num += batch_solver.solvedNum();
+    }
+    double duration = elapsedTime(start_time);
+    std::cout << "| BatchedAdmmSolver (batch " << batch_size << ") | " << std::fixed << std::setprecision(0)
+              << solve_num * batch_size / duration << " | " << solved_problem_num << "/" << solve_num * batch_size
+              << " |\n";
+  }
+
+  for(int i = static_cast<int>(QpSolverType::QLD); i <= static_cast<int>(QpSolverType::Builtin); i++)
+  {
+    QpSolverType qp_solver_type = static_cast<QpSolverType>(i);
+    if(!isQpSolverEnabled(qp_solver_type))
+    {
+      continue;
+    }
+
+    auto qp_solver = allocateQpSolver(qp_solver_type);
+    int solved_problem_num = 0;
+    auto start_time = QpSolver::clock::now();
+    for(const auto & qp_coeff : qp_coeff_list)
+    {
+      QpCoeff qp_coeff_copied = qp_coeff;
+      qp_solver->solve(qp_coeff_copied);
+      if(!qp_solver->solveFailed())
+      {
+        solved_problem_num++;
+      }
+    }
+    double duration = elapsedTime(start_time);
+    std::cout << "| " << std::to_string(qp_solver_type) << " | " << std::fixed << std::setprecision(0)
+              << problem_num / duration << " | " << solved_problem_num << "/" << problem_num << " |\n";
+  }
+  std::cout << std::flush;
+
+  return 0;
+}
@@ -0,0 +1,97 @@
+/* Author: Masaki Murooka */
+
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <qp_solver_collection/QpSolverCollection.h>
+
+using namespace QpSolverCollection;
+
+namespace
+{
+/** \brief Make a feasible QP of the given dimension with dense random coefficients. */
+QpCoeff makeQpCoeff(int dim_var)
+{
+  int dim_eq = dim_var / 4;
+  int dim_ineq = dim_var / 2;
+  QpCoeff qp_coeff;
+  qp_coeff.setup(dim_var, dim_eq, dim_ineq);
+  Eigen::MatrixXd tmp_mat = Eigen::MatrixXd::Random(dim_var, dim_var);
+  qp_coeff.obj_mat_ = tmp_mat.transpose() * tmp_mat + Eigen::MatrixXd::Identity(dim_var, dim_var);
+  qp_coeff.obj_vec_.setRandom();
+  Eigen::VectorXd x_feasible = Eigen::VectorXd::Random(dim_var);
+  qp_coeff.eq_mat_.setRandom();
+  qp_coeff.eq_vec_ = qp_coeff.eq_mat_ * x_feasible;
+  qp_coeff.ineq_mat_.setRandom();
+  qp_coeff.ineq_vec_ = qp_coeff.ineq_mat_ * x_feasible + Eigen::VectorXd::Ones(dim_ineq);
+  qp_coeff.x_min_.setConstant(-10.0);
+  qp_coeff.x_max_.setConstant(10.0);
+  return qp_coeff;
+}
+} // namespace
+
+int main(int argc, char ** argv)
+{
+  if(argc > 1 && (std::string(argv[1]) == "-h" || std::string(argv[1]) == "--help"))
+  {
+    std::cout << "Usage: qp_memory_benchmark [dims]...\n"
+              << "  Print the memory usage [KiB] of each enabled QP solver after solving a dense QP with the given\n"
+              << "  dimensions of decision variable (default: 10 20 50 100 200). The dimensions of equality and\n"
+              << "  inequality constraints are a quarter and a half of it." << std::endl;
+    return 0;
+  }
+
+  std::vector<int> dim_var_list;
+  for(int i = 1; i < argc; i++)
+  {
+    dim_var_list.push_back(std::stoi(argv[i]));
+  }
+  if(dim_var_list.empty())
+  {
+    dim_var_list = {10, 20, 50, 100, 200};
+  }
+
+  std::vector<QpCoeff> qp_coeff_list;
+  for(int dim_var : dim_var_list)
+  {
+    qp_coeff_list.push_back(makeQpCoeff(dim_var));
+  }
+
+  // Markdown table whose columns correspond to the dimensions
+  std::cout << "| QP solver |";
+  for(int dim_var : dim_var_list)
+  {
+    std::cout << " n=" << dim_var << " |";
+  }
+  std::cout << "\n|---|";
+  for(size_t i = 0; i < dim_var_list.size(); i++)
+  {
+    std::cout << "---:|";
+  }
+  std::cout << "\n";
+
+  for(int i = static_cast<int>(QpSolverType::QLD); i <= static_cast<int>(QpSolverType::Builtin); i++)
+  {
+    QpSolverType qp_solver_type = static_cast<QpSolverType>(i);
+    if(!isQpSolverEnabled(qp_solver_type))
+    {
+      continue;
+    }
+
+    std::cout << "| " << std::to_string(qp_solver_type) << " |";
+    for(const auto & qp_coeff : qp_coeff_list)
+    {
+      // A new instance is used for each dimension so that the memory for other dimensions is not included
+      auto qp_solver = allocateQpSolver(qp_solver_type);
+      QpCoeff qp_coeff_copied = qp_coeff;
+      qp_solver->solve(qp_coeff_copied);
+      std::cout << " " << std::fixed << std::setprecision(1) << qp_solver->memoryUsage() / 1024.0 << " |";
+    }
+    std::cout << "\n";
+  }
+  std::cout << std::flush;
+
+  return 0;
+}
@@ -0,0 +1,80 @@
+/* Author: Masaki Murooka */
+
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <qp_solver_collection/MiqpSolver.h>
+
+using namespace QpSolverCollection;
+
+namespace
+{
+/** \brief Make a mixed-integer QP whose first half of the decision variable is binary.
+
+    The inequality constraints are satisfied by zero so that the QP has an integer solution.
+ */
+QpCoeff makeQpCoeff(int dim_var)
+{
+  int dim_ineq = dim_var / 2;
+  QpCoeff qp_coeff;
+  qp_coeff.setup(dim_var, 0, dim_ineq);
+  Eigen::MatrixXd tmp_mat = Eigen::MatrixXd::Random(dim_var, dim_var);
+  qp_coeff.obj_mat_ = tmp_mat.transpose() * tmp_mat + Eigen::MatrixXd::Identity(dim_var, dim_var);
+  qp_coeff.obj_vec_ = 5.0 * Eigen::VectorXd::Random(dim_var);
+  qp_coeff.ineq_mat_.setRandom();
+  qp_coeff.ineq_vec_.setConstant(1.0);
+  qp_coeff.x_min_.setConstant(-10.0);
+  qp_coeff.x_max_.setConstant(10.0);
+  qp_coeff.x_min_.head(dim_var / 2).setZero();
+  qp_coeff.x_max_.head(dim_var / 2).setOnes();
+  return qp_coeff;
+}
+} // namespace
+
+int main(int argc, char ** argv)
+{
+  if(argc > 1 && (std::string(argv[1]) == "-h" || std::string(argv[1]) == "--help"))
+  {
+    std::cout << "Usage: qp_miqp_benchmark [dim_var] [max_thread_num]\n"
+              << "  Print the node throughput of MiqpSolver for each search strategy and number of threads (1, 2, 4,\n"
+              << "  ..., max_thread_num) on a random mixed-integer QP whose first half of the decision variable is\n"
+              << "  binary (default: dim_var 24, max_thread_num 8). The node relaxations are solved by\n"
+              << "  QpSolverType::Any." << std::endl;
+    return 0;
+  }
+
+  int dim_var = argc > 1 ? std::stoi(argv[1]) : 24;
+  int max_thread_num = argc > 2 ? std::stoi(argv[2]) : 8;
+
+  QpCoeff qp_coeff = makeQpCoeff(dim_var);
+  std::vector<int> integer_idx_list;
+  for(int i = 0; i < dim_var / 2; i++)
+  {
+    integer_idx_list.push_back(i);
+  }
+
+  std::cout << "| strategy | threads | nodes | time [ms] | nodes/s | objective |\n"
+            << "|---|---:|---:|---:|---:|---:|\n";
+  for(auto strategy : {MiqpSearchStrategy::BestBound, MiqpSearchStrategy::DepthFirst})
+  {
+    for(int thread_num = 1; thread_num <= max_thread_num; thread_num *= 2)
+    {
+      MiqpSolver miqp_solver(QpSolverType::Any);
+      miqp_solver.strategy_ = strategy;
+      miqp_solver.thread_num_ = thread_num;
+      auto start_time = QpSolver::clock::now();
+      miqp_solver.solve(qp_coeff, integer_idx_list);
+      double duration =
+          1e3 * std::chrono::duration_cast<std::chrono::duration<double>>(QpSolver::clock::now() - start_time).count();
+      std::cout << "| " << std::to_string(strategy) << " | " << thread_num << " | " << miqp_solver.nodeNum() << " | "
+                << std::fixed << std::setprecision(1) << duration << " | " << std::setprecision(0)
+                << 1e3 * miqp_solver.nodeNum() / duration << " | " << std::setprecision(6) << miqp_solver.objValue()
+                << " |\n";
+    }
+  }
+  std::cout << std::flush;
+
+  return 0;
+}
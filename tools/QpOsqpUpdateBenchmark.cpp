@@ -0,0 +1,132 @@
+/* Author: Masaki Murooka */
+
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <qp_solver_collection/QpSolverCollection.h>
+
+using namespace QpSolverCollection;
+
+#if ENABLE_OSQP
+namespace
+{
+/** \brief Update a banded QP whose coupling coefficients vary with time and vanish periodically.
+
+    The objective matrix is tridiagonal, the equality constraints couple the consecutive variables like the dynamics of
+   MPC, and the inequality constraints are active only in a part of the period like contacts. The coefficients that
+   vanish change the sparsity pattern of the matrices.
+ */
+void updateQpCoeff(QpCoeff & qp_coeff, int step)
+{
+  int dim_var = qp_coeff.dim_var_;
+  double t = 0.1 * step;
+  double coupling = std::max(std::sin(t), 0.0);
+  qp_coeff.obj_mat_.setZero();
+  for(int i = 0; i < dim_var; i++)
+  {
+    qp_coeff.obj_mat_(i, i) = 2.0 + std::cos(t + i);
+    if(i + 1 < dim_var)
+    {
+      qp_coeff.obj_mat_(i, i + 1) = qp_coeff.obj_mat_(i + 1, i) = -0.5 * coupling;
+    }
+    qp_coeff.obj_vec_[i] = std::sin(t + 0.3 * i);
+  }
+  qp_coeff.setModified(QpCoeff::Block::ObjMat);
+  qp_coeff.setModified(QpCoeff::Block::ObjVec);
+
+  qp_coeff.eq_mat_.setZero();
+  for(int i = 0; i < qp_coeff.dim_eq_; i++)
+  {
+    qp_coeff.eq_mat_(i, 2 * i) = 1.0;
+    qp_coeff.eq_mat_(i, 2 * i + 1) = -1.0 - 0.1 * coupling;
+    qp_coeff.eq_vec_[i] = 0.1 * std::cos(t + i);
+  }
+  qp_coeff.setModified(QpCoeff::Block::EqMat);
+  qp_coeff.setModified(QpCoeff::Block::EqVec);
+
+  qp_coeff.ineq_mat_.setZero();
+  for(int i = 0; i < qp_coeff.dim_ineq_; i++)
+  {
+    double contact = std::max(std::cos(t + 0.5 * i), 0.0);
+    qp_coeff.ineq_mat_(i, i) = contact;
+    qp_coeff.ineq_mat_(i, (i + 1) % dim_var) = -contact;
+    qp_coeff.ineq_vec_[i] = 0.5;
+  }
+  qp_coeff.setModified(QpCoeff::Block::IneqMat);
+  qp_coeff.setModified(QpCoeff::Block::IneqVec);
+}
+} // namespace
+#endif
+
+int main(int argc, char ** argv)
+{
+  if(argc > 1 && (std::string(argv[1]) == "-h" || std::string(argv[1]) == "--help"))
+  {
+    std::cout << "Usage: qp_osqp_update_benchmark [solve_num] [dims]...\n"
+              << "  Print the average computation time [us] of OSQP updated with and without fixing the sparsity\n"
+              << "  pattern (QpSolverOsqp::fix_sparsity_pattern_) for a time-varying banded QP whose coefficients\n"
+              << "  vanish periodically, with the given dimensions of decision variable (default: solve_num 1000,\n"
+              << "  dims 20 100 400). The number of full initializations by the wrapper (only counted when the\n"
+              << "  pattern is fixed) and failed solves are also printed." << std::endl;
+    return 0;
+  }
+
+#if ENABLE_OSQP
+  int solve_num = argc > 1 ? std::stoi(argv[1]) : 1000;
+  std::vector<int> dim_var_list;
+  for(int i = 2; i < argc; i++)
+  {
+    dim_var_list.push_back(std::stoi(argv[i]));
+  }
+  if(dim_var_list.empty())
+  {
+    dim_var_list = {20, 100, 400};
+  }
+
+  std::cout << "| n | fix_sparsity_pattern_ | time [us] | full init | failed |\n"
+            << "|---:|---|---:|---:|---:|\n";
+  for(int dim_var : dim_var_list)
+  {
+    for(bool fix_sparsity_pattern : {false, true})
+    {
+      QpSolverOsqp qp_solver;
+      qp_solver.force_initialize_ = false;
+      qp_solver.fix_sparsity_pattern_ = fix_sparsity_pattern;
+
+      QpCoeff qp_coeff;
+      qp_coeff.setup(dim_var, dim_var / 2, dim_var);
+      qp_coeff.x_min_.setConstant(-1.0);
+      qp_coeff.x_max_.setConstant(1.0);
+      qp_coeff.track_modification_ = true;
+
+      int fail_num = 0;
+      double duration = 0;
+      for(int step = 0; step < solve_num; step++)
+      {
+        updateQpCoeff(qp_coeff, step);
+        auto start_time = QpSolver::clock::now();
+        static_cast<QpSolver &>(qp_solver).solve(qp_coeff);
+        duration += std::chrono::duration_cast<std::chrono::duration<double>>(QpSolver::clock::now() - start_time)
+                        .count();
+        if(qp_solver.solveFailed())
+        {
+          fail_num++;
+        }
+      }
+      std::cout << "| " << dim_var << " | " << (fix_sparsity_pattern ? "true" : "false") << " | " << std::fixed
+                << std::setprecision(1) << 1e6 * duration / solve_num << " | "
+                << (fix_sparsity_pattern ? std::to_string(qp_solver.initNum()) : "-") << " | " << fail_num << " |\n";
+    }
+  }
+  std::cout << std::flush;
+
+  return 0;
+#else
+  std::cerr << "[qp_osqp_update_benchmark] OSQP is not enabled." << std::endl;
+  return 1;
+#endif
+}
@@ -0,0 +1,124 @@
+/* Author: Masaki Murooka */
+
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <qp_solver_collection/QpSolverCollection.h>
+
+using namespace QpSolverCollection;
+
+namespace
+{
+/** \brief Make a feasible QP of the given dimension with dense random coefficients. */
+QpCoeff makeQpCoeff(int dim_var)
+{
+  int dim_eq = dim_var / 4;
+  int dim_ineq = dim_var;
+  QpCoeff qp_coeff;
+  qp_coeff.setup(dim_var, dim_eq, dim_ineq);
+  Eigen::MatrixXd tmp_mat = Eigen::MatrixXd::Random(dim_var, dim_var);
+  qp_coeff.obj_mat_ = tmp_mat.transpose() * tmp_mat + Eigen::MatrixXd::Identity(dim_var, dim_var);
+  qp_coeff.obj_vec_ = 10.0 * Eigen::VectorXd::Random(dim_var);
+  Eigen::VectorXd x_feasible = 0.5 * Eigen::VectorXd::Random(dim_var);
+  qp_coeff.eq_mat_.setRandom();
+  qp_coeff.eq_vec_ = qp_coeff.eq_mat_ * x_feasible;
+  qp_coeff.ineq_mat_.setRandom();
+  qp_coeff.ineq_vec_ = qp_coeff.ineq_mat_ * x_feasible + 0.1 * Eigen::VectorXd::Ones(dim_ineq);
+  qp_coeff.x_min_.setConstant(-1.0);
+  qp_coeff.x_max_.setConstant(1.0);
+  return qp_coeff;
+}
+} // namespace
+
+int main(int argc, char ** argv)
+{
+  if(argc > 1 && (std::string(argv[1]) == "-h" || std::string(argv[1]) == "--help"))
+  {
+    std::cout << "Usage: qp_solver_benchmark [solve_num] [dims]...\n"
+              << "  Print the average computation time [us] of each enabled QP solver for dense random QPs with the\n"
+              << "  given dimensions of decision variable (default: solve_num 100, dims 10 20 50 100). The\n"
+              << "  dimensions of equality and inequality constraints are a quarter of and the same as it, and all\n"
+              << "  the variables are bounded. Failed solves are counted in parentheses." << std::endl;
+    return 0;
+  }
+
+  int solve_num = argc > 1 ? std::stoi(argv[1]) : 100;
+  std::vector<int> dim_var_list;
+  for(int i = 2; i < argc; i++)
+  {
+    dim_var_list.push_back(std::stoi(argv[i]));
+  }
+  if(dim_var_list.empty())
+  {
+    dim_var_list = {10, 20, 50, 100};
+  }
+
+  // The same QPs are solved by all the QP solvers
+  std::vector<std::vector<QpCoeff>> qp_coeff_list;
+  for(int dim_var : dim_var_list)
+  {
+    qp_coeff_list.emplace_back();
+    for(int i = 0; i < solve_num; i++)
+    {
+      qp_coeff_list.back().push_back(makeQpCoeff(dim_var));
+    }
+  }
+
+  // Markdown table whose columns correspond to the dimensions
+  std::cout << "| QP solver |";
+  for(int dim_var : dim_var_list)
+  {
+    std::cout << " n=" << dim_var << " |";
+  }
+  std::cout << "\n|---|";
+  for(size_t i = 0; i < dim_var_list.size(); i++)
+  {
+    std::cout << "---:|";
+  }
+  std::cout << "\n";
+
+  for(int i = static_cast<int>(QpSolverType::QLD); i <= static_cast<int>(QpSolverType::Builtin); i++)
+  {
+    QpSolverType qp_solver_type = static_cast<QpSolverType>(i);
+    if(!isQpSolverEnabled(qp_solver_type))
+    {
+      continue;
+    }
+
+    auto qp_solver = allocateQpSolver(qp_solver_type);
+    std::cout << "| " << std::to_string(qp_solver_type) << " |";
+    for(auto & qp_coeff_list_for_dim : qp_coeff_list)
+    {
+      // Solve once before measurement so that the workspace allocation is excluded
+      QpCoeff qp_coeff_copied = qp_coeff_list_for_dim.front();
+      qp_solver->solve(qp_coeff_copied);
+
+      int fail_num = 0;
+      double duration = 0;
+      for(const auto & qp_coeff : qp_coeff_list_for_dim)
+      {
+        qp_coeff_copied = qp_coeff;
+        auto start_time = QpSolver::clock::now();
+        qp_solver->solve(qp_coeff_copied);
+        duration += std::chrono::duration_cast<std::chrono::duration<double>>(QpSolver::clock::now() - start_time)
+                        .count();
+        if(qp_solver->solveFailed())
+        {
+          fail_num++;
+        }
+      }
+      std::cout << " " << std::fixed << std::setprecision(1) << 1e6 * duration / solve_num;
+      if(fail_num > 0)
+      {
+        std::cout << " (" << fail_num << ")";
+      }
+      std::cout << " |";
+    }
+    std::cout << "\n";
+  }
+  std::cout << std::flush;
+
+  return 0;
+}
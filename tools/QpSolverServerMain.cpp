@@ -0,0 +1,118 @@
+/* Author: Masaki Murooka */
+
+#include <chrono>
+#include <csignal>
+#include <iostream>
+#include <thread>
+
+#include <qp_solver_collection/QpSolverServer.h>
+
+using namespace QpSolverCollection;
+
+namespace
+{
+volatile std::sig_atomic_t g_shutdown_requested = 0;
+
+void signalHandler(int)
+{
+  g_shutdown_requested = 1;
+}
+
+void printUsage()
+{
+  std::cout << "Usage: qp_solver_server [options]\n"
+            << "  Solve QPs placed in POSIX shared memory by QpSolverClient.\n"
+            << "Options:\n"
+            << "  --name <name>                  name of shared memory (default: /qp_solver_server)\n"
+            << "  --solver <name>                QP solver name, e.g., OSQP (default: Any)\n"
+            << "  --max-dim <var> <eq> <ineq>    maximum dimensions of QP (default: 100 100 100)\n"
+            << "  --slots <num>                  number of slots (default: 8)\n"
+            << "  --threads <num>                number of worker threads (default: 1)\n"
+            << "  --force                        remove the existing shared memory of the same name\n"
+            << "  --settings <path>              settings profile saved by saveSettingsProfile" << std::endl;
+}
+} // namespace
+
+int main(int argc, char ** argv)
+{
+  std::string name = "/qp_solver_server";
+  QpSolverType qp_solver_type = QpSolverType::Any;
+  QpShmConfig config;
+  config.max_dim_var = 100;
+  config.max_dim_eq = 100;
+  config.max_dim_ineq = 100;
+  int thread_num = 1;
+  std::string settings_path;
+
+  for(int i = 1; i < argc; i++)
+  {
+    std::string arg = argv[i];
+    if(arg == "--name" && i + 1 < argc)
+    {
+      name = argv[++i];
+    }
+    else if(arg == "--solver" && i + 1 < argc)
+    {
+      std::string solver_name = argv[++i];
+      qp_solver_type = (solver_name == "Any" ? QpSolverType::Any : strToQpSolverType(solver_name));
+    }
+    else if(arg == "--max-dim" && i + 3 < argc)
+    {
+      config.max_dim_var = std::stoi(argv[++i]);
+      config.max_dim_eq = std::stoi(argv[++i]);
+      config.max_dim_ineq = std::stoi(argv[++i]);
+    }
+    else if(arg == "--slots" && i + 1 < argc)
+    {
+      config.slot_num = std::stoi(argv[++i]);
+    }
+    else if(arg == "--threads" && i + 1 < argc)
+    {
+      thread_num = std::stoi(argv[++i]);
+    }
+    else if(arg == "--force")
+    {
+      config.remove_existing = true;
+    }
+    else if(arg == "--settings" && i + 1 < argc)
+    {
+      settings_path = argv[++i];
+    }
+    else
+    {
+      printUsage();
+      return arg == "-h" || arg == "--help" ? 0 : 1;
+    }
+  }
+
+  if(qp_solver_type == QpSolverType::Any)
+  {
+    qp_solver_type = getAnyQpSolverType();
+  }
+
+  QpSolverServer server(name, qp_solver_type, config, thread_num);
+  if(!settings_path.empty())
+  {
+    auto settings_profile = loadSettingsProfile(settings_path);
+    if(settings_profile.count(qp_solver_type) > 0)
+    {
+      server.setSettings(settings_profile.at(qp_solver_type));
+    }
+  }
+
+  std::signal(SIGINT, signalHandler);
+  std::signal(SIGTERM, signalHandler);
+  server.start();
+  std::cout << "Serving " << std::to_string(qp_solver_type) << " on shared memory " << name << " with " << thread_num
+            << " threads." << std::endl;
+
+  while(!g_shutdown_requested)
+  {
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  }
+
+  server.stop();
+  std::cout << "Solved " << server.solvedCount() << " requests." << std::endl;
+
+  return 0;
+}
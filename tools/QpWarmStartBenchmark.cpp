@@ -0,0 +1,176 @@
+/* Author: Masaki Murooka */
+
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <qp_solver_collection/QpSolverCollection.h>
+
+using namespace QpSolverCollection;
+
+namespace
+{
+/** \brief Make QPs of MPC for a double integrator tracking a sinusoidal reference in closed loop.
+
+    The decision variable is composed of the states [x_1, ..., x_N] and the inputs [u_0, ..., u_{N-1}], where each
+   state is composed of the position and velocity. The equality constraints are the dynamics from the current state,
+   and the inputs and positions are bounded. The first input of each solution is applied to update the current state.
+ */
+std::vector<QpCoeff> makeMpcQpCoeffList(int horizon, int step_num)
+{
+  constexpr double dt = 0.05;
+  Eigen::Matrix2d state_mat;
+  state_mat << 1.0, dt, 0.0, 1.0;
+  Eigen::Vector2d input_mat(0.5 * dt * dt, dt);
+
+  int dim_state = 2 * horizon;
+  int dim_var = dim_state + horizon;
+  QpCoeff qp_coeff;
+  qp_coeff.setup(dim_var, dim_state, 0);
+  for(int k = 0; k < horizon; k++)
+  {
+    qp_coeff.obj_mat_.block<2, 2>(2 * k, 2 * k).diagonal() << 100.0, 1.0;
+    qp_coeff.obj_mat_(dim_state + k, dim_state + k) = 1e-2;
+    qp_coeff.eq_mat_.block<2, 2>(2 * k, 2 * k).setIdentity();
+    if(k > 0)
+    {
+      qp_coeff.eq_mat_.block<2, 2>(2 * k, 2 * (k - 1)) = -state_mat;
+    }
+    qp_coeff.eq_mat_.block<2, 1>(2 * k, dim_state + k) = -input_mat;
+    qp_coeff.x_min_.segment<2>(2 * k) << -0.8, -10.0;
+    qp_coeff.x_max_.segment<2>(2 * k) << 0.8, 10.0;
+  }
+  qp_coeff.x_min_.tail(horizon).setConstant(-5.0);
+  qp_coeff.x_max_.tail(horizon).setConstant(5.0);
+
+  auto qp_solver = allocateQpSolver(QpSolverType::Builtin);
+  std::vector<QpCoeff> qp_coeff_list;
+  Eigen::Vector2d state = Eigen::Vector2d::Zero();
+  for(int step = 0; step < step_num; step++)
+  {
+    for(int k = 0; k < horizon; k++)
+    {
+      // The reference exceeds the position bound in a part of the period
+      qp_coeff.obj_vec_[2 * k] = -100.0 * std::sin(2.0 * dt * (step + k + 1));
+    }
+    qp_coeff.eq_vec_.head<2>() = state_mat * state;
+    qp_coeff_list.push_back(qp_coeff);
+
+    QpCoeff qp_coeff_copied = qp_coeff;
+    Eigen::VectorXd x = qp_solver->solve(qp_coeff_copied);
+    state = state_mat * state + input_mat * x[dim_state];
+  }
+  return qp_coeff_list;
+}
+
+/** \brief Shift each of the states, inputs, and their Lagrange multipliers by one step along the horizon. */
+Eigen::VectorXd shiftAlongHorizon(const Eigen::VectorXd & vec, int block_size, int block_num)
+{
+  Eigen::VectorXd vec_shifted = vec;
+  int size = block_size * (block_num - 1);
+  vec_shifted.head(size) = vec.segment(block_size, size);
+  return vec_shifted;
+}
+
+/** \brief Make initial guess from the solution of the previous MPC step. */
+WarmStart shiftSolution(const SolveResult & result, int horizon)
+{
+  int dim_state = 2 * horizon;
+  WarmStart warm_start;
+  warm_start.x_.resize(result.x_.size());
+  warm_start.x_ << shiftAlongHorizon(result.x_.head(dim_state), 2, horizon),
+      shiftAlongHorizon(result.x_.tail(horizon), 1, horizon);
+  if(result.hasDual())
+  {
+    warm_start.dual_eq_ = shiftAlongHorizon(result.dual_eq_, 2, horizon);
+    warm_start.dual_bound_.resize(result.dual_bound_.size());
+    warm_start.dual_bound_ << shiftAlongHorizon(result.dual_bound_.head(dim_state), 2, horizon),
+        shiftAlongHorizon(result.dual_bound_.tail(horizon), 1, horizon);
+  }
+  return warm_start;
+}
+} // namespace
+
+int main(int argc, char ** argv)
+{
+  if(argc > 1 && (std::string(argv[1]) == "-h" || std::string(argv[1]) == "--help"))
+  {
+    std::cout << "Usage: qp_warm_start_benchmark [step_num] [horizon]\n"
+              << "  Print the average number of iterations and computation time [us] of each enabled QP solver for\n"
+              << "  the sequential QPs of MPC in closed loop, solved without and with the initial guess shifted from\n"
+              << "  the solution of the previous step (default: step_num 200, horizon 20). The initial guess is used\n"
+              << "  by HPIPM (only the primal variable), OSQP, PROXQP, and qpOASES (only when initialized). The number\n"
+              << "  of iterations is not printed if not provided by the QP solver, and failed solves are counted in\n"
+              << "  parentheses." << std::endl;
+    return 0;
+  }
+
+  int step_num = argc > 1 ? std::stoi(argv[1]) : 200;
+  int horizon = argc > 2 ? std::stoi(argv[2]) : 20;
+  std::vector<QpCoeff> qp_coeff_list = makeMpcQpCoeffList(horizon, step_num);
+
+  std::cout << "| QP solver | iter (cold) | iter (warm) | time (cold) | time (warm) |\n"
+            << "|---|---:|---:|---:|---:|\n";
+  for(int i = static_cast<int>(QpSolverType::QLD); i <= static_cast<int>(QpSolverType::Builtin); i++)
+  {
+    QpSolverType qp_solver_type = static_cast<QpSolverType>(i);
+    if(!isQpSolverEnabled(qp_solver_type))
+    {
+      continue;
+    }
+
+    std::cout << "| " << std::to_string(qp_solver_type) << " |";
+    std::vector<std::string> column_list;
+    for(bool use_warm_start : {false, true})
+    {
+      auto qp_solver = allocateQpSolver(qp_solver_type);
+      SolveResult result;
+      int fail_num = 0;
+      int iter_num = 0;
+      double duration = 0;
+      for(auto & qp_coeff : qp_coeff_list)
+      {
+        QpCoeff qp_coeff_copied = qp_coeff;
+        bool warm = use_warm_start && result.x_.size() > 0 && !qp_solver->solveFailed();
+        WarmStart warm_start = (warm ? shiftSolution(result, horizon) : WarmStart());
+        auto start_time = QpSolver::clock::now();
+        result = (warm ? qp_solver->solveWithResult(qp_coeff_copied, warm_start)
+                       : qp_solver->solveWithResult(qp_coeff_copied));
+        duration += std::chrono::duration_cast<std::chrono::duration<double>>(QpSolver::clock::now() - start_time)
+                        .count();
+        iter_num = (iter_num < 0 || qp_solver->iterNum() < 0 ? -1 : iter_num + qp_solver->iterNum());
+        if(qp_solver->solveFailed())
+        {
+          fail_num++;
+        }
+      }
+
+      std::ostringstream oss;
+      oss << std::fixed << std::setprecision(1);
+      if(iter_num >= 0)
+      {
+        oss << static_cast<double>(iter_num) / step_num;
+      }
+      else
+      {
+        oss << "-";
+      }
+      column_list.push_back(oss.str());
+      oss.str("");
+      oss << 1e6 * duration / step_num;
+      if(fail_num > 0)
+      {
+        oss << " (" << fail_num << ")";
+      }
+      column_list.push_back(oss.str());
+    }
+    std::cout << " " << column_list[0] << " | " << column_list[2] << " | " << column_list[1] << " | "
+              << column_list[3] << " |\n";
+  }
+  std::cout << std::flush;
+
+  return 0;
+}